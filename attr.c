@@ -49,5 +49,7 @@
 #include "pthread_attr_setstackaddr.c"
 #include "pthread_attr_getstacksize.c"
 #include "pthread_attr_setstacksize.c"
+#include "pthread_attr_setgroup_np.c"
+#include "pthread_attr_setname_np.c"
 #include "pthread_attr_getscope.c"
 #include "pthread_attr_setscope.c"
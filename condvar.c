@@ -44,7 +44,9 @@
 #include "pthread_condattr_destroy.c"
 #include "pthread_condattr_getpshared.c"
 #include "pthread_condattr_setpshared.c"
+#include "pthread_condattr_setwakeorder_np.c"
 #include "pthread_cond_init.c"
 #include "pthread_cond_destroy.c"
 #include "pthread_cond_wait.c"
+#include "pthread_cond_timedwait_slack_np.c"
 #include "pthread_cond_signal.c"
@@ -145,6 +145,7 @@ pthread_create (pthread_t * tid,
       stackSize = a->stacksize;
       tp->detachState = a->detachstate;
       priority = a->param.sched_priority;
+      (void) memcpy (tp->name, a->name, sizeof (tp->name));
 
 #if (THREAD_PRIORITY_LOWEST > THREAD_PRIORITY_NORMAL)
       /* WinCE */
@@ -191,6 +192,32 @@ pthread_create (pthread_t * tid,
 
   tp->keys = NULL;
 
+  /*
+   * Join the group before the thread can run, so that it can't
+   * finish unseen by pthread_group_join_np().
+   */
+  if (a != NULL && a->group != NULL)
+    {
+      ptw32_group_add (a->group, tp);
+    }
+
+  /*
+   * Joiners wait for this rather than the thread handle, which is
+   * signaled only after every DLL has seen DLL_THREAD_DETACH. If
+   * it can't be created, pthread_join falls back to the handle.
+   */
+  if (tp->detachState == PTHREAD_CREATE_JOINABLE)
+    {
+      tp->exitEvent = CreateEvent (0, (int) PTW32_TRUE,	/* manualReset  */
+				   (int) PTW32_FALSE,	/* setSignaled  */
+				   NULL);
+
+      if (tp->exitEvent != NULL)
+	{
+	  PTW32_STATS_INC(PTW32_STAT_THREAD_HANDLES);
+	}
+    }
+
   /*
    * Threads must be started in suspended mode and resumed if necessary
    * after _beginthreadex returns us the handle. Otherwise we set up a
@@ -214,11 +241,22 @@ pthread_create (pthread_t * tid,
 
   if (threadH != 0)
     {
+      PTW32_STATS_INC(PTW32_STAT_THREAD_HANDLES);
+
       if (a != NULL)
 	{
 	  (void) ptw32_setthreadpriority (thread, SCHED_OTHER, priority);
 	}
 
+      /*
+       * Name it before it runs, so that it is named in every
+       * event a debugger or profiler sees.
+       */
+      if (tp->name[0] != '\0')
+	{
+	  ptw32_thread_name_publish (threadH, tp->thread, tp->name);
+	}
+
       if (run)
 	{
 	  ResumeThread (threadH);
@@ -297,6 +335,7 @@ FAIL0:
   else
     {
       *tid = thread;
+      PTW32_STATS_INC(PTW32_STAT_THREADS_CREATED);
     }
 
 #ifdef _UWIN
@@ -41,7 +41,7 @@
 
 #ifdef _MSC_VER
 /* 
- * lpvReserved yields an unreferenced formal parameter;
+ * hinstDll yields an unreferenced formal parameter;
  * ignore it
  */
 #pragma warning( disable : 4100 )
@@ -80,6 +80,14 @@ DllMain (HINSTANCE hinstDll, DWORD fdwReason, LPVOID lpvReserved)
       break;
 
     case DLL_PROCESS_DETACH:
+      /*
+       * lpvReserved is non-NULL if the process is terminating
+       * rather than the DLL being unloaded by FreeLibrary.
+       */
+      if (lpvReserved != NULL)
+	{
+	  ptw32_processExiting = PTW32_TRUE;
+	}
       (void) pthread_win32_thread_detach_np ();
       result = pthread_win32_process_detach_np ();
       break;
@@ -40,6 +40,14 @@
 
 
 int ptw32_processInitialized = PTW32_FALSE;
+
+/*
+ * Set when the library is being detached because the process is
+ * exiting (as opposed to the DLL being unloaded). The OS reclaims
+ * everything at that point so teardown can skip freeing memory.
+ */
+int ptw32_processExiting = PTW32_FALSE;
+
 ptw32_thread_t * ptw32_threadReuseTop = PTW32_THREAD_REUSE_EMPTY;
 ptw32_thread_t * ptw32_threadReuseBottom = PTW32_THREAD_REUSE_EMPTY;
 pthread_key_t ptw32_selfThreadKey = NULL;
@@ -52,6 +60,75 @@ int ptw32_concurrency = 0;
 /* What features have been auto-detected */
 int ptw32_features = 0;
 
+/*
+ * Sharded library-wide counters. See pthread_getstats_np().
+ * pthread_stats_export_np() points ptw32_stats_shards elsewhere.
+ */
+ptw32_stats_shard_t ptw32_stats_local[PTW32_STATS_SHARDS];
+ptw32_stats_shard_t * ptw32_stats_shards = ptw32_stats_local;
+
+/*
+ * Wait hooks. See pthread_set_wait_hooks_np().
+ */
+int ptw32_wait_hooks_active = PTW32_FALSE;
+struct ptw32_wait_hooks ptw32_wait_hooks = {NULL, NULL, NULL};
+
+/*
+ * Watchdog. See pthread_watchdog_np().
+ * ptw32_watchdog_used stays set once the watchdog has been started.
+ */
+int ptw32_watchdog_active = PTW32_FALSE;
+int ptw32_watchdog_used = PTW32_FALSE;
+ptw32_thread_t * ptw32_watch_list = NULL;
+DWORD ptw32_watchdog_threadId = 0;
+
+/*
+ * Contention profile. See pthread_profile_np().
+ * ptw32_profile_used stays set once profiling has been turned on.
+ */
+int ptw32_profile_rate = 0;
+int ptw32_profile_used = PTW32_FALSE;
+
+/*
+ * Non-zero while the lock trace is recording. See pthread_locktrace_np().
+ */
+int ptw32_locktrace_enabled = PTW32_FALSE;
+
+/*
+ * Wait policy. See pthread_setwaitpolicy_np().
+ * Set from the processor count at process initialisation.
+ */
+struct ptw32_wait_policy ptw32_wait_policy = {0, 0, PTW32_YIELD_SLEEP0};
+int ptw32_wait_policy_explicit = PTW32_FALSE;
+int ptw32_wait_spinning = PTW32_FALSE;
+
+/*
+ * Cohort mutex topology override.
+ * See pthread_mutex_setcohorttopology_np().
+ */
+int ptw32_cohort_fake_nodes = 0;
+ptw32_cohort_node_fn_t ptw32_cohort_fake_node_of = NULL;
+
+/*
+ * Per-thread arena for sized keys. See pthread_key_create_sized_np().
+ * ptw32_tls_arena_key holds each thread's first arena segment.
+ * Sized keys are listed in offset order and never unlinked; a
+ * deleted one is taken over by the next key of its size.
+ */
+pthread_key_t ptw32_tls_arena_key = NULL;
+pthread_key_t ptw32_tls_arena_keys = NULL;
+pthread_key_t ptw32_tls_arena_last = NULL;
+size_t ptw32_tls_arena_end = 0;
+LONG ptw32_tls_arena_generation = 0;
+
+#if defined(PTW32_TRACE)
+/*
+ * Non-zero while event tracing is recording. Tested inline by
+ * PTW32_TRACE_EVENT so that disabled tracing costs one branch.
+ */
+int ptw32_trace_enabled = PTW32_FALSE;
+#endif
+
 /*
  * Global [process wide] thread sequence Number
  */
@@ -99,6 +176,18 @@ ptw32_mcs_lock_t ptw32_spinlock_test_init_lock = 0;
  */
 ptw32_mcs_lock_t ptw32_cond_list_lock = 0;
 
+/*
+ * Global lock for the sized key list and arena layout.
+ */
+ptw32_mcs_lock_t ptw32_tls_arena_lock = 0;
+
+/*
+ * Global locks for the watchdog's list of blocked threads and for
+ * starting and stopping the watchdog.
+ */
+ptw32_mcs_lock_t ptw32_watch_lock = 0;
+ptw32_mcs_lock_t ptw32_watchdog_lock = 0;
+
 #ifdef _UWIN
 /*
  * Keep a count of the number of threads.
@@ -128,6 +128,7 @@ PThreadState;
 typedef struct ptw32_mcs_node_t_     ptw32_mcs_local_node_t;
 typedef struct ptw32_mcs_node_t_*    ptw32_mcs_lock_t;
 typedef struct ptw32_robust_node_t_  ptw32_robust_node_t;
+typedef struct ptw32_cohort_t_       ptw32_cohort_t;
 typedef struct ptw32_thread_t_       ptw32_thread_t;
 
 
@@ -152,6 +153,29 @@ struct ptw32_thread_t_
   int cancelState;
   int cancelType;
   HANDLE cancelEvent;
+  LONG interrupted;		/* Set by pthread_interrupt_np() */
+  HANDLE exitEvent;		/* Signaled for joiners when done */
+  pthread_group_t group;	/* Group joined at creation, if any */
+  ptw32_thread_t * groupNext;	/* Links members on the group's lists */
+  ptw32_thread_t * groupPrev;
+  int groupDone;		/* On the group's done list */
+  ptw32_thread_t * watchNext;	/* Links threads blocked while the watchdog runs */
+  ptw32_thread_t * watchPrev;
+  void * watchObject;		/* What we are blocked on, see ptw32_watch_begin() */
+  int watchType;		/* PTW32_WAIT_* */
+  ULONGLONG watchStart;		/* Hook counter at first block, 0 if not watched */
+  ULONGLONG watchReported;	/* watchStart of the last wait reported */
+  void * watchRwlock;		/* rwlock being acquired, if any */
+  char name[PTW32_THREAD_NAME_MAX];	/* See pthread_setname_np(), under threadLock */
+  int profileCountdown;		/* Blocks until the next profile sample */
+  DWORD timerSlack;		/* See pthread_setslack_np(), in milliseconds */
+  DWORD callSlack;		/* 1 + slack of a *_slack_np() call in progress, else 0; owner only */
+  HANDLE slackTimer;		/* Waitable timer, created by the owner on first use */
+  struct ptw32_msg * volatile mailHead;	/* Senders push here, newest first */
+  struct ptw32_msg * mailLocal;	/* Taken from mailHead, oldest first; owner only */
+  LONG mailWaiting;		/* Owner is parked on mailEvent */
+  HANDLE mailEvent;		/* Auto-reset, created by the owner on first park */
+  HANDLE parkEvent;		/* Auto-reset, for exchanger waits; owner creates */
 #ifdef __CLEANUP_C
   jmp_buf start_mark;
 #endif				/* __CLEANUP_C */
@@ -185,6 +209,66 @@ struct pthread_attr_t_
 #if HAVE_SIGSET_T
   sigset_t sigmask;
 #endif				/* HAVE_SIGSET_T */
+  pthread_group_t group;
+  char name[PTW32_THREAD_NAME_MAX];
+};
+
+
+/*
+ * A thread group. Members are on 'running' until their start
+ * routine returns. Joinable members then move to 'done' until
+ * pthread_group_join_np() or pthread_group_wait_any_np() reclaims
+ * them; detached members just leave. 'event' is set each time a
+ * member finishes and is reset by a waiter that finds nothing to do.
+ */
+struct pthread_group_t_
+{
+  ptw32_mcs_lock_t lock;
+  ptw32_thread_t * running;
+  ptw32_thread_t * done;
+  HANDLE event;
+};
+
+/*
+ * Exchangers (see pthread_exchanger_put_np()).
+ *
+ * A thread that finds no peer waiting queues a node from its own
+ * stack and spins, then parks on its parkEvent. The peer that
+ * arrives unlinks the node, swaps items with it directly and sets
+ * it DONE, signalling the event only if the waiter had parked. A
+ * parked waiter never returns before it has had that signal, so the
+ * peer never touches a node or event that has gone away.
+ */
+enum {
+  PTW32_EXCHANGE_PUT,
+  PTW32_EXCHANGE_TAKE,
+  PTW32_EXCHANGE_SWAP
+};
+
+enum {
+  PTW32_EXCHANGE_WAITING,
+  PTW32_EXCHANGE_PARKED,
+  PTW32_EXCHANGE_DONE
+};
+
+typedef struct ptw32_exchanger_node_t_ ptw32_exchanger_node_t;
+
+struct ptw32_exchanger_node_t_
+{
+  ptw32_exchanger_node_t * next;
+  ptw32_exchanger_node_t * prev;
+  pthread_exchanger_t exchanger;
+  int role;			/* PTW32_EXCHANGE_PUT, _TAKE or _SWAP */
+  void * item;			/* Ours, replaced by the peer's */
+  volatile LONG state;		/* PTW32_EXCHANGE_WAITING, _PARKED or _DONE */
+  HANDLE event;			/* The waiter's parkEvent */
+};
+
+struct pthread_exchanger_t_
+{
+  ptw32_mcs_lock_t lock;
+  ptw32_exchanger_node_t * head;	/* Waiters, oldest first */
+  ptw32_exchanger_node_t * tail;
 };
 
 
@@ -196,14 +280,38 @@ struct pthread_attr_t_
  * ====================
  */
 
+/*
+ * A thread blocked in sem_wait_n_np(), or in any sem wait on a
+ * semaphore with a wake order set. Waiters queue in arrival order
+ * (by priority first for PTHREAD_WAKE_PRIORITY_NP); the head
+ * collects posted tokens in 'got' until it has 'n' and is then
+ * dequeued and its event set. While the queue is not empty value
+ * is never positive, so tokens are reserved for the head rather
+ * than taken by later arrivals.
+ */
+typedef struct ptw32_sem_waiter_t_ ptw32_sem_waiter_t;
+
+struct ptw32_sem_waiter_t_
+{
+  ptw32_sem_waiter_t * next;
+  HANDLE event;
+  int n;
+  int got;
+  int priority;			/* sched_priority, PTHREAD_WAKE_PRIORITY_NP only */
+};
+
 struct sem_t_
 {
   int value;
   pthread_mutex_t lock;
   HANDLE sem;
+  DWORD wakerThread;		/* Win32 id of the last thread to release sem */
 #ifdef NEED_SEM
   int leftToUnblock;
 #endif
+  ptw32_sem_waiter_t * waitersHead;	/* sem_wait_n_np() queue */
+  ptw32_sem_waiter_t * waitersTail;
+  int wakeOrder;		/* PTHREAD_WAKE_*_NP */
 };
 
 #define PTW32_OBJECT_AUTO_INIT ((void *) -1)
@@ -224,8 +332,11 @@ struct pthread_mutex_t_
   pthread_t ownerThread;
   HANDLE event;			/* Mutex release notification to waiting
 				   threads. */
+  DWORD wakerThread;		/* Win32 id of the last thread to set event */
   ptw32_robust_node_t*
                     robustNode; /* Extra state for robust mutexes  */
+  ptw32_cohort_t*   cohort;     /* Extra state for cohort mutexes  */
+  LONG traceId;			/* Lock trace object id, 0 until traced */
 };
 
 enum ptw32_robust_state_t_
@@ -248,6 +359,44 @@ struct ptw32_robust_node_t_
   ptw32_robust_node_t* next;
 };
 
+/*
+ * Cohort mutexes (PTHREAD_MUTEX_COHORT_NP).
+ *
+ * The mutex's own lock_idx and event form the global lock. Each
+ * node has a local lock of the same form; a thread takes its node's
+ * local lock and then the global lock. On unlock, if other threads
+ * of the same node are waiting for the local lock the global lock is
+ * kept and passed to them with the local lock, up to
+ * PTW32_COHORT_MAX_PASSES times in a row, before it is released so
+ * that other nodes get a turn.
+ */
+#ifndef PTW32_COHORT_MAX_PASSES
+#define PTW32_COHORT_MAX_PASSES  64
+#endif
+
+#define PTW32_COHORT_MAX_NODES   64
+
+typedef struct ptw32_cohort_node_t_ ptw32_cohort_node_t;
+
+struct ptw32_cohort_node_t_
+{
+  LONG lock_idx;		/* Local lock, as pthread_mutex_t_ lock_idx */
+  LONG waiters;			/* Threads waiting for the local lock */
+  int passes;			/* Consecutive local handovers */
+  int holdsGlobal;		/* Local lock carries the global lock */
+  HANDLE event;			/* Local lock release notification */
+  DWORD wakerThread;		/* Win32 id of the last thread to set event */
+  char pad[64];			/* Keep nodes on separate cache lines */
+};
+
+struct ptw32_cohort_t_
+{
+  int nodes;
+  int ownerNode;		/* Node of the current owner */
+  ptw32_cohort_node_fn_t nodeOf;/* Topology override, or NULL */
+  ptw32_cohort_node_t node[1];	/* Actually [nodes] */
+};
+
 struct pthread_mutexattr_t_
 {
   int pshared;
@@ -321,9 +470,42 @@ struct pthread_key_t_
   void (*destructor) (void *);
   ptw32_mcs_lock_t keyLock;
   void *threads;
+  /*
+   * Sized keys only (size != 0); see pthread_key_create_sized_np().
+   */
+  size_t size;
+  size_t offset;		/* Of the block in each thread's arena */
+  void (*constructor) (void *);
+  pthread_key_t nextSized;
+  LONG generation;		/* Stamp of constructed blocks; 0 once deleted */
 };
 
 
+/*
+ * A piece of a thread's sized key arena. The first segment covers
+ * offsets from 0; later ones are added for keys created after it.
+ * The block for offset o is at origin + o, for start <= o < end.
+ * The LONG before each block holds the generation of the key it was
+ * constructed for, 0 until then: a deleted key's place goes to the
+ * next key of the same size, and each thread reconstructs the block
+ * on its first use by the new key.
+ */
+typedef struct ptw32_tls_segment_t_ ptw32_tls_segment_t;
+
+struct ptw32_tls_segment_t_
+{
+  char * origin;
+  size_t start;
+  size_t end;
+  ptw32_tls_segment_t * next;
+};
+
+#define PTW32_TLS_ARENA_ALIGN_MAX  64
+
+#define PTW32_TLS_ARENA_STAMP(_origin, _offset) \
+  ((LONG *) ((_origin) + (_offset)) - 1)
+
+
 typedef struct ThreadParms ThreadParms;
 
 struct ThreadParms
@@ -355,6 +537,7 @@ struct pthread_cond_t_
 struct pthread_condattr_t_
 {
   int pshared;
+  int wakeOrder;		/* PTHREAD_WAKE_*_NP */
 };
 
 #define PTW32_RWLOCK_MAGIC 0xfacade2
@@ -485,6 +668,424 @@ struct ThreadKeyAssoc
 };
 
 
+/*
+ * Library-wide counters returned by pthread_getstats_np().
+ *
+ * Each counter is sharded over PTW32_STATS_SHARDS cache-line sized
+ * slots selected by the calling thread's Win32 id, so that threads
+ * on different CPUs rarely touch the same line. The shards are only
+ * summed when the application asks for a snapshot. Counters are
+ * only updated on slow paths (blocking, object creation and
+ * destruction, thread lifecycle) and never on uncontended lock
+ * and unlock.
+ *
+ * The shards are ptw32_stats_local unless pthread_stats_export_np()
+ * has moved them into a shared memory section.
+ */
+enum {
+  PTW32_STAT_THREADS_CREATED,
+  PTW32_STAT_THREADS_EXITED,
+  PTW32_STAT_THREAD_REUSE_HITS,
+  PTW32_STAT_THREAD_REUSE_MISSES,
+  PTW32_STAT_IMPLICIT_THREADS,
+  PTW32_STAT_MUTEXES_LIVE,
+  PTW32_STAT_CONDS_LIVE,
+  PTW32_STAT_RWLOCKS_LIVE,
+  PTW32_STAT_SPINLOCKS_LIVE,
+  PTW32_STAT_BARRIERS_LIVE,
+  PTW32_STAT_SEMAPHORES_LIVE,
+  PTW32_STAT_KEYS_LIVE,
+  PTW32_STAT_THREAD_HANDLES,
+  PTW32_STAT_MUTEX_HANDLES,
+  PTW32_STAT_SEMAPHORE_HANDLES,
+  PTW32_STAT_MUTEX_WAITS,
+  PTW32_STAT_MUTEX_TIMEOUTS,
+  PTW32_STAT_COND_WAITS,
+  PTW32_STAT_COND_TIMEOUTS,
+  PTW32_STAT_SEM_WAITS,
+  PTW32_STAT_SEM_TIMEOUTS,
+  PTW32_STAT_BARRIER_WAITS,
+  PTW32_STAT_JOIN_WAITS,
+  PTW32_STAT_MCS_CONTENDED,
+  PTW32_STAT_MCS_WAITS,
+  PTW32_STAT_CANCELS_REQUESTED,
+  PTW32_STAT_CANCELS_ACTED,
+  PTW32_STAT_COUNT
+};
+
+/* Must be a power of 2. */
+#define PTW32_STATS_SHARDS      16
+/* Counters per shard; sizeof(LONG) * 32 = two 64 byte cache lines. */
+#define PTW32_STATS_SLOTS       32
+
+typedef struct ptw32_stats_shard_t_ ptw32_stats_shard_t;
+
+struct ptw32_stats_shard_t_
+{
+  LONG counter[PTW32_STATS_SLOTS];
+};
+
+#define PTW32_STATS_SHARD() \
+  (ptw32_stats_shards[(GetCurrentThreadId() >> 2) & (PTW32_STATS_SHARDS - 1)])
+
+#define PTW32_STATS_ADD(_stat, _n) \
+  ((void) PTW32_INTERLOCKED_EXCHANGE_ADD((LPLONG)&PTW32_STATS_SHARD().counter[(_stat)], (LONG)(_n)))
+
+#define PTW32_STATS_INC(_stat)  PTW32_STATS_ADD((_stat), 1)
+#define PTW32_STATS_DEC(_stat)  PTW32_STATS_ADD((_stat), -1)
+
+
+/*
+ * Event tracing (compiled in with -DPTW32_TRACE).
+ *
+ * Each thread that records an event owns a ring of fixed-size binary
+ * records; only the owning thread writes to it, so recording is a
+ * timestamp read and a handful of stores. Rings are linked into a
+ * list that is never shrunk while the process is running, and a ring
+ * released by an exiting thread is reclaimed by the next new thread.
+ * pthread_trace_dump_np() copies every ring into a memory-mapped
+ * file which tools/trace2json converts to Chrome trace JSON. A ring
+ * whose thread has a name is preceded by a THREAD_NAME record; names
+ * are never recorded as events, so they survive the ring wrapping.
+ *
+ * The numeric values of the event types and the record layout are
+ * part of the file format: append only.
+ */
+enum {
+  PTW32_TRACE_THREAD_START         = 1,
+  PTW32_TRACE_THREAD_EXIT          = 2,
+  PTW32_TRACE_CANCEL               = 3,
+  PTW32_TRACE_MUTEX_WAIT_BEGIN     = 4,
+  PTW32_TRACE_MUTEX_WAIT_END       = 5,
+  PTW32_TRACE_COND_WAIT_BEGIN      = 6,
+  PTW32_TRACE_COND_WAIT_END        = 7,
+  PTW32_TRACE_COND_SIGNAL          = 8,
+  PTW32_TRACE_COND_BROADCAST       = 9,
+  PTW32_TRACE_SEM_WAIT_BEGIN       = 10,
+  PTW32_TRACE_SEM_WAIT_END         = 11,
+  PTW32_TRACE_RWLOCK_RDWAIT_BEGIN  = 12,
+  PTW32_TRACE_RWLOCK_RDWAIT_END    = 13,
+  PTW32_TRACE_RWLOCK_WRWAIT_BEGIN  = 14,
+  PTW32_TRACE_RWLOCK_WRWAIT_END    = 15,
+  PTW32_TRACE_BARRIER_WAIT_BEGIN   = 16,
+  PTW32_TRACE_BARRIER_WAIT_END     = 17,
+  PTW32_TRACE_THREAD_NAME          = 18	/* Name in object, arg and reserved */
+};
+
+#define PTW32_TRACE_MAGIC       "PTW32TRC"
+#define PTW32_TRACE_VERSION     1
+
+/* Records per thread ring. Must be a power of 2. */
+#ifndef PTW32_TRACE_RING_SIZE
+#define PTW32_TRACE_RING_SIZE   4096
+#endif
+
+typedef struct ptw32_trace_header_t_ ptw32_trace_header_t;
+typedef struct ptw32_trace_record_t_ ptw32_trace_record_t;
+typedef struct ptw32_trace_ring_t_ ptw32_trace_ring_t;
+
+/* Layout of the start of a dump file; 48 bytes, little-endian. */
+struct ptw32_trace_header_t_
+{
+  char magic[8];
+  DWORD version;
+  DWORD recordSize;
+  ULONGLONG ticksPerSecond;	/* Calibrated against QueryPerformanceCounter */
+  ULONGLONG baseTicks;		/* Timestamp when tracing was enabled */
+  DWORD processId;
+  DWORD recordCount;
+  ULONGLONG reserved;
+};
+
+/* One event; 32 bytes. */
+struct ptw32_trace_record_t_
+{
+  ULONGLONG ticks;
+  ULONGLONG object;		/* Address of the mutex, cond etc. */
+  DWORD threadId;		/* Win32 id of the recording thread */
+  DWORD type;
+  DWORD arg;			/* Wait result for *_END, else event specific */
+  DWORD reserved;
+};
+
+struct ptw32_trace_ring_t_
+{
+  ptw32_trace_ring_t * next;
+  LONG owner;			/* Win32 thread id, or 0 if free */
+  LONG head;			/* Records ever written to this ring */
+  DWORD namedId;		/* Win32 id of the thread 'name' belongs to */
+  char name[PTW32_THREAD_NAME_MAX];	/* Written out as a THREAD_NAME record */
+  ptw32_trace_record_t record[PTW32_TRACE_RING_SIZE];
+};
+
+/*
+ * Wait hooks (see pthread_set_wait_hooks_np()).
+ *
+ * A ptw32_hook_state_t lives on the stack of a blocking call, declared
+ * in the slow path only. PTW32_HOOK_BEFORE is placed immediately
+ * before each blocking wait and PTW32_HOOK_AFTER immediately after it;
+ * PTW32_HOOK_ACQUIRED is placed where the object has been obtained
+ * and reports the time since the first block. Each is a single test
+ * when no hooks are installed.
+ */
+typedef struct ptw32_hook_state_t_ ptw32_hook_state_t;
+
+struct ptw32_hook_state_t_
+{
+  ULONGLONG first;		/* Counter at first block, 0 if not blocked */
+  ULONGLONG start;		/* Counter at current block, 0 if not blocked */
+  int site;			/* Profile site + 1 if sampled, else 0 */
+};
+
+#define PTW32_HOOK_STATE_INITIALIZER {0, 0, 0}
+
+#define PTW32_HOOK_BEFORE(_h, _type, _obj) \
+  do { if (ptw32_wait_hooks_active) ptw32_hook_before(&(_h), (_type), (void *)(_obj)); } while (0)
+
+#define PTW32_HOOK_AFTER(_h, _type, _obj, _waker, _result) \
+  do { if ((_h).start != 0) ptw32_hook_after(&(_h), (_type), (void *)(_obj), (DWORD)(_waker), (_result)); } while (0)
+
+#define PTW32_HOOK_ACQUIRED(_h, _type, _obj, _waker, _result) \
+  do { if ((_h).first != 0) ptw32_hook_acquired(&(_h), (_type), (void *)(_obj), (DWORD)(_waker), (_result)); } while (0)
+
+/*
+ * Watchdog (see pthread_watchdog_np()).
+ *
+ * While it runs, ptw32_hook_before puts the blocking thread on
+ * ptw32_watch_list and ptw32_hook_after (or ptw32_throw, if the
+ * wait is cancelled) takes it off. Normal mutexes record their
+ * owner only in this mode; the other kinds always do. The rwlock
+ * lock routines bracket their blocking waits with
+ * PTW32_WATCH_ENTER/LEAVE so that the rwlock, not its internal
+ * mutex or condition variable, is reported.
+ */
+#define PTW32_WATCH_OWNER(_mx) \
+  do { if (ptw32_watchdog_active) (_mx)->ownerThread = pthread_self (); } while (0)
+
+#define PTW32_WATCH_DISOWN(_mx) \
+  do { if (ptw32_watchdog_used) (_mx)->ownerThread.p = NULL; } while (0)
+
+#define PTW32_WATCH_ENTER(_rwlock) \
+  do { if (ptw32_watchdog_active || ptw32_profile_rate != 0) \
+         ptw32_watch_rwlock((void *)(_rwlock)); } while (0)
+
+#define PTW32_WATCH_LEAVE() \
+  do { if (ptw32_watchdog_used || ptw32_profile_used) ptw32_watch_rwlock(NULL); } while (0)
+
+/*
+ * Contention profile (see pthread_profile_np()).
+ *
+ * While ptw32_profile_rate is non-zero, ptw32_hook_before passes every
+ * block to ptw32_profile_begin, which samples 1 in ptw32_profile_rate
+ * per thread, and ptw32_hook_after adds the time blocked to the
+ * sampled site. The rwlock routines' PTW32_WATCH_ENTER lets samples
+ * taken inside them be counted against the rwlock. Spin locks never
+ * block, so they sample once they start to yield, with
+ * PTW32_PROFILE_BEGIN and PTW32_PROFILE_END.
+ *
+ * Sites live in a fixed table, hashed on type and return addresses.
+ * Samples that find the table full go to the extra last entry.
+ */
+#define PTW32_PROFILE_RATE_DEFAULT  100
+#define PTW32_PROFILE_ENV           "PTW32_PROFILE"
+
+typedef struct ptw32_profile_entry_t_ ptw32_profile_entry_t;
+
+struct ptw32_profile_entry_t_
+{
+  ULONG hash;
+  struct ptw32_profile_site site;	/* Free while site.samples is 0 */
+};
+
+#define PTW32_PROFILE_BEGIN(_h, _type) \
+  do { if (ptw32_profile_rate != 0) ptw32_profile_begin(&(_h), (_type)); } while (0)
+
+#define PTW32_PROFILE_END(_h) \
+  do { if ((_h).site != 0) \
+         ptw32_profile_end(&(_h), ptw32_hook_nanoseconds((_h).start, ptw32_hook_now())); } while (0)
+
+/*
+ * Wait policy (see pthread_setwaitpolicy_np()).
+ *
+ * Before parking, waiters call PTW32_SPIN_ACQUIRE or PTW32_SPIN_WAIT,
+ * which poll for up to spinCount iterations and then yield up to
+ * yieldCount times. Both are a single test when the policy has no
+ * budget. PTW32_WAIT_SPIN_DEFAULT applies to multiprocessors only.
+ */
+#ifndef PTW32_WAIT_SPIN_DEFAULT
+#define PTW32_WAIT_SPIN_DEFAULT  100
+#endif
+
+#define PTW32_WAIT_POLICY_ENV    "PTW32_WAIT_POLICY"
+
+enum {
+  PTW32_SPIN_UNTIL_NONZERO,
+  PTW32_SPIN_UNTIL_POSITIVE
+};
+
+#if defined(YieldProcessor)
+#define PTW32_PAUSE()  YieldProcessor()
+#else
+#define PTW32_PAUSE()  ((void) 0)
+#endif
+
+#define PTW32_SPIN_ACQUIRE(_lock, _value) \
+  (ptw32_wait_spinning && ptw32_spin_acquire((_lock), (_value)))
+
+#define PTW32_SPIN_WAIT(_location, _until) \
+  (ptw32_wait_spinning && ptw32_spin_wait((_location), (_until)))
+
+/*
+ * Timer slack (see pthread_setslack_np()).
+ *
+ * A timed cancelable wait (pthreadCancelableTimedWait()) by a thread
+ * with timerSlack set waits on its slackTimer, armed with
+ * ptw32_slack_arm for a boundary shared with other waiters, instead
+ * of passing its own timeout to the kernel. Boundaries are multiples
+ * of the largest power of two milliseconds within the slack, up to
+ * PTW32_SLACK_GRANULE_MAX.
+ *
+ * pthread_cond_timedwait_slack_np() and sem_timedwait_slack_np() set
+ * callSlack for the duration of the call, leaving timerSlack to
+ * pthread_setslack_np(); PTW32_SLACK_OF gives the slack in force.
+ */
+#define PTW32_SLACK_GRANULE_MAX  65536
+
+#define PTW32_SLACK_OF(_sp) \
+  ((_sp)->callSlack != 0 ? (_sp)->callSlack - 1 : (_sp)->timerSlack)
+
+/*
+ * Lock trace (see pthread_locktrace_np()).
+ *
+ * While ptw32_locktrace_enabled is set every mutex acquisition and
+ * release that changes ownership (not recursive relocks) appends a
+ * record to the calling thread's current chunk. Only the owning
+ * thread writes to a chunk; full chunks stay on a list, in the order
+ * they were started, until the process ends, so that a dump holds
+ * each thread's records in order. Recording stops by itself once the
+ * limit given to pthread_locktrace_np() has been reached.
+ *
+ * The numeric values of the operations and the record layout are
+ * part of the file format: append only.
+ */
+enum {
+  PTW32_LOCKTRACE_LOCK             = 1,	/* lock or timedlock */
+  PTW32_LOCKTRACE_TRYLOCK          = 2,	/* successful trylock */
+  PTW32_LOCKTRACE_UNLOCK           = 3
+};
+
+#define PTW32_LOCKTRACE_MAGIC     "PTW32LKT"
+#define PTW32_LOCKTRACE_VERSION   1
+#define PTW32_LOCKTRACE_ROBUST    0x100	/* Or'd into kind */
+
+/* Records per chunk. */
+#ifndef PTW32_LOCKTRACE_CHUNK
+#define PTW32_LOCKTRACE_CHUNK     1024
+#endif
+
+/* Records kept when started through the PTW32_LOCKTRACE variable. */
+#ifndef PTW32_LOCKTRACE_LIMIT
+#define PTW32_LOCKTRACE_LIMIT     (1024 * 1024)
+#endif
+
+typedef struct ptw32_locktrace_header_t_ ptw32_locktrace_header_t;
+typedef struct ptw32_locktrace_record_t_ ptw32_locktrace_record_t;
+typedef struct ptw32_locktrace_chunk_t_ ptw32_locktrace_chunk_t;
+
+/* Layout of the start of a dump file; 56 bytes, little-endian. */
+struct ptw32_locktrace_header_t_
+{
+  char magic[8];
+  DWORD version;
+  DWORD recordSize;
+  ULONGLONG ticksPerSecond;
+  ULONGLONG baseTicks;		/* Counter when tracing was first started */
+  DWORD processId;
+  DWORD recordCount;
+  DWORD threadCount;		/* Threads are numbered from 1 */
+  DWORD objectCount;		/* Mutexes are numbered from 1 */
+  DWORD dropped;		/* Operations not recorded for lack of room */
+  DWORD reserved;
+};
+
+/* One operation; 24 bytes. */
+struct ptw32_locktrace_record_t_
+{
+  ULONGLONG ticks;		/* Counter at the call (lock) or release */
+  DWORD object;			/* Mutex traceId */
+  DWORD thread;			/* Thread number within the trace */
+  DWORD wait;			/* Lock: counts from the call to ownership */
+  WORD op;			/* PTW32_LOCKTRACE_* */
+  WORD kind;			/* PTHREAD_MUTEX_*, | PTW32_LOCKTRACE_ROBUST */
+};
+
+struct ptw32_locktrace_chunk_t_
+{
+  ptw32_locktrace_chunk_t * next;
+  DWORD thread;
+  LONG size;			/* Records it may hold, up to the limit */
+  LONG count;			/* Records written, published after each */
+  ptw32_locktrace_record_t record[PTW32_LOCKTRACE_CHUNK];
+};
+
+#define PTW32_LOCKTRACE_BEGIN() \
+  (ptw32_locktrace_enabled ? ptw32_hook_now() : (ULONGLONG) 0)
+
+#define PTW32_LOCKTRACE_ACQUIRED(_start, _mx, _op, _result) \
+  do { if ((_start) != 0 && ((_result) == 0 || (_result) == EOWNERDEAD)) \
+         ptw32_locktrace_acquired((_start), (_mx), (_op)); } while (0)
+
+#define PTW32_LOCKTRACE_RELEASE(_mx) \
+  do { if (ptw32_locktrace_enabled) ptw32_locktrace_release(_mx); } while (0)
+
+/*
+ * Lean builds (see GC-lean in GNUmakefile).
+ *
+ * PTW32_NO_CANCEL: the library's own cancelation points (semaphore,
+ * condition variable, rwlock, join and delay waits) are plain waits
+ * without testcancel, cleanup handlers or the cancel event. Explicit
+ * pthread_testcancel() and asynchronous cancelation still work.
+ *
+ * PTW32_NO_ROBUST: robust mutexes can't be created, and the mutex
+ * routines lose their robust branches.
+ */
+#if defined(PTW32_NO_CANCEL)
+#define PTW32_TESTCANCEL()                     ((void) 0)
+#define PTW32_CANCEL_CLEANUP_PUSH(_rout, _arg) \
+  { ptw32_cleanup_callback_t _cleanupRout = (ptw32_cleanup_callback_t) (_rout); \
+    void * _cleanupArg = (void *) (_arg);
+#define PTW32_CANCEL_CLEANUP_POP(_execute) \
+    if (_execute) (*_cleanupRout) (_cleanupArg); }
+#else
+#define PTW32_TESTCANCEL()                     pthread_testcancel ()
+#define PTW32_CANCEL_CLEANUP_PUSH(_rout, _arg) pthread_cleanup_push ((_rout), (_arg))
+#define PTW32_CANCEL_CLEANUP_POP(_execute)     pthread_cleanup_pop (_execute)
+#endif
+
+#if defined(PTW32_NO_ROBUST)
+#define PTW32_MUTEX_KIND_ROBUST(_kind)  0
+#else
+#define PTW32_MUTEX_KIND_ROBUST(_kind)  ((_kind) < 0)
+#endif
+
+/*
+ * A thread's cancelEvent is shared by deferred cancellation and
+ * pthread_interrupt_np(). It is worth waiting on unless it is holding
+ * a cancel request that cancelState will not let us act on yet.
+ */
+#define PTW32_CANCEL_EVENT_WAITABLE(_sp) \
+  ((_sp)->cancelEvent != NULL \
+   && ((_sp)->cancelState == PTHREAD_CANCEL_ENABLE \
+       || (_sp)->state != PThreadStateCancelPending))
+
+#if defined(PTW32_TRACE)
+#define PTW32_TRACE_EVENT(_type, _obj, _arg) \
+  do { if (ptw32_trace_enabled) ptw32_trace_event((_type), (void *)(_obj), (DWORD)(_arg)); } while (0)
+#else
+#define PTW32_TRACE_EVENT(_type, _obj, _arg) ((void) 0)
+#endif
+
+
 #ifdef __CLEANUP_SEH
 /*
  * --------------------------------------------------------------
@@ -552,6 +1153,7 @@ extern DWORD (*ptw32_register_cancelation) (PAPCFUNC, HANDLE, DWORD);
 #define PTW32_THREAD_REUSE_EMPTY ((ptw32_thread_t *) 1)
 
 extern int ptw32_processInitialized;
+extern int ptw32_processExiting;
 extern ptw32_thread_t * ptw32_threadReuseTop;
 extern ptw32_thread_t * ptw32_threadReuseBottom;
 extern pthread_key_t ptw32_selfThreadKey;
@@ -567,12 +1169,48 @@ extern int ptw32_concurrency;
 
 extern int ptw32_features;
 
+extern ptw32_stats_shard_t ptw32_stats_local[PTW32_STATS_SHARDS];
+extern ptw32_stats_shard_t * ptw32_stats_shards;
+
+#if defined(PTW32_TRACE)
+extern int ptw32_trace_enabled;
+#endif
+
+extern int ptw32_wait_hooks_active;
+extern struct ptw32_wait_hooks ptw32_wait_hooks;
+
+extern int ptw32_watchdog_active;
+extern int ptw32_watchdog_used;
+extern ptw32_thread_t * ptw32_watch_list;
+extern DWORD ptw32_watchdog_threadId;
+
+extern int ptw32_profile_rate;
+extern int ptw32_profile_used;
+
+extern int ptw32_locktrace_enabled;
+
+extern struct ptw32_wait_policy ptw32_wait_policy;
+extern int ptw32_wait_policy_explicit;
+extern int ptw32_wait_spinning;
+
+extern int ptw32_cohort_fake_nodes;
+extern ptw32_cohort_node_fn_t ptw32_cohort_fake_node_of;
+
+extern pthread_key_t ptw32_tls_arena_key;
+extern pthread_key_t ptw32_tls_arena_keys;
+extern pthread_key_t ptw32_tls_arena_last;
+extern size_t ptw32_tls_arena_end;
+extern LONG ptw32_tls_arena_generation;
+
 extern ptw32_mcs_lock_t ptw32_thread_reuse_lock;
 extern ptw32_mcs_lock_t ptw32_mutex_test_init_lock;
 extern ptw32_mcs_lock_t ptw32_cond_list_lock;
 extern ptw32_mcs_lock_t ptw32_cond_test_init_lock;
 extern ptw32_mcs_lock_t ptw32_rwlock_test_init_lock;
 extern ptw32_mcs_lock_t ptw32_spinlock_test_init_lock;
+extern ptw32_mcs_lock_t ptw32_tls_arena_lock;
+extern ptw32_mcs_lock_t ptw32_watch_lock;
+extern ptw32_mcs_lock_t ptw32_watchdog_lock;
 
 #ifdef _UWIN
 extern int pthread_count;
@@ -605,10 +1243,14 @@ extern "C"
     ptw32_RegisterCancelation (PAPCFUNC callback,
 			       HANDLE threadH, DWORD callback_arg);
 
+  int ptw32_cancel_thread (ptw32_thread_t * tp, int cancel_self);
+
   int ptw32_processInitialize (void);
 
   void ptw32_processTerminate (void);
 
+  void ptw32_quserex_probe (void);
+
   void ptw32_threadDestroy (pthread_t tid);
 
   void ptw32_pop_cleanup_all (int execute);
@@ -640,6 +1282,8 @@ extern "C"
 
   int ptw32_semwait (sem_t * sem);
 
+  int ptw32_sem_release (sem_t s, int count);
+
   DWORD ptw32_relmillisecs (const struct timespec * abstime);
 
   void ptw32_mcs_lock_acquire (ptw32_mcs_lock_t * lock, ptw32_mcs_local_node_t * node);
@@ -650,6 +1294,83 @@ extern "C"
 
   void ptw32_mcs_node_transfer (ptw32_mcs_local_node_t * new_node, ptw32_mcs_local_node_t * old_node);
 
+  void ptw32_wait_policy_init (void);
+  void ptw32_wait_policy_hint (int level);
+  void ptw32_wait_policy_update (const struct ptw32_wait_policy * policy);
+  void ptw32_yield (void);
+  int ptw32_spin_acquire (LONG * lock, LONG value);
+  int ptw32_spin_wait (volatile LONG * location, int until);
+
+  int ptw32_cancel_event_check (ptw32_thread_t * sp);
+
+  void * ptw32_tls_arena_lookup (pthread_key_t key);
+  void ptw32_tls_arena_destroy (void * segment);
+  void ptw32_tls_arena_key_delete (pthread_key_t key);
+
+  void ptw32_group_add (pthread_group_t group, ptw32_thread_t * tp);
+  void ptw32_group_exited (ptw32_thread_t * sp);
+  void ptw32_group_leave (ptw32_thread_t * tp);
+  void ptw32_group_detach (ptw32_thread_t * tp);
+  void ptw32_group_reclaim (ptw32_thread_t * list);
+
+  int ptw32_cohort_create (pthread_mutex_t mx);
+  void ptw32_cohort_destroy (pthread_mutex_t mx);
+  int ptw32_cohort_lock (pthread_mutex_t * mutex, const struct timespec * abstime);
+  int ptw32_cohort_trylock (pthread_mutex_t * mutex);
+  int ptw32_cohort_unlock (pthread_mutex_t * mutex);
+
+  void ptw32_hook_before (ptw32_hook_state_t * state, int type, void * object);
+  void ptw32_hook_after (ptw32_hook_state_t * state, int type, void * object, DWORD waker, int result);
+  void ptw32_hook_acquired (ptw32_hook_state_t * state, int type, void * object, DWORD waker, int result);
+  ULONGLONG ptw32_hook_now (void);
+  unsigned long long ptw32_hook_nanoseconds (ULONGLONG from, ULONGLONG to);
+
+  void ptw32_watch_begin (int type, void * object, ULONGLONG since);
+  void ptw32_watch_end (ptw32_thread_t * tp);
+  void ptw32_watch_rwlock (void * rwlock);
+  int ptw32_watchdog_start (unsigned long thresholdMillisecs, ptw32_stall_hook_t report);
+  int ptw32_watchdog_stop (void);
+
+  void ptw32_profile_begin (ptw32_hook_state_t * state, int type);
+  void ptw32_profile_end (ptw32_hook_state_t * state, unsigned long long nanoseconds);
+  int ptw32_profile_start (int rate);
+  int ptw32_profile_snapshot (struct ptw32_profile_site * sites, int max);
+  void ptw32_profile_reset (void);
+  int ptw32_profile_write (const char * path, int rate);
+  void ptw32_profile_initialize (void);
+  void ptw32_profile_terminate (void);
+
+  DWORD ptw32_slack_timeout (DWORD timeout, DWORD slack);
+  int ptw32_slack_arm (ptw32_thread_t * sp, DWORD timeout, DWORD slack);
+  void PTW32_CDECL ptw32_slack_call_end (void * arg);
+
+  int ptw32_exchange (pthread_exchanger_t ex, int role, void * item,
+		      void ** other, const struct timespec * abstime);
+
+  void ptw32_locktrace_acquired (ULONGLONG start, pthread_mutex_t mx, int op);
+  void ptw32_locktrace_release (pthread_mutex_t mx);
+  int ptw32_locktrace_start (unsigned long limit);
+  void ptw32_locktrace_stop (void);
+  int ptw32_locktrace_write (const char * path);
+  void ptw32_locktrace_initialize (void);
+  void ptw32_locktrace_terminate (void);
+
+  void ptw32_thread_name_publish (HANDLE threadH, DWORD threadId, const char * name);
+
+  int ptw32_stats_export_start (const char * name);
+  void ptw32_stats_export_initialize (void);
+  void ptw32_stats_export_terminate (void);
+
+#if defined(PTW32_TRACE)
+  void ptw32_trace_initialize (void);
+  void ptw32_trace_terminate (void);
+  void ptw32_trace_start (void);
+  void ptw32_trace_event (int type, void * object, DWORD arg);
+  void ptw32_trace_thread_exit (void);
+  void ptw32_trace_thread_name (DWORD threadId, const char * name);
+  int ptw32_trace_write (const char * path);
+#endif
+
 #ifdef NEED_FTIME
   void ptw32_timespec_to_filetime (const struct timespec *ts, FILETIME * ft);
   void ptw32_filetime_to_timespec (const FILETIME * ft, struct timespec *ts);
@@ -41,6 +41,26 @@
 #include "pthread_mutexattr_getkind_np.c"
 #include "pthread_getw32threadhandle_np.c"
 #include "pthread_getunique_np.c"
+#include "pthread_getstats_np.c"
+#include "pthread_trace_np.c"
+#include "pthread_set_wait_hooks_np.c"
+#include "pthread_mutex_setcohorttopology_np.c"
+#include "pthread_setwaitpolicy_np.c"
+#include "pthread_interrupt_np.c"
+#include "pthread_key_create_sized_np.c"
+#include "pthread_group_init_np.c"
+#include "pthread_group_cancel_np.c"
+#include "pthread_group_join_np.c"
+#include "pthread_watchdog_np.c"
+#include "pthread_setname_np.c"
+#include "pthread_stats_export_np.c"
+#include "pthread_send_np.c"
+#include "pthread_recv_np.c"
+#include "pthread_profile_np.c"
+#include "pthread_setslack_np.c"
+#include "pthread_locktrace_np.c"
+#include "pthread_exchanger_init_np.c"
+#include "pthread_exchanger_exchange_np.c"
 #include "pthread_delay_np.c"
 #include "pthread_num_processors_np.c"
 #include "pthread_win32_attach_detach_np.c"
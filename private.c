@@ -51,7 +51,22 @@
 #include "ptw32_tkAssocDestroy.c"
 #include "ptw32_callUserDestroyRoutines.c"
 #include "ptw32_semwait.c"
+#include "ptw32_sem_release.c"
 #include "ptw32_timespec.c"
 #include "ptw32_relmillisecs.c"
 #include "ptw32_throw.c"
 #include "ptw32_getprocessors.c"
+#include "ptw32_trace.c"
+#include "ptw32_wait_hooks.c"
+#include "ptw32_cohort.c"
+#include "ptw32_wait_policy.c"
+#include "ptw32_interrupt.c"
+#include "ptw32_tls_arena.c"
+#include "ptw32_group.c"
+#include "ptw32_watchdog.c"
+#include "ptw32_thread_name.c"
+#include "ptw32_stats_export.c"
+#include "ptw32_profile.c"
+#include "ptw32_slack.c"
+#include "ptw32_locktrace.c"
+#include "ptw32_exchanger.c"
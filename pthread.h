@@ -716,6 +716,8 @@ enum
   PTHREAD_MUTEX_FAST_NP,
   PTHREAD_MUTEX_RECURSIVE_NP,
   PTHREAD_MUTEX_ERRORCHECK_NP,
+  /* Non-portable: NUMA aware, see pthread_mutex_setcohorttopology_np() */
+  PTHREAD_MUTEX_COHORT_NP,
   PTHREAD_MUTEX_TIMED_NP = PTHREAD_MUTEX_FAST_NP,
   PTHREAD_MUTEX_ADAPTIVE_NP = PTHREAD_MUTEX_FAST_NP,
   /* For compatibility with POSIX */
@@ -1178,6 +1180,304 @@ PTW32_DLLPORT int PTW32_CDECL pthread_delay_np (struct timespec * interval);
 PTW32_DLLPORT int PTW32_CDECL pthread_num_processors_np(void);
 PTW32_DLLPORT unsigned long long PTW32_CDECL pthread_getunique_np(pthread_t thread);
 
+/*
+ * Library-wide counters. Cumulative counts are modulo 2^32 so
+ * compare successive snapshots. Objects created internally by
+ * other objects (e.g. the mutexes inside a read-write lock) are
+ * also counted under their own type.
+ */
+struct ptw32_stats {
+  /* Thread lifecycle */
+  unsigned long threadsCreated;       /* pthread_create() successes */
+  unsigned long threadsExited;        /* POSIX and implicit threads detached */
+  unsigned long threadReuseHits;      /* descriptors taken from the reuse stack */
+  unsigned long threadReuseMisses;    /* descriptors newly allocated */
+  unsigned long implicitThreads;      /* Win32 threads given a POSIX handle */
+  /* Objects currently initialised */
+  long mutexes;
+  long conds;
+  long rwlocks;
+  long spinlocks;
+  long barriers;
+  long semaphores;
+  long keys;
+  /* Kernel handles currently held, by owning object type */
+  long threadHandles;
+  long mutexHandles;
+  long semaphoreHandles;
+  /* Blocking waits and timeouts */
+  unsigned long mutexWaits;
+  unsigned long mutexTimeouts;
+  unsigned long condWaits;
+  unsigned long condTimeouts;
+  unsigned long semWaits;
+  unsigned long semTimeouts;
+  unsigned long barrierWaits;
+  unsigned long joinWaits;
+  /* Internal MCS queue locks */
+  unsigned long mcsContended;         /* acquires that found the lock held */
+  unsigned long mcsWaits;             /* of those, the ones that blocked */
+  /* Cancelation */
+  unsigned long cancelsRequested;
+  unsigned long cancelsActed;
+};
+
+PTW32_DLLPORT int PTW32_CDECL pthread_getstats_np(struct ptw32_stats * stats);
+
+/*
+ * Live export of the counters to a named shared memory section, for
+ * tools in other processes. The section starts with this header.
+ * 'shards' blocks of 'shardSize' bytes follow from 'offset', each
+ * holding 'counters' LONGs in the order of the members of struct
+ * ptw32_stats; a counter's value is its sum over all the shards.
+ * 'sequence' is odd while the library rewrites the section.
+ */
+#define PTW32_STATS_EXPORT_MAGIC    0x53573350UL   /* "P3WS" */
+#define PTW32_STATS_EXPORT_VERSION  1
+
+enum {
+  PTW32_STATS_EXPORT_LIVE     = 1,    /* counters are being updated */
+  PTW32_STATS_EXPORT_DETACHED = 2     /* final values; the library has gone */
+};
+
+struct ptw32_stats_export {
+  unsigned long magic;
+  unsigned long version;
+  unsigned long processId;
+  volatile long sequence;
+  volatile long state;                /* PTW32_STATS_EXPORT_* */
+  unsigned long counters;
+  unsigned long shards;
+  unsigned long shardSize;
+  unsigned long offset;
+};
+
+PTW32_DLLPORT int PTW32_CDECL pthread_stats_export_np(const char * name);
+
+/*
+ * Event tracing. Only records anything if the library was built
+ * with PTW32_TRACE defined; otherwise these return ENOSYS.
+ */
+PTW32_DLLPORT int PTW32_CDECL pthread_trace_np(int enable);
+PTW32_DLLPORT int PTW32_CDECL pthread_trace_dump_np(const char * path);
+
+/*
+ * Wait hooks, called only when a thread actually blocks.
+ */
+enum {
+  PTW32_WAIT_MUTEX     = 1,
+  PTW32_WAIT_COND      = 2,
+  PTW32_WAIT_SEMAPHORE = 3,
+  PTW32_WAIT_BARRIER   = 4,
+  PTW32_WAIT_JOIN      = 5,           /* object is the pthread_t's p */
+  PTW32_WAIT_RWLOCK    = 6,           /* watchdog reports and profile only */
+  PTW32_WAIT_SPIN      = 7            /* profile only */
+};
+
+struct ptw32_wait_event {
+  void * object;                      /* address passed to the blocking call */
+  int type;                           /* PTW32_WAIT_* */
+  int result;                         /* 0 or error; always 0 before blocking */
+  unsigned long wakerThreadId;        /* Win32 id of the waking thread, or 0 */
+  unsigned long long duration;        /* nanoseconds blocked; 0 before blocking */
+};
+
+typedef void (PTW32_CDECL * ptw32_wait_hook_t) (const struct ptw32_wait_event * event);
+
+struct ptw32_wait_hooks {
+  ptw32_wait_hook_t beforeBlock;
+  ptw32_wait_hook_t afterWake;
+  ptw32_wait_hook_t acquiredAfterContention;
+};
+
+PTW32_DLLPORT int PTW32_CDECL pthread_set_wait_hooks_np(const struct ptw32_wait_hooks * hooks);
+
+/*
+ * Thread names, shown by debuggers and profilers and in trace dumps.
+ * Names are at most PTW32_THREAD_NAME_MAX - 1 bytes (UTF-8).
+ */
+#define PTW32_THREAD_NAME_MAX 16
+
+PTW32_DLLPORT int PTW32_CDECL pthread_setname_np (pthread_t thread, const char * name);
+PTW32_DLLPORT int PTW32_CDECL pthread_getname_np (pthread_t thread, char * name, size_t len);
+PTW32_DLLPORT int PTW32_CDECL pthread_attr_setname_np (pthread_attr_t * attr, const char * name);
+PTW32_DLLPORT int PTW32_CDECL pthread_attr_getname_np (const pthread_attr_t * attr,
+                                                       char * name, size_t len);
+
+/*
+ * Per-thread mailboxes. A message is any structure containing a
+ * struct ptw32_msg, which links it while it is queued; the library
+ * neither copies nor frees messages.
+ */
+struct ptw32_msg {
+  struct ptw32_msg * next;
+};
+
+PTW32_DLLPORT int PTW32_CDECL pthread_send_np (pthread_t thread, struct ptw32_msg * msg);
+PTW32_DLLPORT int PTW32_CDECL pthread_recv_np (struct ptw32_msg ** msg,
+                                               const struct timespec * abstime);
+
+/*
+ * Watchdog: report threads blocked in a library wait for longer than
+ * a threshold, once per wait.
+ */
+struct ptw32_stall_report {
+  void * object;                      /* as for wait hooks; the rwlock for rwlock waits */
+  int type;                           /* PTW32_WAIT_* */
+  unsigned long waiterThreadId;       /* Win32 id of the blocked thread */
+  unsigned long ownerThreadId;        /* Win32 id of the mutex owner or join target, or 0 */
+  unsigned long long waited;          /* nanoseconds blocked so far */
+  char waiterName[PTW32_THREAD_NAME_MAX]; /* names, or "" if not named */
+  char ownerName[PTW32_THREAD_NAME_MAX];
+};
+
+typedef void (PTW32_CDECL * ptw32_stall_hook_t) (const struct ptw32_stall_report * report);
+
+PTW32_DLLPORT int PTW32_CDECL pthread_watchdog_np(unsigned long thresholdMillisecs,
+                                                  ptw32_stall_hook_t report);
+
+/*
+ * Contention profile: the call stacks of 1 in 'rate' blocking waits,
+ * with the time blocked, summed per stack. A table of
+ * PTW32_PROFILE_SITES + 1 sites always holds them all.
+ */
+#define PTW32_PROFILE_DEPTH 8
+#define PTW32_PROFILE_SITES 256
+
+struct ptw32_profile_site {
+  int type;                           /* PTW32_WAIT_*, or 0 for samples the table had no room for */
+  int depth;                          /* return addresses in frames[] */
+  void * frames[PTW32_PROFILE_DEPTH]; /* innermost first */
+  unsigned long samples;
+  unsigned long long waited;          /* nanoseconds blocked, summed over samples */
+  unsigned long long maxWaited;       /* longest single block */
+};
+
+PTW32_DLLPORT int PTW32_CDECL pthread_profile_np(int rate);
+PTW32_DLLPORT int PTW32_CDECL pthread_profile_get_np(struct ptw32_profile_site * sites, int * count);
+PTW32_DLLPORT int PTW32_CDECL pthread_profile_reset_np(void);
+PTW32_DLLPORT int PTW32_CDECL pthread_profile_dump_np(const char * path);
+
+/*
+ * Timer slack: how late, in milliseconds, timed waits may end so that
+ * the system can wake many waiters at once.
+ */
+PTW32_DLLPORT int PTW32_CDECL pthread_setslack_np(pthread_t thread, unsigned long slackMillisecs);
+PTW32_DLLPORT int PTW32_CDECL pthread_getslack_np(pthread_t thread, unsigned long * slackMillisecs);
+PTW32_DLLPORT int PTW32_CDECL pthread_cond_timedwait_slack_np(pthread_cond_t * cond,
+                                                              pthread_mutex_t * mutex,
+                                                              const struct timespec * abstime,
+                                                              unsigned long slackMillisecs);
+
+/*
+ * Lock trace: every mutex acquisition and release, with timings,
+ * for tools/locktrace and replay by tests/benchtest13.
+ */
+PTW32_DLLPORT int PTW32_CDECL pthread_locktrace_np(unsigned long maxRecords);
+PTW32_DLLPORT int PTW32_CDECL pthread_locktrace_dump_np(const char * path);
+
+/*
+ * Exchangers: unbuffered rendezvous. A put waits for a take (and
+ * vice versa) and hands it the item; an exchange waits for another
+ * exchange and the two swap items.
+ */
+typedef struct pthread_exchanger_t_ * pthread_exchanger_t;
+
+PTW32_DLLPORT int PTW32_CDECL pthread_exchanger_init_np(pthread_exchanger_t * exchanger);
+PTW32_DLLPORT int PTW32_CDECL pthread_exchanger_destroy_np(pthread_exchanger_t * exchanger);
+PTW32_DLLPORT int PTW32_CDECL pthread_exchanger_put_np(pthread_exchanger_t exchanger,
+                                                       void * item,
+                                                       const struct timespec * abstime);
+PTW32_DLLPORT int PTW32_CDECL pthread_exchanger_take_np(pthread_exchanger_t exchanger,
+                                                        void ** item,
+                                                        const struct timespec * abstime);
+PTW32_DLLPORT int PTW32_CDECL pthread_exchanger_exchange_np(pthread_exchanger_t exchanger,
+                                                            void * item,
+                                                            void ** other,
+                                                            const struct timespec * abstime);
+
+/*
+ * Node topology used by PTHREAD_MUTEX_COHORT_NP mutexes initialised
+ * after the call. nodeOf returns the calling thread's node.
+ */
+typedef int (PTW32_CDECL * ptw32_cohort_node_fn_t) (void);
+
+PTW32_DLLPORT int PTW32_CDECL pthread_mutex_setcohorttopology_np(int nodes,
+                                                                 ptw32_cohort_node_fn_t nodeOf);
+
+/*
+ * How threads wait before blocking in the kernel: poll spinCount
+ * times, then yield yieldCount times, then park.
+ */
+enum {
+  PTW32_YIELD_SWITCH = 0,             /* SwitchToThread() */
+  PTW32_YIELD_SLEEP0 = 1,             /* Sleep(0) */
+  PTW32_YIELD_SLEEP1 = 2              /* Sleep(1) */
+};
+
+struct ptw32_wait_policy {
+  int spinCount;
+  int yieldCount;
+  int yieldKind;                      /* PTW32_YIELD_*, also used by sched_yield() */
+};
+
+PTW32_DLLPORT int PTW32_CDECL pthread_setwaitpolicy_np(const struct ptw32_wait_policy * policy);
+PTW32_DLLPORT int PTW32_CDECL pthread_getwaitpolicy_np(struct ptw32_wait_policy * policy);
+
+/*
+ * Wake 'thread' from a cond, sem, join or delay wait without
+ * cancelling it. The wait returns EINTR (condition waits return 0).
+ */
+PTW32_DLLPORT int PTW32_CDECL pthread_interrupt_np(pthread_t thread);
+
+/*
+ * Keys whose value is a block of 'size' bytes that each thread gets
+ * for itself, zeroed and then passed to 'constructor' if not NULL.
+ * 'align' is 0 or a power of two up to 64.
+ */
+PTW32_DLLPORT int PTW32_CDECL pthread_key_create_sized_np (pthread_key_t * key,
+                                size_t size,
+                                size_t align,
+                                void (*constructor) (void *),
+                                void (*destructor) (void *));
+PTW32_DLLPORT void * PTW32_CDECL pthread_getspecific_ptr_np (pthread_key_t key);
+
+/*
+ * Thread groups. A thread created with pthread_attr_setgroup_np()
+ * stays in the group until it has finished and been joined,
+ * detached or reclaimed by the group.
+ */
+typedef struct pthread_group_t_ * pthread_group_t;
+
+PTW32_DLLPORT int PTW32_CDECL pthread_group_init_np (pthread_group_t * group);
+PTW32_DLLPORT int PTW32_CDECL pthread_group_destroy_np (pthread_group_t * group);
+PTW32_DLLPORT int PTW32_CDECL pthread_attr_setgroup_np (pthread_attr_t * attr,
+                                                        pthread_group_t group);
+PTW32_DLLPORT int PTW32_CDECL pthread_attr_getgroup_np (const pthread_attr_t * attr,
+                                                        pthread_group_t * group);
+PTW32_DLLPORT int PTW32_CDECL pthread_group_cancel_np (pthread_group_t group);
+PTW32_DLLPORT int PTW32_CDECL pthread_group_interrupt_np (pthread_group_t group);
+PTW32_DLLPORT int PTW32_CDECL pthread_group_join_np (pthread_group_t group);
+PTW32_DLLPORT int PTW32_CDECL pthread_group_wait_any_np (pthread_group_t group,
+                                                         pthread_t * thread,
+                                                         void ** value_ptr);
+
+/*
+ * Order in which waiters are released by pthread_cond_signal(),
+ * pthread_cond_broadcast() and sem_post(). See
+ * pthread_condattr_setwakeorder_np() and sem_setwakeorder_np().
+ */
+enum {
+  PTHREAD_WAKE_DEFAULT_NP  = 0,       /* whichever the W32 sema picks */
+  PTHREAD_WAKE_FIFO_NP     = 1,       /* strict arrival order */
+  PTHREAD_WAKE_PRIORITY_NP = 2        /* highest sched_priority first, then FIFO */
+};
+
+PTW32_DLLPORT int PTW32_CDECL pthread_condattr_setwakeorder_np (pthread_condattr_t * attr,
+                                                                int order);
+PTW32_DLLPORT int PTW32_CDECL pthread_condattr_getwakeorder_np (const pthread_condattr_t * attr,
+                                                                int * order);
+
 /*
  * Useful if an application wants to statically link
  * the lib rather than load the DLL at run-time.
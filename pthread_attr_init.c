@@ -108,6 +108,8 @@ pthread_attr_init (pthread_attr_t * attr)
   attr_result->param.sched_priority = THREAD_PRIORITY_NORMAL;
   attr_result->inheritsched = PTHREAD_EXPLICIT_SCHED;
   attr_result->contentionscope = PTHREAD_SCOPE_SYSTEM;
+  attr_result->group = NULL;
+  attr_result->name[0] = '\0';
 
   attr_result->valid = PTW32_ATTR_VALID;
 
@@ -0,0 +1,111 @@
+/*
+ * pthread_attr_setgroup_np.c
+ *
+ * Description:
+ * This translation unit implements operations on thread attribute objects.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_attr_setgroup_np (pthread_attr_t * attr, pthread_group_t group)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function specifies the group that threads created
+      *      with 'attr' will join.
+      *
+      * PARAMETERS
+      *      attr
+      *              pointer to an instance of pthread_attr_t
+      *
+      *      group
+      *              a group from pthread_group_init_np(), or NULL
+      *              for no group (the default)
+      *
+      * DESCRIPTION
+      *      This function specifies the group that threads created
+      *      with 'attr' will join. A thread stays in its group until
+      *      it has finished and been joined, detached or reclaimed
+      *      by the group. The group must not be destroyed while
+      *      'attr' may still be used to create threads.
+      *
+      * RESULTS
+      *              0               successfully set the group,
+      *              EINVAL          'attr' is invalid
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (ptw32_is_attr (attr) != 0)
+    {
+      return EINVAL;
+    }
+
+  (*attr)->group = group;
+  return 0;
+}
+
+
+int
+pthread_attr_getgroup_np (const pthread_attr_t * attr, pthread_group_t * group)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function returns the group that threads created
+      *      with 'attr' will join.
+      *
+      * PARAMETERS
+      *      attr
+      *              pointer to an instance of pthread_attr_t
+      *
+      *      group
+      *              pointer to a pthread_group_t, set to the group
+      *              or NULL
+      *
+      * RESULTS
+      *              0               successfully retrieved the group,
+      *              EINVAL          'attr' or 'group' is invalid
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (ptw32_is_attr (attr) != 0 || group == NULL)
+    {
+      return EINVAL;
+    }
+
+  *group = (*attr)->group;
+  return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * pthread_attr_setname_np.c
+ *
+ * Description:
+ * This translation unit implements operations on thread attribute objects.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_attr_setname_np (pthread_attr_t * attr, const char * name)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function specifies the name given to threads
+      *      created with 'attr'.
+      *
+      * PARAMETERS
+      *      attr
+      *              pointer to an instance of pthread_attr_t
+      *
+      *      name
+      *              a NUL terminated UTF-8 string of at most
+      *              PTW32_THREAD_NAME_MAX - 1 bytes; "" (the
+      *              default) for no name
+      *
+      * DESCRIPTION
+      *      This function specifies the name given to threads
+      *      created with 'attr'. The name is set, as by
+      *      pthread_setname_np(), before the thread starts to
+      *      run, so that it is named for its whole life.
+      *
+      * RESULTS
+      *              0               successfully set the name,
+      *              EINVAL          'attr' or 'name' is invalid,
+      *              ERANGE          'name' is too long
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (ptw32_is_attr (attr) != 0 || name == NULL)
+    {
+      return EINVAL;
+    }
+
+  if (strlen (name) >= PTW32_THREAD_NAME_MAX)
+    {
+      return ERANGE;
+    }
+
+  (void) strcpy ((*attr)->name, name);
+  return 0;
+}
+
+
+int
+pthread_attr_getname_np (const pthread_attr_t * attr, char * name, size_t len)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function copies the name given to threads
+      *      created with 'attr' into 'name'.
+      *
+      * PARAMETERS
+      *      attr
+      *              pointer to an instance of pthread_attr_t
+      *
+      *      name
+      *              buffer for the name
+      *
+      *      len
+      *              size of 'name'
+      *
+      * RESULTS
+      *              0               successfully copied the name,
+      *              EINVAL          'attr' or 'name' is invalid,
+      *              ERANGE          'len' is too small for the name
+      *
+      * ------------------------------------------------------
+      */
+{
+  size_t n;
+
+  if (ptw32_is_attr (attr) != 0 || name == NULL)
+    {
+      return EINVAL;
+    }
+
+  n = strlen ((*attr)->name);
+
+  if (n >= len)
+    {
+      return ERANGE;
+    }
+
+  memcpy (name, (*attr)->name, n + 1);
+  return 0;
+}
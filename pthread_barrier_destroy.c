@@ -77,6 +77,7 @@ pthread_barrier_destroy (pthread_barrier_t * barrier)
            */
           ptw32_mcs_lock_release(&node);
 	  (void) free (b);
+	  PTW32_STATS_DEC(PTW32_STAT_BARRIERS_LIVE);
 	  return 0;
 	}
       else
@@ -60,6 +60,7 @@ pthread_barrier_init (pthread_barrier_t * barrier,
       if (0 == sem_init (&(b->semBarrierBreeched), b->pshared, 0))
 	    {
 	      *barrier = b;
+	      PTW32_STATS_INC(PTW32_STAT_BARRIERS_LIVE);
 	      return 0;
 	    }
       (void) free (b);
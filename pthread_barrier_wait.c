@@ -45,6 +45,7 @@ pthread_barrier_wait (pthread_barrier_t * barrier)
   pthread_barrier_t b;
 
   ptw32_mcs_local_node_t node;
+  ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
 
   if (barrier == NULL || *barrier == (pthread_barrier_t) PTW32_OBJECT_INVALID)
     {
@@ -84,7 +85,13 @@ pthread_barrier_wait (pthread_barrier_t * barrier)
        * If pthread_barrier_destroy is called at that moment then the
        * barrier will be destroyed along with the semas.
        */
+      PTW32_STATS_INC(PTW32_STAT_BARRIER_WAITS);
+      PTW32_TRACE_EVENT(PTW32_TRACE_BARRIER_WAIT_BEGIN, b, 0);
+      PTW32_HOOK_BEFORE(hook, PTW32_WAIT_BARRIER, barrier);
       result = ptw32_semwait (&(b->semBarrierBreeched));
+      PTW32_TRACE_EVENT(PTW32_TRACE_BARRIER_WAIT_END, b, result);
+      PTW32_HOOK_AFTER(hook, PTW32_WAIT_BARRIER, barrier,
+		       b->semBarrierBreeched->wakerThread, result);
     }
 
   if ((PTW32_INTERLOCKED_LONG)PTW32_INTERLOCKED_INCREMENT((LPLONG)&b->nCurrentBarrierHeight)
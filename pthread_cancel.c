@@ -72,57 +72,34 @@ ptw32_RegisterCancelation (PAPCFUNC unused1, HANDLE threadH, DWORD unused2)
 }
 
 int
-pthread_cancel (pthread_t thread)
+ptw32_cancel_thread (ptw32_thread_t * tp, int cancel_self)
      /*
       * ------------------------------------------------------
-      * DOCPUBLIC
-      *      This function requests cancellation of 'thread'.
+      * DOCPRIVATE
+      *      This function requests cancellation of the thread
+      *      'tp', which the caller has already validated.
       *
       * PARAMETERS
-      *      thread
-      *              reference to an instance of pthread_t
+      *      tp
+      *              the target thread
       *
+      *      cancel_self
+      *              non-zero if 'tp' is the calling thread
       *
       * DESCRIPTION
-      *      This function requests cancellation of 'thread'.
-      *      NOTE: cancellation is asynchronous; use pthread_join to
-      *                wait for termination of 'thread' if necessary.
+      *      For asynchronous cancelation of another thread the
+      *      caller must have called ptw32_quserex_probe() first.
+      *      Asynchronous self cancelation does not return.
       *
       * RESULTS
       *              0               successfully requested cancellation,
-      *              ESRCH           no thread found corresponding to 'thread',
-      *              ENOMEM          implicit self thread create failed.
+      *              ESRCH           the thread is already being cancelled.
       * ------------------------------------------------------
       */
 {
-  int result;
-  int cancel_self;
-  pthread_t self;
-  ptw32_thread_t * tp;
+  int result = 0;
   ptw32_mcs_local_node_t stateLock;
 
-  result = pthread_kill (thread, 0);
-
-  if (0 != result)
-    {
-      return result;
-    }
-
-  if ((self = pthread_self ()).p == NULL)
-    {
-      return ENOMEM;
-    };
-
-  /*
-   * For self cancellation we need to ensure that a thread can't
-   * deadlock itself trying to cancel itself asynchronously
-   * (pthread_cancel is required to be an async-cancel
-   * safe function).
-   */
-  cancel_self = pthread_equal (thread, self);
-
-  tp = (ptw32_thread_t *) thread.p;
-
   /*
    * Lock for async-cancel safety.
    */
@@ -136,6 +113,8 @@ pthread_cancel (pthread_t thread)
 	{
 	  tp->state = PThreadStateCanceling;
 	  tp->cancelState = PTHREAD_CANCEL_DISABLE;
+	  PTW32_STATS_INC(PTW32_STAT_CANCELS_REQUESTED);
+	  PTW32_TRACE_EVENT(PTW32_TRACE_CANCEL, tp, tp->thread);
 
 	  ptw32_mcs_lock_release (&stateLock);
 	  ptw32_throw (PTW32_EPS_CANCEL);
@@ -146,10 +125,17 @@ pthread_cancel (pthread_t thread)
 	{
 	  HANDLE threadH = tp->threadH;
 
+	  /*
+	   * Record before suspending the target, which might hold
+	   * a lock that recording needs.
+	   */
+	  PTW32_TRACE_EVENT(PTW32_TRACE_CANCEL, tp, tp->thread);
+
 	  SuspendThread (threadH);
 
 	  if (WaitForSingleObject (threadH, 0) == WAIT_TIMEOUT)
 	    {
+	      PTW32_STATS_INC(PTW32_STAT_CANCELS_REQUESTED);
 	      tp->state = PThreadStateCanceling;
 	      tp->cancelState = PTHREAD_CANCEL_DISABLE;
 	      /*
@@ -176,6 +162,11 @@ pthread_cancel (pthread_t thread)
 	    {
 	      result = ESRCH;
 	    }
+	  else
+	    {
+	      PTW32_STATS_INC(PTW32_STAT_CANCELS_REQUESTED);
+	      PTW32_TRACE_EVENT(PTW32_TRACE_CANCEL, tp, tp->thread);
+	    }
 	}
       else if (tp->state >= PThreadStateCanceling)
 	{
@@ -187,3 +178,68 @@ pthread_cancel (pthread_t thread)
 
   return (result);
 }
+
+
+int
+pthread_cancel (pthread_t thread)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function requests cancellation of 'thread'.
+      *
+      * PARAMETERS
+      *      thread
+      *              reference to an instance of pthread_t
+      *
+      *
+      * DESCRIPTION
+      *      This function requests cancellation of 'thread'.
+      *      NOTE: cancellation is asynchronous; use pthread_join to
+      *                wait for termination of 'thread' if necessary.
+      *
+      * RESULTS
+      *              0               successfully requested cancellation,
+      *              ESRCH           no thread found corresponding to 'thread',
+      *              ENOMEM          implicit self thread create failed.
+      * ------------------------------------------------------
+      */
+{
+  int result;
+  int cancel_self;
+  pthread_t self;
+  ptw32_thread_t * tp;
+
+  result = pthread_kill (thread, 0);
+
+  if (0 != result)
+    {
+      return result;
+    }
+
+  if ((self = pthread_self ()).p == NULL)
+    {
+      return ENOMEM;
+    };
+
+  /*
+   * For self cancellation we need to ensure that a thread can't
+   * deadlock itself trying to cancel itself asynchronously
+   * (pthread_cancel is required to be an async-cancel
+   * safe function).
+   */
+  cancel_self = pthread_equal (thread, self);
+
+  tp = (ptw32_thread_t *) thread.p;
+
+  /*
+   * Async cancelation of another thread needs to know whether
+   * QueueUserAPCEx is available. The probe loads a DLL so it must
+   * be done before we take the lock and suspend the target.
+   */
+  if (!cancel_self && tp->cancelType == PTHREAD_CANCEL_ASYNCHRONOUS)
+    {
+      ptw32_quserex_probe ();
+    }
+
+  return ptw32_cancel_thread (tp, cancel_self);
+}
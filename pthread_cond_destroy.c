@@ -212,6 +212,8 @@ pthread_cond_destroy (pthread_cond_t * cond)
 	    }
 
 	  (void) free (cv);
+
+	  PTW32_STATS_DEC(PTW32_STAT_CONDS_LIVE);
 	}
 
       ptw32_mcs_lock_release(&node);
@@ -116,6 +116,18 @@ pthread_cond_init (pthread_cond_t * cond, const pthread_condattr_t * attr)
       goto FAIL2;
     }
 
+  if (attr != NULL && *attr != NULL
+      && (*attr)->wakeOrder != PTHREAD_WAKE_DEFAULT_NP)
+    {
+      /*
+       * Waiters queue first on semBlockLock, while earlier signals
+       * are being consumed, and then on semBlockQueue. Both must
+       * keep the order for it to hold end to end.
+       */
+      cv->semBlockLock->wakeOrder = (*attr)->wakeOrder;
+      cv->semBlockQueue->wakeOrder = (*attr)->wakeOrder;
+    }
+
   result = 0;
 
   goto DONE;
@@ -158,6 +170,8 @@ DONE:
 	}
 
       ptw32_mcs_lock_release(&node);
+
+      PTW32_STATS_INC(PTW32_STAT_CONDS_LIVE);
     }
 
   *cond = cv;
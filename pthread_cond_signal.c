@@ -137,6 +137,9 @@ ptw32_cond_unblock (pthread_cond_t * cond, int unblockAll)
       return pthread_mutex_unlock (&(cv->mtxUnblockLock));
     }
 
+  PTW32_TRACE_EVENT(unblockAll ? PTW32_TRACE_COND_BROADCAST : PTW32_TRACE_COND_SIGNAL,
+		    cv, nSignalsToIssue);
+
   if ((result = pthread_mutex_unlock (&(cv->mtxUnblockLock))) == 0)
     {
       if (sem_post_multiple (&(cv->semBlockQueue), nSignalsToIssue) != 0)
@@ -177,6 +180,11 @@ pthread_cond_signal (pthread_cond_t * cond)
       *      1)      Use when any waiter can respond and only one need
       *              respond (all waiters being equal).
       *
+      *      2)      The waiter chosen is only guaranteed to be the
+      *              longest or the highest priority one if the
+      *              condition variable was created with
+      *              pthread_condattr_setwakeorder_np().
+      *
       * RESULTS
       *              0               successfully signaled condition,
       *              EINVAL          'cond' is invalid,
@@ -357,6 +357,7 @@ ptw32_cond_timedwait (pthread_cond_t * cond,
   int result = 0;
   pthread_cond_t cv;
   ptw32_cond_wait_cleanup_args_t cleanup_args;
+  ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
 
   if (cond == NULL || *cond == NULL)
     {
@@ -404,7 +405,7 @@ ptw32_cond_timedwait (pthread_cond_t * cond,
 #if defined(_MSC_VER) && _MSC_VER < 800
 #pragma inline_depth(0)
 #endif
-  pthread_cleanup_push (ptw32_cond_wait_cleanup, (void *) &cleanup_args);
+  PTW32_CANCEL_CLEANUP_PUSH (ptw32_cond_wait_cleanup, (void *) &cleanup_args);
 
   /*
    * Now we can release 'mutex' and...
@@ -428,16 +429,36 @@ ptw32_cond_timedwait (pthread_cond_t * cond,
        *      re-lock the mutex and adjust (to)unblock(ed) waiters
        *      counts if we are cancelled, timed out or signalled.
        */
+      PTW32_STATS_INC(PTW32_STAT_COND_WAITS);
+      PTW32_TRACE_EVENT(PTW32_TRACE_COND_WAIT_BEGIN, cv, 0);
+      PTW32_HOOK_BEFORE(hook, PTW32_WAIT_COND, cond);
       if (sem_timedwait (&(cv->semBlockQueue), abstime) != 0)
 	{
 	  result = errno;
+	  if (result == ETIMEDOUT)
+	    {
+	      PTW32_STATS_INC(PTW32_STAT_COND_TIMEOUTS);
+	    }
+	  else if (result == EINTR)
+	    {
+	      /*
+	       * Interrupted by pthread_interrupt_np(). Condition waits
+	       * may not fail with EINTR, so treat it as a spurious
+	       * wakeup: the caller re-tests its predicate with the
+	       * mutex held.
+	       */
+	      result = 0;
+	    }
 	}
+      PTW32_TRACE_EVENT(PTW32_TRACE_COND_WAIT_END, cv, result);
+      PTW32_HOOK_AFTER(hook, PTW32_WAIT_COND, cond,
+		       result == 0 ? cv->semBlockQueue->wakerThread : 0, result);
     }
 
   /*
    * Always cleanup
    */
-  pthread_cleanup_pop (1);
+  PTW32_CANCEL_CLEANUP_POP (1);
 #if defined(_MSC_VER) && _MSC_VER < 800
 #pragma inline_depth()
 #endif
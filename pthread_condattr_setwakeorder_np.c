@@ -0,0 +1,128 @@
+/*
+ * pthread_condattr_setwakeorder_np.c
+ *
+ * Description:
+ * This translation unit implements condition variables and their primitives.
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+
+int
+pthread_condattr_setwakeorder_np (pthread_condattr_t * attr, int order)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function chooses the order in which condition
+      *      variables created with 'attr' release their waiters.
+      *
+      * PARAMETERS
+      *      attr
+      *              pointer to an instance of pthread_condattr_t
+      *
+      *      order
+      *              must be one of:
+      *
+      *                      PTHREAD_WAKE_DEFAULT_NP
+      *                              whichever waiter the W32 sema
+      *                              picks (the default)
+      *
+      *                      PTHREAD_WAKE_FIFO_NP
+      *                              strict arrival order
+      *
+      *                      PTHREAD_WAKE_PRIORITY_NP
+      *                              highest sched_priority first,
+      *                              arrival order among equals
+      *
+      * DESCRIPTION
+      *      The condition variable's internal semaphores are given
+      *      the same order with sem_setwakeorder_np(), so that
+      *      pthread_cond_signal() wakes the longest or the highest
+      *      priority waiter and pthread_cond_broadcast() wakes
+      *      them in that order. Each wait that blocks then costs an
+      *      event. A PTHREAD_COND_INITIALIZER condition variable
+      *      always has the default order.
+      *
+      * RESULTS
+      *              0               successfully set the order,
+      *              EINVAL          'attr' or 'order' is invalid.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (attr == NULL || *attr == NULL
+      || order < PTHREAD_WAKE_DEFAULT_NP || order > PTHREAD_WAKE_PRIORITY_NP)
+    {
+      return EINVAL;
+    }
+
+  (*attr)->wakeOrder = order;
+  return 0;
+
+}				/* pthread_condattr_setwakeorder_np */
+
+
+int
+pthread_condattr_getwakeorder_np (const pthread_condattr_t * attr, int *order)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function returns the order in which condition
+      *      variables created with 'attr' release their waiters.
+      *
+      * PARAMETERS
+      *      attr
+      *              pointer to an instance of pthread_condattr_t
+      *
+      *      order
+      *              pointer to an int, set to one of the
+      *              PTHREAD_WAKE_*_NP values
+      *
+      * RESULTS
+      *              0               successfully retrieved the order,
+      *              EINVAL          'attr' or 'order' is invalid.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (attr == NULL || *attr == NULL || order == NULL)
+    {
+      return EINVAL;
+    }
+
+  *order = (*attr)->wakeOrder;
+  return 0;
+
+}				/* pthread_condattr_getwakeorder_np */
@@ -66,6 +66,8 @@
  *           Successful completion.
  *  [EINVAL] 
  *           The value specified by interval is invalid. 
+ *  [EINTR] 
+ *           The thread was woken early by pthread_interrupt_np(). 
  *
  * Example
  *
@@ -84,9 +86,11 @@ pthread_delay_np (struct timespec *interval)
   DWORD wait_time;
   DWORD secs_in_millisecs;
   DWORD millisecs;
+#if !defined(PTW32_NO_CANCEL)
   DWORD status;
   pthread_t self;
   ptw32_thread_t * sp;
+#endif
 
   if (interval == NULL)
     {
@@ -95,9 +99,9 @@ pthread_delay_np (struct timespec *interval)
 
   if (interval->tv_sec == 0L && interval->tv_nsec == 0L)
     {
-      pthread_testcancel ();
+      PTW32_TESTCANCEL ();
       Sleep (0);
-      pthread_testcancel ();
+      PTW32_TESTCANCEL ();
       return (0);
     }
 
@@ -125,6 +129,7 @@ pthread_delay_np (struct timespec *interval)
 #pragma enable_message (124)
 #endif
 
+#if !defined(PTW32_NO_CANCEL)
   if (NULL == (self = pthread_self ()).p)
     {
       return ENOMEM;
@@ -132,41 +137,44 @@ pthread_delay_np (struct timespec *interval)
 
   sp = (ptw32_thread_t *) self.p;
 
-  if (sp->cancelState == PTHREAD_CANCEL_ENABLE)
+  while (PTW32_CANCEL_EVENT_WAITABLE(sp))
     {
+      DWORD started = GetTickCount ();
+
       /*
        * Async cancelation won't catch us until wait_time is up.
-       * Deferred cancelation will cancel us immediately.
+       * Deferred cancelation will cancel us immediately, and
+       * pthread_interrupt_np() will wake us early with EINTR.
        */
       if (WAIT_OBJECT_0 ==
 	  (status = WaitForSingleObject (sp->cancelEvent, wait_time)))
 	{
-          ptw32_mcs_local_node_t stateLock;
+	  DWORD elapsed;
+
 	  /*
-	   * Canceling!
+	   * Canceling (does not return) or interrupted?
 	   */
-	  ptw32_mcs_lock_acquire (&sp->stateLock, &stateLock);
-	  if (sp->state < PThreadStateCanceling)
+	  if (ptw32_cancel_event_check (sp) == EINTR)
 	    {
-	      sp->state = PThreadStateCanceling;
-	      sp->cancelState = PTHREAD_CANCEL_DISABLE;
-	      ptw32_mcs_lock_release (&stateLock);
-
-	      ptw32_throw (PTW32_EPS_CANCEL);
+	      return EINTR;
 	    }
 
-	  ptw32_mcs_lock_release (&stateLock);
-	  return ESRCH;
+	  /* Stale signal: wait out the remainder. */
+	  elapsed = GetTickCount () - started;
+	  wait_time = (elapsed < wait_time) ? wait_time - elapsed : 0;
 	}
       else if (status != WAIT_TIMEOUT)
 	{
 	  return EINVAL;
 	}
+      else
+	{
+	  return (0);
+	}
     }
-  else
-    {
-      Sleep (wait_time);
-    }
+#endif
+
+  Sleep (wait_time);
 
   return (0);
 }
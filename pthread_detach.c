@@ -113,6 +113,12 @@ pthread_detach (pthread_t thread)
           destroyIt = PTW32_TRUE;
         }
       ptw32_mcs_lock_release (&stateLock);
+
+      /*
+       * Still under the reuse lock, so the thread can't be recycled
+       * even if it is now destroying itself.
+       */
+      ptw32_group_detach (tp);
     }
 
   ptw32_mcs_lock_release(&node);
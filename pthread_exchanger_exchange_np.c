@@ -0,0 +1,177 @@
+/*
+ * pthread_exchanger_exchange_np.c
+ *
+ * Description:
+ * This translation unit implements exchanger handoffs.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_exchanger_put_np (pthread_exchanger_t exchanger, void * item,
+			  const struct timespec * abstime)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function hands an item to a thread taking from
+      *      the exchanger, waiting for one to arrive if necessary.
+      *
+      * PARAMETERS
+      *      exchanger
+      *              an exchanger
+      *
+      *      item
+      *              the item to hand over
+      *
+      *      abstime
+      *              absolute time by which a taker must arrive, or
+      *              NULL to wait indefinitely
+      *
+      * DESCRIPTION
+      *      Takers are served oldest first. A waiting thread spins
+      *      for the wait policy's spin budget (see
+      *      pthread_setwaitpolicy_np()) before it blocks. This
+      *      function is a cancellation point; if the thread is
+      *      cancelled while it waits, the item is either withdrawn
+      *      or has already been taken.
+      *
+      * RESULTS
+      *              0               a taker received 'item',
+      *              EINVAL          'exchanger' is invalid,
+      *              ETIMEDOUT       'abstime' passed first,
+      *              EINTR           the wait was interrupted,
+      *              ENOMEM          insufficient resources.
+      *
+      * ------------------------------------------------------
+      */
+{
+  void * ignored;
+
+  if (exchanger == NULL)
+    {
+      return EINVAL;
+    }
+
+  return ptw32_exchange (exchanger, PTW32_EXCHANGE_PUT, item, &ignored, abstime);
+}
+
+
+int
+pthread_exchanger_take_np (pthread_exchanger_t exchanger, void ** item,
+			   const struct timespec * abstime)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function takes an item from a thread putting to
+      *      the exchanger, waiting for one to arrive if necessary.
+      *
+      * PARAMETERS
+      *      exchanger
+      *              an exchanger
+      *
+      *      item
+      *              receives the item
+      *
+      *      abstime
+      *              absolute time by which a putter must arrive, or
+      *              NULL to wait indefinitely
+      *
+      * DESCRIPTION
+      *      Putters are served oldest first. This function is a
+      *      cancellation point.
+      *
+      * RESULTS
+      *              0               *item is the putter's item,
+      *              EINVAL          an argument is invalid,
+      *              ETIMEDOUT       'abstime' passed first,
+      *              EINTR           the wait was interrupted,
+      *              ENOMEM          insufficient resources.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (exchanger == NULL || item == NULL)
+    {
+      return EINVAL;
+    }
+
+  return ptw32_exchange (exchanger, PTW32_EXCHANGE_TAKE, NULL, item, abstime);
+}
+
+
+int
+pthread_exchanger_exchange_np (pthread_exchanger_t exchanger, void * item,
+			       void ** other, const struct timespec * abstime)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function swaps an item with another thread
+      *      exchanging on the exchanger.
+      *
+      * PARAMETERS
+      *      exchanger
+      *              an exchanger
+      *
+      *      item
+      *              the item to give
+      *
+      *      other
+      *              receives the other thread's item
+      *
+      *      abstime
+      *              absolute time by which a partner must arrive,
+      *              or NULL to wait indefinitely
+      *
+      * DESCRIPTION
+      *      Exchanging threads pair up oldest first and never with
+      *      putters or takers. This function is a cancellation
+      *      point.
+      *
+      * RESULTS
+      *              0               *other is the partner's item,
+      *              EINVAL          an argument is invalid,
+      *              ETIMEDOUT       'abstime' passed first,
+      *              EINTR           the wait was interrupted,
+      *              ENOMEM          insufficient resources.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (exchanger == NULL || other == NULL)
+    {
+      return EINVAL;
+    }
+
+  return ptw32_exchange (exchanger, PTW32_EXCHANGE_SWAP, item, other, abstime);
+}
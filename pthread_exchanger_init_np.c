@@ -0,0 +1,134 @@
+/*
+ * pthread_exchanger_init_np.c
+ *
+ * Description:
+ * This translation unit implements exchanger creation and destruction.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_exchanger_init_np (pthread_exchanger_t * exchanger)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function creates an exchanger.
+      *
+      * PARAMETERS
+      *      exchanger
+      *              pointer to a pthread_exchanger_t
+      *
+      * DESCRIPTION
+      *      An exchanger is a rendezvous with no buffer: each
+      *      pthread_exchanger_put_np() waits for a matching
+      *      pthread_exchanger_take_np() and hands its item straight
+      *      to it, and two pthread_exchanger_exchange_np() calls
+      *      swap items.
+      *
+      * RESULTS
+      *              0               successfully created the exchanger,
+      *              EINVAL          'exchanger' is NULL,
+      *              ENOMEM          insufficient memory.
+      *
+      * ------------------------------------------------------
+      */
+{
+  pthread_exchanger_t ex;
+
+  if (exchanger == NULL)
+    {
+      return EINVAL;
+    }
+
+  ex = (pthread_exchanger_t) calloc (1, sizeof (*ex));
+
+  if (ex == NULL)
+    {
+      return ENOMEM;
+    }
+
+  *exchanger = ex;
+
+  return 0;
+}
+
+
+int
+pthread_exchanger_destroy_np (pthread_exchanger_t * exchanger)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function destroys an exchanger.
+      *
+      * PARAMETERS
+      *      exchanger
+      *              pointer to a pthread_exchanger_t
+      *
+      * DESCRIPTION
+      *      No thread may be waiting on the exchanger.
+      *
+      * RESULTS
+      *              0               successfully destroyed the exchanger,
+      *              EINVAL          'exchanger' is invalid,
+      *              EBUSY           a thread is waiting on it.
+      *
+      * ------------------------------------------------------
+      */
+{
+  pthread_exchanger_t ex;
+  ptw32_mcs_local_node_t node;
+  int result = 0;
+
+  if (exchanger == NULL || *exchanger == NULL)
+    {
+      return EINVAL;
+    }
+
+  ex = *exchanger;
+
+  ptw32_mcs_lock_acquire (&ex->lock, &node);
+  if (ex->head != NULL)
+    {
+      result = EBUSY;
+    }
+  ptw32_mcs_lock_release (&node);
+
+  if (result == 0)
+    {
+      *exchanger = NULL;
+      free (ex);
+    }
+
+  return result;
+}
@@ -0,0 +1,119 @@
+/*
+ * pthread_getstats_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_getstats_np (struct ptw32_stats * stats)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Takes a snapshot of the library-wide counters.
+      *
+      * PARAMETERS
+      *      stats
+      *              pointer to a struct ptw32_stats to fill in.
+      *
+      * DESCRIPTION
+      *      The counters are sharded to keep updates cheap, and
+      *      the shards are summed here. The shards are read
+      *      without locking so the snapshot is not atomic as a
+      *      whole: values that are updated together (e.g. waits
+      *      and timeouts) may be momentarily out of step.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          'stats' is NULL.
+      *
+      * ------------------------------------------------------
+      */
+{
+  LONG sum[PTW32_STAT_COUNT];
+  int i, j;
+
+  if (stats == NULL)
+    {
+      return EINVAL;
+    }
+
+  for (j = 0; j < PTW32_STAT_COUNT; j++)
+    {
+      sum[j] = 0;
+    }
+
+  for (i = 0; i < PTW32_STATS_SHARDS; i++)
+    {
+      volatile LONG * counter = ptw32_stats_shards[i].counter;
+
+      for (j = 0; j < PTW32_STAT_COUNT; j++)
+	{
+	  sum[j] += counter[j];
+	}
+    }
+
+  stats->threadsCreated = (unsigned long) sum[PTW32_STAT_THREADS_CREATED];
+  stats->threadsExited = (unsigned long) sum[PTW32_STAT_THREADS_EXITED];
+  stats->threadReuseHits = (unsigned long) sum[PTW32_STAT_THREAD_REUSE_HITS];
+  stats->threadReuseMisses = (unsigned long) sum[PTW32_STAT_THREAD_REUSE_MISSES];
+  stats->implicitThreads = (unsigned long) sum[PTW32_STAT_IMPLICIT_THREADS];
+  stats->mutexes = (long) sum[PTW32_STAT_MUTEXES_LIVE];
+  stats->conds = (long) sum[PTW32_STAT_CONDS_LIVE];
+  stats->rwlocks = (long) sum[PTW32_STAT_RWLOCKS_LIVE];
+  stats->spinlocks = (long) sum[PTW32_STAT_SPINLOCKS_LIVE];
+  stats->barriers = (long) sum[PTW32_STAT_BARRIERS_LIVE];
+  stats->semaphores = (long) sum[PTW32_STAT_SEMAPHORES_LIVE];
+  stats->keys = (long) sum[PTW32_STAT_KEYS_LIVE];
+  stats->threadHandles = (long) sum[PTW32_STAT_THREAD_HANDLES];
+  stats->mutexHandles = (long) sum[PTW32_STAT_MUTEX_HANDLES];
+  stats->semaphoreHandles = (long) sum[PTW32_STAT_SEMAPHORE_HANDLES];
+  stats->mutexWaits = (unsigned long) sum[PTW32_STAT_MUTEX_WAITS];
+  stats->mutexTimeouts = (unsigned long) sum[PTW32_STAT_MUTEX_TIMEOUTS];
+  stats->condWaits = (unsigned long) sum[PTW32_STAT_COND_WAITS];
+  stats->condTimeouts = (unsigned long) sum[PTW32_STAT_COND_TIMEOUTS];
+  stats->semWaits = (unsigned long) sum[PTW32_STAT_SEM_WAITS];
+  stats->semTimeouts = (unsigned long) sum[PTW32_STAT_SEM_TIMEOUTS];
+  stats->barrierWaits = (unsigned long) sum[PTW32_STAT_BARRIER_WAITS];
+  stats->joinWaits = (unsigned long) sum[PTW32_STAT_JOIN_WAITS];
+  stats->mcsContended = (unsigned long) sum[PTW32_STAT_MCS_CONTENDED];
+  stats->mcsWaits = (unsigned long) sum[PTW32_STAT_MCS_WAITS];
+  stats->cancelsRequested = (unsigned long) sum[PTW32_STAT_CANCELS_REQUESTED];
+  stats->cancelsActed = (unsigned long) sum[PTW32_STAT_CANCELS_ACTED];
+
+  return 0;
+}
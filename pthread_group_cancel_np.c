@@ -0,0 +1,163 @@
+/*
+ * pthread_group_cancel_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_group_cancel_np (pthread_group_t group)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function requests cancellation of every member
+      *      of 'group' whose start routine has not returned.
+      *
+      * PARAMETERS
+      *      group
+      *              a thread group
+      *
+      * DESCRIPTION
+      *      Each member is cancelled as if by pthread_cancel(), but
+      *      the members are found by walking the group under its
+      *      lock instead of validating each thread handle against
+      *      the global thread list. If the caller is itself a
+      *      member it is cancelled last, after the group lock has
+      *      been released.
+      *
+      *      NOTE: cancellation is asynchronous; use
+      *      pthread_group_join_np() to wait for the members.
+      *
+      * RESULTS
+      *              0               successfully requested cancellation,
+      *              EINVAL          'group' is invalid,
+      *              ENOMEM          implicit self thread create failed.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_thread_t * sp;
+  ptw32_thread_t * tp;
+  ptw32_mcs_local_node_t node;
+  int cancel_self = PTW32_FALSE;
+
+  if (group == NULL)
+    {
+      return EINVAL;
+    }
+
+  if ((sp = (ptw32_thread_t *) pthread_self ().p) == NULL)
+    {
+      return ENOMEM;
+    }
+
+  /*
+   * Any member may be using async cancelation. The probe loads a DLL
+   * so it must be done before we take any locks; see pthread_cancel.
+   */
+  ptw32_quserex_probe ();
+
+  ptw32_mcs_lock_acquire (&group->lock, &node);
+  for (tp = group->running; tp != NULL; tp = tp->groupNext)
+    {
+      if (tp == sp)
+	{
+	  cancel_self = PTW32_TRUE;
+	}
+      else
+	{
+	  (void) ptw32_cancel_thread (tp, PTW32_FALSE);
+	}
+    }
+  ptw32_mcs_lock_release (&node);
+
+  if (cancel_self)
+    {
+      (void) ptw32_cancel_thread (sp, PTW32_TRUE);
+    }
+
+  return 0;
+}
+
+
+int
+pthread_group_interrupt_np (pthread_group_t group)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function interrupts every member of 'group' whose
+      *      start routine has not returned.
+      *
+      * PARAMETERS
+      *      group
+      *              a thread group
+      *
+      * DESCRIPTION
+      *      Each member is interrupted as if by
+      *      pthread_interrupt_np().
+      *
+      * RESULTS
+      *              0               successfully interrupted the members,
+      *              EINVAL          'group' is invalid,
+      *              ENOSYS          the library was built without
+      *                              cancelation support.
+      *
+      * ------------------------------------------------------
+      */
+{
+#if defined(PTW32_NO_CANCEL)
+  return ENOSYS;
+#else
+  ptw32_thread_t * tp;
+  ptw32_mcs_local_node_t node;
+
+  if (group == NULL)
+    {
+      return EINVAL;
+    }
+
+  ptw32_mcs_lock_acquire (&group->lock, &node);
+  for (tp = group->running; tp != NULL; tp = tp->groupNext)
+    {
+      /* See pthread_interrupt_np() */
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG) &tp->interrupted, (LONG) 1);
+      (void) SetEvent (tp->cancelEvent);
+    }
+  ptw32_mcs_lock_release (&node);
+
+  return 0;
+#endif
+}
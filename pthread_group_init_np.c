@@ -0,0 +1,149 @@
+/*
+ * pthread_group_init_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_group_init_np (pthread_group_t * group)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function creates an empty thread group.
+      *
+      * PARAMETERS
+      *      group
+      *              pointer to a pthread_group_t
+      *
+      * DESCRIPTION
+      *      Threads join the group when they are created with an
+      *      attribute object set by pthread_attr_setgroup_np(). The
+      *      group can then cancel, interrupt or join all of them
+      *      at once.
+      *
+      * RESULTS
+      *              0               successfully created the group,
+      *              EINVAL          'group' is NULL,
+      *              ENOMEM          insufficient memory,
+      *              EAGAIN          the group's event could not be
+      *                              created.
+      *
+      * ------------------------------------------------------
+      */
+{
+  pthread_group_t g;
+
+  if (group == NULL)
+    {
+      return EINVAL;
+    }
+
+  g = (pthread_group_t) calloc (1, sizeof (*g));
+
+  if (g == NULL)
+    {
+      return ENOMEM;
+    }
+
+  g->event = CreateEvent (0, (int) PTW32_TRUE,	/* manualReset  */
+			  (int) PTW32_FALSE,	/* setSignaled  */
+			  NULL);
+
+  if (g->event == NULL)
+    {
+      free (g);
+      return EAGAIN;
+    }
+
+  *group = g;
+
+  return 0;
+}
+
+
+int
+pthread_group_destroy_np (pthread_group_t * group)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function destroys a thread group.
+      *
+      * PARAMETERS
+      *      group
+      *              pointer to a pthread_group_t
+      *
+      * DESCRIPTION
+      *      The group must have no members: every thread created
+      *      in it must have been joined, detached and finished, or
+      *      reclaimed by pthread_group_join_np() or
+      *      pthread_group_wait_any_np().
+      *
+      * RESULTS
+      *              0               successfully destroyed the group,
+      *              EINVAL          'group' is invalid,
+      *              EBUSY           the group still has members.
+      *
+      * ------------------------------------------------------
+      */
+{
+  pthread_group_t g;
+  ptw32_mcs_local_node_t node;
+  int result = 0;
+
+  if (group == NULL || *group == NULL)
+    {
+      return EINVAL;
+    }
+
+  g = *group;
+
+  ptw32_mcs_lock_acquire (&g->lock, &node);
+  if (g->running != NULL || g->done != NULL)
+    {
+      result = EBUSY;
+    }
+  ptw32_mcs_lock_release (&node);
+
+  if (result == 0)
+    {
+      *group = NULL;
+      (void) CloseHandle (g->event);
+      free (g);
+    }
+
+  return result;
+}
@@ -0,0 +1,264 @@
+/*
+ * pthread_group_join_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_group_join_np (pthread_group_t group)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function waits for every member of 'group' to
+      *      finish and reclaims the joinable ones.
+      *
+      * PARAMETERS
+      *      group
+      *              a thread group
+      *
+      * DESCRIPTION
+      *      Returns once no member's start routine is still
+      *      running. Each joinable member is reclaimed as if by
+      *      pthread_join() with its exit value discarded; detached
+      *      members are only waited for. Threads added to the group
+      *      while this function waits are waited for too.
+      *
+      *      Rather than one wait per member, the caller sleeps on
+      *      the group's event, which members set as they finish,
+      *      and reclaims whatever has finished each time it wakes.
+      *
+      *      This function is a cancelation point. If it is
+      *      cancelled or interrupted, members not yet reclaimed
+      *      stay in the group.
+      *
+      * RESULTS
+      *              0               all members finished,
+      *              EINVAL          'group' is invalid,
+      *              EDEADLK         the caller is a member of 'group',
+      *              ENOMEM          implicit self thread create failed,
+      *              EINTR           interrupted by pthread_interrupt_np().
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result = 0;
+  ptw32_thread_t * sp;
+  ptw32_thread_t * taken;
+  ptw32_thread_t * tp;
+  ptw32_mcs_local_node_t node;
+
+  if (group == NULL)
+    {
+      return EINVAL;
+    }
+
+  if ((sp = (ptw32_thread_t *) pthread_self ().p) == NULL)
+    {
+      return ENOMEM;
+    }
+
+  for (;;)
+    {
+      ptw32_mcs_lock_acquire (&group->lock, &node);
+
+      if (sp->group == group)
+	{
+	  ptw32_mcs_lock_release (&node);
+	  result = EDEADLK;
+	  break;
+	}
+
+      taken = group->done;
+      group->done = NULL;
+
+      for (tp = taken; tp != NULL; tp = tp->groupNext)
+	{
+	  tp->group = NULL;
+	}
+
+      if (taken == NULL)
+	{
+	  if (group->running == NULL)
+	    {
+	      ptw32_mcs_lock_release (&node);
+	      break;
+	    }
+
+	  /* Members set it under the lock, so no wakeup is lost. */
+	  (void) ResetEvent (group->event);
+	}
+
+      ptw32_mcs_lock_release (&node);
+
+      if (taken != NULL)
+	{
+	  ptw32_group_reclaim (taken);
+	}
+      else
+	{
+	  PTW32_STATS_INC(PTW32_STAT_JOIN_WAITS);
+	  if ((result = pthreadCancelableWait (group->event)) != 0)
+	    {
+	      if (result != EINTR)
+		{
+		  result = EINVAL;
+		}
+	      break;
+	    }
+	}
+    }
+
+  return (result);
+
+}				/* pthread_group_join_np */
+
+
+int
+pthread_group_wait_any_np (pthread_group_t group, pthread_t * thread,
+			   void **value_ptr)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function waits for any joinable member of 'group'
+      *      to finish and reclaims it.
+      *
+      * PARAMETERS
+      *      group
+      *              a thread group
+      *
+      *      thread
+      *              if not NULL, set to the member reclaimed
+      *
+      *      value_ptr
+      *              if not NULL, set to the member's exit value
+      *
+      * DESCRIPTION
+      *      If a member has already finished it is reclaimed at
+      *      once, as if by pthread_join(); otherwise the caller
+      *      waits on the group's event. The pthread_t returned is
+      *      no longer valid for other calls.
+      *
+      *      This function is a cancelation point.
+      *
+      * RESULTS
+      *              0               a member was reclaimed,
+      *              EINVAL          'group' is invalid,
+      *              ESRCH           the group has no joinable members
+      *                              left to wait for,
+      *              EDEADLK         the caller is the only member left,
+      *              ENOMEM          implicit self thread create failed,
+      *              EINTR           interrupted by pthread_interrupt_np().
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result = 0;
+  ptw32_thread_t * sp;
+  ptw32_thread_t * tp;
+  ptw32_mcs_local_node_t node;
+
+  if (group == NULL)
+    {
+      return EINVAL;
+    }
+
+  if ((sp = (ptw32_thread_t *) pthread_self ().p) == NULL)
+    {
+      return ENOMEM;
+    }
+
+  for (;;)
+    {
+      ptw32_mcs_lock_acquire (&group->lock, &node);
+
+      if ((tp = group->done) != NULL)
+	{
+	  if ((group->done = tp->groupNext) != NULL)
+	    {
+	      group->done->groupPrev = NULL;
+	    }
+	  tp->groupNext = NULL;
+	  tp->group = NULL;
+	}
+      else if (group->running == NULL)
+	{
+	  result = ESRCH;
+	}
+      else if (group->running == sp && sp->groupNext == NULL)
+	{
+	  result = EDEADLK;
+	}
+      else
+	{
+	  (void) ResetEvent (group->event);
+	}
+
+      ptw32_mcs_lock_release (&node);
+
+      if (tp != NULL)
+	{
+	  if (thread != NULL)
+	    {
+	      *thread = tp->ptHandle;
+	    }
+	  if (value_ptr != NULL)
+	    {
+	      *value_ptr = tp->exitStatus;
+	    }
+	  ptw32_group_reclaim (tp);
+	  break;
+	}
+
+      if (result != 0)
+	{
+	  break;
+	}
+
+      PTW32_STATS_INC(PTW32_STAT_JOIN_WAITS);
+      if ((result = pthreadCancelableWait (group->event)) != 0)
+	{
+	  if (result != EINTR)
+	    {
+	      result = EINVAL;
+	    }
+	  break;
+	}
+    }
+
+  return (result);
+
+}				/* pthread_group_wait_any_np */
@@ -0,0 +1,106 @@
+/*
+ * pthread_interrupt_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_interrupt_np (pthread_t thread)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function wakes 'thread' from a blocking library
+      *      wait without cancelling it.
+      *
+      * PARAMETERS
+      *      thread
+      *              an instance of pthread_t
+      *
+      * DESCRIPTION
+      *      If 'thread' is blocked in sem_wait, sem_timedwait,
+      *      pthread_join or pthread_delay_np, that call returns
+      *      EINTR. A thread blocked in pthread_cond_wait or
+      *      pthread_cond_timedwait returns 0, as if spuriously
+      *      woken, with the mutex reacquired. If 'thread' is not
+      *      waiting, its next such wait returns immediately.
+      *
+      *      The interrupt shares the thread's cancellation event.
+      *      A pending deferred cancel takes precedence, and a thread
+      *      with a cancel pending while cancellation is disabled
+      *      cannot be interrupted until the cancel is acted on.
+      *      Mutex waits are not interrupted.
+      *
+      * RESULTS
+      *              0               the interrupt was posted,
+      *              ESRCH           no thread could be found with ID
+      *                              'thread', or it has no event.
+      *              ENOSYS          the library was built with
+      *                              PTW32_NO_CANCEL.
+      *
+      * ------------------------------------------------------
+      */
+{
+#if defined(PTW32_NO_CANCEL)
+  return ENOSYS;
+#else
+  int result;
+  ptw32_thread_t * tp;
+
+  result = pthread_kill (thread, 0);
+
+  if (0 != result)
+    {
+      return result;
+    }
+
+  tp = (ptw32_thread_t *) thread.p;
+
+  /*
+   * Set the flag before the event so that whoever sees the
+   * event can also see why it was set.
+   */
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG) &tp->interrupted, (LONG) 1);
+
+  if (tp->cancelEvent == NULL || !SetEvent (tp->cancelEvent))
+    {
+      result = ESRCH;
+    }
+
+  return result;
+#endif
+
+}				/* pthread_interrupt_np */
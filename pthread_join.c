@@ -78,6 +78,8 @@ pthread_join (pthread_t thread, void **value_ptr)
       *              ESRCH           no thread could be found with ID 'thread',
       *              ENOENT          thread couldn't find it's own valid handle,
       *              EDEADLK         attempt to join thread with self
+      *              EINTR           woken by pthread_interrupt_np(); 'thread'
+      *                              is still joinable
       *
       * ------------------------------------------------------
       */
@@ -128,8 +130,24 @@ pthread_join (pthread_t thread, void **value_ptr)
 	   * detached (destroyed). This is guarranteed because
 	   * pthreadCancelableWait will not return if we
 	   * are canceled.
+	   *
+	   * The exitEvent is set as soon as the target's start routine
+	   * and TSD destructors have finished. If the target is still
+	   * tearing down when we detach it below, it destroys itself
+	   * afterwards, so only that path waits on the thread handle.
 	   */
-	  result = pthreadCancelableWait (tp->threadH);
+	  HANDLE h = (tp->exitEvent != NULL ? tp->exitEvent : tp->threadH);
+	  ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+
+	  PTW32_STATS_INC(PTW32_STAT_JOIN_WAITS);
+
+	  /* Only call the wait hooks if we are really going to block. */
+	  if (ptw32_wait_hooks_active && WaitForSingleObject (h, 0) == WAIT_TIMEOUT)
+	    {
+	      ptw32_hook_before (&hook, PTW32_WAIT_JOIN, tp);
+	    }
+	  result = pthreadCancelableWait (h);
+	  PTW32_HOOK_AFTER(hook, PTW32_WAIT_JOIN, tp, result == 0 ? tp->thread : 0, result);
 
 	  if (0 == result)
 	    {
@@ -145,8 +163,11 @@ pthread_join (pthread_t thread, void **value_ptr)
 	       */
 	      result = pthread_detach (thread);
 	    }
-	  else
+	  else if (EINTR != result)
 	    {
+	      /*
+	       * An interrupted join leaves the target joinable.
+	       */
 	      result = ESRCH;
 	    }
 	}
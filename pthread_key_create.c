@@ -104,5 +104,10 @@ pthread_key_create (pthread_key_t * key, void (*destructor) (void *))
 
   *key = newkey;
 
+  if (0 == result)
+    {
+      PTW32_STATS_INC(PTW32_STAT_KEYS_LIVE);
+    }
+
   return (result);
 }
@@ -0,0 +1,271 @@
+/*
+ * pthread_key_create_sized_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+/* TLS_OUT_OF_INDEXES not defined on WinCE */
+#ifndef TLS_OUT_OF_INDEXES
+#define TLS_OUT_OF_INDEXES 0xffffffff
+#endif
+
+
+int
+pthread_key_create_sized_np (pthread_key_t * key,
+			     size_t size,
+			     size_t align,
+			     void (*constructor) (void *),
+			     void (*destructor) (void *))
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function creates a key whose value in each
+      *      thread is a private block of 'size' bytes.
+      *
+      * PARAMETERS
+      *      key
+      *              pointer to an instance of pthread_key_t
+      *
+      *      size
+      *              size of each thread's block in bytes
+      *
+      *      align
+      *              required alignment of the block: 0 for
+      *              the default (that of malloc for small types),
+      *              or a power of two no greater than 64
+      *
+      *      constructor
+      *              if not NULL, called with the address of each
+      *              thread's block when it is allocated
+      *
+      *      destructor
+      *              if not NULL, called with the address of each
+      *              thread's block when the thread exits
+      *
+      * DESCRIPTION
+      *      Blocks for all sized keys live together in a per-thread
+      *      arena, so pthread_getspecific_ptr_np() finds one with a
+      *      TLS lookup and an add rather than following a pointer
+      *      to a separately allocated structure. A thread's arena
+      *      is allocated on its first call to
+      *      pthread_getspecific_ptr_np(); keys created after that
+      *      get an extra arena segment on their first use. Each
+      *      block is zeroed and constructed on the thread's first
+      *      call for its key.
+      *
+      *      pthread_setspecific() fails with EINVAL for a sized key
+      *      and pthread_getspecific() returns NULL. After
+      *      pthread_key_delete() the blocks are no longer destroyed;
+      *      the next key created with the same size and a compatible
+      *      alignment takes over their place in every arena.
+      *
+      * RESULTS
+      *              0               successfully created key,
+      *              EINVAL          'size' is 0 or 'align' is not
+      *                              valid,
+      *              ENOMEM          insufficient memory to create
+      *                              key.
+      *
+      * ------------------------------------------------------
+      */
+{
+  pthread_key_t newkey;
+  pthread_key_t k = NULL;
+  ptw32_mcs_local_node_t node;
+  int result = 0;
+
+  if (align == 0)
+    {
+      align = 2 * sizeof (void *);
+    }
+
+  if (size == 0
+      || align > PTW32_TLS_ARENA_ALIGN_MAX
+      || (align & (align - 1)) != 0)
+    {
+      return EINVAL;
+    }
+
+  /*
+   * Room for the block's generation stamp.
+   */
+  if (align < sizeof (LONG))
+    {
+      align = sizeof (LONG);
+    }
+
+  if ((newkey = (pthread_key_t) calloc (1, sizeof (*newkey))) == NULL)
+    {
+      return ENOMEM;
+    }
+
+  newkey->key = TLS_OUT_OF_INDEXES;
+  newkey->size = size;
+  newkey->constructor = constructor;
+  newkey->destructor = destructor;
+
+  ptw32_mcs_lock_acquire (&ptw32_tls_arena_lock, &node);
+
+  /*
+   * The first sized key creates the key that holds each thread's
+   * arena and frees it at thread exit.
+   */
+  if (ptw32_tls_arena_key == NULL)
+    {
+      result = pthread_key_create (&ptw32_tls_arena_key,
+				   ptw32_tls_arena_destroy);
+    }
+
+  if (result == 0)
+    {
+      if (++ptw32_tls_arena_generation == 0)
+	{
+	  ptw32_tls_arena_generation = 1;
+	}
+
+      /*
+       * Take over the place of a deleted key if one fits.
+       */
+      for (k = ptw32_tls_arena_keys; k != NULL; k = k->nextSized)
+	{
+	  if (k->generation == 0 && k->size == size
+	      && (k->offset & (align - 1)) == 0)
+	    {
+	      break;
+	    }
+	}
+
+      if (k != NULL)
+	{
+	  k->constructor = constructor;
+	  k->destructor = destructor;
+	  k->generation = ptw32_tls_arena_generation;
+	}
+      else
+	{
+	  newkey->offset = (ptw32_tls_arena_end + sizeof (LONG) + align - 1)
+	    & ~(align - 1);
+	  ptw32_tls_arena_end = newkey->offset + size;
+	  newkey->generation = ptw32_tls_arena_generation;
+
+	  if (ptw32_tls_arena_last == NULL)
+	    {
+	      ptw32_tls_arena_keys = newkey;
+	    }
+	  else
+	    {
+	      ptw32_tls_arena_last->nextSized = newkey;
+	    }
+	  ptw32_tls_arena_last = newkey;
+	}
+    }
+
+  ptw32_mcs_lock_release (&node);
+
+  if (result != 0)
+    {
+      free (newkey);
+      newkey = NULL;
+    }
+  else
+    {
+      if (k != NULL)
+	{
+	  free (newkey);
+	  newkey = k;
+	}
+      PTW32_STATS_INC(PTW32_STAT_KEYS_LIVE);
+    }
+
+  *key = newkey;
+
+  return result;
+
+}				/* pthread_key_create_sized_np */
+
+
+void *
+pthread_getspecific_ptr_np (pthread_key_t key)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function returns the address of the calling
+      *      thread's block for a key made by
+      *      pthread_key_create_sized_np().
+      *
+      * PARAMETERS
+      *      key
+      *              an instance of pthread_key_t
+      *
+      * DESCRIPTION
+      *      The address does not change for the life of the
+      *      thread. The block is allocated and constructed by
+      *      the thread's first call for the key.
+      *
+      * RESULTS
+      *              address of the block, or NULL if memory
+      *              could not be allocated.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_tls_segment_t * seg;
+  int lasterror = GetLastError ();
+#if defined(RETAIN_WSALASTERROR)
+  int lastWSAerror = WSAGetLastError ();
+#endif
+
+  seg = (ptw32_tls_segment_t *) TlsGetValue (ptw32_tls_arena_key->key);
+
+  SetLastError (lasterror);
+#if defined(RETAIN_WSALASTERROR)
+  WSASetLastError (lastWSAerror);
+#endif
+
+  /*
+   * The first segment starts at offset 0 and includes every key
+   * that existed when it was allocated. The block is ready once
+   * stamped with the key's generation.
+   */
+  if (seg != NULL && key->offset < seg->end
+      && *PTW32_TLS_ARENA_STAMP(seg->origin, key->offset) == key->generation)
+    {
+      return seg->origin + key->offset;
+    }
+
+  return ptw32_tls_arena_lookup (key);
+
+}				/* pthread_getspecific_ptr_np */
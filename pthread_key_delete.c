@@ -69,7 +69,15 @@ pthread_key_delete (pthread_key_t key)
   ptw32_mcs_local_node_t keyLock;
   int result = 0;
 
-  if (key != NULL)
+  if (key != NULL && key->size != 0)
+    {
+      /*
+       * Sized keys have no TLS index or associations of their own.
+       */
+      ptw32_tls_arena_key_delete (key);
+      PTW32_STATS_DEC(PTW32_STAT_KEYS_LIVE);
+    }
+  else if (key != NULL)
     {
       if (key->threads != NULL && key->destructor != NULL)
 	{
@@ -119,6 +127,8 @@ pthread_key_delete (pthread_key_t key)
       memset ((char *) key, 0, sizeof (*key));
 #endif
       free (key);
+
+      PTW32_STATS_DEC(PTW32_STAT_KEYS_LIVE);
     }
 
   return (result);
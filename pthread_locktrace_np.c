@@ -0,0 +1,112 @@
+/*
+ * pthread_locktrace_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_locktrace_np (unsigned long maxRecords)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Starts or stops recording every mutex acquisition and
+      *      release in the process.
+      *
+      * PARAMETERS
+      *      maxRecords
+      *              the number of further operations that may be
+      *              recorded before recording stops by itself, or
+      *              zero to stop now.
+      *
+      * DESCRIPTION
+      *      Each record holds the mutex, the thread, the
+      *      operation, when it was called and, for a lock, how
+      *      long it took to get. Records are kept when recording
+      *      stops, and are written by pthread_locktrace_dump_np().
+      *      Each record takes 24 bytes.
+      *
+      * RESULTS
+      *              0               success,
+      *              EAGAIN          no TLS slot was available for
+      *                              the trace at process attach.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (maxRecords == 0)
+    {
+      ptw32_locktrace_stop ();
+      return 0;
+    }
+
+  return ptw32_locktrace_start (maxRecords);
+}
+
+
+int
+pthread_locktrace_dump_np (const char * path)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Writes the recorded lock trace to a file.
+      *
+      * PARAMETERS
+      *      path
+      *              name of the file to create or overwrite.
+      *
+      * DESCRIPTION
+      *      Every operation recorded since the process started is
+      *      written in the binary format described in
+      *      README.NONPORTABLE. Recording is not stopped. Use
+      *      tools/locktrace to summarise the file and
+      *      tests/benchtest13 to replay it.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          'path' is NULL,
+      *              EIO             the file couldn't be written.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (path == NULL)
+    {
+      return EINVAL;
+    }
+
+  return ptw32_locktrace_write (path);
+}
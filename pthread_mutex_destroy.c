@@ -82,6 +82,10 @@ pthread_mutex_destroy (pthread_mutex_t * mutex)
                     {
                       free(mx->robustNode);
                     }
+                  if (mx->cohort != NULL)
+                    {
+                      ptw32_cohort_destroy(mx);
+                    }
 		  if (!CloseHandle (mx->event))
 		    {
 		      *mutex = mx;
@@ -90,6 +94,8 @@ pthread_mutex_destroy (pthread_mutex_t * mutex)
 		  else
 		    {
 		      free (mx);
+		      PTW32_STATS_DEC(PTW32_STAT_MUTEXES_LIVE);
+		      PTW32_STATS_DEC(PTW32_STAT_MUTEX_HANDLES);
 		    }
 		}
 	      else
@@ -71,6 +71,12 @@ pthread_mutex_init (pthread_mutex_t * mutex, const pthread_mutexattr_t * attr)
 
 #endif /* _POSIX_THREAD_PROCESS_SHARED */
         }
+
+      if ((*attr)->kind == PTHREAD_MUTEX_COHORT_NP
+          && (*attr)->robustness == PTHREAD_MUTEX_ROBUST)
+        {
+          return EINVAL;
+        }
     }
 
   mx = (pthread_mutex_t) calloc (1, sizeof (*mx));
@@ -84,6 +90,7 @@ pthread_mutex_init (pthread_mutex_t * mutex, const pthread_mutexattr_t * attr)
       mx->lock_idx = 0;
       mx->recursive_count = 0;
       mx->robustNode = NULL;
+      mx->cohort = NULL;
       if (attr == NULL || *attr == NULL)
         {
           mx->kind = PTHREAD_MUTEX_DEFAULT;
@@ -122,6 +129,18 @@ pthread_mutex_init (pthread_mutex_t * mutex, const pthread_mutexattr_t * attr)
           free (mx);
           mx = NULL;
         }
+      else if (PTHREAD_MUTEX_COHORT_NP == mx->kind
+               && 0 != (result = ptw32_cohort_create (mx)))
+        {
+          (void) CloseHandle (mx->event);
+          free (mx);
+          mx = NULL;
+        }
+      else
+        {
+          PTW32_STATS_INC(PTW32_STAT_MUTEXES_LIVE);
+          PTW32_STATS_INC(PTW32_STAT_MUTEX_HANDLES);
+        }
     }
 
   *mutex = mx;
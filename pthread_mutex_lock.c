@@ -40,12 +40,40 @@
 #include "pthread.h"
 #include "implement.h"
 
+
+static INLINE DWORD
+ptw32_mutex_block (pthread_mutex_t * mutex, ptw32_hook_state_t * hook)
+     /*
+      * ------------------------------------------------------
+      * DESCRIPTION
+      *      Block until the mutex's event is set, updating the
+      *      counters and calling any wait hooks around the wait.
+      *
+      * RESULTS
+      *      The WaitForSingleObject result.
+      * ------------------------------------------------------
+      */
+{
+  pthread_mutex_t mx = *mutex;
+  DWORD status;
+
+  PTW32_STATS_INC(PTW32_STAT_MUTEX_WAITS);
+  PTW32_HOOK_BEFORE(*hook, PTW32_WAIT_MUTEX, mutex);
+  status = WaitForSingleObject (mx->event, INFINITE);
+  PTW32_HOOK_AFTER(*hook, PTW32_WAIT_MUTEX, mutex, mx->wakerThread,
+		   status == WAIT_OBJECT_0 ? 0 : EINVAL);
+
+  return status;
+}
+
+
 int
 pthread_mutex_lock (pthread_mutex_t * mutex)
 {
   int kind;
   pthread_mutex_t mx;
   int result = 0;
+  ULONGLONG traced = PTW32_LOCKTRACE_BEGIN();
 
   /*
    * Let the system deal with invalid pointers.
@@ -72,26 +100,43 @@ pthread_mutex_lock (pthread_mutex_t * mutex)
   mx = *mutex;
   kind = mx->kind;
 
-  if (kind >= 0)
+  if (!PTW32_MUTEX_KIND_ROBUST(kind))
     {
       /* Non-robust */
       if (PTHREAD_MUTEX_NORMAL == kind)
         {
-          if ((LONG) PTW32_INTERLOCKED_EXCHANGE(
+          LONG old;
+
+          /*
+           * If we overwrite -1 (waiters) with 1 any lock we then take
+           * must be taken with -1, so that unlock wakes a waiter.
+           */
+          if ((old = (LONG) PTW32_INTERLOCKED_EXCHANGE(
 		       (LPLONG) &mx->lock_idx,
-		       (LONG) 1) != 0)
+		       (LONG) 1)) != 0
+	      && !PTW32_SPIN_ACQUIRE(&mx->lock_idx, (old < 0) ? -1 : 1))
 	    {
+	      ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+
+	      PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_BEGIN, mx, 0);
 	      while ((LONG) PTW32_INTERLOCKED_EXCHANGE(
                               (LPLONG) &mx->lock_idx,
 			      (LONG) -1) != 0)
 	        {
-	          if (WAIT_OBJECT_0 != WaitForSingleObject (mx->event, INFINITE))
+	          if (WAIT_OBJECT_0 != ptw32_mutex_block (mutex, &hook))
 	            {
 	              result = EINVAL;
 		      break;
 	            }
 	        }
+	      PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_END, mx, result);
+	      PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_MUTEX, mutex, mx->wakerThread, result);
 	    }
+	  PTW32_WATCH_OWNER(mx);
+        }
+      else if (PTHREAD_MUTEX_COHORT_NP == kind)
+        {
+          result = ptw32_cohort_lock (mutex, NULL);
         }
       else
         {
@@ -118,18 +163,28 @@ pthread_mutex_lock (pthread_mutex_t * mutex)
 		      result = EDEADLK;
 		    }
 	        }
+	      else if (PTW32_SPIN_ACQUIRE(&mx->lock_idx, 1))
+	        {
+		  mx->recursive_count = 1;
+		  mx->ownerThread = self;
+	        }
 	      else
 	        {
+	          ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+
+	          PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_BEGIN, mx, 0);
 	          while ((LONG) PTW32_INTERLOCKED_EXCHANGE(
                                   (LPLONG) &mx->lock_idx,
 			          (LONG) -1) != 0)
 		    {
-	              if (WAIT_OBJECT_0 != WaitForSingleObject (mx->event, INFINITE))
+	              if (WAIT_OBJECT_0 != ptw32_mutex_block (mutex, &hook))
 		        {
 	                  result = EINVAL;
 		          break;
 		        }
 		    }
+	          PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_END, mx, result);
+	          PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_MUTEX, mutex, mx->wakerThread, result);
 
 	          if (0 == result)
 		    {
@@ -167,12 +222,15 @@ pthread_mutex_lock (pthread_mutex_t * mutex)
                            (LPLONG) &mx->lock_idx,
                            (LONG) 1) != 0)
                 {
+                  ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+
+                  PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_BEGIN, mx, 0);
                   while (0 == (result = ptw32_robust_mutex_inherit(mutex))
                            && (LONG) PTW32_INTERLOCKED_EXCHANGE(
                                        (LPLONG) &mx->lock_idx,
                                        (LONG) -1) != 0)
                     {
-                      if (WAIT_OBJECT_0 != WaitForSingleObject (mx->event, INFINITE))
+                      if (WAIT_OBJECT_0 != ptw32_mutex_block (mutex, &hook))
                         {
                           result = EINVAL;
                           break;
@@ -188,6 +246,8 @@ pthread_mutex_lock (pthread_mutex_t * mutex)
                           break;
                         }
                     }
+                  PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_END, mx, result);
+                  PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_MUTEX, mutex, mx->wakerThread, result);
                 }
               if (0 == result || EOWNERDEAD == result)
                 {
@@ -227,12 +287,15 @@ pthread_mutex_lock (pthread_mutex_t * mutex)
                     }
                   else
                     {
+                      ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+
+                      PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_BEGIN, mx, 0);
                       while (0 == (result = ptw32_robust_mutex_inherit(mutex))
                                && (LONG) PTW32_INTERLOCKED_EXCHANGE(
                                            (LPLONG) &mx->lock_idx,
                                            (LONG) -1) != 0)
                         {
-                          if (WAIT_OBJECT_0 != WaitForSingleObject (mx->event, INFINITE))
+                          if (WAIT_OBJECT_0 != ptw32_mutex_block (mutex, &hook))
                             {
                               result = EINVAL;
                               break;
@@ -248,6 +311,8 @@ pthread_mutex_lock (pthread_mutex_t * mutex)
                               break;
                             }
                         }
+                      PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_END, mx, result);
+                      PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_MUTEX, mutex, mx->wakerThread, result);
 
                       if (0 == result || EOWNERDEAD == result)
                         {
@@ -264,6 +329,8 @@ pthread_mutex_lock (pthread_mutex_t * mutex)
         }
     }
 
+  PTW32_LOCKTRACE_ACQUIRED(traced, mx, PTW32_LOCKTRACE_LOCK, result);
+
   return (result);
 }
 
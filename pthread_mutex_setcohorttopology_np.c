@@ -0,0 +1,93 @@
+/*
+ * pthread_mutex_setcohorttopology_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_mutex_setcohorttopology_np (int nodes, ptw32_cohort_node_fn_t nodeOf)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Overrides the processor topology used by mutexes of
+      *      type PTHREAD_MUTEX_COHORT_NP.
+      *
+      * PARAMETERS
+      *      nodes
+      *              number of nodes, from 1 to 64, or 0 to return
+      *              to the system topology.
+      *
+      *      nodeOf
+      *              function returning the calling thread's node,
+      *              or NULL if nodes is 0.
+      *
+      * DESCRIPTION
+      *      By default a cohort mutex groups threads by the NUMA
+      *      node of the processor they are running on. This lets
+      *      an application (or a test on a single node machine)
+      *      supply its own grouping instead. nodeOf is called on
+      *      every lock and trylock; its result is taken modulo
+      *      nodes.
+      *
+      *      Only mutexes initialised after the call are affected.
+      *      The call should not be made while other threads may
+      *      be initialising cohort mutexes.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          invalid arguments.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (nodes == 0 && nodeOf == NULL)
+    {
+      ptw32_cohort_fake_node_of = NULL;
+      ptw32_cohort_fake_nodes = 0;
+      return 0;
+    }
+
+  if (nodes < 1 || nodes > PTW32_COHORT_MAX_NODES || nodeOf == NULL)
+    {
+      return EINVAL;
+    }
+
+  ptw32_cohort_fake_nodes = nodes;
+  ptw32_cohort_fake_node_of = nodeOf;
+
+  return 0;
+}
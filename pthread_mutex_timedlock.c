@@ -39,12 +39,14 @@
 
 
 static INLINE int
-ptw32_timed_eventwait (HANDLE event, const struct timespec *abstime)
+ptw32_timed_eventwait (pthread_mutex_t * mutex, const struct timespec *abstime,
+		       ptw32_hook_state_t * hook)
      /*
       * ------------------------------------------------------
       * DESCRIPTION
-      *      This function waits on an event until signaled or until
-      *      abstime passes.
+      *      This function waits on the mutex's event until signaled
+      *      or until abstime passes, calling any wait hooks around
+      *      the wait.
       *      If abstime has passed when this routine is called then
       *      it returns a result to indicate this.
       *
@@ -57,14 +59,16 @@ ptw32_timed_eventwait (HANDLE event, const struct timespec *abstime)
       * RESULTS
       *              0               successfully signaled,
       *              ETIMEDOUT       abstime passed
-      *              EINVAL          'event' is not a valid event,
+      *              EINVAL          the mutex has no valid event,
       *
       * ------------------------------------------------------
       */
 {
 
+  pthread_mutex_t mx = *mutex;
   DWORD milliseconds;
   DWORD status;
+  HANDLE event = mx->event;
 
   if (event == NULL)
     {
@@ -84,18 +88,28 @@ ptw32_timed_eventwait (HANDLE event, const struct timespec *abstime)
 	  milliseconds = ptw32_relmillisecs (abstime);
 	}
 
+      PTW32_STATS_INC(PTW32_STAT_MUTEX_WAITS);
+      PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_BEGIN, mx, 0);
+      PTW32_HOOK_BEFORE(*hook, PTW32_WAIT_MUTEX, mutex);
       status = WaitForSingleObject (event, milliseconds);
 
       if (status == WAIT_OBJECT_0)
 	{
+	  PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_END, mx, 0);
+	  PTW32_HOOK_AFTER(*hook, PTW32_WAIT_MUTEX, mutex, mx->wakerThread, 0);
 	  return 0;
 	}
       else if (status == WAIT_TIMEOUT)
 	{
+	  PTW32_STATS_INC(PTW32_STAT_MUTEX_TIMEOUTS);
+	  PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_END, mx, ETIMEDOUT);
+	  PTW32_HOOK_AFTER(*hook, PTW32_WAIT_MUTEX, mutex, 0, ETIMEDOUT);
 	  return ETIMEDOUT;
 	}
       else
 	{
+	  PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_END, mx, EINVAL);
+	  PTW32_HOOK_AFTER(*hook, PTW32_WAIT_MUTEX, mutex, 0, EINVAL);
 	  return EINVAL;
 	}
     }
@@ -112,6 +126,8 @@ pthread_mutex_timedlock (pthread_mutex_t * mutex,
   pthread_mutex_t mx;
   int kind;
   int result = 0;
+  ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+  ULONGLONG traced = PTW32_LOCKTRACE_BEGIN();
 
   /*
    * Let the system deal with invalid pointers.
@@ -134,24 +150,35 @@ pthread_mutex_timedlock (pthread_mutex_t * mutex,
   mx = *mutex;
   kind = mx->kind;
 
-  if (kind >= 0)
+  if (!PTW32_MUTEX_KIND_ROBUST(kind))
     {
       if (mx->kind == PTHREAD_MUTEX_NORMAL)
         {
-          if ((LONG) PTW32_INTERLOCKED_EXCHANGE(
+          LONG old;
+
+          /* See pthread_mutex_lock() */
+          if ((old = (LONG) PTW32_INTERLOCKED_EXCHANGE(
 		       (LPLONG) &mx->lock_idx,
-		       (LONG) 1) != 0)
+		       (LONG) 1)) != 0
+	      && !PTW32_SPIN_ACQUIRE(&mx->lock_idx, (old < 0) ? -1 : 1))
 	    {
               while ((LONG) PTW32_INTERLOCKED_EXCHANGE(
                               (LPLONG) &mx->lock_idx,
 			      (LONG) -1) != 0)
                 {
-	          if (0 != (result = ptw32_timed_eventwait (mx->event, abstime)))
+	          if (0 != (result = ptw32_timed_eventwait (mutex, abstime, &hook)))
 		    {
 		      return result;
 		    }
 	        }
 	    }
+	  PTW32_WATCH_OWNER(mx);
+        }
+      else if (PTHREAD_MUTEX_COHORT_NP == kind)
+        {
+          result = ptw32_cohort_lock (mutex, abstime);
+          PTW32_LOCKTRACE_ACQUIRED(traced, mx, PTW32_LOCKTRACE_LOCK, result);
+          return result;
         }
       else
         {
@@ -178,13 +205,18 @@ pthread_mutex_timedlock (pthread_mutex_t * mutex,
 		      return EDEADLK;
 		    }
 	        }
+	      else if (PTW32_SPIN_ACQUIRE(&mx->lock_idx, 1))
+	        {
+	          mx->recursive_count = 1;
+	          mx->ownerThread = self;
+	        }
 	      else
 	        {
                   while ((LONG) PTW32_INTERLOCKED_EXCHANGE(
                                   (LPLONG) &mx->lock_idx,
 			          (LONG) -1) != 0)
                     {
-		      if (0 != (result = ptw32_timed_eventwait (mx->event, abstime)))
+		      if (0 != (result = ptw32_timed_eventwait (mutex, abstime, &hook)))
 		        {
 		          return result;
 		        }
@@ -228,7 +260,7 @@ pthread_mutex_timedlock (pthread_mutex_t * mutex,
                                   (LPLONG) &mx->lock_idx,
 			          (LONG) -1) != 0)
                     {
-	              if (0 != (result = ptw32_timed_eventwait (mx->event, abstime)))
+	              if (0 != (result = ptw32_timed_eventwait (mutex, abstime, &hook)))
 		        {
 		          return result;
 		        }
@@ -290,7 +322,7 @@ pthread_mutex_timedlock (pthread_mutex_t * mutex,
                                           (LPLONG) &mx->lock_idx,
 			                  (LONG) -1) != 0)
                         {
-		          if (0 != (result = ptw32_timed_eventwait (mx->event, abstime)))
+		          if (0 != (result = ptw32_timed_eventwait (mutex, abstime, &hook)))
 		            {
 		              return result;
 		            }
@@ -320,5 +352,8 @@ pthread_mutex_timedlock (pthread_mutex_t * mutex,
         }
     }
 
+  PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_MUTEX, mutex, mx->wakerThread, result);
+  PTW32_LOCKTRACE_ACQUIRED(traced, mx, PTW32_LOCKTRACE_LOCK, result);
+
   return result;
 }
@@ -44,6 +44,7 @@ pthread_mutex_trylock (pthread_mutex_t * mutex)
   pthread_mutex_t mx;
   int kind;
   int result = 0;
+  ULONGLONG traced = PTW32_LOCKTRACE_BEGIN();
 
   /*
    * Let the system deal with invalid pointers.
@@ -66,7 +67,11 @@ pthread_mutex_trylock (pthread_mutex_t * mutex)
   mx = *mutex;
   kind = mx->kind;
 
-  if (kind >= 0)
+  if (PTHREAD_MUTEX_COHORT_NP == kind)
+    {
+      result = ptw32_cohort_trylock (mutex);
+    }
+  else if (!PTW32_MUTEX_KIND_ROBUST(kind))
     {
       /* Non-robust */
       if (0 == (LONG) PTW32_INTERLOCKED_COMPARE_EXCHANGE (
@@ -79,6 +84,10 @@ pthread_mutex_trylock (pthread_mutex_t * mutex)
 	      mx->recursive_count = 1;
 	      mx->ownerThread = pthread_self ();
 	    }
+          else
+	    {
+	      PTW32_WATCH_OWNER(mx);
+	    }
         }
       else
         {
@@ -150,5 +159,7 @@ pthread_mutex_trylock (pthread_mutex_t * mutex)
         }
     }
 
+  PTW32_LOCKTRACE_ACQUIRED(traced, mx, PTW32_LOCKTRACE_TRYLOCK, result);
+
   return (result);
 }
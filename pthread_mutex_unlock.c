@@ -58,14 +58,17 @@ pthread_mutex_unlock (pthread_mutex_t * mutex)
    */
   if (mx < PTHREAD_ERRORCHECK_MUTEX_INITIALIZER)
     {
+      PTW32_LOCKTRACE_RELEASE(mx);
+
       kind = mx->kind;
 
-      if (kind >= 0)
+      if (!PTW32_MUTEX_KIND_ROBUST(kind))
         {
           if (kind == PTHREAD_MUTEX_NORMAL)
 	    {
 	      LONG idx;
 
+	      PTW32_WATCH_DISOWN(mx);
 	      idx = (LONG) PTW32_INTERLOCKED_EXCHANGE ((LPLONG) &mx->lock_idx,
 						       (LONG) 0);
 	      if (idx != 0)
@@ -75,6 +78,7 @@ pthread_mutex_unlock (pthread_mutex_t * mutex)
 		      /*
 		       * Someone may be waiting on that mutex.
 		       */
+		      mx->wakerThread = GetCurrentThreadId ();
 		      if (SetEvent (mx->event) == 0)
 		        {
 		          result = EINVAL;
@@ -82,6 +86,10 @@ pthread_mutex_unlock (pthread_mutex_t * mutex)
 		    }
 	        }
 	    }
+          else if (kind == PTHREAD_MUTEX_COHORT_NP)
+	    {
+	      result = ptw32_cohort_unlock (mutex);
+	    }
           else
 	    {
 	      if (pthread_equal (mx->ownerThread, pthread_self()))
@@ -95,6 +103,7 @@ pthread_mutex_unlock (pthread_mutex_t * mutex)
 							     (LONG) 0) < 0)
 		        {
 		          /* Someone may be waiting on that mutex */
+		          mx->wakerThread = GetCurrentThreadId ();
 		          if (SetEvent (mx->event) == 0)
 			    {
 			      result = EINVAL;
@@ -133,6 +142,7 @@ pthread_mutex_unlock (pthread_mutex_t * mutex)
                       /*
                        * Someone may be waiting on that mutex.
                        */
+                      mx->wakerThread = GetCurrentThreadId ();
                       if (SetEvent (mx->event) == 0)
                         {
                           result = EINVAL;
@@ -152,6 +162,7 @@ pthread_mutex_unlock (pthread_mutex_t * mutex)
                           /*
                            * Someone may be waiting on that mutex.
                            */
+                          mx->wakerThread = GetCurrentThreadId ();
                           if (SetEvent (mx->event) == 0)
                             {
                               result = EINVAL;
@@ -97,6 +97,8 @@ pthread_mutexattr_setrobust (pthread_mutexattr_t * attr, int robust)
       * RESULTS
       *              0               successfully set attribute,
       *              EINVAL          'attr' or 'robust' is invalid,
+      *              ENOTSUP         PTHREAD_MUTEX_ROBUST was requested from a
+      *                              library built with PTW32_NO_ROBUST,
       *
       * ------------------------------------------------------
       */
@@ -107,8 +109,12 @@ pthread_mutexattr_setrobust (pthread_mutexattr_t * attr, int robust)
     {
       switch (robust)
         {
-          case PTHREAD_MUTEX_STALLED:
           case PTHREAD_MUTEX_ROBUST:
+#if defined(PTW32_NO_ROBUST)
+            result = ENOTSUP;
+            break;
+#endif
+          case PTHREAD_MUTEX_STALLED:
 	    (*attr)->robustness = robust;
             result = 0;
             break;
@@ -64,6 +64,8 @@ pthread_mutexattr_settype (pthread_mutexattr_t * attr, int kind)
       *
       *                      PTHREAD_MUTEX_RECURSIVE
       *
+      *                      PTHREAD_MUTEX_COHORT_NP
+      *
       * DESCRIPTION
       * The pthread_mutexattr_settype() and
       * pthread_mutexattr_gettype() functions  respectively set and
@@ -111,6 +113,15 @@ pthread_mutexattr_settype (pthread_mutexattr_t * attr, int kind)
       *          process        shared         attribute         is
       *          PTHREAD_PROCESS_PRIVATE.
       *
+      * PTHREAD_MUTEX_COHORT_NP
+      *          Behaves as PTHREAD_MUTEX_NORMAL but hands the
+      *          mutex preferentially to waiters running on the
+      *          same NUMA node as the thread unlocking it, a
+      *          bounded number of times in a row, to reduce cache
+      *          line transfers between nodes. Cannot be combined
+      *          with PTHREAD_MUTEX_ROBUST. See
+      *          pthread_mutex_setcohorttopology_np().
+      *
       * RESULTS
       *              0               successfully set attribute,
       *              EINVAL          'attr' or 'type' is invalid,
@@ -127,6 +138,7 @@ pthread_mutexattr_settype (pthread_mutexattr_t * attr, int kind)
 	case PTHREAD_MUTEX_FAST_NP:
 	case PTHREAD_MUTEX_RECURSIVE_NP:
 	case PTHREAD_MUTEX_ERRORCHECK_NP:
+	case PTHREAD_MUTEX_COHORT_NP:
 	  (*attr)->kind = kind;
 	  break;
 	default:
@@ -0,0 +1,178 @@
+/*
+ * pthread_profile_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_profile_np (int rate)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Starts or stops sampling the call stacks of blocking
+      *      waits.
+      *
+      * PARAMETERS
+      *      rate
+      *              sample 1 in 'rate' blocking waits on each
+      *              thread, or 0 to stop sampling
+      *
+      * DESCRIPTION
+      *      While sampling, each thread records the call stack of
+      *      1 in 'rate' of the waits in which it blocks in a
+      *      mutex, rwlock, condition variable, semaphore, barrier
+      *      or join, or in which it starts to yield in a spin
+      *      lock, together with the time it waits. Samples are
+      *      summed per call stack and type of wait; see
+      *      pthread_profile_get_np() and pthread_profile_dump_np().
+      *
+      *      The rate may be changed at any time. Stopping keeps
+      *      what has been collected. Waits that don't block cost
+      *      nothing, and waits that block but aren't sampled cost
+      *      a per-thread countdown.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          'rate' is negative.
+      *
+      * ------------------------------------------------------
+      */
+{
+  return ptw32_profile_start (rate);
+}
+
+
+int
+pthread_profile_get_np (struct ptw32_profile_site * sites, int * count)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Copies out the call sites sampled so far.
+      *
+      * PARAMETERS
+      *      sites
+      *              array to copy into, may be NULL if *count is 0
+      *
+      *      count
+      *              in: the size of 'sites'; out: the number of
+      *              sites copied, or the number there are if that
+      *              is more
+      *
+      * DESCRIPTION
+      *      Sites come in no particular order. There are never
+      *      more than PTW32_PROFILE_SITES + 1; the extra one, of
+      *      type 0, collects samples for which the table had no
+      *      room. Times are totals over the samples, so about
+      *      1 / rate of the time actually waited.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          'count' is NULL or invalid,
+      *              ERANGE          there are more than *count sites;
+      *                              the first *count were copied.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int n;
+
+  if (count == NULL || *count < 0 || (sites == NULL && *count > 0))
+    {
+      return EINVAL;
+    }
+
+  n = ptw32_profile_snapshot (sites, *count);
+
+  if (n > *count)
+    {
+      *count = n;
+      return ERANGE;
+    }
+
+  *count = n;
+
+  return 0;
+}
+
+
+int
+pthread_profile_reset_np (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Discards the call sites sampled so far. Sampling
+      *      carries on at the same rate.
+      *
+      * RESULTS
+      *              0               success.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_profile_reset ();
+
+  return 0;
+}
+
+
+int
+pthread_profile_dump_np (const char * path)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Writes the call sites sampled so far to a file.
+      *
+      * PARAMETERS
+      *      path
+      *              name of the file to create or overwrite, or
+      *              NULL to write to the debugger
+      *
+      * DESCRIPTION
+      *      Writes one line of text per site, most time waited
+      *      first, in the format described in README.NONPORTABLE.
+      *      Return addresses are written as module+offset.
+      *
+      * RESULTS
+      *              0               success,
+      *              EIO             the file couldn't be created,
+      *              ENOMEM          no memory to sort the sites.
+      *
+      * ------------------------------------------------------
+      */
+{
+  return ptw32_profile_write (path, ptw32_profile_rate);
+}
@@ -0,0 +1,212 @@
+/*
+ * pthread_recv_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+/*
+ * Moves everything senders have pushed onto the owner's private list,
+ * reversing it so that the oldest message comes out first.
+ */
+static struct ptw32_msg *
+ptw32_mailbox_take (ptw32_thread_t * tp)
+{
+  struct ptw32_msg * list;
+  struct ptw32_msg * next;
+  struct ptw32_msg * fifo = NULL;
+
+  if (tp->mailLocal == NULL && tp->mailHead != NULL)
+    {
+      list = (struct ptw32_msg *) (size_t)
+	PTW32_INTERLOCKED_EXCHANGE_PTR((PVOID volatile *)&tp->mailHead, NULL);
+
+      while (list != NULL)
+	{
+	  next = list->next;
+	  list->next = fifo;
+	  fifo = list;
+	  list = next;
+	}
+
+      tp->mailLocal = fifo;
+    }
+
+  return tp->mailLocal;
+}
+
+static void PTW32_CDECL
+ptw32_mailbox_unpark (void * arg)
+{
+  ptw32_thread_t * tp = (ptw32_thread_t *) arg;
+
+  /*
+   * A sender that cleared mailWaiting first has set, or is about
+   * to set, the event; consume it so the next park doesn't return
+   * early.
+   */
+  if (PTW32_INTERLOCKED_EXCHANGE((LPLONG)&tp->mailWaiting, 0L) == 0)
+    {
+      (void) WaitForSingleObject (tp->mailEvent, INFINITE);
+    }
+}
+
+
+int
+pthread_recv_np (struct ptw32_msg ** msg, const struct timespec * abstime)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function takes the oldest message from the
+      *      calling thread's mailbox, waiting for one if need be.
+      *
+      * PARAMETERS
+      *      msg
+      *              receives the message
+      *
+      *      abstime
+      *              latest time to wait until, or NULL to wait
+      *              for as long as it takes
+      *
+      * DESCRIPTION
+      *      This function takes the oldest message sent to the
+      *      calling thread by pthread_send_np(). Only the owner
+      *      receives, so taking a message costs no interlocked
+      *      operation unless the private list is empty, when one
+      *      exchange takes every message queued so far.
+      *
+      *      An empty mailbox is polled for the wait policy's spin
+      *      budget (see pthread_setwaitpolicy_np()) before the
+      *      thread parks on its mailbox event, which is created on
+      *      first use.
+      *
+      *      This function is a cancellation point and, like
+      *      pthread_join(), returns EINTR if the thread is
+      *      interrupted (see pthread_interrupt_np()).
+      *
+      * RESULTS
+      *              0               *msg is the message,
+      *              EINVAL          'msg' is NULL,
+      *              ETIMEDOUT       'abstime' passed with no message,
+      *              EINTR           the wait was interrupted,
+      *              ENOMEM          the mailbox event could not be
+      *                              created.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_thread_t * tp;
+  struct ptw32_msg * m;
+  int result = 0;
+  int i;
+
+  if (msg == NULL)
+    {
+      return EINVAL;
+    }
+
+  PTW32_TESTCANCEL();
+
+  tp = (ptw32_thread_t *) pthread_self ().p;
+
+  if (tp == NULL)
+    {
+      return ENOMEM;
+    }
+
+  m = ptw32_mailbox_take (tp);
+
+  if (m == NULL && ptw32_wait_spinning)
+    {
+      for (i = 0; i < ptw32_wait_policy.spinCount && tp->mailHead == NULL; i++)
+	{
+	  PTW32_PAUSE ();
+	}
+      m = ptw32_mailbox_take (tp);
+    }
+
+  if (m == NULL && tp->mailEvent == NULL)
+    {
+      HANDLE ev = CreateEvent (NULL, PTW32_FALSE, PTW32_FALSE, NULL);
+      ptw32_mcs_local_node_t node;
+
+      if (ev == NULL)
+	{
+	  return ENOMEM;
+	}
+
+      PTW32_STATS_INC(PTW32_STAT_THREAD_HANDLES);
+
+      /* Senders read mailEvent under this lock. */
+      ptw32_mcs_lock_acquire(&ptw32_thread_reuse_lock, &node);
+      tp->mailEvent = ev;
+      ptw32_mcs_lock_release(&node);
+    }
+
+  while (m == NULL && result == 0)
+    {
+      DWORD ms = (abstime == NULL) ? INFINITE : ptw32_relmillisecs (abstime);
+
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&tp->mailWaiting, 1L);
+
+      if (tp->mailHead != NULL)
+	{
+	  /* A message slipped in before we were seen to be parked. */
+	  if (PTW32_INTERLOCKED_EXCHANGE((LPLONG)&tp->mailWaiting, 0L) == 0)
+	    {
+	      (void) WaitForSingleObject (tp->mailEvent, INFINITE);
+	    }
+	}
+      else
+	{
+	  PTW32_CANCEL_CLEANUP_PUSH(ptw32_mailbox_unpark, tp);
+	  result = pthreadCancelableTimedWait (tp->mailEvent, ms);
+	  PTW32_CANCEL_CLEANUP_POP(result);
+	}
+
+      m = ptw32_mailbox_take (tp);
+    }
+
+  if (m != NULL)
+    {
+      tp->mailLocal = m->next;
+      m->next = NULL;
+      *msg = m;
+      result = 0;
+    }
+
+  return result;
+}
@@ -104,6 +104,8 @@ pthread_rwlock_destroy (pthread_rwlock_t * rwlock)
 	  result1 = pthread_mutex_destroy (&(rwl->mtxSharedAccessCompleted));
 	  result2 = pthread_mutex_destroy (&(rwl->mtxExclusiveAccess));
 	  (void) free (rwl);
+
+	  PTW32_STATS_DEC(PTW32_STAT_RWLOCKS_LIVE);
 	}
     }
   else
@@ -89,6 +89,8 @@ pthread_rwlock_init (pthread_rwlock_t * rwlock,
 
   rwl->nMagic = PTW32_RWLOCK_MAGIC;
 
+  PTW32_STATS_INC(PTW32_STAT_RWLOCKS_LIVE);
+
   result = 0;
   goto DONE;
 
@@ -74,8 +74,19 @@ pthread_rwlock_timedrdlock (pthread_rwlock_t * rwlock,
       return EINVAL;
     }
 
-  if ((result =
-       pthread_mutex_timedlock (&(rwl->mtxExclusiveAccess), abstime)) != 0)
+  /*
+   * Try first so that only a blocked acquire is traced.
+   */
+  if ((result = pthread_mutex_trylock (&(rwl->mtxExclusiveAccess))) == EBUSY)
+    {
+      PTW32_WATCH_ENTER(rwlock);
+      PTW32_TRACE_EVENT(PTW32_TRACE_RWLOCK_RDWAIT_BEGIN, rwl, 0);
+      result = pthread_mutex_timedlock (&(rwl->mtxExclusiveAccess), abstime);
+      PTW32_TRACE_EVENT(PTW32_TRACE_RWLOCK_RDWAIT_END, rwl, result);
+      PTW32_WATCH_LEAVE();
+    }
+
+  if (result != 0)
     {
       return result;
     }
@@ -74,8 +74,19 @@ pthread_rwlock_timedwrlock (pthread_rwlock_t * rwlock,
       return EINVAL;
     }
 
-  if ((result =
-       pthread_mutex_timedlock (&(rwl->mtxExclusiveAccess), abstime)) != 0)
+  /*
+   * Try first so that only a blocked acquire is traced.
+   */
+  if ((result = pthread_mutex_trylock (&(rwl->mtxExclusiveAccess))) == EBUSY)
+    {
+      PTW32_WATCH_ENTER(rwlock);
+      PTW32_TRACE_EVENT(PTW32_TRACE_RWLOCK_WRWAIT_BEGIN, rwl, 0);
+      result = pthread_mutex_timedlock (&(rwl->mtxExclusiveAccess), abstime);
+      PTW32_TRACE_EVENT(PTW32_TRACE_RWLOCK_WRWAIT_END, rwl, result);
+      PTW32_WATCH_LEAVE();
+    }
+
+  if (result != 0)
     {
       return result;
     }
@@ -107,7 +118,10 @@ pthread_rwlock_timedwrlock (pthread_rwlock_t * rwlock,
 #if defined(_MSC_VER) && _MSC_VER < 800
 #pragma inline_depth(0)
 #endif
-	  pthread_cleanup_push (ptw32_rwlock_cancelwrwait, (void *) rwl);
+	  PTW32_CANCEL_CLEANUP_PUSH (ptw32_rwlock_cancelwrwait, (void *) rwl);
+
+	  PTW32_WATCH_ENTER(rwlock);
+	  PTW32_TRACE_EVENT(PTW32_TRACE_RWLOCK_WRWAIT_BEGIN, rwl, 0);
 
 	  do
 	    {
@@ -118,7 +132,10 @@ pthread_rwlock_timedwrlock (pthread_rwlock_t * rwlock,
 	    }
 	  while (result == 0 && rwl->nCompletedSharedAccessCount < 0);
 
-	  pthread_cleanup_pop ((result != 0) ? 1 : 0);
+	  PTW32_TRACE_EVENT(PTW32_TRACE_RWLOCK_WRWAIT_END, rwl, result);
+	  PTW32_WATCH_LEAVE();
+
+	  PTW32_CANCEL_CLEANUP_POP ((result != 0) ? 1 : 0);
 #if defined(_MSC_VER) && _MSC_VER < 800
 #pragma inline_depth()
 #endif
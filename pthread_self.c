@@ -125,6 +125,8 @@ pthread_self (void)
 	       */
 	      return nil;
 	    }
+
+	  PTW32_STATS_INC(PTW32_STAT_THREAD_HANDLES);
 #endif
 
 	  /*
@@ -133,6 +135,8 @@ pthread_self (void)
 	   */
 	  sp->sched_priority = GetThreadPriority (sp->threadH);
 	  pthread_setspecific (ptw32_selfThreadKey, (void *) sp);
+
+	  PTW32_STATS_INC(PTW32_STAT_IMPLICIT_THREADS);
 	}
     }
 
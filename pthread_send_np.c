@@ -0,0 +1,129 @@
+/*
+ * pthread_send_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_send_np (pthread_t thread, struct ptw32_msg * msg)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function queues 'msg' on the mailbox of 'thread'.
+      *
+      * PARAMETERS
+      *      thread
+      *              a running thread
+      *
+      *      msg
+      *              the message, which must not be queued
+      *              already; it belongs to the receiver from now on
+      *
+      * DESCRIPTION
+      *      This function queues 'msg' on the mailbox of 'thread',
+      *      for pthread_recv_np(). Any number of threads may send
+      *      to one mailbox at once. The send is lock-free: one
+      *      interlocked compare-exchange, plus a SetEvent() if the
+      *      receiver is parked. Messages from one sender are
+      *      received in the order they were sent.
+      *
+      *      As for pthread_kill(), 'thread' must not have been
+      *      joined or detached and exited; messages still queued
+      *      when a thread ends are dropped. A message sent to a
+      *      thread that is being joined, or is exiting detached,
+      *      may be dropped or delivered to a later thread that
+      *      reuses the thread's descriptor.
+      *
+      * RESULTS
+      *              0               the message has been queued,
+      *              EINVAL          'msg' is NULL,
+      *              ESRCH           'thread' is not a valid thread.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_thread_t * tp = (ptw32_thread_t *) thread.p;
+  struct ptw32_msg * head;
+
+  if (msg == NULL)
+    {
+      return EINVAL;
+    }
+
+  /*
+   * Not under ptw32_thread_reuse_lock, which would serialise all
+   * senders, so the push below can land after the descriptor has
+   * been wiped for reuse. ptw32_new() empties the mailbox of a
+   * reused descriptor, which drops such a message; one pushed after
+   * that is received by the thread that now owns the descriptor.
+   * Hence the pthread_kill() precondition above.
+   */
+  if (tp == NULL || thread.x != tp->ptHandle.x || tp->threadH == NULL)
+    {
+      return ESRCH;
+    }
+
+  do
+    {
+      head = tp->mailHead;
+      msg->next = head;
+    }
+  while ((PVOID) PTW32_INTERLOCKED_COMPARE_EXCHANGE_PTR((PVOID volatile *)&tp->mailHead,
+							(PVOID) msg,
+							(PVOID) head) != (PVOID) head);
+
+  /*
+   * The exchange above is a full barrier, so either the receiver
+   * sees the message before it parks or we see it parked. Whoever
+   * clears mailWaiting owns the wakeup, which is made under the
+   * reuse lock so that the event cannot be closed under us.
+   */
+  if (tp->mailWaiting
+      && PTW32_INTERLOCKED_EXCHANGE((LPLONG)&tp->mailWaiting, 0L) != 0)
+    {
+      ptw32_mcs_local_node_t node;
+
+      ptw32_mcs_lock_acquire(&ptw32_thread_reuse_lock, &node);
+      if (thread.x == tp->ptHandle.x && tp->mailEvent != NULL)
+	{
+	  (void) SetEvent (tp->mailEvent);
+	}
+      ptw32_mcs_lock_release(&node);
+    }
+
+  return 0;
+}
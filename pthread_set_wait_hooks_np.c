@@ -0,0 +1,105 @@
+/*
+ * pthread_set_wait_hooks_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_set_wait_hooks_np (const struct ptw32_wait_hooks * hooks)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Installs or removes callbacks that are made when a
+      *      thread blocks in a mutex, condition variable,
+      *      semaphore, barrier or join wait.
+      *
+      * PARAMETERS
+      *      hooks
+      *              pointer to the callbacks to install, any of
+      *              which may be NULL, or NULL to remove all.
+      *              The structure is copied.
+      *
+      * DESCRIPTION
+      *      beforeBlock is called just before the thread blocks,
+      *      afterWake when it wakes (with the time blocked and,
+      *      where known, the thread that woke it), and
+      *      acquiredAfterContention when a mutex or semaphore has
+      *      been obtained after blocking at least once (with the
+      *      time since the first block). None of them are called
+      *      if the thread doesn't block.
+      *
+      *      Callbacks run on the blocking thread with no library
+      *      locks held. They must not wait on the object being
+      *      reported. Replacing hooks while other threads are
+      *      blocked may result in those threads calling either
+      *      the old or the new callbacks, so old callbacks must
+      *      remain callable.
+      *
+      * RESULTS
+      *              0               success.
+      *
+      * ------------------------------------------------------
+      */
+{
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_wait_hooks_active, (LONG)PTW32_FALSE);
+
+  if (hooks == NULL)
+    {
+      ptw32_wait_hooks.beforeBlock = NULL;
+      ptw32_wait_hooks.afterWake = NULL;
+      ptw32_wait_hooks.acquiredAfterContention = NULL;
+    }
+  else
+    {
+      ptw32_wait_hooks = *hooks;
+    }
+
+  /*
+   * The watchdog (see pthread_watchdog_np()) and the contention
+   * profile (see pthread_profile_np()) rely on the hook calls too.
+   */
+  if (ptw32_wait_hooks.beforeBlock != NULL
+      || ptw32_wait_hooks.afterWake != NULL
+      || ptw32_wait_hooks.acquiredAfterContention != NULL
+      || ptw32_watchdog_active
+      || ptw32_profile_rate != 0)
+    {
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_wait_hooks_active, (LONG)PTW32_TRUE);
+    }
+
+  return 0;
+}
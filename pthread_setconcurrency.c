@@ -48,6 +48,7 @@ pthread_setconcurrency (int level)
   else
     {
       ptw32_concurrency = level;
+      ptw32_wait_policy_hint (level);
       return 0;
     }
 }
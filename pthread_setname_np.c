@@ -0,0 +1,179 @@
+/*
+ * pthread_setname_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_setname_np (pthread_t thread, const char * name)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function names 'thread' for debuggers, profilers
+      *      and trace dumps.
+      *
+      * PARAMETERS
+      *      thread
+      *              any thread
+      *
+      *      name
+      *              a NUL terminated UTF-8 string of at most
+      *              PTW32_THREAD_NAME_MAX - 1 bytes; "" removes
+      *              the name
+      *
+      * DESCRIPTION
+      *      This function names 'thread' for debuggers, profilers
+      *      and trace dumps. The name is kept with the thread,
+      *      where pthread_getname_np() reads it, and passed to
+      *      the system with SetThreadDescription() where it
+      *      exists, or to an attached debugger otherwise. The
+      *      system copy is not removed by "".
+      *
+      * RESULTS
+      *              0               successfully named the thread,
+      *              EINVAL          'name' is NULL,
+      *              ERANGE          'name' is too long,
+      *              ESRCH           'thread' is not a valid thread.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result;
+  ptw32_thread_t * tp = (ptw32_thread_t *) thread.p;
+  ptw32_mcs_local_node_t threadLock;
+  char copy[PTW32_THREAD_NAME_MAX];
+  HANDLE threadH;
+
+  if (name == NULL)
+    {
+      return EINVAL;
+    }
+
+  if (strlen (name) >= PTW32_THREAD_NAME_MAX)
+    {
+      return ERANGE;
+    }
+
+  /* Validate the thread id. */
+  result = pthread_kill (thread, 0);
+  if (0 != result)
+    {
+      return result;
+    }
+
+  (void) strcpy (copy, name);
+
+  ptw32_mcs_lock_acquire (&tp->threadLock, &threadLock);
+  (void) strcpy (tp->name, copy);
+  threadH = tp->threadH;
+  ptw32_mcs_lock_release (&threadLock);
+
+  if (copy[0] != '\0')
+    {
+      ptw32_thread_name_publish (threadH, tp->thread, copy);
+    }
+
+#if defined(PTW32_TRACE)
+  ptw32_trace_thread_name (tp->thread, copy);
+#endif
+
+  return 0;
+}
+
+
+int
+pthread_getname_np (pthread_t thread, char * name, size_t len)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function copies the name of 'thread' into 'name'.
+      *
+      * PARAMETERS
+      *      thread
+      *              any thread
+      *
+      *      name
+      *              buffer for the name, which is "" if the thread
+      *              has not been named
+      *
+      *      len
+      *              size of 'name'; PTW32_THREAD_NAME_MAX is always
+      *              enough
+      *
+      * RESULTS
+      *              0               successfully copied the name,
+      *              EINVAL          'name' is NULL,
+      *              ERANGE          'len' is too small for the name,
+      *              ESRCH           'thread' is not a valid thread.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result;
+  ptw32_thread_t * tp = (ptw32_thread_t *) thread.p;
+  ptw32_mcs_local_node_t threadLock;
+  size_t n;
+
+  if (name == NULL)
+    {
+      return EINVAL;
+    }
+
+  /* Validate the thread id. */
+  result = pthread_kill (thread, 0);
+  if (0 != result)
+    {
+      return result;
+    }
+
+  ptw32_mcs_lock_acquire (&tp->threadLock, &threadLock);
+
+  n = strlen (tp->name);
+
+  if (n < len)
+    {
+      memcpy (name, tp->name, n + 1);
+    }
+  else
+    {
+      result = ERANGE;
+    }
+
+  ptw32_mcs_lock_release (&threadLock);
+
+  return result;
+}
@@ -0,0 +1,133 @@
+/*
+ * pthread_setslack_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_setslack_np (pthread_t thread, unsigned long slackMillisecs)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function sets how late the timed waits of
+      *      'thread' may end.
+      *
+      * PARAMETERS
+      *      thread
+      *              any thread
+      *
+      *      slackMillisecs
+      *              milliseconds a timeout may be late by, or 0
+      *              for timeouts as precise as the system's
+      *
+      * DESCRIPTION
+      *      This function lets the timed waits of 'thread'
+      *      (pthread_cond_timedwait(), sem_timedwait(),
+      *      pthread_recv_np() and the like) end up to
+      *      'slackMillisecs' after their deadline. Each such
+      *      timeout is moved to the next boundary shared with
+      *      other waiters, on a waitable timer that the system
+      *      may fire later still, within the slack, together
+      *      with other timers (Windows 7 and later). Many idle
+      *      threads with housekeeping deadlines then wake the
+      *      processor a few times instead of once each.
+      *
+      *      Waits that are woken before their deadline are not
+      *      affected.
+      *
+      * RESULTS
+      *              0               the slack has been set,
+      *              EINVAL          'slackMillisecs' is INFINITE,
+      *              ESRCH           'thread' is not a valid thread.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result;
+
+  if (slackMillisecs >= (unsigned long) INFINITE)
+    {
+      return EINVAL;
+    }
+
+  /* Validate the thread id. */
+  result = pthread_kill (thread, 0);
+  if (0 != result)
+    {
+      return result;
+    }
+
+  ((ptw32_thread_t *) thread.p)->timerSlack = (DWORD) slackMillisecs;
+
+  return 0;
+}
+
+
+int
+pthread_getslack_np (pthread_t thread, unsigned long * slackMillisecs)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function returns the timer slack of 'thread'
+      *      (see pthread_setslack_np()).
+      *
+      * RESULTS
+      *              0               *slackMillisecs is the slack,
+      *              EINVAL          'slackMillisecs' is NULL,
+      *              ESRCH           'thread' is not a valid thread.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result;
+
+  if (slackMillisecs == NULL)
+    {
+      return EINVAL;
+    }
+
+  /* Validate the thread id. */
+  result = pthread_kill (thread, 0);
+  if (0 != result)
+    {
+      return result;
+    }
+
+  *slackMillisecs = (unsigned long) ((ptw32_thread_t *) thread.p)->timerSlack;
+
+  return 0;
+}
@@ -68,6 +68,12 @@ pthread_setspecific (pthread_key_t key, const void *value)
   pthread_t self;
   int result = 0;
 
+  if (key != NULL && key->size != 0)
+    {
+      /* See pthread_key_create_sized_np() */
+      return EINVAL;
+    }
+
   if (key != ptw32_selfThreadKey)
     {
       /*
@@ -0,0 +1,129 @@
+/*
+ * pthread_setwaitpolicy_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_setwaitpolicy_np (const struct ptw32_wait_policy * policy)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Sets how threads wait before blocking in mutexes,
+      *      semaphores, condition variables, barriers, spinlocks
+      *      and the library's internal locks.
+      *
+      * PARAMETERS
+      *      policy
+      *              the policy to use, which is copied, or NULL to
+      *              return to the default.
+      *
+      * DESCRIPTION
+      *      A thread that finds an object unavailable first polls
+      *      it up to spinCount times, then yields the processor
+      *      up to yieldCount times in the way yieldKind says, and
+      *      only then blocks. Spinlocks never block; they keep
+      *      yielding once spinCount is used up. sched_yield()
+      *      also uses yieldKind.
+      *
+      *      The default, also used after a NULL policy, is to
+      *      spin a little on multiprocessors (unless the
+      *      pthread_setconcurrency() level is 1), not to yield,
+      *      and to yield with Sleep(0). The PTW32_WAIT_POLICY
+      *      environment variable, read at process start, can
+      *      set the policy as e.g. "spin=200,yield=2,kind=switch".
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          a count is negative or
+      *                              yieldKind is unknown.
+      *
+      * ------------------------------------------------------
+      */
+{
+  struct ptw32_wait_policy copy;
+
+  if (policy == NULL)
+    {
+      ptw32_wait_policy_explicit = PTW32_FALSE;
+      ptw32_wait_policy_hint (ptw32_concurrency);
+      return 0;
+    }
+
+  copy = *policy;
+
+  if (copy.spinCount < 0 || copy.yieldCount < 0
+      || copy.yieldKind < PTW32_YIELD_SWITCH
+      || copy.yieldKind > PTW32_YIELD_SLEEP1)
+    {
+      return EINVAL;
+    }
+
+  ptw32_wait_policy_explicit = PTW32_TRUE;
+  ptw32_wait_policy_update (&copy);
+
+  return 0;
+}
+
+
+int
+pthread_getwaitpolicy_np (struct ptw32_wait_policy * policy)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Returns the wait policy in use.
+      *
+      * PARAMETERS
+      *      policy
+      *              receives a copy of the policy.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          'policy' is NULL.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (policy == NULL)
+    {
+      return EINVAL;
+    }
+
+  *policy = ptw32_wait_policy;
+
+  return 0;
+}
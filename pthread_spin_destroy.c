@@ -74,6 +74,7 @@ pthread_spin_destroy (pthread_spinlock_t * lock)
 	   */
 	  *lock = NULL;
 	  (void) free (s);
+	  PTW32_STATS_DEC(PTW32_STAT_SPINLOCKS_LIVE);
 	}
     }
   else
@@ -112,6 +112,7 @@ pthread_spin_init (pthread_spinlock_t * lock, int pshared)
   if (0 == result)
     {
       *lock = s;
+      PTW32_STATS_INC(PTW32_STAT_SPINLOCKS_LIVE);
     }
   else
     {
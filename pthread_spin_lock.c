@@ -42,6 +42,9 @@ int
 pthread_spin_lock (pthread_spinlock_t * lock)
 {
   register pthread_spinlock_t s;
+  int spins = 0;
+  int yielded = PTW32_FALSE;
+  ptw32_hook_state_t h = PTW32_HOOK_STATE_INITIALIZER;
 
   if (NULL == lock || NULL == *lock)
     {
@@ -68,10 +71,26 @@ pthread_spin_lock (pthread_spinlock_t * lock)
 					     (PTW32_INTERLOCKED_LONG)
 					     PTW32_SPIN_UNLOCKED))
     {
+      /* Busy-wait for the policy's spin budget, then yield. */
+      if (spins < ptw32_wait_policy.spinCount)
+	{
+	  spins++;
+	  PTW32_PAUSE ();
+	}
+      else
+	{
+	  if (!yielded)
+	    {
+	      yielded = PTW32_TRUE;
+	      PTW32_PROFILE_BEGIN(h, PTW32_WAIT_SPIN);
+	    }
+	  ptw32_yield ();
+	}
     }
 
   if (s->interlock == PTW32_SPIN_LOCKED)
     {
+      PTW32_PROFILE_END(h);
       return 0;
     }
   else if (s->interlock == PTW32_SPIN_USE_MUTEX)
@@ -0,0 +1,90 @@
+/*
+ * pthread_stats_export_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_stats_export_np (const char * name)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Publishes the library-wide counters in the named
+      *      shared memory section 'name', for monitoring tools
+      *      in other processes.
+      *
+      * PARAMETERS
+      *      name
+      *              the section name, e.g. "Local\myapp-stats"
+      *
+      * DESCRIPTION
+      *      The counters are moved into the section and updated
+      *      there from then on, so exporting costs nothing per
+      *      update and readers need no system call per sample:
+      *      they map the section read-only and sum the shards
+      *      described by its struct ptw32_stats_export header,
+      *      retrying while its sequence is odd or has changed.
+      *      pthread_getstats_np() still works.
+      *
+      *      Exporting lasts until the library detaches from the
+      *      process, which leaves the final values in the section
+      *      for readers that still have it open. Setting the
+      *      environment variable PTW32_STATS_EXPORT to a section
+      *      name exports from process attach, without calling
+      *      this function; an update made by another thread
+      *      while this function switches over may be lost.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          'name' is NULL or empty,
+      *              EBUSY           the counters are already
+      *                              exported,
+      *              EEXIST          another process has a section
+      *                              of that name,
+      *              EAGAIN          the section couldn't be created,
+      *              ENOMEM          the section couldn't be mapped.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (name == NULL || name[0] == '\0')
+    {
+      return EINVAL;
+    }
+
+  return ptw32_stats_export_start (name);
+}
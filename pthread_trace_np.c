@@ -0,0 +1,122 @@
+/*
+ * pthread_trace_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_trace_np (int enable)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Starts or stops recording of trace events.
+      *
+      * PARAMETERS
+      *      enable
+      *              non-zero to start recording, zero to stop.
+      *
+      * DESCRIPTION
+      *      Events already recorded are kept when recording
+      *      stops, and are written by pthread_trace_dump_np().
+      *
+      * RESULTS
+      *              0               success,
+      *              EAGAIN          no TLS slot was available for
+      *                              tracing at process attach,
+      *              ENOSYS          the library was built without
+      *                              PTW32_TRACE.
+      *
+      * ------------------------------------------------------
+      */
+{
+#if defined(PTW32_TRACE)
+  if (enable)
+    {
+      ptw32_trace_start ();
+
+      return ptw32_trace_enabled ? 0 : EAGAIN;
+    }
+
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_trace_enabled, (LONG)PTW32_FALSE);
+
+  return 0;
+#else
+  return ENOSYS;
+#endif
+}
+
+
+int
+pthread_trace_dump_np (const char * path)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Writes the recorded trace events to a file.
+      *
+      * PARAMETERS
+      *      path
+      *              name of the file to create or overwrite.
+      *
+      * DESCRIPTION
+      *      The last PTW32_TRACE_RING_SIZE events of every thread
+      *      that has recorded any are written in the binary format
+      *      described in README.NONPORTABLE. Recording is not
+      *      stopped. Use tools/trace2json to convert the file for
+      *      chrome://tracing.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          'path' is NULL,
+      *              EIO             the file couldn't be created,
+      *              ENOMEM          the file couldn't be mapped,
+      *              ENOSYS          the library was built without
+      *                              PTW32_TRACE.
+      *
+      * ------------------------------------------------------
+      */
+{
+#if defined(PTW32_TRACE)
+  if (path == NULL)
+    {
+      return EINVAL;
+    }
+
+  return ptw32_trace_write (path);
+#else
+  return ENOSYS;
+#endif
+}
@@ -0,0 +1,111 @@
+/*
+ * pthread_watchdog_np.c
+ *
+ * Description:
+ * This translation unit implements non-portable thread functions.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+pthread_watchdog_np (unsigned long thresholdMillisecs, ptw32_stall_hook_t report)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      Starts, reconfigures or stops a watchdog that reports
+      *      threads blocked in a library wait for longer than
+      *      'thresholdMillisecs'.
+      *
+      * PARAMETERS
+      *      thresholdMillisecs
+      *              how long a wait may block before it is
+      *              reported, or 0 to stop the watchdog.
+      *
+      *      report
+      *              callback to receive each report, or NULL to
+      *              write them with OutputDebugString.
+      *
+      * DESCRIPTION
+      *      While the watchdog runs, threads that block in a
+      *      mutex, condition variable, semaphore, barrier, rwlock
+      *      or join wait are put on a list with the time they
+      *      first blocked; threads that don't block are not
+      *      tracked. A library thread scans the list at half the
+      *      threshold (between 10 ms and 1 s) and reports each
+      *      wait that has gone on too long once, with the waiter,
+      *      the object and, for mutexes and joins, the Win32 id
+      *      of the thread holding the mutex or being joined.
+      *      PTHREAD_MUTEX_NORMAL mutexes record their owner only
+      *      while the watchdog runs, and cohort mutexes never do.
+      *
+      *      'report' runs on the watchdog thread with no library
+      *      locks held, and may not call this function. Replacing
+      *      it while the watchdog runs takes effect at the next
+      *      scan, so the old callback must remain callable.
+      *
+      *      Stop the watchdog before unloading the library.
+      *
+      * RESULTS
+      *              0               success,
+      *              EAGAIN          the watchdog thread could not
+      *                              be created,
+      *              EDEADLK         called from 'report'.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result;
+  ptw32_mcs_local_node_t node;
+
+  /* The thread stopping the watchdog waits for it under the lock. */
+  if (GetCurrentThreadId () == ptw32_watchdog_threadId)
+    {
+      return EDEADLK;
+    }
+
+  ptw32_mcs_lock_acquire (&ptw32_watchdog_lock, &node);
+
+  if (thresholdMillisecs == 0)
+    {
+      result = ptw32_watchdog_stop ();
+    }
+  else
+    {
+      result = ptw32_watchdog_start (thresholdMillisecs, report);
+    }
+
+  ptw32_mcs_lock_release (&node);
+
+  return result;
+}
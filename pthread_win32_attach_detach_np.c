@@ -47,72 +47,142 @@ static HINSTANCE ptw32_h_kernel32;
  */
 static HINSTANCE ptw32_h_quserex;
 
-BOOL
-pthread_win32_process_attach_np ()
+/*
+ * Set once the QUSEREX.DLL probe has been done.
+ */
+static int ptw32_quserex_probed = PTW32_FALSE;
+
+/*
+ * Serialises the QUSEREX.DLL probe.
+ */
+static ptw32_mcs_lock_t ptw32_quserex_lock = 0;
+
+void
+ptw32_quserex_probe (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      This function loads QUSEREX.DLL, if present, and
+      *      selects the async cancelation routine.
+      *
+      * PARAMETERS
+      *      N/A
+      *
+      * DESCRIPTION
+      *      Probing for QUSEREX.DLL costs a LoadLibrary call that
+      *      almost always fails, and it is only of use to
+      *      asynchronous cancelation. The probe is therefore not
+      *      done at process attach but deferred until the first
+      *      async cancel, or until the application asks for
+      *      PTW32_ALERTABLE_ASYNC_CANCEL via
+      *      pthread_win32_test_features_np(). Later calls return
+      *      immediately.
+      *
+      *      Must not be called while holding a thread's stateLock
+      *      or with a thread suspended, since LoadLibrary takes
+      *      the loader lock.
+      *
+      * RESULTS
+      *              N/A
+      *
+      * ------------------------------------------------------
+      */
 {
-  BOOL result = TRUE;
+  ptw32_mcs_local_node_t node;
 
-  result = ptw32_processInitialize ();
+  if (ptw32_quserex_probed)
+    {
+      return;
+    }
 
-#ifdef _UWIN
-  pthread_count++;
-#endif
+  ptw32_mcs_lock_acquire (&ptw32_quserex_lock, &node);
 
-  ptw32_features = 0;
+  if (!ptw32_quserex_probed)
+    {
+      DWORD (*register_cancelation) (PAPCFUNC, HANDLE, DWORD) = NULL;
 
-  /*
-   * Load QUSEREX.DLL and try to get address of QueueUserAPCEx
-   */
-  ptw32_h_quserex = LoadLibrary (TEXT ("QUSEREX.DLL"));
+      /*
+       * Load QUSEREX.DLL and try to get address of QueueUserAPCEx
+       */
+      ptw32_h_quserex = LoadLibrary (TEXT ("QUSEREX.DLL"));
 
-  if (ptw32_h_quserex != NULL)
-    {
-      ptw32_register_cancelation = (DWORD (*)(PAPCFUNC, HANDLE, DWORD))
+      if (ptw32_h_quserex != NULL)
+	{
+	  register_cancelation = (DWORD (*)(PAPCFUNC, HANDLE, DWORD))
 #if defined(NEED_UNICODE_CONSTS)
-	GetProcAddress (ptw32_h_quserex,
-			(const TCHAR *) TEXT ("QueueUserAPCEx"));
+	    GetProcAddress (ptw32_h_quserex,
+			    (const TCHAR *) TEXT ("QueueUserAPCEx"));
 #else
-	GetProcAddress (ptw32_h_quserex, (LPCSTR) "QueueUserAPCEx");
+	    GetProcAddress (ptw32_h_quserex, (LPCSTR) "QueueUserAPCEx");
 #endif
-    }
-
-  if (NULL == ptw32_register_cancelation)
-    {
-      ptw32_register_cancelation = ptw32_RegisterCancelation;
+	}
 
-      if (ptw32_h_quserex != NULL)
+      if (NULL == register_cancelation)
 	{
-	  (void) FreeLibrary (ptw32_h_quserex);
+	  if (ptw32_h_quserex != NULL)
+	    {
+	      (void) FreeLibrary (ptw32_h_quserex);
+	    }
+	  ptw32_h_quserex = 0;
 	}
-      ptw32_h_quserex = 0;
-    }
-  else
-    {
-      /* Initialise QueueUserAPCEx */
-      BOOL (*queue_user_apc_ex_init) (VOID);
+      else
+	{
+	  /* Initialise QueueUserAPCEx */
+	  BOOL (*queue_user_apc_ex_init) (VOID);
 
-      queue_user_apc_ex_init = (BOOL (*)(VOID))
+	  queue_user_apc_ex_init = (BOOL (*)(VOID))
 #if defined(NEED_UNICODE_CONSTS)
-	GetProcAddress (ptw32_h_quserex,
-			(const TCHAR *) TEXT ("QueueUserAPCEx_Init"));
+	    GetProcAddress (ptw32_h_quserex,
+			    (const TCHAR *) TEXT ("QueueUserAPCEx_Init"));
 #else
-	GetProcAddress (ptw32_h_quserex, (LPCSTR) "QueueUserAPCEx_Init");
+	    GetProcAddress (ptw32_h_quserex, (LPCSTR) "QueueUserAPCEx_Init");
 #endif
 
-      if (queue_user_apc_ex_init == NULL || !queue_user_apc_ex_init ())
-	{
-	  ptw32_register_cancelation = ptw32_RegisterCancelation;
+	  if (queue_user_apc_ex_init == NULL || !queue_user_apc_ex_init ())
+	    {
+	      (void) FreeLibrary (ptw32_h_quserex);
+	      ptw32_h_quserex = 0;
+	    }
+	}
 
-	  (void) FreeLibrary (ptw32_h_quserex);
-	  ptw32_h_quserex = 0;
+      /*
+       * Publish only a fully initialised routine; pthread_cancel()
+       * may be reading ptw32_register_cancelation concurrently.
+       */
+      if (ptw32_h_quserex)
+	{
+	  ptw32_register_cancelation = register_cancelation;
+	  ptw32_features |= PTW32_ALERTABLE_ASYNC_CANCEL;
 	}
-    }
 
-  if (ptw32_h_quserex)
-    {
-      ptw32_features |= PTW32_ALERTABLE_ASYNC_CANCEL;
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_quserex_probed,
+					(LONG)PTW32_TRUE);
     }
 
+  ptw32_mcs_lock_release (&node);
+}
+
+BOOL
+pthread_win32_process_attach_np ()
+{
+  BOOL result = TRUE;
+
+  result = ptw32_processInitialize ();
+
+#ifdef _UWIN
+  pthread_count++;
+#endif
+
+  ptw32_features = 0;
+
+  /*
+   * QUSEREX.DLL is probed for on first use - see ptw32_quserex_probe().
+   * Until then async cancelation uses the substitute routine.
+   */
+  ptw32_register_cancelation = ptw32_RegisterCancelation;
+  ptw32_quserex_probed = PTW32_FALSE;
+  ptw32_processExiting = PTW32_FALSE;
+
   return result;
 }
 
@@ -159,13 +229,23 @@ pthread_win32_process_detach_np ()
 	    {
 	      (void) queue_user_apc_ex_fini ();
 	    }
-	  (void) FreeLibrary (ptw32_h_quserex);
+	  /*
+	   * Don't unload other DLLs if the process is exiting, the
+	   * loader will do it and they may already be detached.
+	   */
+	  if (!ptw32_processExiting)
+	    {
+	      (void) FreeLibrary (ptw32_h_quserex);
+	    }
+	  ptw32_h_quserex = 0;
 	}
 
-      if (ptw32_h_kernel32)
+      if (ptw32_h_kernel32 && !ptw32_processExiting)
 	{
 	  (void) FreeLibrary (ptw32_h_kernel32);
 	}
+
+      ptw32_quserex_probed = PTW32_FALSE;
     }
 
   return TRUE;
@@ -193,6 +273,8 @@ pthread_win32_thread_detach_np ()
           ptw32_mcs_local_node_t stateLock;
 	  ptw32_callUserDestroyRoutines (sp->ptHandle);
 
+	  PTW32_STATS_INC(PTW32_STAT_THREADS_EXITED);
+
 	  ptw32_mcs_lock_acquire (&sp->stateLock, &stateLock);
 	  sp->state = PThreadStateLast;
 	  /*
@@ -227,6 +309,10 @@ pthread_win32_thread_detach_np ()
 	      TlsSetValue (ptw32_selfThreadKey->key, NULL);
 	    }
 	}
+
+#if defined(PTW32_TRACE)
+      ptw32_trace_thread_exit ();
+#endif
     }
 
   return TRUE;
@@ -235,5 +321,10 @@ pthread_win32_thread_detach_np ()
 BOOL
 pthread_win32_test_features_np (int feature_mask)
 {
+  if (feature_mask & PTW32_ALERTABLE_ASYNC_CANCEL)
+    {
+      ptw32_quserex_probe ();
+    }
+
   return ((ptw32_features & feature_mask) == feature_mask);
 }
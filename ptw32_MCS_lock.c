@@ -117,17 +117,22 @@ ptw32_mcs_flag_set (LONG * flag)
  * ptw32_mcs_flag_set -- wait for notification from another.
  * 
  * Store an event handle in the flag and wait on it if the flag has not been
- * set, and proceed without creating an event otherwise.
+ * set, and proceed without creating an event otherwise. Spin first, per the
+ * wait policy, since the wait is usually short and the event costs two
+ * system calls to create and close.
  */
 INLINE void 
 ptw32_mcs_flag_wait (LONG * flag)
 {
-  if (0 == PTW32_INTERLOCKED_EXCHANGE_ADD((LPLONG)flag, 0)) /* MBR fence */
+  if (0 == PTW32_INTERLOCKED_EXCHANGE_ADD((LPLONG)flag, 0) /* MBR fence */
+      && !PTW32_SPIN_WAIT((volatile LONG *)flag, PTW32_SPIN_UNTIL_NONZERO))
     {
       /* the flag is not set. create event. */
 
       HANDLE e = CreateEvent(NULL, PTW32_FALSE, PTW32_FALSE, NULL);
 
+      PTW32_STATS_INC(PTW32_STAT_MCS_WAITS);
+
       if (0 == PTW32_INTERLOCKED_COMPARE_EXCHANGE(
 			                  (PTW32_INTERLOCKED_LPLONG)flag,
 			                  (PTW32_INTERLOCKED_LONG)(size_t)e,
@@ -169,6 +174,7 @@ ptw32_mcs_lock_acquire (ptw32_mcs_lock_t * lock, ptw32_mcs_local_node_t * node)
   if (0 != pred)
     {
       /* the lock was not free. link behind predecessor. */
+      PTW32_STATS_INC(PTW32_STAT_MCS_CONTENDED);
       pred->next = node;
       ptw32_mcs_flag_set(&pred->nextFlag);
       ptw32_mcs_flag_wait(&node->readyFlag);
@@ -268,7 +274,7 @@ ptw32_mcs_node_transfer (ptw32_mcs_local_node_t * new_node, ptw32_mcs_local_node
        */
       while (old_node->next == 0)
         {
-          sched_yield();
+          ptw32_yield();
         }
       new_node->next = old_node->next;
     }
@@ -0,0 +1,526 @@
+/*
+ * ptw32_cohort.c
+ *
+ * Description:
+ * This translation unit implements cohort (NUMA aware) mutexes.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+/*
+ * The processor to node map, filled in on first use.
+ */
+static int ptw32_cohort_probed = PTW32_FALSE;
+static ptw32_mcs_lock_t ptw32_cohort_probe_lock = 0;
+static int ptw32_cohort_system_nodes = 1;
+static unsigned char ptw32_cohort_cpu_node[64];
+static DWORD (WINAPI *ptw32_cohort_cpu_number) (VOID) = NULL;
+
+
+static void
+ptw32_cohort_probe (void)
+     /*
+      * ------------------------------------------------------
+      * DESCRIPTION
+      *      Builds the processor to node map from the NUMA
+      *      functions in kernel32, if they exist. Without them,
+      *      or without GetCurrentProcessorNumber() (pre-Vista),
+      *      the system is treated as a single node.
+      *
+      *      Only the first 64 processors (the current processor
+      *      group) are mapped.
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+
+  if (ptw32_cohort_probed)
+    {
+      return;
+    }
+
+  ptw32_mcs_lock_acquire (&ptw32_cohort_probe_lock, &node);
+
+  if (!ptw32_cohort_probed)
+    {
+      HMODULE kernel32 = GetModuleHandle (TEXT ("KERNEL32.DLL"));
+      BOOL (WINAPI *highest_node) (ULONG *) = NULL;
+      BOOL (WINAPI *processor_node) (UCHAR, UCHAR *) = NULL;
+      DWORD (WINAPI *cpu_number) (VOID) = NULL;
+      ULONG highest;
+
+      if (kernel32 != NULL)
+	{
+#if defined(NEED_UNICODE_CONSTS)
+	  highest_node = (BOOL (WINAPI *) (ULONG *))
+	    GetProcAddress (kernel32,
+			    (const TCHAR *) TEXT ("GetNumaHighestNodeNumber"));
+	  processor_node = (BOOL (WINAPI *) (UCHAR, UCHAR *))
+	    GetProcAddress (kernel32,
+			    (const TCHAR *) TEXT ("GetNumaProcessorNode"));
+	  cpu_number = (DWORD (WINAPI *) (VOID))
+	    GetProcAddress (kernel32,
+			    (const TCHAR *) TEXT ("GetCurrentProcessorNumber"));
+#else
+	  highest_node = (BOOL (WINAPI *) (ULONG *))
+	    GetProcAddress (kernel32, (LPCSTR) "GetNumaHighestNodeNumber");
+	  processor_node = (BOOL (WINAPI *) (UCHAR, UCHAR *))
+	    GetProcAddress (kernel32, (LPCSTR) "GetNumaProcessorNode");
+	  cpu_number = (DWORD (WINAPI *) (VOID))
+	    GetProcAddress (kernel32, (LPCSTR) "GetCurrentProcessorNumber");
+#endif
+	}
+
+      if (highest_node != NULL && processor_node != NULL
+	  && cpu_number != NULL
+	  && highest_node (&highest) && highest > 0)
+	{
+	  int cpu;
+
+	  ptw32_cohort_system_nodes = (highest < PTW32_COHORT_MAX_NODES)
+	                              ? (int) highest + 1
+	                              : PTW32_COHORT_MAX_NODES;
+
+	  for (cpu = 0; cpu < 64; cpu++)
+	    {
+	      UCHAR n;
+
+	      if (processor_node ((UCHAR) cpu, &n)
+		  && n < (UCHAR) ptw32_cohort_system_nodes)
+		{
+		  ptw32_cohort_cpu_node[cpu] = n;
+		}
+	    }
+
+	  ptw32_cohort_cpu_number = cpu_number;
+	}
+
+      ptw32_cohort_probed = PTW32_TRUE;
+    }
+
+  ptw32_mcs_lock_release (&node);
+}
+
+
+static INLINE int
+ptw32_cohort_current (ptw32_cohort_t * ch)
+     /*
+      * ------------------------------------------------------
+      * DESCRIPTION
+      *      Returns the node the calling thread is running on,
+      *      in the range 0 to ch->nodes - 1.
+      * ------------------------------------------------------
+      */
+{
+  unsigned int n;
+
+  if (ch->nodes == 1)
+    {
+      return 0;
+    }
+
+  if (ch->nodeOf != NULL)
+    {
+      n = (unsigned int) ch->nodeOf ();
+    }
+  else
+    {
+      n = ptw32_cohort_cpu_node[ptw32_cohort_cpu_number () & 63];
+    }
+
+  return (int) (n % (unsigned int) ch->nodes);
+}
+
+
+static int
+ptw32_cohort_block (pthread_mutex_t * mutex, HANDLE event, DWORD * waker,
+		    const struct timespec * abstime, ptw32_hook_state_t * hook)
+     /*
+      * ------------------------------------------------------
+      * DESCRIPTION
+      *      Waits for a local or the global lock's event, as
+      *      ptw32_timed_eventwait() does for other mutexes.
+      *
+      * RESULTS
+      *              0               successfully signaled,
+      *              ETIMEDOUT       abstime passed,
+      *              EINVAL          the wait failed.
+      * ------------------------------------------------------
+      */
+{
+  DWORD status;
+  int result;
+
+  PTW32_STATS_INC(PTW32_STAT_MUTEX_WAITS);
+  PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_BEGIN, *mutex, 0);
+  PTW32_HOOK_BEFORE(*hook, PTW32_WAIT_MUTEX, mutex);
+
+  status = WaitForSingleObject (event, (abstime == NULL)
+				       ? INFINITE
+				       : ptw32_relmillisecs (abstime));
+
+  if (status == WAIT_OBJECT_0)
+    {
+      result = 0;
+    }
+  else if (status == WAIT_TIMEOUT)
+    {
+      PTW32_STATS_INC(PTW32_STAT_MUTEX_TIMEOUTS);
+      result = ETIMEDOUT;
+    }
+  else
+    {
+      result = EINVAL;
+    }
+
+  PTW32_TRACE_EVENT(PTW32_TRACE_MUTEX_WAIT_END, *mutex, result);
+  PTW32_HOOK_AFTER(*hook, PTW32_WAIT_MUTEX, mutex,
+		   (0 == result) ? *waker : 0, result);
+
+  return result;
+}
+
+
+static INLINE int
+ptw32_cohort_release (LONG * lock_idx, HANDLE event, DWORD * waker)
+{
+  if ((LONG) PTW32_INTERLOCKED_EXCHANGE ((LPLONG) lock_idx, (LONG) 0) < 0)
+    {
+      /* Someone may be waiting */
+      *waker = GetCurrentThreadId ();
+      if (SetEvent (event) == 0)
+	{
+	  return EINVAL;
+	}
+    }
+
+  return 0;
+}
+
+
+int
+ptw32_cohort_create (pthread_mutex_t mx)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Allocates the per-node state of a new cohort mutex.
+      *
+      * DESCRIPTION
+      *      The number of nodes, and how a thread's node is
+      *      found, are fixed here from the system topology or
+      *      the override set by
+      *      pthread_mutex_setcohorttopology_np().
+      *
+      * RESULTS
+      *              0               success,
+      *              ENOMEM          insufficient memory,
+      *              ENOSPC          an event could not be created.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_cohort_t * ch;
+  ptw32_cohort_node_fn_t nodeOf = ptw32_cohort_fake_node_of;
+  int nodes = ptw32_cohort_fake_nodes;
+  int i;
+
+  ptw32_cohort_probe ();
+
+  if (nodeOf == NULL || nodes < 1)
+    {
+      nodeOf = NULL;
+      nodes = ptw32_cohort_system_nodes;
+    }
+
+  ch = (ptw32_cohort_t *) calloc (1, sizeof (*ch)
+				     + (nodes - 1) * sizeof (ptw32_cohort_node_t));
+
+  if (ch == NULL)
+    {
+      return ENOMEM;
+    }
+
+  ch->nodes = nodes;
+  ch->nodeOf = nodeOf;
+
+  for (i = 0; i < nodes; i++)
+    {
+      ch->node[i].event = CreateEvent (NULL, PTW32_FALSE, PTW32_FALSE, NULL);
+
+      if (ch->node[i].event == NULL)
+	{
+	  while (--i >= 0)
+	    {
+	      (void) CloseHandle (ch->node[i].event);
+	    }
+	  free (ch);
+	  return ENOSPC;
+	}
+    }
+
+  PTW32_STATS_ADD(PTW32_STAT_MUTEX_HANDLES, nodes);
+  mx->cohort = ch;
+
+  return 0;
+}
+
+
+void
+ptw32_cohort_destroy (pthread_mutex_t mx)
+{
+  ptw32_cohort_t * ch = mx->cohort;
+  int i;
+
+  for (i = 0; i < ch->nodes; i++)
+    {
+      (void) CloseHandle (ch->node[i].event);
+    }
+
+  PTW32_STATS_ADD(PTW32_STAT_MUTEX_HANDLES, -ch->nodes);
+  mx->cohort = NULL;
+  free (ch);
+}
+
+
+int
+ptw32_cohort_lock (pthread_mutex_t * mutex, const struct timespec * abstime)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Locks a cohort mutex, waiting until abstime if it
+      *      is not NULL.
+      *
+      * DESCRIPTION
+      *      Takes the calling node's local lock and then, unless
+      *      the previous owner passed it on with the local lock,
+      *      the global lock.
+      *
+      *      A waiter that gives up on the local lock may be the
+      *      one the global lock was just passed to; it takes the
+      *      local lock if it is now free rather than leave the
+      *      global lock held by nobody (see ptw32_cohort_unlock).
+      *
+      * RESULTS
+      *              0               success,
+      *              ETIMEDOUT       abstime passed,
+      *              EINVAL          a wait failed.
+      *
+      * ------------------------------------------------------
+      */
+{
+  pthread_mutex_t mx = *mutex;
+  ptw32_cohort_t * ch = mx->cohort;
+  int n = ptw32_cohort_current (ch);
+  ptw32_cohort_node_t * nd = &ch->node[n];
+  ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+  DWORD waker = 0;
+  int result = 0;
+
+  if ((LONG) PTW32_INTERLOCKED_EXCHANGE ((LPLONG) &nd->lock_idx, (LONG) 1) != 0)
+    {
+      PTW32_INTERLOCKED_INCREMENT ((LPLONG) &nd->waiters);
+
+      while ((LONG) PTW32_INTERLOCKED_EXCHANGE ((LPLONG) &nd->lock_idx, (LONG) -1) != 0)
+	{
+	  if (0 != (result = ptw32_cohort_block (mutex, nd->event,
+						 &nd->wakerThread,
+						 abstime, &hook)))
+	    {
+	      break;
+	    }
+	}
+
+      PTW32_INTERLOCKED_DECREMENT ((LPLONG) &nd->waiters);
+
+      if (ETIMEDOUT == result
+	  && 0 == (LONG) PTW32_INTERLOCKED_COMPARE_EXCHANGE (
+			   (PTW32_INTERLOCKED_LPLONG) &nd->lock_idx,
+			   (PTW32_INTERLOCKED_LONG) -1,
+			   (PTW32_INTERLOCKED_LONG) 0))
+	{
+	  result = 0;
+	}
+
+      waker = nd->wakerThread;
+    }
+
+  if (0 == result && !nd->holdsGlobal)
+    {
+      if ((LONG) PTW32_INTERLOCKED_EXCHANGE ((LPLONG) &mx->lock_idx, (LONG) 1) != 0)
+	{
+	  while ((LONG) PTW32_INTERLOCKED_EXCHANGE ((LPLONG) &mx->lock_idx, (LONG) -1) != 0)
+	    {
+	      if (0 != (result = ptw32_cohort_block (mutex, mx->event,
+						     &mx->wakerThread,
+						     abstime, &hook)))
+		{
+		  break;
+		}
+	    }
+
+	  waker = mx->wakerThread;
+	}
+
+      if (0 != result)
+	{
+	  (void) ptw32_cohort_release (&nd->lock_idx, nd->event, &nd->wakerThread);
+	}
+    }
+
+  if (0 == result)
+    {
+      ch->ownerNode = n;
+    }
+
+  PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_MUTEX, mutex, waker, result);
+
+  return result;
+}
+
+
+int
+ptw32_cohort_trylock (pthread_mutex_t * mutex)
+{
+  pthread_mutex_t mx = *mutex;
+  ptw32_cohort_t * ch = mx->cohort;
+  int n = ptw32_cohort_current (ch);
+  ptw32_cohort_node_t * nd = &ch->node[n];
+
+  if (0 != (LONG) PTW32_INTERLOCKED_COMPARE_EXCHANGE (
+		    (PTW32_INTERLOCKED_LPLONG) &nd->lock_idx,
+		    (PTW32_INTERLOCKED_LONG) 1,
+		    (PTW32_INTERLOCKED_LONG) 0))
+    {
+      return EBUSY;
+    }
+
+  if (!nd->holdsGlobal
+      && 0 != (LONG) PTW32_INTERLOCKED_COMPARE_EXCHANGE (
+		       (PTW32_INTERLOCKED_LPLONG) &mx->lock_idx,
+		       (PTW32_INTERLOCKED_LONG) 1,
+		       (PTW32_INTERLOCKED_LONG) 0))
+    {
+      (void) ptw32_cohort_release (&nd->lock_idx, nd->event, &nd->wakerThread);
+      return EBUSY;
+    }
+
+  ch->ownerNode = n;
+
+  return 0;
+}
+
+
+int
+ptw32_cohort_unlock (pthread_mutex_t * mutex)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Unlocks a cohort mutex.
+      *
+      * DESCRIPTION
+      *      If a thread of the owner's node is waiting for the
+      *      local lock, and the global lock has not already been
+      *      passed PTW32_COHORT_MAX_PASSES times in a row, the
+      *      global lock is kept and only the local lock released.
+      *
+      *      The waiter may time out before it takes the local
+      *      lock. So, having passed the global lock, we check
+      *      again for waiters and if there are none we take the
+      *      local lock back, if still free, and release both.
+      *
+      * RESULTS
+      *              0               success,
+      *              EPERM           the mutex is not locked,
+      *              EINVAL          an event could not be set.
+      *
+      * ------------------------------------------------------
+      */
+{
+  pthread_mutex_t mx = *mutex;
+  ptw32_cohort_t * ch = mx->cohort;
+  ptw32_cohort_node_t * nd = &ch->node[ch->ownerNode];
+  int result;
+
+  if (0 == mx->lock_idx)
+    {
+      return EPERM;
+    }
+
+  if (nd->passes < PTW32_COHORT_MAX_PASSES
+      && PTW32_INTERLOCKED_EXCHANGE_ADD ((LPLONG) &nd->waiters, 0L) > 0)
+    {
+      nd->passes++;
+      nd->holdsGlobal = PTW32_TRUE;
+
+      result = ptw32_cohort_release (&nd->lock_idx, nd->event, &nd->wakerThread);
+
+      if (0 == result
+	  && 0 == PTW32_INTERLOCKED_EXCHANGE_ADD ((LPLONG) &nd->waiters, 0L)
+	  && 0 == (LONG) PTW32_INTERLOCKED_COMPARE_EXCHANGE (
+			   (PTW32_INTERLOCKED_LPLONG) &nd->lock_idx,
+			   (PTW32_INTERLOCKED_LONG) -1,
+			   (PTW32_INTERLOCKED_LONG) 0))
+	{
+	  /* Nobody took it. Retract and release as below. */
+	  if (nd->holdsGlobal)
+	    {
+	      nd->passes = 0;
+	      nd->holdsGlobal = PTW32_FALSE;
+	      result = ptw32_cohort_release (&mx->lock_idx, mx->event,
+					     &mx->wakerThread);
+	    }
+
+	  if (0 == result)
+	    {
+	      result = ptw32_cohort_release (&nd->lock_idx, nd->event,
+					     &nd->wakerThread);
+	    }
+	}
+    }
+  else
+    {
+      nd->passes = 0;
+      nd->holdsGlobal = PTW32_FALSE;
+
+      result = ptw32_cohort_release (&mx->lock_idx, mx->event, &mx->wakerThread);
+
+      if (0 == result)
+	{
+	  result = ptw32_cohort_release (&nd->lock_idx, nd->event,
+					 &nd->wakerThread);
+	}
+    }
+
+  return result;
+}
@@ -0,0 +1,268 @@
+/*
+ * ptw32_exchanger.c
+ *
+ * Description:
+ * This translation unit implements the exchanger rendezvous.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+static int
+ptw32_exchanger_withdraw (ptw32_exchanger_node_t * node)
+     /*
+      * ------------------------------------------------------
+      * Take a parked waiter's node off the queue unless a peer
+      * has already completed it, in which case wait for the
+      * peer's signal so that it can't arrive after we have gone.
+      * Returns PTW32_TRUE if the node was withdrawn.
+      * ------------------------------------------------------
+      */
+{
+  pthread_exchanger_t ex = node->exchanger;
+  ptw32_mcs_local_node_t qnode;
+  int withdrawn = PTW32_FALSE;
+
+  ptw32_mcs_lock_acquire (&ex->lock, &qnode);
+
+  if (node->state != PTW32_EXCHANGE_DONE)
+    {
+      if (node->prev == NULL)
+	{
+	  ex->head = node->next;
+	}
+      else
+	{
+	  node->prev->next = node->next;
+	}
+
+      if (node->next == NULL)
+	{
+	  ex->tail = node->prev;
+	}
+      else
+	{
+	  node->next->prev = node->prev;
+	}
+
+      withdrawn = PTW32_TRUE;
+    }
+
+  ptw32_mcs_lock_release (&qnode);
+
+  if (!withdrawn)
+    {
+      (void) WaitForSingleObject (node->event, INFINITE);
+    }
+
+  return withdrawn;
+}
+
+
+static void PTW32_CDECL
+ptw32_exchanger_cancelwait (void * arg)
+{
+  (void) ptw32_exchanger_withdraw ((ptw32_exchanger_node_t *) arg);
+}
+
+
+int
+ptw32_exchange (pthread_exchanger_t ex, int role, void * item,
+		void ** other, const struct timespec * abstime)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Meets a peer on 'ex': a PTW32_EXCHANGE_PUT meets a
+      *      _TAKE and vice versa, a _SWAP meets another _SWAP,
+      *      oldest waiter first. The caller's 'item' goes to the
+      *      peer and the peer's is returned in *other.
+      *
+      *      If a peer is waiting the items are swapped through
+      *      its node at once. Otherwise the caller queues a node
+      *      and polls it for the wait policy's spin budget before
+      *      parking on its thread's parkEvent until a peer
+      *      completes it, 'abstime' passes, or the thread is
+      *      interrupted or cancelled.
+      *
+      * RESULTS
+      *              0               *other is the peer's item,
+      *              ETIMEDOUT       'abstime' passed with no peer,
+      *              EINTR           the wait was interrupted,
+      *              ENOMEM          the thread's event could not be
+      *                              created.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int match = (role == PTW32_EXCHANGE_PUT) ? PTW32_EXCHANGE_TAKE
+    : (role == PTW32_EXCHANGE_TAKE) ? PTW32_EXCHANGE_PUT
+    : PTW32_EXCHANGE_SWAP;
+  ptw32_exchanger_node_t node;
+  ptw32_exchanger_node_t * peer;
+  ptw32_mcs_local_node_t qnode;
+  ptw32_thread_t * sp;
+  int result = 0;
+  int i;
+
+  PTW32_TESTCANCEL();
+
+  sp = (ptw32_thread_t *) pthread_self ().p;
+
+  if (sp == NULL)
+    {
+      return ENOMEM;
+    }
+
+  if (sp->parkEvent == NULL)
+    {
+      if ((sp->parkEvent = CreateEvent (NULL, PTW32_FALSE, PTW32_FALSE, NULL)) == NULL)
+	{
+	  return ENOMEM;
+	}
+      PTW32_STATS_INC(PTW32_STAT_THREAD_HANDLES);
+    }
+
+  ptw32_mcs_lock_acquire (&ex->lock, &qnode);
+
+  for (peer = ex->head; peer != NULL && peer->role != match; peer = peer->next)
+    {
+      ;
+    }
+
+  if (peer != NULL)
+    {
+      HANDLE event = peer->event;
+
+      if (peer->prev == NULL)
+	{
+	  ex->head = peer->next;
+	}
+      else
+	{
+	  peer->prev->next = peer->next;
+	}
+
+      if (peer->next == NULL)
+	{
+	  ex->tail = peer->prev;
+	}
+      else
+	{
+	  peer->next->prev = peer->prev;
+	}
+
+      *other = peer->item;
+      peer->item = item;
+
+      /*
+       * The node may be gone as soon as it is DONE, unless the
+       * waiter had parked: then it waits for the event.
+       */
+      if ((LONG) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&peer->state,
+					     (LONG)PTW32_EXCHANGE_DONE)
+	  == PTW32_EXCHANGE_PARKED)
+	{
+	  ptw32_mcs_lock_release (&qnode);
+	  (void) SetEvent (event);
+	}
+      else
+	{
+	  ptw32_mcs_lock_release (&qnode);
+	}
+
+      return 0;
+    }
+
+  if (abstime != NULL && ptw32_relmillisecs (abstime) == 0)
+    {
+      ptw32_mcs_lock_release (&qnode);
+      return ETIMEDOUT;
+    }
+
+  node.next = NULL;
+  node.prev = ex->tail;
+  node.exchanger = ex;
+  node.role = role;
+  node.item = item;
+  node.state = PTW32_EXCHANGE_WAITING;
+  node.event = sp->parkEvent;
+
+  if (ex->tail == NULL)
+    {
+      ex->head = &node;
+    }
+  else
+    {
+      ex->tail->next = &node;
+    }
+  ex->tail = &node;
+
+  ptw32_mcs_lock_release (&qnode);
+
+  if (ptw32_wait_spinning)
+    {
+      for (i = 0; i < ptw32_wait_policy.spinCount
+		  && node.state == PTW32_EXCHANGE_WAITING; i++)
+	{
+	  PTW32_PAUSE ();
+	}
+    }
+
+  if ((LONG) PTW32_INTERLOCKED_COMPARE_EXCHANGE((PTW32_INTERLOCKED_LPLONG)&node.state,
+						(PTW32_INTERLOCKED_LONG)PTW32_EXCHANGE_PARKED,
+						(PTW32_INTERLOCKED_LONG)PTW32_EXCHANGE_WAITING)
+      == PTW32_EXCHANGE_WAITING)
+    {
+      DWORD ms = (abstime == NULL) ? INFINITE : ptw32_relmillisecs (abstime);
+
+      PTW32_CANCEL_CLEANUP_PUSH(ptw32_exchanger_cancelwait, &node);
+      result = pthreadCancelableTimedWait (node.event, ms);
+      PTW32_CANCEL_CLEANUP_POP(0);
+
+      /*
+       * Only a peer sets the event, so success means DONE. Otherwise
+       * a peer may still have got there first.
+       */
+      if (result != 0 && !ptw32_exchanger_withdraw (&node))
+	{
+	  result = 0;
+	}
+    }
+
+  if (result == 0)
+    {
+      *other = node.item;
+    }
+
+  return result;
+}
@@ -0,0 +1,251 @@
+/*
+ * ptw32_group.c
+ *
+ * Description:
+ * This translation unit implements routines which are private to
+ * the implementation and may be used throughout it.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+static void
+ptw32_group_unlink (pthread_group_t group, ptw32_thread_t * tp)
+{
+  if (tp->groupNext != NULL)
+    {
+      tp->groupNext->groupPrev = tp->groupPrev;
+    }
+
+  if (tp->groupPrev != NULL)
+    {
+      tp->groupPrev->groupNext = tp->groupNext;
+    }
+  else if (group->running == tp)
+    {
+      group->running = tp->groupNext;
+    }
+  else
+    {
+      group->done = tp->groupNext;
+    }
+
+  tp->groupNext = tp->groupPrev = NULL;
+}
+
+
+void
+ptw32_group_add (pthread_group_t group, ptw32_thread_t * tp)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Puts a thread that is being created, and has not yet
+      *      been started, on its group's running list.
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+
+  ptw32_mcs_lock_acquire (&group->lock, &node);
+  tp->group = group;
+  tp->groupDone = PTW32_FALSE;
+  tp->groupPrev = NULL;
+  tp->groupNext = group->running;
+  if (group->running != NULL)
+    {
+      group->running->groupPrev = tp;
+    }
+  group->running = tp;
+  ptw32_mcs_lock_release (&node);
+}
+
+
+void
+ptw32_group_exited (ptw32_thread_t * sp)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called by a group member once its start routine has
+      *      returned and, if it is joinable, its TSD destructors
+      *      have run. A joinable member moves to the done list to
+      *      await reclaiming; a detached member leaves the group.
+      * ------------------------------------------------------
+      */
+{
+  pthread_group_t group = sp->group;
+  ptw32_mcs_local_node_t node;
+
+  ptw32_mcs_lock_acquire (&group->lock, &node);
+
+  ptw32_group_unlink (group, sp);
+
+  if (sp->detachState == PTHREAD_CREATE_JOINABLE)
+    {
+      sp->groupNext = group->done;
+      if (group->done != NULL)
+	{
+	  group->done->groupPrev = sp;
+	}
+      group->done = sp;
+      sp->groupDone = PTW32_TRUE;
+    }
+  else
+    {
+      sp->group = NULL;
+    }
+
+  (void) SetEvent (group->event);
+
+  ptw32_mcs_lock_release (&node);
+}
+
+
+void
+ptw32_group_leave (ptw32_thread_t * tp)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Removes a thread from its group before its struct is
+      *      recycled: a detached or explicitly joined member, or
+      *      one whose creation failed.
+      * ------------------------------------------------------
+      */
+{
+  pthread_group_t group = tp->group;
+  ptw32_mcs_local_node_t node;
+
+  if (group != NULL)
+    {
+      ptw32_mcs_lock_acquire (&group->lock, &node);
+      if (tp->group == group)
+	{
+	  ptw32_group_unlink (group, tp);
+	  tp->group = NULL;
+	  (void) SetEvent (group->event);
+	}
+      ptw32_mcs_lock_release (&node);
+    }
+}
+
+
+void
+ptw32_group_detach (ptw32_thread_t * tp)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called by pthread_detach(), holding the thread reuse
+      *      lock, after marking 'tp' detached. A finished member
+      *      is taken off the done list so that the group cannot
+      *      reclaim it too. A running member stays, to be waited
+      *      for, and leaves when it finishes.
+      * ------------------------------------------------------
+      */
+{
+  pthread_group_t group = tp->group;
+  ptw32_mcs_local_node_t node;
+
+  if (group != NULL)
+    {
+      ptw32_mcs_lock_acquire (&group->lock, &node);
+      if (tp->group == group && tp->groupDone)
+	{
+	  ptw32_group_unlink (group, tp);
+	  tp->group = NULL;
+	}
+      ptw32_mcs_lock_release (&node);
+    }
+}
+
+
+void
+ptw32_group_reclaim (ptw32_thread_t * list)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Reclaims finished joinable members, linked through
+      *      groupNext, that the caller has already taken off
+      *      their group's done list. This is what pthread_detach()
+      *      does for each, less the validation: a member on the
+      *      done list cannot be recycled until it is reclaimed.
+      *
+      *      Members still tearing down are marked detached and
+      *      destroy themselves. The others are destroyed here,
+      *      after waiting for their handles MAXIMUM_WAIT_OBJECTS
+      *      at a time rather than one by one.
+      * ------------------------------------------------------
+      */
+{
+  HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+  pthread_t threads[MAXIMUM_WAIT_OBJECTS];
+  DWORD count = 0;
+  DWORD i;
+  ptw32_thread_t * tp;
+  ptw32_thread_t * next;
+
+  for (tp = list; tp != NULL; tp = next)
+    {
+      ptw32_mcs_local_node_t stateLock;
+      BOOL destroyIt = PTW32_FALSE;
+
+      /* Once marked detached the member may destroy itself. */
+      next = tp->groupNext;
+      tp->groupNext = tp->groupPrev = NULL;
+
+      ptw32_mcs_lock_acquire (&tp->stateLock, &stateLock);
+      if (tp->state != PThreadStateLast)
+	{
+	  tp->detachState = PTHREAD_CREATE_DETACHED;
+	}
+      else
+	{
+	  destroyIt = PTW32_TRUE;
+	}
+      ptw32_mcs_lock_release (&stateLock);
+
+      if (destroyIt)
+	{
+	  handles[count] = tp->threadH;
+	  threads[count++] = tp->ptHandle;
+	}
+
+      if (count == MAXIMUM_WAIT_OBJECTS || (count > 0 && next == NULL))
+	{
+	  (void) WaitForMultipleObjects (count, handles, PTW32_TRUE, INFINITE);
+	  for (i = 0; i < count; i++)
+	    {
+	      ptw32_threadDestroy (threads[i]);
+	    }
+	  count = 0;
+	}
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * ptw32_interrupt.c
+ *
+ * Description:
+ * This translation unit implements routines which are private to
+ * the implementation and may be used throughout it.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+int
+ptw32_cancel_event_check (ptw32_thread_t * sp)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called by a thread that has seen its own cancelEvent
+      *      signaled, to find out who signaled it.
+      *
+      * PARAMETERS
+      *      sp
+      *              the calling thread.
+      *
+      * DESCRIPTION
+      *      A deferred cancel that the thread can act on wins:
+      *      this routine does not return. Otherwise a pending
+      *      pthread_interrupt_np() is consumed. The event is left
+      *      signaled while a (disabled) cancel request is pending
+      *      so that the request is not lost.
+      *
+      * RESULTS
+      *              EINTR           the thread was interrupted,
+      *              0               nothing to act on; wait again.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result = 0;
+  ptw32_mcs_local_node_t stateLock;
+
+  ptw32_mcs_lock_acquire (&sp->stateLock, &stateLock);
+
+  if (sp->state == PThreadStateCancelPending
+      && sp->cancelState == PTHREAD_CANCEL_ENABLE)
+    {
+      ResetEvent (sp->cancelEvent);
+      sp->state = PThreadStateCanceling;
+      sp->cancelState = PTHREAD_CANCEL_DISABLE;
+      ptw32_mcs_lock_release (&stateLock);
+      ptw32_throw (PTW32_EPS_CANCEL);
+
+      /* Never reached */
+    }
+
+  if (sp->state != PThreadStateCancelPending)
+    {
+      ResetEvent (sp->cancelEvent);
+    }
+
+  if ((LONG) PTW32_INTERLOCKED_EXCHANGE((LPLONG) &sp->interrupted,
+					(LONG) 0) != 0)
+    {
+      result = EINTR;
+    }
+
+  ptw32_mcs_lock_release (&stateLock);
+
+  return result;
+
+}				/* ptw32_cancel_event_check */
@@ -0,0 +1,478 @@
+/*
+ * ptw32_locktrace.c
+ *
+ * Description:
+ * This translation unit implements the lock trace recorder.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+static DWORD ptw32_locktrace_tlsIndex = TLS_OUT_OF_INDEXES;
+static ptw32_locktrace_chunk_t * ptw32_locktrace_chunks = NULL;
+static ptw32_locktrace_chunk_t * ptw32_locktrace_last = NULL;
+static ptw32_mcs_lock_t ptw32_locktrace_lock = 0;
+static ULONGLONG ptw32_locktrace_baseTicks = 0;
+static unsigned long ptw32_locktrace_reserved = 0;	/* Chunk room given out */
+static unsigned long ptw32_locktrace_limit = 0;
+static LONG ptw32_locktrace_threads = 0;
+static LONG ptw32_locktrace_objects = 0;
+static LONG ptw32_locktrace_dropped = 0;
+static char ptw32_locktrace_path[MAX_PATH];
+
+
+static ptw32_locktrace_chunk_t *
+ptw32_locktrace_claim (ptw32_locktrace_chunk_t * full)
+     /*
+      * ------------------------------------------------------
+      * Give the calling thread a new chunk, following 'full',
+      * its last one, if it had one. At the limit, or without
+      * memory, recording stops.
+      * ------------------------------------------------------
+      */
+{
+  ptw32_locktrace_chunk_t * chunk = NULL;
+  ptw32_mcs_local_node_t node;
+
+  ptw32_mcs_lock_acquire (&ptw32_locktrace_lock, &node);
+
+  if (ptw32_locktrace_reserved < ptw32_locktrace_limit)
+    {
+      chunk = (ptw32_locktrace_chunk_t *) calloc (1, sizeof (ptw32_locktrace_chunk_t));
+    }
+
+  if (chunk != NULL)
+    {
+      chunk->thread = (full != NULL)
+	? full->thread
+	: (DWORD) PTW32_INTERLOCKED_INCREMENT((LPLONG)&ptw32_locktrace_threads);
+      chunk->size = (LONG) PTW32_MIN(ptw32_locktrace_limit - ptw32_locktrace_reserved,
+				     (unsigned long) PTW32_LOCKTRACE_CHUNK);
+      ptw32_locktrace_reserved += (unsigned long) chunk->size;
+
+      /* Appended, so that each thread's chunks stay in order. */
+      if (ptw32_locktrace_last == NULL)
+	{
+	  ptw32_locktrace_chunks = chunk;
+	}
+      else
+	{
+	  ptw32_locktrace_last->next = chunk;
+	}
+      ptw32_locktrace_last = chunk;
+
+      TlsSetValue (ptw32_locktrace_tlsIndex, (LPVOID) chunk);
+    }
+  else
+    {
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_locktrace_enabled, (LONG)PTW32_FALSE);
+    }
+
+  ptw32_mcs_lock_release (&node);
+
+  return chunk;
+}
+
+
+static void
+ptw32_locktrace_record (ULONGLONG ticks, pthread_mutex_t mx, int op, DWORD wait)
+     /*
+      * ------------------------------------------------------
+      * Append one record to the calling thread's chunk,
+      * numbering the mutex the first time it is seen.
+      * ------------------------------------------------------
+      */
+{
+  ptw32_locktrace_chunk_t * chunk;
+  ptw32_locktrace_record_t * rec;
+  DWORD lastError = GetLastError ();
+  int kind = mx->kind;
+
+  chunk = (ptw32_locktrace_chunk_t *) TlsGetValue (ptw32_locktrace_tlsIndex);
+
+  if (chunk == NULL || chunk->count == chunk->size)
+    {
+      if ((chunk = ptw32_locktrace_claim (chunk)) == NULL)
+	{
+	  (void) PTW32_INTERLOCKED_INCREMENT((LPLONG)&ptw32_locktrace_dropped);
+	  SetLastError (lastError);
+	  return;
+	}
+    }
+
+  if (mx->traceId == 0)
+    {
+      /* A number lost to a race leaves a gap, which is harmless. */
+      (void) PTW32_INTERLOCKED_COMPARE_EXCHANGE((PTW32_INTERLOCKED_LPLONG)&mx->traceId,
+		  (PTW32_INTERLOCKED_LONG)PTW32_INTERLOCKED_INCREMENT((LPLONG)&ptw32_locktrace_objects),
+		  (PTW32_INTERLOCKED_LONG)0);
+    }
+
+  rec = &chunk->record[chunk->count];
+  rec->ticks = ticks;
+  rec->object = (DWORD) mx->traceId;
+  rec->thread = chunk->thread;
+  rec->wait = wait;
+  rec->op = (WORD) op;
+  rec->kind = (WORD) (PTW32_MUTEX_KIND_ROBUST(kind)
+		      ? (-kind - 1) | PTW32_LOCKTRACE_ROBUST
+		      : kind);
+
+  /* Publish the record to a concurrent dump. */
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&chunk->count, chunk->count + 1);
+
+  SetLastError (lastError);
+}
+
+
+void
+ptw32_locktrace_acquired (ULONGLONG start, pthread_mutex_t mx, int op)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Records that the calling thread has taken 'mx', having
+      *      called for it at 'start'. Relocking a recursive mutex
+      *      isn't recorded. Called through
+      *      PTW32_LOCKTRACE_ACQUIRED.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ULONGLONG wait = ptw32_hook_now () - start;
+  int kind = mx->kind;
+
+  if (PTW32_MUTEX_KIND_ROBUST(kind))
+    {
+      kind = -kind - 1;
+    }
+
+  if (kind == PTHREAD_MUTEX_RECURSIVE && mx->recursive_count > 1)
+    {
+      return;
+    }
+
+  ptw32_locktrace_record (start, mx, op,
+			  (DWORD) PTW32_MIN(wait, (ULONGLONG) 0xFFFFFFFF));
+}
+
+
+void
+ptw32_locktrace_release (pthread_mutex_t mx)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Records that the calling thread is about to release
+      *      'mx'. Unlocks that won't release it (not the owner,
+      *      or an inner recursive unlock) aren't recorded.
+      *      Called through PTW32_LOCKTRACE_RELEASE.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int kind = mx->kind;
+  int robust = PTW32_MUTEX_KIND_ROBUST(kind);
+
+  if (robust)
+    {
+      kind = -kind - 1;
+    }
+
+  /*
+   * Normal and cohort mutexes don't keep their owner unless they
+   * are robust.
+   */
+  if (robust || (kind != PTHREAD_MUTEX_NORMAL && kind != PTHREAD_MUTEX_COHORT_NP))
+    {
+      if (!pthread_equal (mx->ownerThread, pthread_self ()))
+	{
+	  return;
+	}
+
+      if (kind == PTHREAD_MUTEX_RECURSIVE && mx->recursive_count > 1)
+	{
+	  return;
+	}
+    }
+
+  ptw32_locktrace_record (ptw32_hook_now (), mx, PTW32_LOCKTRACE_UNLOCK, 0);
+}
+
+
+int
+ptw32_locktrace_start (unsigned long limit)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Turn recording on, for up to 'limit' more records.
+      *
+      * RESULTS
+      *              0       recording,
+      *              EAGAIN  no TLS slot was available.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+
+  if (ptw32_locktrace_tlsIndex == TLS_OUT_OF_INDEXES)
+    {
+      return EAGAIN;
+    }
+
+  ptw32_mcs_lock_acquire (&ptw32_locktrace_lock, &node);
+
+  if (ptw32_locktrace_baseTicks == 0)
+    {
+      ptw32_locktrace_baseTicks = ptw32_hook_now ();
+    }
+
+  ptw32_locktrace_limit = (limit > (unsigned long) -1 - ptw32_locktrace_reserved)
+    ? (unsigned long) -1
+    : ptw32_locktrace_reserved + limit;
+
+  ptw32_mcs_lock_release (&node);
+
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_locktrace_enabled, (LONG)PTW32_TRUE);
+
+  return 0;
+}
+
+
+void
+ptw32_locktrace_stop (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Turn recording off. Operations already under way may
+      *      still be recorded.
+      *
+      * ------------------------------------------------------
+      */
+{
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_locktrace_enabled, (LONG)PTW32_FALSE);
+}
+
+
+int
+ptw32_locktrace_write (const char * path)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Write the header and every record so far to a new
+      *      file, chunk by chunk. Records written while this runs
+      *      may or may not be included, so dump from a quiet
+      *      point for a trace that ends cleanly.
+      *
+      * RESULTS
+      *              0       successfully written,
+      *              EIO     the file couldn't be created or
+      *                      written.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_locktrace_chunk_t * chunk;
+  ptw32_locktrace_header_t header;
+  ptw32_mcs_local_node_t node;
+  LARGE_INTEGER frequency;
+  HANDLE file;
+  DWORD done;
+  DWORD total = 0;
+  int locked = PTW32_TRUE;
+  int result = 0;
+
+  if (ptw32_processExiting)
+    {
+      /* The system may have ended a thread that held the lock. */
+      locked = (0 == ptw32_mcs_lock_try_acquire (&ptw32_locktrace_lock, &node));
+    }
+  else
+    {
+      ptw32_mcs_lock_acquire (&ptw32_locktrace_lock, &node);
+    }
+
+  file = CreateFileA (path, GENERIC_WRITE, 0, NULL,
+		      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if (file == INVALID_HANDLE_VALUE)
+    {
+      result = EIO;
+      goto FAIL0;
+    }
+
+  /*
+   * The header goes in last, once the records have been counted.
+   */
+  memset (&header, 0, sizeof (header));
+
+  if (!WriteFile (file, &header, sizeof (header), &done, NULL))
+    {
+      result = EIO;
+      goto FAIL1;
+    }
+
+  for (chunk = ptw32_locktrace_chunks; chunk != NULL; chunk = chunk->next)
+    {
+      LONG count = (LONG) PTW32_INTERLOCKED_EXCHANGE_ADD((LPLONG)&chunk->count, 0L);
+
+      if (count > 0
+	  && !WriteFile (file, chunk->record,
+			 (DWORD) count * sizeof (ptw32_locktrace_record_t), &done, NULL))
+	{
+	  result = EIO;
+	  goto FAIL1;
+	}
+
+      total += (DWORD) count;
+    }
+
+  memcpy (header.magic, PTW32_LOCKTRACE_MAGIC, sizeof (header.magic));
+  header.version = PTW32_LOCKTRACE_VERSION;
+  header.recordSize = sizeof (ptw32_locktrace_record_t);
+  header.ticksPerSecond = QueryPerformanceFrequency (&frequency)
+    ? (ULONGLONG) frequency.QuadPart
+    : 1000;
+  header.baseTicks = ptw32_locktrace_baseTicks;
+  header.processId = GetCurrentProcessId ();
+  header.recordCount = total;
+  header.threadCount = (DWORD) ptw32_locktrace_threads;
+  header.objectCount = (DWORD) ptw32_locktrace_objects;
+  header.dropped = (DWORD) ptw32_locktrace_dropped;
+
+  if (SetFilePointer (file, 0, NULL, FILE_BEGIN) == INVALID_SET_FILE_POINTER
+      || !WriteFile (file, &header, sizeof (header), &done, NULL))
+    {
+      result = EIO;
+    }
+
+FAIL1:
+  CloseHandle (file);
+
+FAIL0:
+  if (locked)
+    {
+      ptw32_mcs_lock_release (&node);
+    }
+
+  return result;
+}
+
+
+void
+ptw32_locktrace_initialize (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Allocate the TLS slot that holds each thread's chunk
+      *      and, if the PTW32_LOCKTRACE environment variable
+      *      names a file, start recording now, up to
+      *      PTW32_LOCKTRACE_LIMIT records, and write them to that
+      *      file at process detach. If no TLS slot is available
+      *      the lock trace can't be used.
+      *
+      * ------------------------------------------------------
+      */
+{
+#if !defined(WINCE)
+  DWORD len;
+#endif
+
+  if (ptw32_locktrace_tlsIndex == TLS_OUT_OF_INDEXES)
+    {
+      if ((ptw32_locktrace_tlsIndex = TlsAlloc ()) == TLS_OUT_OF_INDEXES)
+	{
+	  return;
+	}
+    }
+
+  ptw32_locktrace_path[0] = '\0';
+
+#if !defined(WINCE)
+  len = GetEnvironmentVariableA ("PTW32_LOCKTRACE", ptw32_locktrace_path, MAX_PATH);
+
+  if (len > 0 && len < MAX_PATH)
+    {
+      (void) ptw32_locktrace_start (PTW32_LOCKTRACE_LIMIT);
+    }
+  else
+    {
+      ptw32_locktrace_path[0] = '\0';
+    }
+#endif
+}
+
+
+void
+ptw32_locktrace_terminate (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Stop recording, write the file requested through the
+      *      environment if any, and release the chunks unless the
+      *      process is exiting.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_locktrace_chunk_t * chunk, * next;
+
+  ptw32_locktrace_stop ();
+
+  if (ptw32_locktrace_path[0] != '\0')
+    {
+      (void) ptw32_locktrace_write (ptw32_locktrace_path);
+      ptw32_locktrace_path[0] = '\0';
+    }
+
+  if (ptw32_processExiting)
+    {
+      return;
+    }
+
+  for (chunk = ptw32_locktrace_chunks; chunk != NULL; chunk = next)
+    {
+      next = chunk->next;
+      free (chunk);
+    }
+
+  ptw32_locktrace_chunks = NULL;
+  ptw32_locktrace_last = NULL;
+  ptw32_locktrace_reserved = 0;
+  ptw32_locktrace_limit = 0;
+
+  if (ptw32_locktrace_tlsIndex != TLS_OUT_OF_INDEXES)
+    {
+      TlsFree (ptw32_locktrace_tlsIndex);
+      ptw32_locktrace_tlsIndex = TLS_OUT_OF_INDEXES;
+    }
+}
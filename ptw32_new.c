@@ -53,9 +53,12 @@ ptw32_new (void)
   if (NULL != t.p)
     {
       tp = (ptw32_thread_t *) t.p;
+      PTW32_STATS_INC(PTW32_STAT_THREAD_REUSE_HITS);
     }
   else
     {
+      PTW32_STATS_INC(PTW32_STAT_THREAD_REUSE_MISSES);
+
       /* No reuse threads available */
       tp = (ptw32_thread_t *) calloc (1, sizeof(ptw32_thread_t));
 
@@ -79,6 +82,12 @@ ptw32_new (void)
   tp->threadLock = 0;
   tp->robustMxListLock = 0;
   tp->robustMxList = NULL;
+  tp->interrupted = 0;
+  tp->exitEvent = NULL;
+  tp->group = NULL;
+  tp->mailHead = NULL;
+  tp->mailLocal = NULL;
+  tp->mailWaiting = 0;
   tp->cancelEvent = CreateEvent (0, (int) PTW32_TRUE,	/* manualReset  */
 				 (int) PTW32_FALSE,	/* setSignaled  */
 				 NULL);
@@ -89,6 +98,8 @@ ptw32_new (void)
       return nil;
     }
 
+  PTW32_STATS_INC(PTW32_STAT_THREAD_HANDLES);
+
   return t;
 
 }
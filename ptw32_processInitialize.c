@@ -77,6 +77,11 @@ ptw32_processInitialize (void)
 
   ptw32_processInitialized = PTW32_TRUE;
 
+  /*
+   * Before anything is counted.
+   */
+  ptw32_stats_export_initialize ();
+
   /*
    * Initialize Keys
    */
@@ -87,6 +92,21 @@ ptw32_processInitialize (void)
       ptw32_processTerminate ();
     }
 
+  ptw32_wait_policy_init ();
+
+  if (ptw32_processInitialized)
+    {
+      ptw32_profile_initialize ();
+      ptw32_locktrace_initialize ();
+    }
+
+#if defined(PTW32_TRACE)
+  if (ptw32_processInitialized)
+    {
+      ptw32_trace_initialize ();
+    }
+#endif
+
   return (ptw32_processInitialized);
 
 }				/* processInitialize */
@@ -56,6 +56,21 @@ ptw32_processTerminate (void)
       *      This routine sets the global variable
       *      ptw32_processInitialized to FALSE
       *
+      *      If ptw32_processExiting is set then all other threads
+      *      have already been terminated by the system and the
+      *      address space is about to go, so the keys and the
+      *      thread reuse stack are not released.
+      *
+      *      In trace builds any dump requested through the
+      *      PTW32_TRACE environment variable is written first.
+      *      A running watchdog (see pthread_watchdog_np()) is
+      *      stopped.
+      *      A contention profile requested through the
+      *      PTW32_PROFILE environment variable is written out,
+      *      as is a lock trace requested through PTW32_LOCKTRACE.
+      *      A statistics section (see pthread_stats_export_np())
+      *      is left with the final counts.
+      *
       * RESULTS
       *              N/A
       *
@@ -67,6 +82,33 @@ ptw32_processTerminate (void)
       ptw32_thread_t * tp, * tpNext;
       ptw32_mcs_local_node_t node;
 
+#if defined(PTW32_TRACE)
+      ptw32_trace_terminate ();
+#endif
+
+      if (ptw32_processExiting)
+	{
+	  ptw32_profile_terminate ();
+	  ptw32_locktrace_terminate ();
+	  ptw32_stats_export_terminate ();
+	  ptw32_processInitialized = PTW32_FALSE;
+	  return;
+	}
+
+      /*
+       * The watchdog thread runs library code, so it must stop
+       * before the library is unloaded.
+       */
+      (void) ptw32_watchdog_stop ();
+
+      ptw32_profile_terminate ();
+      ptw32_locktrace_terminate ();
+
+      /*
+       * Only once nothing else can update the counters.
+       */
+      ptw32_stats_export_terminate ();
+
       if (ptw32_selfThreadKey != NULL)
 	{
 	  /*
@@ -87,6 +129,34 @@ ptw32_processTerminate (void)
 	  ptw32_cleanupKey = NULL;
 	}
 
+      if (ptw32_tls_arena_key != NULL)
+	{
+	  /*
+	   * Release ptw32_tls_arena_key
+	   */
+	  pthread_key_delete (ptw32_tls_arena_key);
+
+	  ptw32_tls_arena_key = NULL;
+	}
+
+      /*
+       * A later initialisation (static library) starts a fresh
+       * arena layout. Deleted sized keys belong to the library.
+       */
+      while (ptw32_tls_arena_keys != NULL)
+	{
+	  pthread_key_t next = ptw32_tls_arena_keys->nextSized;
+
+	  if (ptw32_tls_arena_keys->generation == 0)
+	    {
+	      free (ptw32_tls_arena_keys);
+	    }
+	  ptw32_tls_arena_keys = next;
+	}
+      ptw32_tls_arena_last = NULL;
+      ptw32_tls_arena_end = 0;
+      ptw32_tls_arena_generation = 0;
+
       ptw32_mcs_lock_acquire(&ptw32_thread_reuse_lock, &node);
 
       tp = ptw32_threadReuseTop;
@@ -97,6 +167,9 @@ ptw32_processTerminate (void)
 	  tp = tpNext;
 	}
 
+      ptw32_threadReuseTop = PTW32_THREAD_REUSE_EMPTY;
+      ptw32_threadReuseBottom = PTW32_THREAD_REUSE_EMPTY;
+
       ptw32_mcs_lock_release(&node);
 
       ptw32_processInitialized = PTW32_FALSE;
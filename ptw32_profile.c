@@ -0,0 +1,672 @@
+/*
+ * ptw32_profile.c
+ *
+ * Description:
+ * This translation unit implements the contention profile.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+/*
+ * RtlCaptureStackBackTrace() (Windows XP and later), looked up on
+ * first use. Before XP nothing is captured and sites are told apart
+ * by type alone. Skip plus capture must stay below 63 on XP.
+ */
+#define PTW32_PROFILE_CAPTURE  (PTW32_PROFILE_DEPTH + 8)
+
+static int ptw32_profile_probed = PTW32_FALSE;
+static WORD (WINAPI *ptw32_profile_capture) (DWORD, DWORD, PVOID *, LPDWORD) = NULL;
+static PVOID ptw32_profile_module = NULL;
+
+static ptw32_profile_entry_t ptw32_profile_table[PTW32_PROFILE_SITES + 1];
+static ptw32_mcs_lock_t ptw32_profile_lock = 0;
+static LONG ptw32_profile_ticket = 0;
+static char ptw32_profile_path[MAX_PATH];
+static int ptw32_profile_atExit = PTW32_FALSE;
+
+
+static void
+ptw32_profile_probe (void)
+{
+  HMODULE kernel32 = GetModuleHandle (TEXT ("KERNEL32.DLL"));
+  MEMORY_BASIC_INFORMATION mbi;
+
+  if (kernel32 != NULL)
+    {
+#if defined(NEED_UNICODE_CONSTS)
+      ptw32_profile_capture = (WORD (WINAPI *) (DWORD, DWORD, PVOID *, LPDWORD))
+	GetProcAddress (kernel32,
+			(const TCHAR *) TEXT ("RtlCaptureStackBackTrace"));
+#else
+      ptw32_profile_capture = (WORD (WINAPI *) (DWORD, DWORD, PVOID *, LPDWORD))
+	GetProcAddress (kernel32, (LPCSTR) "RtlCaptureStackBackTrace");
+#endif
+    }
+
+#if !defined(PTW32_STATIC_LIB)
+  /*
+   * Frames in the library itself are dropped from the front of each
+   * capture. Linked statically, the library can't be told apart from
+   * the application, so they stay.
+   */
+  if (VirtualQuery ((LPCVOID) (size_t) ptw32_profile_probe, &mbi, sizeof (mbi)) != 0)
+    {
+      ptw32_profile_module = mbi.AllocationBase;
+    }
+#endif
+
+  ptw32_profile_probed = PTW32_TRUE;
+}
+
+
+static int
+ptw32_profile_stack (void ** frames)
+{
+  PVOID captured[PTW32_PROFILE_CAPTURE];
+  MEMORY_BASIC_INFORMATION mbi;
+  int n, first = 0, i;
+
+  if (!ptw32_profile_probed)
+    {
+      ptw32_profile_probe ();
+    }
+
+  if (ptw32_profile_capture == NULL)
+    {
+      return 0;
+    }
+
+  n = (int) ptw32_profile_capture (2, PTW32_PROFILE_CAPTURE, captured, NULL);
+
+  if (ptw32_profile_module != NULL)
+    {
+      while (first < n
+	     && VirtualQuery (captured[first], &mbi, sizeof (mbi)) != 0
+	     && mbi.AllocationBase == ptw32_profile_module)
+	{
+	  first++;
+	}
+    }
+
+  for (i = 0; i < PTW32_PROFILE_DEPTH && first + i < n; i++)
+    {
+      frames[i] = captured[first + i];
+    }
+
+  return i;
+}
+
+
+static ptw32_profile_entry_t *
+ptw32_profile_find (int type, void ** frames, int depth)
+{
+  ULONG hash = (ULONG) type * 2654435761UL;
+  ULONG i;
+  int n;
+
+  for (n = 0; n < depth; n++)
+    {
+      hash = (hash ^ (ULONG) (size_t) frames[n]) * 16777619UL;
+    }
+
+  for (n = 0, i = hash; n < PTW32_PROFILE_SITES; n++, i++)
+    {
+      ptw32_profile_entry_t * e = &ptw32_profile_table[i & (PTW32_PROFILE_SITES - 1)];
+
+      if (e->site.samples == 0)
+	{
+	  e->hash = hash;
+	  e->site.type = type;
+	  e->site.depth = depth;
+	  memcpy (e->site.frames, frames, depth * sizeof (void *));
+	  return e;
+	}
+
+      if (e->hash == hash
+	  && e->site.type == type
+	  && e->site.depth == depth
+	  && memcmp (e->site.frames, frames, depth * sizeof (void *)) == 0)
+	{
+	  return e;
+	}
+    }
+
+  return &ptw32_profile_table[PTW32_PROFILE_SITES];
+}
+
+
+void
+ptw32_profile_begin (ptw32_hook_state_t * state, int type)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called from ptw32_hook_before and through
+      *      PTW32_PROFILE_BEGIN as the calling thread starts to
+      *      wait. Every ptw32_profile_rate'th call on each thread
+      *      captures the call stack and counts a sample against
+      *      its site; ptw32_profile_end then adds the time waited.
+      *      A wait that blocks more than once is sampled at most
+      *      once.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int rate = ptw32_profile_rate;
+  ptw32_thread_t * tp;
+  ptw32_profile_entry_t * e;
+  ptw32_mcs_local_node_t node;
+  void * frames[PTW32_PROFILE_DEPTH];
+  int depth;
+
+  if (state->site != 0 || rate <= 0)
+    {
+      return;
+    }
+
+  tp = (ptw32_thread_t *) pthread_getspecific (ptw32_selfThreadKey);
+
+  if (tp != NULL)
+    {
+      if (tp->profileCountdown > 1)
+	{
+	  tp->profileCountdown--;
+	  return;
+	}
+      tp->profileCountdown = rate;
+
+      if (tp->watchRwlock != NULL)
+	{
+	  type = PTW32_WAIT_RWLOCK;
+	}
+    }
+  else if ((ULONG) PTW32_INTERLOCKED_INCREMENT(&ptw32_profile_ticket) % (ULONG) rate != 0)
+    {
+      /* Not a POSIX thread yet, so no countdown of its own. */
+      return;
+    }
+
+  depth = ptw32_profile_stack (frames);
+
+  ptw32_mcs_lock_acquire (&ptw32_profile_lock, &node);
+  e = ptw32_profile_find (type, frames, depth);
+  e->site.samples++;
+  ptw32_mcs_lock_release (&node);
+
+  state->site = (int) (e - ptw32_profile_table) + 1;
+
+  if (state->start == 0)
+    {
+      state->start = ptw32_hook_now ();
+    }
+}
+
+
+void
+ptw32_profile_end (ptw32_hook_state_t * state, unsigned long long nanoseconds)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Adds a block of 'nanoseconds' to the site sampled by
+      *      ptw32_profile_begin. Called from ptw32_hook_after and
+      *      through PTW32_PROFILE_END.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_profile_entry_t * e = &ptw32_profile_table[state->site - 1];
+  ptw32_mcs_local_node_t node;
+
+  ptw32_mcs_lock_acquire (&ptw32_profile_lock, &node);
+
+  /* Skip sites cleared by pthread_profile_reset_np() meanwhile. */
+  if (e->site.samples != 0)
+    {
+      e->site.waited += nanoseconds;
+      if (nanoseconds > e->site.maxWaited)
+	{
+	  e->site.maxWaited = nanoseconds;
+	}
+    }
+
+  ptw32_mcs_lock_release (&node);
+}
+
+
+int
+ptw32_profile_start (int rate)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Sets the sampling rate, 0 to stop sampling, and turns
+      *      the calls from the wait routines on or off to match.
+      *      Collected sites are kept.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (rate < 0)
+    {
+      return EINVAL;
+    }
+
+  if (rate != 0)
+    {
+      /* Used before the rate is set: see PTW32_WATCH_LEAVE. */
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_profile_used, (LONG)PTW32_TRUE);
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_profile_rate, (LONG)rate);
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_wait_hooks_active, (LONG)PTW32_TRUE);
+    }
+  else
+    {
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_profile_rate, 0L);
+
+      if (ptw32_wait_hooks.beforeBlock == NULL
+	  && ptw32_wait_hooks.afterWake == NULL
+	  && ptw32_wait_hooks.acquiredAfterContention == NULL
+	  && !ptw32_watchdog_active)
+	{
+	  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_wait_hooks_active, (LONG)PTW32_FALSE);
+	}
+    }
+
+  return 0;
+}
+
+
+int
+ptw32_profile_snapshot (struct ptw32_profile_site * sites, int max)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Copies up to 'max' sites with samples into 'sites', in
+      *      table order, and returns how many sites there are.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+  int locked = PTW32_TRUE;
+  int i, n = 0;
+
+  if (ptw32_processExiting)
+    {
+      /* The system may have ended a thread that held the lock. */
+      locked = (0 == ptw32_mcs_lock_try_acquire (&ptw32_profile_lock, &node));
+    }
+  else
+    {
+      ptw32_mcs_lock_acquire (&ptw32_profile_lock, &node);
+    }
+
+  for (i = 0; i <= PTW32_PROFILE_SITES; i++)
+    {
+      if (ptw32_profile_table[i].site.samples != 0)
+	{
+	  if (n < max)
+	    {
+	      sites[n] = ptw32_profile_table[i].site;
+	    }
+	  n++;
+	}
+    }
+
+  if (locked)
+    {
+      ptw32_mcs_lock_release (&node);
+    }
+
+  return n;
+}
+
+
+void
+ptw32_profile_reset (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Discards every site.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+
+  ptw32_mcs_lock_acquire (&ptw32_profile_lock, &node);
+  memset (ptw32_profile_table, 0, sizeof (ptw32_profile_table));
+  ptw32_mcs_lock_release (&node);
+}
+
+
+/*
+ * The library does not use stdio, so the dump is formatted by hand.
+ */
+static char *
+ptw32_profile_format (char * p, const char * s)
+{
+  while (*s != '\0')
+    {
+      *p++ = *s++;
+    }
+
+  return p;
+}
+
+
+static char *
+ptw32_profile_format_number (char * p, unsigned long long value, unsigned base)
+{
+  char digits[24];
+  int n = 0;
+
+  do
+    {
+      digits[n++] = "0123456789abcdef"[value % base];
+      value /= base;
+    }
+  while (value != 0);
+
+  while (n > 0)
+    {
+      *p++ = digits[--n];
+    }
+
+  return p;
+}
+
+
+/*
+ * "module+0x1234", or "0x12345678" outside any module. The module is
+ * named without its directory, so that dumps from different machines
+ * compare.
+ */
+static char *
+ptw32_profile_format_frame (char * p, void * frame)
+{
+  MEMORY_BASIC_INFORMATION mbi;
+  char path[MAX_PATH];
+  const char * name = path;
+  const char * s;
+
+  if (VirtualQuery (frame, &mbi, sizeof (mbi)) != 0
+      && mbi.AllocationBase != NULL
+      && GetModuleFileNameA ((HMODULE) mbi.AllocationBase, path, MAX_PATH) > 0)
+    {
+      path[MAX_PATH - 1] = '\0';
+      for (s = path; *s != '\0'; s++)
+	{
+	  if (*s == '\\' || *s == '/')
+	    {
+	      name = s + 1;
+	    }
+	}
+      p = ptw32_profile_format (p, name);
+      p = ptw32_profile_format (p, "+0x");
+      return ptw32_profile_format_number (p, (size_t) frame - (size_t) mbi.AllocationBase, 16);
+    }
+
+  p = ptw32_profile_format (p, "0x");
+  return ptw32_profile_format_number (p, (size_t) frame, 16);
+}
+
+
+static void
+ptw32_profile_put (HANDLE file, const char * line, char * end)
+{
+  DWORD written;
+
+  *end = '\0';
+
+  if (file == INVALID_HANDLE_VALUE)
+    {
+      OutputDebugStringA (line);
+    }
+  else
+    {
+      (void) WriteFile (file, line, (DWORD) (end - line), &written, NULL);
+    }
+}
+
+
+int
+ptw32_profile_write (const char * path, int rate)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Writes the sites, most time waited first, as text to
+      *      the file 'path', or to the debugger if 'path' is NULL.
+      *      'rate' is only for the header:
+      *
+      *        # pthreads-win32 contention profile, 1 in 100 waits
+      *        # type samples wait_usec max_usec frames...
+      *        mutex 120 53012 2044 app.exe+0x1a2b3 app.exe+0x1c000
+      *
+      *      Fields are separated by tabs.
+      *
+      * ------------------------------------------------------
+      */
+{
+  static const char * names[] = {
+    "unattributed", "mutex", "cond", "semaphore", "barrier", "join", "rwlock", "spin"
+  };
+  struct ptw32_profile_site * sites;
+  struct ptw32_profile_site tmp;
+  HANDLE file = INVALID_HANDLE_VALUE;
+  char line[64 + PTW32_PROFILE_DEPTH * (MAX_PATH + 24)];
+  char * p;
+  int n, i, j, type;
+
+  sites = (struct ptw32_profile_site *)
+    calloc (PTW32_PROFILE_SITES + 1, sizeof (struct ptw32_profile_site));
+
+  if (sites == NULL)
+    {
+      return ENOMEM;
+    }
+
+  n = ptw32_profile_snapshot (sites, PTW32_PROFILE_SITES + 1);
+
+  /* At most a few hundred, so a simple sort will do. */
+  for (i = 1; i < n; i++)
+    {
+      tmp = sites[i];
+      for (j = i; j > 0 && sites[j - 1].waited < tmp.waited; j--)
+	{
+	  sites[j] = sites[j - 1];
+	}
+      sites[j] = tmp;
+    }
+
+  if (path != NULL)
+    {
+      file = CreateFileA (path, GENERIC_WRITE, 0, NULL,
+			  CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+      if (file == INVALID_HANDLE_VALUE)
+	{
+	  free (sites);
+	  return EIO;
+	}
+    }
+
+  p = ptw32_profile_format (line, "# pthreads-win32 contention profile, 1 in ");
+  p = ptw32_profile_format_number (p, (unsigned) rate, 10);
+  p = ptw32_profile_format (p, " waits\n# type\tsamples\twait_usec\tmax_usec\tframes\n");
+  ptw32_profile_put (file, line, p);
+
+  for (i = 0; i < n; i++)
+    {
+      type = sites[i].type;
+      if (type < 0 || type >= (int) (sizeof (names) / sizeof (names[0])))
+	{
+	  type = 0;
+	}
+
+      p = ptw32_profile_format (line, names[type]);
+      *p++ = '\t';
+      p = ptw32_profile_format_number (p, sites[i].samples, 10);
+      *p++ = '\t';
+      p = ptw32_profile_format_number (p, sites[i].waited / 1000, 10);
+      *p++ = '\t';
+      p = ptw32_profile_format_number (p, sites[i].maxWaited / 1000, 10);
+      for (j = 0; j < sites[i].depth; j++)
+	{
+	  *p++ = j == 0 ? '\t' : ' ';
+	  p = ptw32_profile_format_frame (p, sites[i].frames[j]);
+	}
+      *p++ = '\n';
+      ptw32_profile_put (file, line, p);
+    }
+
+  if (file != INVALID_HANDLE_VALUE)
+    {
+      (void) CloseHandle (file);
+    }
+
+  free (sites);
+
+  return 0;
+}
+
+
+#if !defined(WINCE)
+static int
+ptw32_profile_match (const char * s, const char * item)
+{
+  while (*item != '\0')
+    {
+      if (*s++ != *item++)
+	{
+	  return PTW32_FALSE;
+	}
+    }
+
+  return PTW32_TRUE;
+}
+#endif
+
+
+void
+ptw32_profile_initialize (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Starts profiling if the PTW32_PROFILE environment
+      *      variable is set, e.g.
+      *
+      *        PTW32_PROFILE=rate=50,file=c:\tmp\app.prof
+      *
+      *      Both items may be left out; 'file' takes the rest of
+      *      the value. The profile is written out at process
+      *      detach, to the debugger if there is no file.
+      *
+      * ------------------------------------------------------
+      */
+{
+#if !defined(WINCE)
+  char value[MAX_PATH + 32];
+  char * s = value;
+  DWORD len = GetEnvironmentVariableA (PTW32_PROFILE_ENV, value, (DWORD) sizeof (value));
+  int rate = PTW32_PROFILE_RATE_DEFAULT;
+  int i;
+
+  if (len == 0 || len >= sizeof (value))
+    {
+      return;
+    }
+
+  ptw32_profile_path[0] = '\0';
+
+  while (*s != '\0')
+    {
+      if (ptw32_profile_match (s, "rate="))
+	{
+	  rate = 0;
+	  for (s += 5; *s >= '0' && *s <= '9' && rate < 100000000; s++)
+	    {
+	      rate = rate * 10 + (*s - '0');
+	    }
+	}
+      else if (ptw32_profile_match (s, "file="))
+	{
+	  for (s += 5, i = 0; *s != '\0' && i < MAX_PATH - 1; s++, i++)
+	    {
+	      ptw32_profile_path[i] = *s;
+	    }
+	  ptw32_profile_path[i] = '\0';
+	  break;
+	}
+
+      if (*s == ',')
+	{
+	  s++;
+	}
+      else if (*s != '\0')
+	{
+	  /* Not understood: leave profiling off. */
+	  return;
+	}
+    }
+
+  if (rate > 0)
+    {
+      ptw32_profile_atExit = PTW32_TRUE;
+      (void) ptw32_profile_start (rate);
+    }
+#endif
+}
+
+
+void
+ptw32_profile_terminate (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Stops sampling and writes the profile requested
+      *      through the environment, if any.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int rate = ptw32_profile_rate;
+
+  if (!ptw32_profile_atExit)
+    {
+      return;
+    }
+
+  ptw32_profile_atExit = PTW32_FALSE;
+  (void) ptw32_profile_start (0);
+  (void) ptw32_profile_write (ptw32_profile_path[0] != '\0' ? ptw32_profile_path : NULL,
+			      rate);
+}
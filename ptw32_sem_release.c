@@ -0,0 +1,125 @@
+/*
+ * ptw32_sem_release.c
+ *
+ * Description:
+ * This translation unit implements semaphores.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "semaphore.h"
+#include "implement.h"
+
+
+int
+ptw32_sem_release (sem_t s, int count)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Hand 'count' tokens to the waiters on a semaphore.
+      *      The caller holds s->lock and has checked that the
+      *      value cannot exceed SEM_VALUE_MAX.
+      *
+      * DESCRIPTION
+      *      Threads blocked in sem_wait() or sem_timedwait() on the
+      *      W32 sema (counted by a negative value) queued first and
+      *      are released first. The remaining tokens go to the
+      *      sem_wait_n_np() queue (see ptw32_sem_waiter_t): each
+      *      waiter at the head collects tokens until it has all it
+      *      asked for, then is dequeued and woken. Whatever is left
+      *      over is added to the value.
+      *
+      * RESULTS
+      *              0               tokens released,
+      *              EINVAL          the W32 sema could not be released.
+      *
+      * ------------------------------------------------------
+      */
+{
+  long waiters = -s->value;
+  ptw32_sem_waiter_t * w;
+
+  if (waiters > 0)
+    {
+      long n = (waiters <= count) ? waiters : count;
+
+      s->wakerThread = GetCurrentThreadId ();
+      s->value += n;
+#ifdef NEED_SEM
+      if (SetEvent(s->sem))
+	{
+	  s->leftToUnblock += n - 1;
+	  if (s->leftToUnblock > waiters - 1)
+	    {
+	      s->leftToUnblock = waiters - 1;
+	    }
+	}
+#else
+      if (ReleaseSemaphore (s->sem, n, 0))
+	{
+	  /* No action */
+	}
+#endif
+      else
+	{
+	  s->value -= n;
+	  return EINVAL;
+	}
+      count -= n;
+    }
+
+  while (count > 0 && (w = s->waitersHead) != NULL)
+    {
+      int take = w->n - w->got;
+
+      if (take > count)
+	{
+	  take = count;
+	}
+      w->got += take;
+      count -= take;
+
+      if (w->got == w->n)
+	{
+	  if ((s->waitersHead = w->next) == NULL)
+	    {
+	      s->waitersTail = NULL;
+	    }
+	  w->next = NULL;
+	  s->wakerThread = GetCurrentThreadId ();
+	  (void) SetEvent (w->event);
+	}
+    }
+
+  s->value += count;
+
+  return 0;
+}
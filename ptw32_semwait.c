@@ -75,9 +75,13 @@ ptw32_semwait (sem_t * sem)
     }
   else
     {
+      /* See sem_wait() */
+      (void) PTW32_SPIN_WAIT((volatile LONG *) &s->value, PTW32_SPIN_UNTIL_POSITIVE);
+
       if ((result = pthread_mutex_lock (&s->lock)) == 0)
         {
           int v;
+          DWORD status;
 
 	  /* See sem_destroy.c
 	   */
@@ -94,7 +98,12 @@ ptw32_semwait (sem_t * sem)
           if (v < 0)
             {
               /* Must wait */
-              if (WaitForSingleObject (s->sem, INFINITE) == WAIT_OBJECT_0)
+              PTW32_STATS_INC(PTW32_STAT_SEM_WAITS);
+              PTW32_TRACE_EVENT(PTW32_TRACE_SEM_WAIT_BEGIN, s, 0);
+              status = WaitForSingleObject (s->sem, INFINITE);
+              PTW32_TRACE_EVENT(PTW32_TRACE_SEM_WAIT_END, s,
+                                status == WAIT_OBJECT_0 ? 0 : EINVAL);
+              if (status == WAIT_OBJECT_0)
 		{
 #ifdef NEED_SEM
 		  if (pthread_mutex_lock (&s->lock) == 0)
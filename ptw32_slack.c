@@ -0,0 +1,203 @@
+/*
+ * ptw32_slack.c
+ *
+ * Description:
+ * This translation unit implements timer slack for timed waits.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+#if !defined(WINCE)
+/*
+ * SetWaitableTimerEx() (Windows 7 and later), looked up on first use.
+ * Without it slack timers are aligned but not tolerant.
+ */
+static int ptw32_slack_probed = PTW32_FALSE;
+static BOOL (WINAPI *ptw32_slack_set) (HANDLE, const LARGE_INTEGER *, LONG,
+				       PVOID, LPVOID, PVOID, ULONG) = NULL;
+#endif
+
+
+static ULONGLONG
+ptw32_slack_now (void)
+{
+  FILETIME ft;
+
+#if defined(WINCE)
+  SYSTEMTIME st;
+
+  GetSystemTime (&st);
+  SystemTimeToFileTime (&st, &ft);
+#else
+  GetSystemTimeAsFileTime (&ft);
+#endif
+
+  return ((ULONGLONG) ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+}
+
+
+/*
+ * The boundary waits are aligned to: the largest power of two
+ * milliseconds that is no more than the slack, so that waiters with
+ * the same slack, or slacks within a factor of two, share boundaries.
+ */
+static ULONGLONG
+ptw32_slack_granule (DWORD slack)
+{
+  DWORD g = 1;
+
+  while (g <= slack / 2 && g < PTW32_SLACK_GRANULE_MAX)
+    {
+      g *= 2;
+    }
+
+  return (ULONGLONG) g * 10000;	/* FILETIME units */
+}
+
+
+DWORD
+ptw32_slack_timeout (DWORD timeout, DWORD slack)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Returns 'timeout' (milliseconds) lengthened by less
+      *      than 'slack' so that it ends on a shared boundary.
+      *      Used where no slack timer can be armed.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ULONGLONG g, now, due;
+
+  if (timeout == 0 || timeout == INFINITE || slack == 0)
+    {
+      return timeout;
+    }
+
+  g = ptw32_slack_granule (slack);
+  now = ptw32_slack_now ();
+  due = ((now + (ULONGLONG) timeout * 10000 + g - 1) / g) * g;
+  due = (due - now + 9999) / 10000;
+
+  return (due >= INFINITE) ? timeout : (DWORD) due;
+}
+
+
+int
+ptw32_slack_arm (ptw32_thread_t * sp, DWORD timeout, DWORD slack)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Arms the calling thread's slack timer to fire on the
+      *      first shared boundary at least 'timeout' milliseconds
+      *      from now, allowing the system to fire it later by
+      *      what is left of 'slack' so that it can wake other
+      *      timers with it. The timer is created on first use.
+      *
+      *      The boundary is in system time, so it is the same
+      *      instant for every waiter however late each one got
+      *      here.
+      *
+      * RESULTS
+      *              PTW32_TRUE      sp->slackTimer is armed,
+      *              PTW32_FALSE     no timer: wait for
+      *                              ptw32_slack_timeout() instead.
+      *
+      * ------------------------------------------------------
+      */
+{
+#if defined(WINCE)
+  return PTW32_FALSE;
+#else
+  ULONGLONG g, end;
+  LARGE_INTEGER due;
+  DWORD tolerance;
+
+  if (sp->slackTimer == NULL)
+    {
+      if ((sp->slackTimer = CreateWaitableTimer (NULL, PTW32_TRUE, NULL)) == NULL)
+	{
+	  return PTW32_FALSE;
+	}
+      PTW32_STATS_INC(PTW32_STAT_THREAD_HANDLES);
+    }
+
+  if (!ptw32_slack_probed)
+    {
+      HMODULE kernel32 = GetModuleHandle (TEXT ("KERNEL32.DLL"));
+
+      if (kernel32 != NULL)
+	{
+#if defined(NEED_UNICODE_CONSTS)
+	  ptw32_slack_set = (BOOL (WINAPI *) (HANDLE, const LARGE_INTEGER *, LONG,
+					      PVOID, LPVOID, PVOID, ULONG))
+	    GetProcAddress (kernel32, (const TCHAR *) TEXT ("SetWaitableTimerEx"));
+#else
+	  ptw32_slack_set = (BOOL (WINAPI *) (HANDLE, const LARGE_INTEGER *, LONG,
+					      PVOID, LPVOID, PVOID, ULONG))
+	    GetProcAddress (kernel32, (LPCSTR) "SetWaitableTimerEx");
+#endif
+	}
+
+      ptw32_slack_probed = PTW32_TRUE;
+    }
+
+  g = ptw32_slack_granule (slack);
+  end = ptw32_slack_now () + (ULONGLONG) timeout * 10000;
+  due.QuadPart = (LONGLONG) (((end + g - 1) / g) * g);	/* Positive: absolute */
+  tolerance = slack - (DWORD) (((ULONGLONG) due.QuadPart - end) / 10000);
+
+  if (ptw32_slack_set != NULL)
+    {
+      return ptw32_slack_set (sp->slackTimer, &due, 0, NULL, NULL, NULL, tolerance) != 0;
+    }
+
+  return SetWaitableTimer (sp->slackTimer, &due, 0, NULL, NULL, PTW32_FALSE) != 0;
+#endif
+}
+
+
+void PTW32_CDECL
+ptw32_slack_call_end (void * arg)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Ends the per-call slack of a *_slack_np() wait, on
+      *      return or as a cancellation cleanup handler.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ((ptw32_thread_t *) arg)->callSlack = 0;
+}
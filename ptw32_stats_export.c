@@ -0,0 +1,240 @@
+/*
+ * ptw32_stats_export.c
+ *
+ * Description:
+ * This translation unit exports the library counters to shared memory.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+/* Shards start on a cache line after the header. */
+#define PTW32_STATS_EXPORT_OFFSET 64
+
+static ptw32_mcs_lock_t ptw32_stats_export_lock = 0;
+static HANDLE ptw32_stats_export_mapping = NULL;
+static struct ptw32_stats_export * ptw32_stats_export_view = NULL;
+
+
+int
+ptw32_stats_export_start (const char * name)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Creates the section 'name', moves the counters into
+      *      it and switches the library over to updating them
+      *      there. A section of that name left by an earlier
+      *      attach of the library in this process is reused.
+      *
+      * RESULTS
+      *              0               success,
+      *              EBUSY           already exporting,
+      *              EEXIST          another process has a section
+      *                              of that name,
+      *              EAGAIN          the section couldn't be created,
+      *              ENOMEM          the section couldn't be mapped.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+  ptw32_stats_shard_t * shards;
+  HANDLE mapping;
+  struct ptw32_stats_export * view;
+  DWORD size = PTW32_STATS_EXPORT_OFFSET + sizeof (ptw32_stats_local);
+  int existed;
+  int result = 0;
+  int i, j;
+
+  ptw32_mcs_lock_acquire (&ptw32_stats_export_lock, &node);
+
+  if (ptw32_stats_export_view != NULL)
+    {
+      result = EBUSY;
+      goto FAIL0;
+    }
+
+  mapping = CreateFileMappingA (INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+				0, size, name);
+
+  if (mapping == NULL)
+    {
+      result = EAGAIN;
+      goto FAIL0;
+    }
+
+  existed = (GetLastError () == ERROR_ALREADY_EXISTS);
+
+  view = (struct ptw32_stats_export *) MapViewOfFile (mapping, FILE_MAP_WRITE, 0, 0, size);
+
+  if (view == NULL)
+    {
+      result = ENOMEM;
+      goto FAIL1;
+    }
+
+  if (existed
+      && (view->magic != PTW32_STATS_EXPORT_MAGIC
+	  || view->version != PTW32_STATS_EXPORT_VERSION
+	  || view->processId != GetCurrentProcessId ()))
+    {
+      result = EEXIST;
+      goto FAIL2;
+    }
+
+  /*
+   * Readers retry while the sequence is odd. A reused section still
+   * holds the values it was left with, which we also hold.
+   */
+  (void) PTW32_INTERLOCKED_INCREMENT((LPLONG)&view->sequence);
+
+  view->magic = PTW32_STATS_EXPORT_MAGIC;
+  view->version = PTW32_STATS_EXPORT_VERSION;
+  view->processId = GetCurrentProcessId ();
+  view->counters = PTW32_STAT_COUNT;
+  view->shards = PTW32_STATS_SHARDS;
+  view->shardSize = sizeof (ptw32_stats_shard_t);
+  view->offset = PTW32_STATS_EXPORT_OFFSET;
+
+  shards = (ptw32_stats_shard_t *) ((char *) view + PTW32_STATS_EXPORT_OFFSET);
+  memset (shards, 0, sizeof (ptw32_stats_local));
+
+  /*
+   * Switch first, then move what has been counted so far. An update
+   * by a thread that read the old pointer just before the switch
+   * and lands after its counter has been moved is lost, so set
+   * PTW32_STATS_EXPORT to export from the start.
+   */
+  (void) PTW32_INTERLOCKED_EXCHANGE_PTR((PVOID volatile *)&ptw32_stats_shards, (PVOID) shards);
+
+  for (i = 0; i < PTW32_STATS_SHARDS; i++)
+    {
+      for (j = 0; j < PTW32_STAT_COUNT; j++)
+	{
+	  LONG n = (LONG) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_stats_local[i].counter[j], 0L);
+
+	  if (n != 0)
+	    {
+	      (void) PTW32_INTERLOCKED_EXCHANGE_ADD((LPLONG)&shards[i].counter[j], n);
+	    }
+	}
+    }
+
+  view->state = PTW32_STATS_EXPORT_LIVE;
+  (void) PTW32_INTERLOCKED_INCREMENT((LPLONG)&view->sequence);
+
+  ptw32_stats_export_mapping = mapping;
+  ptw32_stats_export_view = view;
+
+  ptw32_mcs_lock_release (&node);
+
+  return 0;
+
+FAIL2:
+  (void) UnmapViewOfFile (view);
+
+FAIL1:
+  (void) CloseHandle (mapping);
+
+FAIL0:
+  ptw32_mcs_lock_release (&node);
+
+  return result;
+}
+
+
+void
+ptw32_stats_export_initialize (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      If the PTW32_STATS_EXPORT environment variable names
+      *      a section, export to it. Called first thing at
+      *      process attach so that no counts are missed.
+      *
+      * ------------------------------------------------------
+      */
+{
+  char name[MAX_PATH];
+  DWORD len = GetEnvironmentVariableA ("PTW32_STATS_EXPORT", name, MAX_PATH);
+
+  if (len > 0 && len < MAX_PATH)
+    {
+      (void) ptw32_stats_export_start (name);
+    }
+}
+
+
+void
+ptw32_stats_export_terminate (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Marks the section detached, leaving the final values
+      *      in it for readers that still have it open. Unless
+      *      the process is exiting, the counters move back to
+      *      ptw32_stats_local and the section is unmapped.
+      *
+      * ------------------------------------------------------
+      */
+{
+  struct ptw32_stats_export * view = ptw32_stats_export_view;
+  ptw32_stats_shard_t * shards;
+
+  if (view == NULL)
+    {
+      return;
+    }
+
+  (void) PTW32_INTERLOCKED_INCREMENT((LPLONG)&view->sequence);
+  view->state = PTW32_STATS_EXPORT_DETACHED;
+
+  if (!ptw32_processExiting)
+    {
+      shards = (ptw32_stats_shard_t *) ((char *) view + PTW32_STATS_EXPORT_OFFSET);
+      ptw32_stats_shards = ptw32_stats_local;
+      memcpy (ptw32_stats_local, shards, sizeof (ptw32_stats_local));
+    }
+
+  (void) PTW32_INTERLOCKED_INCREMENT((LPLONG)&view->sequence);
+
+  if (ptw32_processExiting)
+    {
+      return;
+    }
+
+  (void) UnmapViewOfFile (view);
+  (void) CloseHandle (ptw32_stats_export_mapping);
+  ptw32_stats_export_view = NULL;
+  ptw32_stats_export_mapping = NULL;
+}
@@ -47,6 +47,8 @@ ptw32_threadDestroy (pthread_t thread)
 
   if (tp != NULL)
     {
+      ptw32_group_leave (tp);
+
       /*
        * Copy thread state so that the thread can be atomically NULLed.
        */
@@ -62,6 +64,32 @@ ptw32_threadDestroy (pthread_t thread)
       if (threadCopy.cancelEvent != NULL)
 	{
 	  CloseHandle (threadCopy.cancelEvent);
+	  PTW32_STATS_DEC(PTW32_STAT_THREAD_HANDLES);
+	}
+
+      if (threadCopy.exitEvent != NULL)
+	{
+	  CloseHandle (threadCopy.exitEvent);
+	  PTW32_STATS_DEC(PTW32_STAT_THREAD_HANDLES);
+	}
+
+      if (threadCopy.slackTimer != NULL)
+	{
+	  CloseHandle (threadCopy.slackTimer);
+	  PTW32_STATS_DEC(PTW32_STAT_THREAD_HANDLES);
+	}
+
+      /* Messages still queued are dropped; the library never owns them. */
+      if (threadCopy.mailEvent != NULL)
+	{
+	  CloseHandle (threadCopy.mailEvent);
+	  PTW32_STATS_DEC(PTW32_STAT_THREAD_HANDLES);
+	}
+
+      if (threadCopy.parkEvent != NULL)
+	{
+	  CloseHandle (threadCopy.parkEvent);
+	  PTW32_STATS_DEC(PTW32_STAT_THREAD_HANDLES);
 	}
 
 #if ! (defined(__MINGW64__) || defined(__MINGW32__)) || defined (__MSVCRT__) || defined (__DMC__)
@@ -71,6 +99,7 @@ ptw32_threadDestroy (pthread_t thread)
       if (threadCopy.threadH != 0)
 	{
 	  CloseHandle (threadCopy.threadH);
+	  PTW32_STATS_DEC(PTW32_STAT_THREAD_HANDLES);
 	}
 #endif
 
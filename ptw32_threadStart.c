@@ -161,6 +161,14 @@ ptw32_threadStart (void *vthreadParms)
    */
   ptw32_mcs_lock_acquire (&sp->stateLock, &stateLock);
   pthread_setspecific (ptw32_selfThreadKey, sp);
+  /*
+   * pthread_create() couldn't name us before we started without
+   * the thread id.
+   */
+  if (sp->name[0] != '\0')
+    {
+      ptw32_thread_name_publish (sp->threadH, sp->thread, sp->name);
+    }
 #else
   pthread_setspecific (ptw32_selfThreadKey, sp);
   ptw32_mcs_lock_acquire (&sp->stateLock, &stateLock);
@@ -169,6 +177,8 @@ ptw32_threadStart (void *vthreadParms)
   sp->state = PThreadStateRunning;
   ptw32_mcs_lock_release (&stateLock);
 
+  PTW32_TRACE_EVENT(PTW32_TRACE_THREAD_START, sp, 0);
+
 #ifdef __CLEANUP_SEH
 
   __try
@@ -317,6 +327,24 @@ ptw32_threadStart (void *vthreadParms)
 #endif /* __CLEANUP_C */
 #endif /* __CLEANUP_SEH */
 
+  /*
+   * As far as a joiner is concerned we are done once the TSD
+   * destructors have run, so run them now and release the joiner
+   * without waiting for the rest of thread detach, which includes
+   * every loaded DLL's DLL_THREAD_DETACH. Running the destructors
+   * again from pthread_win32_thread_detach_np() finds nothing to do.
+   */
+  if (sp->exitEvent != NULL)
+    {
+      ptw32_callUserDestroyRoutines (self);
+      SetEvent (sp->exitEvent);
+    }
+
+  if (sp->group != NULL)
+    {
+      ptw32_group_exited (sp);
+    }
+
 #if defined(PTW32_STATIC_LIB)
   /*
    * We need to cleanup the pthread now if we have
@@ -0,0 +1,140 @@
+/*
+ * ptw32_thread_name.c
+ *
+ * Description:
+ * This translation unit passes thread names to debuggers and profilers.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+/*
+ * SetThreadDescription() (Windows 10 1607 and later), looked up on
+ * first use. Threads racing here look up the same address.
+ */
+static int ptw32_thread_name_probed = PTW32_FALSE;
+static HRESULT (WINAPI *ptw32_thread_name_set) (HANDLE, const WCHAR *) = NULL;
+
+
+#if defined(_MSC_VER)
+
+/*
+ * The structure older debuggers expect with the 0x406D1388
+ * exception (MSDN "How to: Set a Thread Name in Native Code").
+ */
+#pragma pack(push, 8)
+typedef struct
+{
+  DWORD dwType;			/* Must be 0x1000 */
+  LPCSTR szName;
+  DWORD dwThreadID;
+  DWORD dwFlags;		/* Must be 0 */
+} ptw32_thread_name_info_t;
+#pragma pack(pop)
+
+static void
+ptw32_thread_name_raise (DWORD threadId, const char * name)
+{
+  ptw32_thread_name_info_t info;
+
+  info.dwType = 0x1000;
+  info.szName = name;
+  info.dwThreadID = threadId;
+  info.dwFlags = 0;
+
+  __try
+  {
+    RaiseException (0x406D1388, 0, sizeof (info) / sizeof (ULONG_PTR),
+		    (const ULONG_PTR *) &info);
+  }
+  __except (EXCEPTION_EXECUTE_HANDLER)
+  {
+  }
+}
+
+#endif /* _MSC_VER */
+
+
+void
+ptw32_thread_name_publish (HANDLE threadH, DWORD threadId, const char * name)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Gives the Win32 thread the name 'name' (UTF-8), with
+      *      SetThreadDescription() where the system has it, so
+      *      that debuggers, profilers and crash dumps show it.
+      *      Otherwise, in MSVC builds and only while a debugger
+      *      is attached, raises the exception debuggers have
+      *      traditionally read thread names from. Does nothing
+      *      if neither is possible.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (!ptw32_thread_name_probed)
+    {
+      HMODULE kernel32 = GetModuleHandle (TEXT ("KERNEL32.DLL"));
+
+      if (kernel32 != NULL)
+	{
+#if defined(NEED_UNICODE_CONSTS)
+	  ptw32_thread_name_set = (HRESULT (WINAPI *) (HANDLE, const WCHAR *))
+	    GetProcAddress (kernel32,
+			    (const TCHAR *) TEXT ("SetThreadDescription"));
+#else
+	  ptw32_thread_name_set = (HRESULT (WINAPI *) (HANDLE, const WCHAR *))
+	    GetProcAddress (kernel32, (LPCSTR) "SetThreadDescription");
+#endif
+	}
+
+      ptw32_thread_name_probed = PTW32_TRUE;
+    }
+
+  if (ptw32_thread_name_set != NULL && threadH != 0)
+    {
+      WCHAR wide[PTW32_THREAD_NAME_MAX];
+
+      if (MultiByteToWideChar (CP_UTF8, 0, name, -1, wide, PTW32_THREAD_NAME_MAX) > 0
+	  && ptw32_thread_name_set (threadH, wide) >= 0)
+	{
+	  return;
+	}
+    }
+
+#if defined(_MSC_VER)
+  if (IsDebuggerPresent ())
+    {
+      ptw32_thread_name_raise (threadId, name);
+    }
+#endif
+}
@@ -72,12 +72,24 @@ ptw32_throw (DWORD exception)
 
   sp->state = PThreadStateExiting;
 
+  if (ptw32_watchdog_used && sp != NULL)
+    {
+      /* We may be leaving a watched wait without returning from it. */
+      ptw32_watch_end (sp);
+      sp->watchRwlock = NULL;
+    }
+
   if (exception != PTW32_EPS_CANCEL && exception != PTW32_EPS_EXIT)
     {
       /* Should never enter here */
       exit (1);
     }
 
+  if (exception == PTW32_EPS_CANCEL)
+    {
+      PTW32_STATS_INC(PTW32_STAT_CANCELS_ACTED);
+    }
+
   if (NULL == sp || sp->implicit)
     {
       /*
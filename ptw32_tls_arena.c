@@ -0,0 +1,229 @@
+/*
+ * ptw32_tls_arena.c
+ *
+ * Description:
+ * This translation unit implements routines which are private to
+ * the implementation and may be used throughout it.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+static ptw32_tls_segment_t *
+ptw32_tls_segment_new (size_t start, size_t end)
+{
+  ptw32_tls_segment_t * seg;
+  char * data;
+  size_t bytes = end - start;
+
+  /*
+   * Over-allocate so that origin is aligned to the largest
+   * alignment a key can ask for. Offsets are aligned for their
+   * key, so origin + offset is too.
+   */
+  seg = (ptw32_tls_segment_t *) calloc (1, sizeof (*seg)
+					+ bytes + PTW32_TLS_ARENA_ALIGN_MAX);
+  if (seg == NULL)
+    {
+      return NULL;
+    }
+
+  data = (char *) (seg + 1);
+  seg->origin = (char *) ((((size_t) data - start) + PTW32_TLS_ARENA_ALIGN_MAX - 1)
+			  & ~((size_t) PTW32_TLS_ARENA_ALIGN_MAX - 1));
+  seg->start = start;
+  seg->end = end;
+  seg->next = NULL;
+
+  return seg;
+}
+
+
+void *
+ptw32_tls_arena_lookup (pthread_key_t key)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Slow path of pthread_getspecific_ptr_np(): find the
+      *      block for 'key' in a later arena segment, or add a
+      *      segment covering every key created since the last
+      *      one, then construct the block if this thread hasn't
+      *      for the key's current generation.
+      *
+      * RESULTS
+      *              address of the block, or NULL if memory
+      *              could not be allocated.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_tls_segment_t * seg;
+  ptw32_tls_segment_t * last = NULL;
+  ptw32_mcs_local_node_t node;
+  void (*constructor) (void *);
+  LONG generation;
+  LONG * stamp;
+  char * block;
+  size_t end;
+
+  seg = (ptw32_tls_segment_t *) pthread_getspecific (ptw32_tls_arena_key);
+
+  for (; seg != NULL; seg = seg->next)
+    {
+      if (key->offset >= seg->start && key->offset < seg->end)
+	{
+	  break;
+	}
+      last = seg;
+    }
+
+  if (seg == NULL)
+    {
+      ptw32_mcs_lock_acquire (&ptw32_tls_arena_lock, &node);
+      end = ptw32_tls_arena_end;
+      ptw32_mcs_lock_release (&node);
+
+      if ((seg = ptw32_tls_segment_new ((last == NULL) ? 0 : last->end,
+					end)) == NULL)
+	{
+	  return NULL;
+	}
+
+      if (last == NULL)
+	{
+	  if (pthread_setspecific (ptw32_tls_arena_key, seg) != 0)
+	    {
+	      free (seg);
+	      return NULL;
+	    }
+	}
+      else
+	{
+	  last->next = seg;
+	}
+    }
+
+  block = seg->origin + key->offset;
+  stamp = PTW32_TLS_ARENA_STAMP(seg->origin, key->offset);
+
+  ptw32_mcs_lock_acquire (&ptw32_tls_arena_lock, &node);
+  generation = key->generation;
+  constructor = key->constructor;
+  ptw32_mcs_lock_release (&node);
+
+  /*
+   * A new block, or one left by a deleted key that this key has
+   * taken over.
+   */
+  if (*stamp != generation)
+    {
+      memset (block, 0, key->size);
+      *stamp = generation;
+
+      if (constructor != NULL)
+	{
+	  constructor (block);
+	}
+    }
+
+  return block;
+
+}				/* ptw32_tls_arena_lookup */
+
+
+void
+ptw32_tls_arena_destroy (void * segment)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Destructor for ptw32_tls_arena_key: destroy the
+      *      blocks the exiting thread constructed for live sized
+      *      keys in each of its arena segments, then free the
+      *      segments.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_tls_segment_t * seg = (ptw32_tls_segment_t *) segment;
+  ptw32_mcs_local_node_t node;
+  pthread_key_t first;
+
+  ptw32_mcs_lock_acquire (&ptw32_tls_arena_lock, &node);
+  first = ptw32_tls_arena_keys;
+  ptw32_mcs_lock_release (&node);
+
+  while (seg != NULL)
+    {
+      ptw32_tls_segment_t * next = seg->next;
+      pthread_key_t k;
+
+      for (k = first; k != NULL && k->offset < seg->end; k = k->nextSized)
+	{
+	  void (*destructor) (void *) = k->destructor;
+
+	  if (k->offset >= seg->start && destructor != NULL
+	      && *PTW32_TLS_ARENA_STAMP(seg->origin, k->offset) == k->generation)
+	    {
+	      destructor (seg->origin + k->offset);
+	    }
+	}
+
+      free (seg);
+      seg = next;
+    }
+
+}				/* ptw32_tls_arena_destroy */
+
+
+void
+ptw32_tls_arena_key_delete (pthread_key_t key)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      pthread_key_delete() for a sized key. The key stays
+      *      on the list because arena segments still hold its
+      *      block, but no longer constructs or destroys it; the
+      *      next key created with its size takes it over.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+
+  ptw32_mcs_lock_acquire (&ptw32_tls_arena_lock, &node);
+  key->constructor = NULL;
+  key->destructor = NULL;
+  key->generation = 0;
+  ptw32_mcs_lock_release (&node);
+
+}				/* ptw32_tls_arena_key_delete */
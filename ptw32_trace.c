@@ -0,0 +1,520 @@
+/*
+ * ptw32_trace.c
+ *
+ * Description:
+ * This translation unit implements event tracing.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+#if defined(PTW32_TRACE)
+
+/*
+ * Use the CPU timestamp counter where we can read it directly and
+ * QueryPerformanceCounter otherwise. Either way the dump records
+ * how many ticks there are per second.
+ */
+#if defined(_MSC_VER) && _MSC_VER >= 1400 && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define PTW32_TRACE_TICKS() ((ULONGLONG) __rdtsc())
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define PTW32_TRACE_TICKS() ((ULONGLONG) __builtin_ia32_rdtsc())
+#else
+#define PTW32_TRACE_TICKS() ptw32_trace_counter()
+#endif
+
+static DWORD ptw32_trace_tlsIndex = TLS_OUT_OF_INDEXES;
+static ptw32_trace_ring_t * ptw32_trace_rings = NULL;
+static ptw32_mcs_lock_t ptw32_trace_lock = 0;
+static ULONGLONG ptw32_trace_baseTicks = 0;
+static ULONGLONG ptw32_trace_baseCounter = 0;
+static char ptw32_trace_path[MAX_PATH];
+
+
+static ULONGLONG
+ptw32_trace_counter (void)
+{
+  LARGE_INTEGER count;
+
+  if (!QueryPerformanceCounter (&count))
+    {
+      return (ULONGLONG) GetTickCount ();
+    }
+
+  return (ULONGLONG) count.QuadPart;
+}
+
+
+static ULONGLONG
+ptw32_trace_frequency (void)
+{
+  LARGE_INTEGER freq;
+
+  if (!QueryPerformanceFrequency (&freq))
+    {
+      return 1000;
+    }
+
+  return (ULONGLONG) freq.QuadPart;
+}
+
+
+void
+ptw32_trace_initialize (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Allocate the TLS slot that holds each thread's ring
+      *      and, if the PTW32_TRACE environment variable names a
+      *      file, start tracing now and dump to that file at
+      *      process detach. If no TLS slot is available tracing
+      *      stays off.
+      *
+      * ------------------------------------------------------
+      */
+{
+  DWORD len;
+
+  if (ptw32_trace_tlsIndex == TLS_OUT_OF_INDEXES)
+    {
+      if ((ptw32_trace_tlsIndex = TlsAlloc ()) == TLS_OUT_OF_INDEXES)
+	{
+	  return;
+	}
+    }
+
+  len = GetEnvironmentVariableA ("PTW32_TRACE", ptw32_trace_path, MAX_PATH);
+
+  if (len > 0 && len < MAX_PATH)
+    {
+      ptw32_trace_start ();
+    }
+  else
+    {
+      ptw32_trace_path[0] = '\0';
+    }
+}
+
+
+void
+ptw32_trace_terminate (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Stop tracing, write the dump requested through the
+      *      environment if any, and release the rings unless the
+      *      process is exiting.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_trace_ring_t * ring, * next;
+
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_trace_enabled, (LONG)PTW32_FALSE);
+
+  if (ptw32_trace_path[0] != '\0')
+    {
+      (void) ptw32_trace_write (ptw32_trace_path);
+      ptw32_trace_path[0] = '\0';
+    }
+
+  if (ptw32_processExiting)
+    {
+      return;
+    }
+
+  for (ring = ptw32_trace_rings; ring != NULL; ring = next)
+    {
+      next = ring->next;
+      free (ring);
+    }
+
+  ptw32_trace_rings = NULL;
+
+  if (ptw32_trace_tlsIndex != TLS_OUT_OF_INDEXES)
+    {
+      TlsFree (ptw32_trace_tlsIndex);
+      ptw32_trace_tlsIndex = TLS_OUT_OF_INDEXES;
+    }
+}
+
+
+void
+ptw32_trace_start (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Turn recording on. The first time, note the timestamp
+      *      and performance counter so that the tick rate can be
+      *      calibrated when the rings are dumped.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (ptw32_trace_tlsIndex == TLS_OUT_OF_INDEXES)
+    {
+      return;
+    }
+
+  if (ptw32_trace_baseCounter == 0)
+    {
+      ptw32_trace_baseCounter = ptw32_trace_counter ();
+      ptw32_trace_baseTicks = PTW32_TRACE_TICKS ();
+    }
+
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_trace_enabled, (LONG)PTW32_TRUE);
+}
+
+
+static ptw32_trace_ring_t *
+ptw32_trace_ring_claim (void)
+     /*
+      * ------------------------------------------------------
+      * Give the calling thread a ring: one released by an exited
+      * thread if there is one, otherwise a new one.
+      * ------------------------------------------------------
+      */
+{
+  ptw32_trace_ring_t * ring;
+  ptw32_mcs_local_node_t node;
+  LONG self = (LONG) GetCurrentThreadId ();
+  ptw32_thread_t * sp = (ptw32_thread_t *) pthread_getspecific (ptw32_selfThreadKey);
+
+  ptw32_mcs_lock_acquire (&ptw32_trace_lock, &node);
+
+  for (ring = ptw32_trace_rings; ring != NULL; ring = ring->next)
+    {
+      if (ring->owner == 0)
+	{
+	  break;
+	}
+    }
+
+  if (ring == NULL)
+    {
+      ring = (ptw32_trace_ring_t *) calloc (1, sizeof (ptw32_trace_ring_t));
+
+      if (ring != NULL)
+	{
+	  ring->next = ptw32_trace_rings;
+	  ptw32_trace_rings = ring;
+	}
+    }
+
+  if (ring != NULL)
+    {
+      ring->owner = self;
+      ring->namedId = (DWORD) self;
+      ring->name[0] = '\0';
+
+      /*
+       * Not under the thread's threadLock, which may be held by our
+       * caller; a name being changed now is also passed to
+       * ptw32_trace_thread_name(), which waits for us.
+       */
+      if (sp != NULL)
+	{
+	  (void) memcpy (ring->name, sp->name, sizeof (ring->name));
+	  ring->name[sizeof (ring->name) - 1] = '\0';
+	}
+
+      TlsSetValue (ptw32_trace_tlsIndex, (LPVOID) ring);
+    }
+
+  ptw32_mcs_lock_release (&node);
+
+  return ring;
+}
+
+
+void
+ptw32_trace_event (int type, void * object, DWORD arg)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Append one record to the calling thread's ring,
+      *      overwriting the oldest record when the ring is full.
+      *      Called through PTW32_TRACE_EVENT only when tracing
+      *      is enabled.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_trace_ring_t * ring;
+  ptw32_trace_record_t * rec;
+  LONG head;
+  DWORD lastError = GetLastError ();
+
+  ring = (ptw32_trace_ring_t *) TlsGetValue (ptw32_trace_tlsIndex);
+
+  if (ring == NULL && (ring = ptw32_trace_ring_claim ()) == NULL)
+    {
+      SetLastError (lastError);
+      return;
+    }
+
+  head = ring->head;
+  rec = &ring->record[head & (PTW32_TRACE_RING_SIZE - 1)];
+  rec->ticks = PTW32_TRACE_TICKS ();
+  rec->object = (ULONGLONG) (size_t) object;
+  rec->threadId = (DWORD) ring->owner;
+  rec->type = (DWORD) type;
+  rec->arg = arg;
+  rec->reserved = 0;
+
+  /*
+   * Publish the record to a concurrent dump. Once the ring has
+   * wrapped, head stays in [RING_SIZE, 2 * RING_SIZE) so that it
+   * can't overflow.
+   */
+  if (++head == 2 * PTW32_TRACE_RING_SIZE)
+    {
+      head = PTW32_TRACE_RING_SIZE;
+    }
+
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ring->head, head);
+
+  SetLastError (lastError);
+}
+
+
+void
+ptw32_trace_thread_exit (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Record the exit of a thread that has a ring and hand
+      *      the ring back for reuse. Records already in the ring are kept until a
+      *      new owner overwrites them.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_trace_ring_t * ring;
+
+  if (ptw32_trace_tlsIndex == TLS_OUT_OF_INDEXES)
+    {
+      return;
+    }
+
+  ring = (ptw32_trace_ring_t *) TlsGetValue (ptw32_trace_tlsIndex);
+
+  if (ring != NULL)
+    {
+      PTW32_TRACE_EVENT(PTW32_TRACE_THREAD_EXIT, NULL, 0);
+      TlsSetValue (ptw32_trace_tlsIndex, NULL);
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ring->owner, 0L);
+    }
+}
+
+
+void
+ptw32_trace_thread_name (DWORD threadId, const char * name)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Give the ring of thread 'threadId', if it has one, the
+      *      name to write out with it. Called by
+      *      pthread_setname_np().
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_trace_ring_t * ring;
+  ptw32_mcs_local_node_t node;
+
+  ptw32_mcs_lock_acquire (&ptw32_trace_lock, &node);
+
+  for (ring = ptw32_trace_rings; ring != NULL; ring = ring->next)
+    {
+      if (ring->owner == (LONG) threadId)
+	{
+	  (void) strcpy (ring->name, name);
+	  break;
+	}
+    }
+
+  ptw32_mcs_lock_release (&node);
+}
+
+
+int
+ptw32_trace_write (const char * path)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Copy the header and the contents of every ring into
+      *      a new memory-mapped file. Each ring is copied oldest
+      *      record first, after a THREAD_NAME record if its
+      *      thread has a name. Threads may keep recording while this
+      *      runs; records written after a ring's head is sampled
+      *      are not included and a record being overwritten while
+      *      it is copied may be torn, so dump from a quiet point
+      *      for exact results.
+      *
+      * RESULTS
+      *              0       successfully written,
+      *              EIO     the file couldn't be created,
+      *              ENOMEM  the file couldn't be mapped.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_trace_ring_t * ring;
+  ptw32_trace_header_t header;
+  ptw32_mcs_local_node_t node;
+  HANDLE file, mapping;
+  char * view;
+  DWORD total = 0;
+  DWORD written = 0;
+  DWORD size;
+  ULONGLONG counter, ticks, frequency;
+  int result = 0;
+
+  ptw32_mcs_lock_acquire (&ptw32_trace_lock, &node);
+
+  for (ring = ptw32_trace_rings; ring != NULL; ring = ring->next)
+    {
+      total += (DWORD) PTW32_MIN(ring->head, PTW32_TRACE_RING_SIZE);
+
+      if (ring->name[0] != '\0')
+	{
+	  total++;
+	}
+    }
+
+  size = sizeof (header) + total * sizeof (ptw32_trace_record_t);
+
+  file = CreateFileA (path, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+		      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if (file == INVALID_HANDLE_VALUE)
+    {
+      result = EIO;
+      goto FAIL0;
+    }
+
+  mapping = CreateFileMappingA (file, NULL, PAGE_READWRITE, 0, size, NULL);
+
+  if (mapping == NULL)
+    {
+      result = ENOMEM;
+      goto FAIL1;
+    }
+
+  view = (char *) MapViewOfFile (mapping, FILE_MAP_WRITE, 0, 0, size);
+
+  if (view == NULL)
+    {
+      result = ENOMEM;
+      goto FAIL2;
+    }
+
+  for (ring = ptw32_trace_rings; ring != NULL && written < total; ring = ring->next)
+    {
+      LONG head = (LONG) PTW32_INTERLOCKED_EXCHANGE_ADD((LPLONG)&ring->head, 0L);
+      LONG count = PTW32_MIN(head, PTW32_TRACE_RING_SIZE);
+      LONG i;
+
+      /*
+       * Names can't change while we hold the lock, so there is
+       * room for each one counted above.
+       */
+      if (ring->name[0] != '\0')
+	{
+	  ptw32_trace_record_t rec;
+
+	  memset (&rec, 0, sizeof (rec));
+	  rec.ticks = ptw32_trace_baseTicks;
+	  rec.threadId = ring->namedId;
+	  rec.type = PTW32_TRACE_THREAD_NAME;
+	  memcpy (&rec.object, ring->name, 8);
+	  memcpy (&rec.arg, ring->name + 8, 4);
+	  memcpy (&rec.reserved, ring->name + 12, 4);
+
+	  memcpy (view + sizeof (header) + written * sizeof (ptw32_trace_record_t),
+		  &rec, sizeof (ptw32_trace_record_t));
+	  written++;
+	}
+
+      count = PTW32_MIN(count, (LONG) (total - written));
+
+      for (i = head - count; i < head; i++)
+	{
+	  memcpy (view + sizeof (header) + written * sizeof (ptw32_trace_record_t),
+		  &ring->record[i & (PTW32_TRACE_RING_SIZE - 1)],
+		  sizeof (ptw32_trace_record_t));
+	  written++;
+	}
+    }
+
+  counter = ptw32_trace_counter ();
+  ticks = PTW32_TRACE_TICKS ();
+  frequency = ptw32_trace_frequency ();
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, PTW32_TRACE_MAGIC, sizeof (header.magic));
+  header.version = PTW32_TRACE_VERSION;
+  header.recordSize = sizeof (ptw32_trace_record_t);
+  header.baseTicks = ptw32_trace_baseTicks;
+  header.processId = GetCurrentProcessId ();
+  header.recordCount = written;
+
+  if (counter > ptw32_trace_baseCounter && ticks > ptw32_trace_baseTicks)
+    {
+      header.ticksPerSecond = (ULONGLONG)
+	((double) (LONGLONG) (ticks - ptw32_trace_baseTicks) * (double) (LONGLONG) frequency
+	 / (double) (LONGLONG) (counter - ptw32_trace_baseCounter));
+    }
+  else
+    {
+      header.ticksPerSecond = frequency;
+    }
+
+  memcpy (view, &header, sizeof (header));
+
+  UnmapViewOfFile (view);
+
+FAIL2:
+  CloseHandle (mapping);
+
+FAIL1:
+  CloseHandle (file);
+
+FAIL0:
+  ptw32_mcs_lock_release (&node);
+
+  return result;
+}
+
+#endif /* PTW32_TRACE */
@@ -0,0 +1,213 @@
+/*
+ * ptw32_wait_hooks.c
+ *
+ * Description:
+ * This translation unit implements calls to the wait hooks.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+ULONGLONG
+ptw32_hook_now (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Returns the counter used to time blocks; never 0.
+      *
+      * ------------------------------------------------------
+      */
+{
+  LARGE_INTEGER count;
+
+  if (!QueryPerformanceCounter (&count) || count.QuadPart == 0)
+    {
+      /* Never 0, which means "not blocked". */
+      return (ULONGLONG) GetTickCount () | 1;
+    }
+
+  return (ULONGLONG) count.QuadPart;
+}
+
+
+unsigned long long
+ptw32_hook_nanoseconds (ULONGLONG from, ULONGLONG to)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Converts an interval of ptw32_hook_now() counts to
+      *      nanoseconds.
+      *
+      * ------------------------------------------------------
+      */
+{
+  static ULONGLONG frequency = 0;
+  ULONGLONG ticks = to - from;
+
+  if (frequency == 0)
+    {
+      LARGE_INTEGER freq;
+
+      frequency = QueryPerformanceFrequency (&freq) ? (ULONGLONG) freq.QuadPart : 1000;
+    }
+
+  /* Split to avoid overflowing 64 bits on long waits. */
+  return (unsigned long long) ((ticks / frequency) * 1000000000
+			       + ((ticks % frequency) * 1000000000) / frequency);
+}
+
+
+static void
+ptw32_hook_call (ptw32_wait_hook_t hook, int type, void * object,
+		 DWORD waker, int result, unsigned long long duration)
+{
+  struct ptw32_wait_event event;
+  DWORD lastError = GetLastError ();
+
+  event.object = object;
+  event.type = type;
+  event.result = result;
+  event.wakerThreadId = (unsigned long) waker;
+  event.duration = duration;
+
+  (*hook) (&event);
+
+  SetLastError (lastError);
+}
+
+
+void
+ptw32_hook_before (ptw32_hook_state_t * state, int type, void * object)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called through PTW32_HOOK_BEFORE just before the
+      *      calling thread blocks on 'object'. Starts timing
+      *      this block and, if it is the first, the whole
+      *      contended acquire. While the watchdog runs, also
+      *      puts the thread on its list until ptw32_hook_after.
+      *      While profiling, may sample the call stack.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_wait_hook_t hook = ptw32_wait_hooks.beforeBlock;
+
+  state->start = ptw32_hook_now ();
+
+  if (state->first == 0)
+    {
+      state->first = state->start;
+    }
+
+  if (ptw32_watchdog_active)
+    {
+      ptw32_watch_begin (type, object, state->first);
+    }
+
+  if (ptw32_profile_rate != 0)
+    {
+      ptw32_profile_begin (state, type);
+    }
+
+  if (hook != NULL)
+    {
+      ptw32_hook_call (hook, type, object, 0, 0, 0);
+    }
+}
+
+
+void
+ptw32_hook_after (ptw32_hook_state_t * state, int type, void * object,
+		  DWORD waker, int result)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called through PTW32_HOOK_AFTER when a block timed
+      *      by ptw32_hook_before returns.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_wait_hook_t hook = ptw32_wait_hooks.afterWake;
+  ULONGLONG start = state->start;
+  unsigned long long duration;
+
+  state->start = 0;
+
+  if (ptw32_watchdog_used)
+    {
+      ptw32_watch_end (NULL);
+    }
+
+  if (hook != NULL || state->site != 0)
+    {
+      duration = ptw32_hook_nanoseconds (start, ptw32_hook_now ());
+
+      if (state->site != 0)
+	{
+	  ptw32_profile_end (state, duration);
+	}
+
+      if (hook != NULL)
+	{
+	  ptw32_hook_call (hook, type, object, waker, result, duration);
+	}
+    }
+}
+
+
+void
+ptw32_hook_acquired (ptw32_hook_state_t * state, int type, void * object,
+		     DWORD waker, int result)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called through PTW32_HOOK_ACQUIRED where a contended
+      *      acquire ends. Reports only if the object was obtained
+      *      ('result' is 0, or EOWNERDEAD for robust mutexes).
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_wait_hook_t hook = ptw32_wait_hooks.acquiredAfterContention;
+  ULONGLONG first = state->first;
+
+  state->first = 0;
+
+  if (hook != NULL && (result == 0 || result == EOWNERDEAD))
+    {
+      ptw32_hook_call (hook, type, object, waker, result,
+		       ptw32_hook_nanoseconds (first, ptw32_hook_now ()));
+    }
+}
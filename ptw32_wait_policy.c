@@ -0,0 +1,358 @@
+/*
+ * ptw32_wait_policy.c
+ *
+ * Description:
+ * This translation unit implements the spin, yield and park wait policy.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+static void
+ptw32_wait_policy_default (int level, struct ptw32_wait_policy * policy)
+{
+  int cpus = 1;
+
+  (void) ptw32_getprocessors (&cpus);
+
+  /*
+   * Spinning only helps if the thread we are waiting for can run at
+   * the same time, which a concurrency level of 1 says it won't.
+   */
+  policy->spinCount = (cpus > 1 && level != 1) ? PTW32_WAIT_SPIN_DEFAULT : 0;
+  policy->yieldCount = 0;
+  policy->yieldKind = PTW32_YIELD_SLEEP0;
+}
+
+
+#if !defined(WINCE)
+static int
+ptw32_wait_policy_match (const char * s, const char * word, size_t len)
+{
+  while (len-- > 0)
+    {
+      if (*s++ != *word++)
+	{
+	  return PTW32_FALSE;
+	}
+    }
+
+  return PTW32_TRUE;
+}
+
+
+static int
+ptw32_wait_policy_parse (const char * s, struct ptw32_wait_policy * policy)
+     /*
+      * ------------------------------------------------------
+      * DESCRIPTION
+      *      Parses a comma separated list of the form
+      *
+      *        spin=N,yield=N,kind=switch|sleep0|sleep1
+      *
+      *      into 'policy'. Any item may be left out, in which
+      *      case 'policy' is unchanged for it.
+      *
+      * RESULTS
+      *              0               success,
+      *              EINVAL          's' is malformed.
+      *
+      * ------------------------------------------------------
+      */
+{
+  while (*s != '\0')
+    {
+      const char * name = s;
+      size_t len;
+      int n = 0;
+
+      while (*s != '\0' && *s != '=' && *s != ',')
+	{
+	  s++;
+	}
+      len = (size_t) (s - name);
+
+      if (*s++ != '=')
+	{
+	  return EINVAL;
+	}
+
+      if (len == 4 && ptw32_wait_policy_match (name, "kind", 4))
+	{
+	  if (ptw32_wait_policy_match (s, "switch", 6))
+	    {
+	      policy->yieldKind = PTW32_YIELD_SWITCH;
+	      s += 6;
+	    }
+	  else if (ptw32_wait_policy_match (s, "sleep0", 6))
+	    {
+	      policy->yieldKind = PTW32_YIELD_SLEEP0;
+	      s += 6;
+	    }
+	  else if (ptw32_wait_policy_match (s, "sleep1", 6))
+	    {
+	      policy->yieldKind = PTW32_YIELD_SLEEP1;
+	      s += 6;
+	    }
+	  else
+	    {
+	      return EINVAL;
+	    }
+	}
+      else
+	{
+	  if (*s < '0' || *s > '9')
+	    {
+	      return EINVAL;
+	    }
+	  while (*s >= '0' && *s <= '9' && n < 100000000)
+	    {
+	      n = n * 10 + (*s++ - '0');
+	    }
+
+	  if (len == 4 && ptw32_wait_policy_match (name, "spin", 4))
+	    {
+	      policy->spinCount = n;
+	    }
+	  else if (len == 5 && ptw32_wait_policy_match (name, "yield", 5))
+	    {
+	      policy->yieldCount = n;
+	    }
+	  else
+	    {
+	      return EINVAL;
+	    }
+	}
+
+      if (*s == ',')
+	{
+	  s++;
+	}
+      else if (*s != '\0')
+	{
+	  return EINVAL;
+	}
+    }
+
+  return 0;
+}
+#endif
+
+
+void
+ptw32_wait_policy_update (const struct ptw32_wait_policy * policy)
+{
+  ptw32_wait_policy = *policy;
+  ptw32_wait_spinning = (policy->spinCount > 0 || policy->yieldCount > 0);
+}
+
+
+void
+ptw32_wait_policy_init (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Sets the wait policy at process initialisation,
+      *      from the PTW32_WAIT_POLICY environment variable if
+      *      it is set and valid, otherwise from the processor
+      *      count and pthread_setconcurrency() level.
+      * ------------------------------------------------------
+      */
+{
+  struct ptw32_wait_policy policy;
+
+  ptw32_wait_policy_default (ptw32_concurrency, &policy);
+
+#if !defined(WINCE)
+  {
+    char value[64];
+    DWORD len = GetEnvironmentVariableA (PTW32_WAIT_POLICY_ENV,
+					 value, (DWORD) sizeof (value));
+
+    if (len > 0 && len < sizeof (value)
+	&& 0 == ptw32_wait_policy_parse (value, &policy))
+      {
+	ptw32_wait_policy_explicit = PTW32_TRUE;
+      }
+    else
+      {
+	ptw32_wait_policy_default (ptw32_concurrency, &policy);
+      }
+  }
+#endif
+
+  ptw32_wait_policy_update (&policy);
+}
+
+
+void
+ptw32_wait_policy_hint (int level)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called by pthread_setconcurrency(). Recomputes the
+      *      default policy for the new level unless a policy
+      *      has been set by environment variable or by
+      *      pthread_setwaitpolicy_np().
+      * ------------------------------------------------------
+      */
+{
+  struct ptw32_wait_policy policy;
+
+  if (!ptw32_wait_policy_explicit)
+    {
+      ptw32_wait_policy_default (level, &policy);
+      ptw32_wait_policy_update (&policy);
+    }
+}
+
+
+void
+ptw32_yield (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Gives up the processor in the way the wait policy
+      *      says. Sleep(0) only runs threads of equal or higher
+      *      priority; SwitchToThread() runs any ready thread on
+      *      this processor; Sleep(1) waits at least one tick.
+      * ------------------------------------------------------
+      */
+{
+  switch (ptw32_wait_policy.yieldKind)
+    {
+#if !defined(WINCE)
+    case PTW32_YIELD_SWITCH:
+      (void) SwitchToThread ();
+      break;
+#endif
+    case PTW32_YIELD_SLEEP1:
+      Sleep (1);
+      break;
+    default:
+      Sleep (0);
+      break;
+    }
+}
+
+
+int
+ptw32_spin_acquire (LONG * lock, LONG value)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Spins and then yields, per the wait policy, trying
+      *      to change *lock from 0 to 'value'. Used by mutexes
+      *      before they park; 'value' is -1 if the caller has
+      *      overwritten a -1 (waiters) in *lock.
+      *
+      * RESULTS
+      *              PTW32_TRUE      the lock was taken,
+      *              PTW32_FALSE     the budget ran out.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int spin = ptw32_wait_policy.spinCount;
+  int limit = spin + ptw32_wait_policy.yieldCount;
+  int i;
+
+  for (i = 0; i < limit; i++)
+    {
+      if (*(volatile LONG *) lock == 0
+	  && 0 == (LONG) PTW32_INTERLOCKED_COMPARE_EXCHANGE (
+			   (PTW32_INTERLOCKED_LPLONG) lock,
+			   (PTW32_INTERLOCKED_LONG) value,
+			   (PTW32_INTERLOCKED_LONG) 0))
+	{
+	  return PTW32_TRUE;
+	}
+
+      if (i < spin)
+	{
+	  PTW32_PAUSE ();
+	}
+      else
+	{
+	  ptw32_yield ();
+	}
+    }
+
+  return PTW32_FALSE;
+}
+
+
+int
+ptw32_spin_wait (volatile LONG * location, int until)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Spins and then yields, per the wait policy, until
+      *      *location is non-zero (PTW32_SPIN_UNTIL_NONZERO) or
+      *      greater than zero (PTW32_SPIN_UNTIL_POSITIVE).
+      *
+      * RESULTS
+      *              PTW32_TRUE      the condition holds,
+      *              PTW32_FALSE     the budget ran out.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int spin = ptw32_wait_policy.spinCount;
+  int limit = spin + ptw32_wait_policy.yieldCount;
+  int i;
+
+  for (i = 0; ; i++)
+    {
+      LONG v = *location;
+
+      if (until == PTW32_SPIN_UNTIL_NONZERO ? v != 0 : v > 0)
+	{
+	  return PTW32_TRUE;
+	}
+
+      if (i >= limit)
+	{
+	  return PTW32_FALSE;
+	}
+
+      if (i < spin)
+	{
+	  PTW32_PAUSE ();
+	}
+      else
+	{
+	  ptw32_yield ();
+	}
+    }
+}
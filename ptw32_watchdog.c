@@ -0,0 +1,531 @@
+/*
+ * ptw32_watchdog.c
+ *
+ * Description:
+ * This translation unit implements the blocked-wait watchdog.
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "implement.h"
+
+
+/* Reports collected per pass of the list; any more wait for the next. */
+#define PTW32_WATCHDOG_BATCH 16
+
+static HANDLE ptw32_watchdog_thread = NULL;
+static HANDLE ptw32_watchdog_stopEvent = NULL;
+static HANDLE ptw32_watchdog_doneEvent = NULL;
+static DWORD ptw32_watchdog_period = 0;
+
+/* Protected by ptw32_watch_lock. */
+static unsigned long long ptw32_watchdog_threshold = 0;
+static ptw32_stall_hook_t ptw32_watchdog_report = NULL;
+
+
+void
+ptw32_watch_begin (int type, void * object, ULONGLONG since)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called from ptw32_hook_before while the watchdog runs.
+      *      Puts the calling thread on the watch list, blocked on
+      *      'object' since 'since' (a ptw32_hook_now() count),
+      *      unless it is already on it.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_thread_t * tp = (ptw32_thread_t *) pthread_self ().p;
+  ptw32_mcs_local_node_t node;
+
+  if (tp == NULL)
+    {
+      return;
+    }
+
+  ptw32_mcs_lock_acquire (&ptw32_watch_lock, &node);
+
+  /*
+   * A condition variable or barrier wait blocks again inside, on its
+   * internal semaphore; keep reporting the outer object.
+   */
+  if (tp->watchStart == 0)
+    {
+      tp->watchPrev = NULL;
+      tp->watchNext = ptw32_watch_list;
+      if (ptw32_watch_list != NULL)
+	{
+	  ptw32_watch_list->watchPrev = tp;
+	}
+      ptw32_watch_list = tp;
+
+      tp->watchObject = object;
+      tp->watchType = type;
+      tp->watchStart = since;
+    }
+
+  ptw32_mcs_lock_release (&node);
+}
+
+
+void
+ptw32_watch_end (ptw32_thread_t * tp)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Takes 'tp' (the calling thread if NULL) off the watch
+      *      list, if it is on it. Called when a watched wait
+      *      returns and from ptw32_throw when one is abandoned.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+
+  if (tp == NULL)
+    {
+      tp = (ptw32_thread_t *) pthread_getspecific (ptw32_selfThreadKey);
+    }
+
+  /* Only this thread sets watchStart, so the test needs no lock. */
+  if (tp == NULL || tp->watchStart == 0)
+    {
+      return;
+    }
+
+  ptw32_mcs_lock_acquire (&ptw32_watch_lock, &node);
+
+  if (tp->watchPrev == NULL)
+    {
+      ptw32_watch_list = tp->watchNext;
+    }
+  else
+    {
+      tp->watchPrev->watchNext = tp->watchNext;
+    }
+
+  if (tp->watchNext != NULL)
+    {
+      tp->watchNext->watchPrev = tp->watchPrev;
+    }
+
+  tp->watchNext = tp->watchPrev = NULL;
+  tp->watchObject = NULL;
+  tp->watchStart = 0;
+
+  ptw32_mcs_lock_release (&node);
+}
+
+
+void
+ptw32_watch_rwlock (void * rwlock)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Called through PTW32_WATCH_ENTER and PTW32_WATCH_LEAVE
+      *      to set or clear the rwlock the calling thread is
+      *      blocking to acquire.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_thread_t * tp;
+
+  if (rwlock != NULL)
+    {
+      tp = (ptw32_thread_t *) pthread_self ().p;
+    }
+  else
+    {
+      tp = (ptw32_thread_t *) pthread_getspecific (ptw32_selfThreadKey);
+    }
+
+  if (tp != NULL)
+    {
+      tp->watchRwlock = rwlock;
+    }
+}
+
+
+static ptw32_thread_t *
+ptw32_watch_owner (ptw32_thread_t * tp)
+{
+  /*
+   * Called with ptw32_watch_lock held. 'tp' cannot leave its wait
+   * until we release it, so the object it waits on is still valid.
+   * ptw32_thread_t structs are never freed while the process runs.
+   */
+  ptw32_thread_t * owner = NULL;
+
+  if (tp->watchType == PTW32_WAIT_MUTEX)
+    {
+      pthread_mutex_t mx = *(pthread_mutex_t *) tp->watchObject;
+
+      if (mx != NULL && mx < PTHREAD_ERRORCHECK_MUTEX_INITIALIZER)
+	{
+	  owner = (ptw32_thread_t *) mx->ownerThread.p;
+	}
+    }
+  else if (tp->watchType == PTW32_WAIT_JOIN)
+    {
+      owner = (ptw32_thread_t *) tp->watchObject;
+    }
+
+  return owner;
+}
+
+
+static void
+ptw32_watch_name (char * name, ptw32_thread_t * tp)
+{
+  /*
+   * Without the thread's threadLock: a name being changed may come
+   * out mixed, but always terminated.
+   */
+  if (tp != NULL)
+    {
+      memcpy (name, tp->name, PTW32_THREAD_NAME_MAX);
+      name[PTW32_THREAD_NAME_MAX - 1] = '\0';
+    }
+  else
+    {
+      name[0] = '\0';
+    }
+}
+
+
+static char *
+ptw32_watchdog_format (char * p, const char * s)
+{
+  while (*s != '\0')
+    {
+      *p++ = *s++;
+    }
+
+  return p;
+}
+
+
+static char *
+ptw32_watchdog_format_number (char * p, unsigned long long value, unsigned base)
+{
+  char digits[24];
+  int n = 0;
+
+  do
+    {
+      digits[n++] = "0123456789abcdef"[value % base];
+      value /= base;
+    }
+  while (value != 0);
+
+  while (n > 0)
+    {
+      *p++ = digits[--n];
+    }
+
+  return p;
+}
+
+
+static char *
+ptw32_watchdog_format_name (char * p, const char * name)
+{
+  if (name[0] != '\0')
+    {
+      p = ptw32_watchdog_format (p, " (");
+      p = ptw32_watchdog_format (p, name);
+      p = ptw32_watchdog_format (p, ")");
+    }
+
+  return p;
+}
+
+
+static void
+ptw32_watchdog_log (const struct ptw32_stall_report * report)
+{
+  /*
+   * The library does not use stdio, so format by hand:
+   * "pthreads-win32: thread 1234 (reader) blocked 2000 ms on mutex 0x12ff40,
+   *  owner 5678 (writer)\n", without the names of unnamed threads.
+   */
+  static const char * names[] = {
+    "object", "mutex", "cond", "semaphore", "barrier", "join", "rwlock"
+  };
+  char line[128 + 2 * PTW32_THREAD_NAME_MAX];
+  char * p = line;
+  int type = report->type;
+
+  if (type < 0 || type >= (int) (sizeof (names) / sizeof (names[0])))
+    {
+      type = 0;
+    }
+
+  p = ptw32_watchdog_format (p, "pthreads-win32: thread ");
+  p = ptw32_watchdog_format_number (p, report->waiterThreadId, 10);
+  p = ptw32_watchdog_format_name (p, report->waiterName);
+  p = ptw32_watchdog_format (p, " blocked ");
+  p = ptw32_watchdog_format_number (p, report->waited / 1000000, 10);
+  p = ptw32_watchdog_format (p, " ms on ");
+  p = ptw32_watchdog_format (p, names[type]);
+  p = ptw32_watchdog_format (p, " 0x");
+  p = ptw32_watchdog_format_number (p, (size_t) report->object, 16);
+  if (report->ownerThreadId != 0)
+    {
+      p = ptw32_watchdog_format (p, ", owner ");
+      p = ptw32_watchdog_format_number (p, report->ownerThreadId, 10);
+      p = ptw32_watchdog_format_name (p, report->ownerName);
+    }
+  p = ptw32_watchdog_format (p, "\n");
+  *p = '\0';
+
+  OutputDebugStringA (line);
+}
+
+
+static void
+ptw32_watchdog_scan (void)
+{
+  struct ptw32_stall_report report[PTW32_WATCHDOG_BATCH];
+  ptw32_stall_hook_t hook;
+  int n;
+  int i;
+
+  do
+    {
+      ptw32_thread_t * tp;
+      ptw32_thread_t * owner;
+      ptw32_mcs_local_node_t node;
+      ULONGLONG now;
+
+      n = 0;
+
+      ptw32_mcs_lock_acquire (&ptw32_watch_lock, &node);
+
+      /* After the lock, so that no watchStart is later than now. */
+      now = ptw32_hook_now ();
+      hook = ptw32_watchdog_report;
+
+      for (tp = ptw32_watch_list; tp != NULL && n < PTW32_WATCHDOG_BATCH; tp = tp->watchNext)
+	{
+	  unsigned long long waited;
+
+	  if (tp->watchReported == tp->watchStart)
+	    {
+	      continue;
+	    }
+
+	  waited = ptw32_hook_nanoseconds (tp->watchStart, now);
+
+	  if (waited < ptw32_watchdog_threshold)
+	    {
+	      continue;
+	    }
+
+	  tp->watchReported = tp->watchStart;
+
+	  if (tp->watchRwlock != NULL)
+	    {
+	      report[n].object = tp->watchRwlock;
+	      report[n].type = PTW32_WAIT_RWLOCK;
+	    }
+	  else
+	    {
+	      report[n].object = tp->watchObject;
+	      report[n].type = tp->watchType;
+	    }
+	  owner = ptw32_watch_owner (tp);
+	  report[n].waiterThreadId = (unsigned long) tp->thread;
+	  report[n].ownerThreadId = (unsigned long) (owner != NULL ? owner->thread : 0);
+	  ptw32_watch_name (report[n].waiterName, tp);
+	  ptw32_watch_name (report[n].ownerName, owner);
+	  report[n].waited = waited;
+	  n++;
+	}
+
+      ptw32_mcs_lock_release (&node);
+
+      /* With no library locks held. */
+      for (i = 0; i < n; i++)
+	{
+	  if (hook != NULL)
+	    {
+	      (*hook) (&report[i]);
+	    }
+	  else
+	    {
+	      ptw32_watchdog_log (&report[i]);
+	    }
+	}
+    }
+  while (n == PTW32_WATCHDOG_BATCH);
+}
+
+
+static unsigned __stdcall
+ptw32_watchdog_main (void * arg)
+{
+  while (WaitForSingleObject (ptw32_watchdog_stopEvent, ptw32_watchdog_period) == WAIT_TIMEOUT)
+    {
+      ptw32_watchdog_scan ();
+    }
+
+  /*
+   * Tell ptw32_watchdog_stop() we are done with the library. It
+   * doesn't wait for the thread itself to exit, which would deadlock
+   * on the loader lock when called at DLL process detach.
+   */
+  (void) SetEvent (ptw32_watchdog_doneEvent);
+
+  return 0;
+}
+
+
+int
+ptw32_watchdog_start (unsigned long thresholdMillisecs, ptw32_stall_hook_t report)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Starts the watchdog thread, or changes the threshold
+      *      and callback of the running one. Called with
+      *      ptw32_watchdog_lock held.
+      *
+      * RESULTS
+      *              0               success,
+      *              EAGAIN          the thread or its events could
+      *                              not be created.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_mcs_local_node_t node;
+  DWORD period = thresholdMillisecs / 2;
+
+  /* Often enough to report within half the threshold again. */
+  if (period < 10)
+    {
+      period = 10;
+    }
+  else if (period > 1000)
+    {
+      period = 1000;
+    }
+
+  ptw32_mcs_lock_acquire (&ptw32_watch_lock, &node);
+  ptw32_watchdog_threshold = (unsigned long long) thresholdMillisecs * 1000000;
+  ptw32_watchdog_report = report;
+  ptw32_watchdog_period = period;
+  ptw32_mcs_lock_release (&node);
+
+  if (ptw32_watchdog_thread == NULL)
+    {
+      ptw32_watchdog_stopEvent = CreateEvent (NULL, PTW32_TRUE, PTW32_FALSE, NULL);
+      ptw32_watchdog_doneEvent = CreateEvent (NULL, PTW32_TRUE, PTW32_FALSE, NULL);
+
+      if (ptw32_watchdog_stopEvent != NULL && ptw32_watchdog_doneEvent != NULL)
+	{
+	  ptw32_watchdog_thread =
+	    (HANDLE) _beginthreadex (NULL, 0, ptw32_watchdog_main, NULL, 0,
+				     (unsigned *) &ptw32_watchdog_threadId);
+	}
+
+      if (ptw32_watchdog_thread == NULL)
+	{
+	  if (ptw32_watchdog_stopEvent != NULL)
+	    {
+	      (void) CloseHandle (ptw32_watchdog_stopEvent);
+	      ptw32_watchdog_stopEvent = NULL;
+	    }
+	  if (ptw32_watchdog_doneEvent != NULL)
+	    {
+	      (void) CloseHandle (ptw32_watchdog_doneEvent);
+	      ptw32_watchdog_doneEvent = NULL;
+	    }
+	  return EAGAIN;
+	}
+    }
+
+  /* Used before active: see PTW32_WATCH_DISOWN. */
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_watchdog_used, (LONG)PTW32_TRUE);
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_watchdog_active, (LONG)PTW32_TRUE);
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_wait_hooks_active, (LONG)PTW32_TRUE);
+
+  return 0;
+}
+
+
+int
+ptw32_watchdog_stop (void)
+     /*
+      * ------------------------------------------------------
+      * DOCPRIVATE
+      *      Stops the watchdog thread, if running. Called with
+      *      ptw32_watchdog_lock held, or at process detach, and
+      *      never from the watchdog thread. Threads blocked at
+      *      the time stay on the watch list until they wake but
+      *      are no longer reported.
+      *
+      * RESULTS
+      *              0               success.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (ptw32_watchdog_thread == NULL)
+    {
+      return 0;
+    }
+
+  (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_watchdog_active, (LONG)PTW32_FALSE);
+
+  if (ptw32_wait_hooks.beforeBlock == NULL
+      && ptw32_wait_hooks.afterWake == NULL
+      && ptw32_wait_hooks.acquiredAfterContention == NULL
+      && ptw32_profile_rate == 0)
+    {
+      (void) PTW32_INTERLOCKED_EXCHANGE((LPLONG)&ptw32_wait_hooks_active, (LONG)PTW32_FALSE);
+    }
+
+  (void) SetEvent (ptw32_watchdog_stopEvent);
+  (void) WaitForSingleObject (ptw32_watchdog_doneEvent, INFINITE);
+
+  (void) CloseHandle (ptw32_watchdog_thread);
+  (void) CloseHandle (ptw32_watchdog_stopEvent);
+  (void) CloseHandle (ptw32_watchdog_doneEvent);
+  ptw32_watchdog_thread = NULL;
+  ptw32_watchdog_threadId = 0;
+  ptw32_watchdog_stopEvent = NULL;
+  ptw32_watchdog_doneEvent = NULL;
+
+  return 0;
+}
@@ -53,6 +53,8 @@ sched_yield (void)
       * DESCRIPTION
       *      This function indicates that the calling thread is
       *      willing to give up some time slices to other threads.
+      *      How it does so follows the yieldKind of the wait
+      *      policy (see pthread_setwaitpolicy_np()).
       *      NOTE: Since this is part of POSIX 1003.1b
       *                (realtime extensions), it is defined as returning
       *                -1 if an error occurs and sets errno to the actual
@@ -65,7 +67,7 @@ sched_yield (void)
       * ------------------------------------------------------
       */
 {
-  Sleep (0);
+  ptw32_yield ();
 
   return 0;
 }
@@ -85,7 +85,7 @@ sem_destroy (sem_t * sem)
 
       if ((result = pthread_mutex_lock (&s->lock)) == 0)
         {
-          if (s->value < 0)
+          if (s->value < 0 || s->waitersHead != NULL)
             {
               (void) pthread_mutex_unlock (&s->lock);
               result = EBUSY;
@@ -139,6 +139,9 @@ sem_destroy (sem_t * sem)
 
   free (s);
 
+  PTW32_STATS_DEC(PTW32_STAT_SEMAPHORES_LIVE);
+  PTW32_STATS_DEC(PTW32_STAT_SEMAPHORE_HANDLES);
+
   return 0;
 
 }				/* sem_destroy */
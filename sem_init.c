@@ -164,6 +164,9 @@ sem_init (sem_t * sem, int pshared, unsigned int value)
 
   *sem = s;
 
+  PTW32_STATS_INC(PTW32_STAT_SEMAPHORES_LIVE);
+  PTW32_STATS_INC(PTW32_STAT_SEMAPHORE_HANDLES);
+
   return 0;
 
 }				/* sem_init */
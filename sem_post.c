@@ -91,23 +91,26 @@ sem_post (sem_t * sem)
           return -1;
         }
 
-      if (s->value < SEM_VALUE_MAX)
+      if (s->value >= 0 && s->waitersHead != NULL)
 	{
-#ifdef NEED_SEM
-	  if (++s->value <= 0
-	      && !SetEvent(s->sem))
+	  /* The token belongs to the sem_wait_n_np() queue. */
+	  result = ptw32_sem_release (s, 1);
+	}
+      else if (s->value < SEM_VALUE_MAX)
+	{
+	  if (++s->value <= 0)
 	    {
-	      s->value--;
-	      result = EINVAL;
-	    }
+	      s->wakerThread = GetCurrentThreadId ();
+#ifdef NEED_SEM
+	      if (!SetEvent(s->sem))
 #else
-	  if (++s->value <= 0
-	      && !ReleaseSemaphore (s->sem, 1, NULL))
-	    {
-	      s->value--;
-	      result = EINVAL;
-	    }
+	      if (!ReleaseSemaphore (s->sem, 1, NULL))
 #endif /* NEED_SEM */
+		{
+		  s->value--;
+		  result = EINVAL;
+		}
+	    }
 	}
       else
 	{
@@ -65,6 +65,11 @@ sem_post_multiple (sem_t * sem, int count)
       *      are waiting threads (or processes), n <= count are awakened;
       *      the semaphore value is incremented by count - n.
       *
+      *      Threads waiting in sem_wait_n_np() are served in arrival
+      *      order, after any threads already blocked in sem_wait().
+      *      Each is woken only once all of its tokens have been posted,
+      *      so one call may wake several of them.
+      *
       * RESULTS
       *              0               successfully posted semaphore,
       *              -1              failed, error in errno
@@ -77,7 +82,6 @@ sem_post_multiple (sem_t * sem, int count)
       */
 {
   int result = 0;
-  long waiters;
   sem_t s = *sem;
 
   if (s == NULL || count <= 0)
@@ -97,32 +101,7 @@ sem_post_multiple (sem_t * sem, int count)
 
       if (s->value <= (SEM_VALUE_MAX - count))
 	{
-	  waiters = -s->value;
-	  s->value += count;
-	  if (waiters > 0)
-	    {
-#ifdef NEED_SEM
-	      if (SetEvent(s->sem))
-		{
-		  waiters--;
-		  s->leftToUnblock += count - 1;
-		  if (s->leftToUnblock > waiters)
-		    {
-		      s->leftToUnblock = waiters;
-		    }
-		}
-#else
-	      if (ReleaseSemaphore (s->sem,  (waiters<=count)?waiters:count, 0))
-		{
-		  /* No action */
-		}
-#endif
-	      else
-		{
-		  s->value -= count;
-		  result = EINVAL;
-		}
-	    }
+	  result = ptw32_sem_release (s, count);
 	}
       else
 	{
@@ -0,0 +1,171 @@
+/*
+ * -------------------------------------------------------------
+ *
+ * Module: sem_setwakeorder_np.c
+ *
+ * Purpose:
+ *	Non-portable extension: choose the order in which a
+ *	semaphore releases its waiters.
+ *
+ * -------------------------------------------------------------
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "semaphore.h"
+#include "implement.h"
+
+
+int
+sem_setwakeorder_np (sem_t * sem, int order)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function chooses the order in which sem_post()
+      *      releases threads waiting on a semaphore.
+      *
+      * PARAMETERS
+      *      sem
+      *              pointer to an instance of sem_t
+      *
+      *      order
+      *              must be one of:
+      *
+      *                      PTHREAD_WAKE_DEFAULT_NP
+      *                              whichever waiter the W32 sema
+      *                              picks (the default)
+      *
+      *                      PTHREAD_WAKE_FIFO_NP
+      *                              strict arrival order
+      *
+      *                      PTHREAD_WAKE_PRIORITY_NP
+      *                              highest sched_priority first,
+      *                              arrival order among equals
+      *
+      * DESCRIPTION
+      *      With an order other than the default, every wait that
+      *      blocks joins the sem_wait_n_np() queue and each post
+      *      is handed directly to the waiter at its head, so a
+      *      thread arriving later cannot take it first. This costs
+      *      an event per blocking wait. The priority is the
+      *      waiter's sched_priority, as set by pthread_create()
+      *      or pthread_setschedparam(), when it starts to wait.
+      *
+      *      The order may only be changed while no thread is
+      *      waiting on the semaphore.
+      *
+      * RESULTS
+      *              0               successfully set the order,
+      *              -1              failed, error in errno
+      * ERRNO
+      *              EINVAL          'sem' or 'order' is invalid,
+      *              EBUSY           threads are waiting on 'sem'.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result = 0;
+  sem_t s;
+
+  if (sem == NULL || (s = *sem) == NULL
+      || order < PTHREAD_WAKE_DEFAULT_NP || order > PTHREAD_WAKE_PRIORITY_NP)
+    {
+      result = EINVAL;
+    }
+  else if ((result = pthread_mutex_lock (&s->lock)) == 0)
+    {
+      /* See sem_destroy.c
+       */
+      if (*sem == NULL)
+	{
+	  (void) pthread_mutex_unlock (&s->lock);
+	  errno = EINVAL;
+	  return -1;
+	}
+
+      if (s->value < 0 || s->waitersHead != NULL)
+	{
+	  result = EBUSY;
+	}
+      else
+	{
+	  s->wakeOrder = order;
+	}
+
+      (void) pthread_mutex_unlock (&s->lock);
+    }
+
+  if (result != 0)
+    {
+      errno = result;
+      return -1;
+    }
+
+  return 0;
+
+}				/* sem_setwakeorder_np */
+
+
+int
+sem_getwakeorder_np (sem_t * sem, int * order)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function returns the order in which a semaphore
+      *      releases its waiters.
+      *
+      * PARAMETERS
+      *      sem
+      *              pointer to an instance of sem_t
+      *
+      *      order
+      *              pointer to an int, set to one of the
+      *              PTHREAD_WAKE_*_NP values
+      *
+      * RESULTS
+      *              0               successfully retrieved the order,
+      *              -1              failed, error in errno
+      * ERRNO
+      *              EINVAL          'sem' or 'order' is invalid.
+      *
+      * ------------------------------------------------------
+      */
+{
+  if (sem == NULL || *sem == NULL || order == NULL)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  *order = (*sem)->wakeOrder;
+  return 0;
+
+}				/* sem_getwakeorder_np */
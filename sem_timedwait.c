@@ -127,7 +127,8 @@ sem_timedwait (sem_t * sem, const struct timespec *abstime)
       * ERRNO
       *              EINVAL          'sem' is not a valid semaphore,
       *              ENOSYS          semaphores are not supported,
-      *              EINTR           the function was interrupted by a signal,
+      *              EINTR           the function was interrupted by
+      *                              pthread_interrupt_np(),
       *              EDEADLK         a deadlock condition was detected.
       *              ETIMEDOUT       abstime elapsed before success.
       *
@@ -137,7 +138,7 @@ sem_timedwait (sem_t * sem, const struct timespec *abstime)
   int result = 0;
   sem_t s = *sem;
 
-  pthread_testcancel();
+  PTW32_TESTCANCEL();
 
   if (sem == NULL)
     {
@@ -159,6 +160,9 @@ sem_timedwait (sem_t * sem, const struct timespec *abstime)
 	  milliseconds = ptw32_relmillisecs (abstime);
 	}
 
+      /* Give a post that is about to happen a chance to arrive. */
+      (void) PTW32_SPIN_WAIT((volatile LONG *) &s->value, PTW32_SPIN_UNTIL_POSITIVE);
+
       if ((result = pthread_mutex_lock (&s->lock)) == 0)
 	{
 	  int v;
@@ -172,6 +176,17 @@ sem_timedwait (sem_t * sem, const struct timespec *abstime)
 	      return -1;
 	    }
 
+	  if (s->waitersHead != NULL
+	      || s->wakeOrder != PTHREAD_WAKE_DEFAULT_NP)
+	    {
+	      /*
+	       * Queue behind the sem_wait_n_np() waiters, or in the
+	       * order the semaphore was asked to wake its waiters.
+	       */
+	      (void) pthread_mutex_unlock (&s->lock);
+	      return sem_wait_n_np (sem, 1, abstime);
+	    }
+
 	  v = --s->value;
 	  (void) pthread_mutex_unlock (&s->lock);
 
@@ -181,6 +196,7 @@ sem_timedwait (sem_t * sem, const struct timespec *abstime)
 	      int timedout;
 #endif
 	      sem_timedwait_cleanup_args_t cleanup_args;
+	      ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
 
 	      cleanup_args.sem = s;
 	      cleanup_args.resultPtr = &result;
@@ -189,12 +205,25 @@ sem_timedwait (sem_t * sem, const struct timespec *abstime)
 #pragma inline_depth(0)
 #endif
 	      /* Must wait */
-              pthread_cleanup_push(ptw32_sem_timedwait_cleanup, (void *) &cleanup_args);
+              PTW32_CANCEL_CLEANUP_PUSH(ptw32_sem_timedwait_cleanup, (void *) &cleanup_args);
+	      PTW32_TRACE_EVENT(PTW32_TRACE_SEM_WAIT_BEGIN, s, 0);
+	      PTW32_HOOK_BEFORE(hook, PTW32_WAIT_SEMAPHORE, sem);
 #ifdef NEED_SEM
 	      timedout =
 #endif
 	      result = pthreadCancelableTimedWait (s->sem, milliseconds);
-	      pthread_cleanup_pop(result);
+	      PTW32_TRACE_EVENT(PTW32_TRACE_SEM_WAIT_END, s, result);
+	      PTW32_HOOK_AFTER(hook, PTW32_WAIT_SEMAPHORE, sem,
+			       result == 0 ? s->wakerThread : 0, result);
+	      PTW32_CANCEL_CLEANUP_POP(result);
+	      /* The cleanup handler may have turned a timeout into a post. */
+	      PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_SEMAPHORE, sem, s->wakerThread, result);
+
+	      PTW32_STATS_INC(PTW32_STAT_SEM_WAITS);
+	      if (result == ETIMEDOUT)
+		{
+		  PTW32_STATS_INC(PTW32_STAT_SEM_TIMEOUTS);
+		}
 #if defined(_MSC_VER) && _MSC_VER < 800
 #pragma inline_depth()
 #endif
@@ -0,0 +1,109 @@
+/*
+ * -------------------------------------------------------------
+ *
+ * Module: sem_timedwait_slack_np.c
+ *
+ * Purpose:
+ *	Non-portable extension: sem_timedwait() with its own
+ *	timer slack.
+ *
+ * -------------------------------------------------------------
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "semaphore.h"
+#include "implement.h"
+
+
+int
+sem_timedwait_slack_np (sem_t * sem, const struct timespec *abstime,
+			unsigned long slackMillisecs)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function is sem_timedwait() with its own timer
+      *      slack.
+      *
+      * PARAMETERS
+      *      sem, abstime
+      *              as for sem_timedwait()
+      *
+      *      slackMillisecs
+      *              milliseconds the timeout may be late by
+      *
+      * DESCRIPTION
+      *      This function waits as sem_timedwait() does, but with
+      *      'slackMillisecs' in place of the calling thread's
+      *      timer slack (see pthread_setslack_np()) for the
+      *      duration of the call.
+      *      The thread's own slack is not changed:
+      *      pthread_getslack_np() still reports it, and
+      *      pthread_setslack_np() on the thread takes effect
+      *      after the call.
+      *
+      * RESULTS
+      *              as for sem_timedwait()
+      * ERRNO
+      *              as for sem_timedwait(), and
+      *              EINVAL          'slackMillisecs' is INFINITE.
+      *
+      * ------------------------------------------------------
+      */
+{
+  ptw32_thread_t * sp;
+  int result;
+
+  if (slackMillisecs >= (unsigned long) INFINITE)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  sp = (ptw32_thread_t *) pthread_self ().p;
+
+  if (sp == NULL)
+    {
+      return sem_timedwait (sem, abstime);
+    }
+
+  /*
+   * The thread's own timerSlack is left alone, so other threads
+   * can still set it; a cancellation ends the per-call slack before
+   * any earlier cleanup handler runs.
+   */
+  sp->callSlack = (DWORD) slackMillisecs + 1;
+  PTW32_CANCEL_CLEANUP_PUSH(ptw32_slack_call_end, sp);
+  result = sem_timedwait (sem, abstime);
+  PTW32_CANCEL_CLEANUP_POP(1);
+
+  return result;
+}
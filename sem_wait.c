@@ -46,10 +46,17 @@
 #include "implement.h"
 
 
+typedef struct {
+  sem_t sem;
+  int * resultPtr;
+} sem_wait_cleanup_args_t;
+
+
 static void PTW32_CDECL
-ptw32_sem_wait_cleanup(void * sem)
+ptw32_sem_wait_cleanup(void * args)
 {
-  sem_t s = (sem_t) sem;
+  sem_wait_cleanup_args_t * a = (sem_wait_cleanup_args_t *) args;
+  sem_t s = a->sem;
 
   if (pthread_mutex_lock (&s->lock) == 0)
     {
@@ -57,23 +64,31 @@ ptw32_sem_wait_cleanup(void * sem)
        * If sema is destroyed do nothing, otherwise:-
        * If the sema is posted between us being cancelled and us locking
        * the sema again above then we need to consume that post but cancel
-       * anyway. If we don't get the semaphore we indicate that we're no
-       * longer waiting.
+       * anyway. If we were interrupted rather than cancelled, the post
+       * is ours and we succeed. If we don't get the semaphore we indicate
+       * that we're no longer waiting.
        */
-      if (*((sem_t *)sem) != NULL && !(WaitForSingleObject(s->sem, 0) == WAIT_OBJECT_0))
+      if (*((sem_t *)s) != NULL)
 	{
-	  ++s->value;
-#ifdef NEED_SEM
-	  if (s->value > 0)
+	  if (WaitForSingleObject(s->sem, 0) == WAIT_OBJECT_0)
 	    {
-	      s->leftToUnblock = 0;
+	      *(a->resultPtr) = 0;
 	    }
+	  else
+	    {
+	      ++s->value;
+#ifdef NEED_SEM
+	      if (s->value > 0)
+		{
+		  s->leftToUnblock = 0;
+		}
 #else
-	  /*
-	   * Don't release the W32 sema, it doesn't need adjustment
-	   * because it doesn't record the number of waiters.
-	   */
+	      /*
+	       * Don't release the W32 sema, it doesn't need adjustment
+	       * because it doesn't record the number of waiters.
+	       */
 #endif /* NEED_SEM */
+	    }
 	}
       (void) pthread_mutex_unlock (&s->lock);
     }
@@ -104,7 +119,8 @@ sem_wait (sem_t * sem)
       * ERRNO
       *              EINVAL          'sem' is not a valid semaphore,
       *              ENOSYS          semaphores are not supported,
-      *              EINTR           the function was interrupted by a signal,
+      *              EINTR           the function was interrupted by
+      *                              pthread_interrupt_np(),
       *              EDEADLK         a deadlock condition was detected.
       *
       * ------------------------------------------------------
@@ -113,7 +129,7 @@ sem_wait (sem_t * sem)
   int result = 0;
   sem_t s = *sem;
 
-  pthread_testcancel();
+  PTW32_TESTCANCEL();
 
   if (s == NULL)
     {
@@ -121,6 +137,9 @@ sem_wait (sem_t * sem)
     }
   else
     {
+      /* Give a post that is about to happen a chance to arrive. */
+      (void) PTW32_SPIN_WAIT((volatile LONG *) &s->value, PTW32_SPIN_UNTIL_POSITIVE);
+
       if ((result = pthread_mutex_lock (&s->lock)) == 0)
 	{
 	  int v;
@@ -134,19 +153,42 @@ sem_wait (sem_t * sem)
 	      return -1;
 	    }
 
+	  if (s->waitersHead != NULL
+	      || s->wakeOrder != PTHREAD_WAKE_DEFAULT_NP)
+	    {
+	      /*
+	       * Queue behind the sem_wait_n_np() waiters, or in the
+	       * order the semaphore was asked to wake its waiters.
+	       */
+	      (void) pthread_mutex_unlock (&s->lock);
+	      return sem_wait_n_np (sem, 1, NULL);
+	    }
+
           v = --s->value;
 	  (void) pthread_mutex_unlock (&s->lock);
 
 	  if (v < 0)
 	    {
+	      sem_wait_cleanup_args_t cleanup_args;
+	      ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+
+	      cleanup_args.sem = s;
+	      cleanup_args.resultPtr = &result;
+
 #if defined(_MSC_VER) && _MSC_VER < 800
 #pragma inline_depth(0)
 #endif
 	      /* Must wait */
-	      pthread_cleanup_push(ptw32_sem_wait_cleanup, (void *) s);
+	      PTW32_CANCEL_CLEANUP_PUSH(ptw32_sem_wait_cleanup, (void *) &cleanup_args);
+	      PTW32_STATS_INC(PTW32_STAT_SEM_WAITS);
+	      PTW32_TRACE_EVENT(PTW32_TRACE_SEM_WAIT_BEGIN, s, 0);
+	      PTW32_HOOK_BEFORE(hook, PTW32_WAIT_SEMAPHORE, sem);
 	      result = pthreadCancelableWait (s->sem);
+	      PTW32_TRACE_EVENT(PTW32_TRACE_SEM_WAIT_END, s, result);
+	      PTW32_HOOK_AFTER(hook, PTW32_WAIT_SEMAPHORE, sem, s->wakerThread, result);
 	      /* Cleanup if we're canceled or on any other error */
-	      pthread_cleanup_pop(result);
+	      PTW32_CANCEL_CLEANUP_POP(result);
+	      PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_SEMAPHORE, sem, s->wakerThread, result);
 #if defined(_MSC_VER) && _MSC_VER < 800
 #pragma inline_depth()
 #endif
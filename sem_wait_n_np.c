@@ -0,0 +1,426 @@
+/*
+ * -------------------------------------------------------------
+ *
+ * Module: sem_wait_n_np.c
+ *
+ * Purpose:
+ *	Non-portable extension: acquire several semaphore tokens
+ *	as a single operation.
+ *
+ * -------------------------------------------------------------
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ */
+
+#include "pthread.h"
+#include "semaphore.h"
+#include "implement.h"
+
+
+typedef struct {
+  sem_t sem;
+  ptw32_sem_waiter_t * waiter;
+} sem_wait_n_cleanup_args_t;
+
+
+static int
+ptw32_sem_waiter_abandon (sem_t s, ptw32_sem_waiter_t * w)
+{
+  /*
+   * Called with s->lock held once the waiter has stopped waiting.
+   * Returns 1 if every token had already been handed over (the
+   * poster dequeued us). Otherwise we are still queued: unlink
+   * ourselves and pass on any tokens collected so far.
+   */
+  ptw32_sem_waiter_t * prev = NULL;
+  ptw32_sem_waiter_t * p;
+
+  if (w->got == w->n)
+    {
+      return 1;
+    }
+
+  for (p = s->waitersHead; p != w; p = p->next)
+    {
+      prev = p;
+    }
+
+  if (prev == NULL)
+    {
+      s->waitersHead = w->next;
+    }
+  else
+    {
+      prev->next = w->next;
+    }
+
+  if (s->waitersTail == w)
+    {
+      s->waitersTail = prev;
+    }
+
+  if (w->got > 0)
+    {
+      (void) ptw32_sem_release (s, w->got);
+    }
+
+  return 0;
+}
+
+
+static INLINE void
+ptw32_sem_waiter_enqueue (sem_t s, ptw32_sem_waiter_t * w)
+{
+  /*
+   * Called with s->lock held. FIFO unless the semaphore orders by
+   * priority, in which case we go behind every waiter of equal or
+   * higher priority.
+   */
+  ptw32_sem_waiter_t * prev = s->waitersTail;
+
+  if (s->wakeOrder == PTHREAD_WAKE_PRIORITY_NP)
+    {
+      ptw32_sem_waiter_t * p;
+
+      prev = NULL;
+      for (p = s->waitersHead; p != NULL && p->priority >= w->priority; p = p->next)
+	{
+	  prev = p;
+	}
+    }
+
+  if (prev == NULL)
+    {
+      w->next = s->waitersHead;
+      s->waitersHead = w;
+    }
+  else
+    {
+      w->next = prev->next;
+      prev->next = w;
+    }
+
+  if (w->next == NULL)
+    {
+      s->waitersTail = w;
+    }
+}
+
+
+static void PTW32_CDECL
+ptw32_sem_wait_n_cleanup (void * args)
+{
+  sem_wait_n_cleanup_args_t * a = (sem_wait_n_cleanup_args_t *) args;
+  sem_t s = a->sem;
+
+  if (pthread_mutex_lock (&s->lock) == 0)
+    {
+      /*
+       * We are being cancelled, so even a complete set of tokens
+       * must go back to the semaphore rather than be lost.
+       */
+      if (ptw32_sem_waiter_abandon (s, a->waiter))
+	{
+	  (void) ptw32_sem_release (s, a->waiter->n);
+	}
+      (void) pthread_mutex_unlock (&s->lock);
+    }
+
+  (void) CloseHandle (a->waiter->event);
+}
+
+
+int
+sem_wait_n_np (sem_t * sem, int n, const struct timespec *abstime)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function takes 'n' tokens from a semaphore at
+      *      once, possibly waiting until 'abstime'.
+      *
+      * PARAMETERS
+      *      sem
+      *              pointer to an instance of sem_t
+      *
+      *      n
+      *              number of tokens, must be greater than zero.
+      *
+      *      abstime
+      *              pointer to an instance of struct timespec, or
+      *              NULL to wait without a time limit.
+      *
+      * DESCRIPTION
+      *      If no other thread is waiting in this function and the
+      *      semaphore value is at least 'n', the value is decreased
+      *      by 'n' and the function returns. Otherwise the thread
+      *      joins a queue and blocks until all 'n' tokens have been
+      *      posted to it. Tokens are never taken one at a time by
+      *      the caller, so two threads each wanting several tokens
+      *      cannot deadlock holding part of what they need.
+      *
+      *      The queue is served in arrival order, or highest
+      *      sched_priority first if sem_setwakeorder_np() selected
+      *      PTHREAD_WAKE_PRIORITY_NP. The thread at its head reserves
+      *      each token as it is posted, and while the queue is not
+      *      empty sem_wait() and sem_timedwait() join it (as requests
+      *      for one token) and sem_trywait() fails. A large request
+      *      therefore cannot be starved by a stream of small ones.
+      *
+      *      On timeout, interruption or cancelation any tokens
+      *      already reserved are passed on to the next waiters.
+      *
+      * RESULTS
+      *              0               successfully took 'n' tokens,
+      *              -1              failed, error in errno
+      * ERRNO
+      *              EINVAL          'sem' is not a valid semaphore
+      *                              or 'n' is out of range,
+      *              ENOSPC          a required resource has been
+      *                              depleted,
+      *              EINTR           the function was interrupted by
+      *                              pthread_interrupt_np(),
+      *              ETIMEDOUT       abstime elapsed before success.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result = 0;
+  sem_t s;
+  ptw32_sem_waiter_t waiter;
+
+  PTW32_TESTCANCEL();
+
+  if (sem == NULL || (s = *sem) == NULL || n <= 0 || n > SEM_VALUE_MAX)
+    {
+      result = EINVAL;
+    }
+  else
+    {
+      DWORD milliseconds;
+
+      if (abstime == NULL)
+	{
+	  milliseconds = INFINITE;
+	}
+      else
+	{
+	  milliseconds = ptw32_relmillisecs (abstime);
+	}
+
+      waiter.next = NULL;
+      waiter.event = NULL;
+      waiter.n = n;
+      waiter.got = 0;
+      waiter.priority = 0;
+
+      if (s->wakeOrder == PTHREAD_WAKE_PRIORITY_NP)
+	{
+	  waiter.priority = ((ptw32_thread_t *) pthread_self ().p)->sched_priority;
+	}
+
+      /*
+       * If we look likely to block, create our event before taking
+       * the lock rather than while holding it. This is only a hint;
+       * it is checked again below.
+       */
+      if (s->waitersHead != NULL || s->value < n)
+	{
+	  waiter.event = CreateEvent (NULL, PTW32_FALSE, PTW32_FALSE, NULL);
+	}
+
+      if ((result = pthread_mutex_lock (&s->lock)) == 0)
+	{
+	  /* See sem_destroy.c
+	   */
+	  if (*sem == NULL)
+	    {
+	      (void) pthread_mutex_unlock (&s->lock);
+	      if (waiter.event != NULL)
+		{
+		  (void) CloseHandle (waiter.event);
+		}
+	      errno = EINVAL;
+	      return -1;
+	    }
+
+	  if (s->waitersHead == NULL && s->value >= n)
+	    {
+	      s->value -= n;
+	      (void) pthread_mutex_unlock (&s->lock);
+	    }
+	  else if (waiter.event == NULL
+		   && (waiter.event = CreateEvent (NULL, PTW32_FALSE, PTW32_FALSE, NULL)) == NULL)
+	    {
+	      (void) pthread_mutex_unlock (&s->lock);
+	      result = ENOSPC;
+	    }
+	  else
+	    {
+	      sem_wait_n_cleanup_args_t cleanup_args;
+	      ptw32_hook_state_t hook = PTW32_HOOK_STATE_INITIALIZER;
+
+	      ptw32_sem_waiter_enqueue (s, &waiter);
+
+	      /*
+	       * At the head of the queue we reserve whatever is available
+	       * now (less than n, or we would have taken it above).
+	       */
+	      if (s->waitersHead == &waiter && s->value > 0)
+		{
+		  waiter.got = s->value;
+		  s->value = 0;
+		}
+	      (void) pthread_mutex_unlock (&s->lock);
+
+	      cleanup_args.sem = s;
+	      cleanup_args.waiter = &waiter;
+
+#if defined(_MSC_VER) && _MSC_VER < 800
+#pragma inline_depth(0)
+#endif
+	      /* Must wait */
+	      PTW32_CANCEL_CLEANUP_PUSH(ptw32_sem_wait_n_cleanup, (void *) &cleanup_args);
+	      PTW32_STATS_INC(PTW32_STAT_SEM_WAITS);
+	      PTW32_TRACE_EVENT(PTW32_TRACE_SEM_WAIT_BEGIN, s, 0);
+	      PTW32_HOOK_BEFORE(hook, PTW32_WAIT_SEMAPHORE, sem);
+	      result = pthreadCancelableTimedWait (waiter.event, milliseconds);
+	      PTW32_TRACE_EVENT(PTW32_TRACE_SEM_WAIT_END, s, result);
+	      PTW32_HOOK_AFTER(hook, PTW32_WAIT_SEMAPHORE, sem,
+			       result == 0 ? s->wakerThread : 0, result);
+	      PTW32_CANCEL_CLEANUP_POP(0);
+#if defined(_MSC_VER) && _MSC_VER < 800
+#pragma inline_depth()
+#endif
+
+	      if (result != 0 && pthread_mutex_lock (&s->lock) == 0)
+		{
+		  /* The last of our tokens may have arrived meanwhile. */
+		  if (ptw32_sem_waiter_abandon (s, &waiter))
+		    {
+		      result = 0;
+		    }
+		  (void) pthread_mutex_unlock (&s->lock);
+		}
+	      PTW32_HOOK_ACQUIRED(hook, PTW32_WAIT_SEMAPHORE, sem, s->wakerThread, result);
+
+	      if (result == ETIMEDOUT)
+		{
+		  PTW32_STATS_INC(PTW32_STAT_SEM_TIMEOUTS);
+		}
+	    }
+	}
+
+      if (waiter.event != NULL)
+	{
+	  (void) CloseHandle (waiter.event);
+	}
+    }
+
+  if (result != 0)
+    {
+      errno = result;
+      return -1;
+    }
+
+  return 0;
+
+}				/* sem_wait_n_np */
+
+
+int
+sem_trywait_n_np (sem_t * sem, int n)
+     /*
+      * ------------------------------------------------------
+      * DOCPUBLIC
+      *      This function takes 'n' tokens from a semaphore at
+      *      once if they are available, without waiting.
+      *
+      * PARAMETERS
+      *      sem
+      *              pointer to an instance of sem_t
+      *
+      *      n
+      *              number of tokens, must be greater than zero.
+      *
+      * DESCRIPTION
+      *      If no thread is waiting in sem_wait_n_np() and the
+      *      semaphore value is at least 'n', the value is decreased
+      *      by 'n'. Otherwise the semaphore is left unchanged.
+      *
+      * RESULTS
+      *              0               successfully took 'n' tokens,
+      *              -1              failed, error in errno
+      * ERRNO
+      *              EINVAL          'sem' is not a valid semaphore
+      *                              or 'n' is out of range,
+      *              EAGAIN          fewer than 'n' tokens are available.
+      *
+      * ------------------------------------------------------
+      */
+{
+  int result = 0;
+  sem_t s;
+
+  if (sem == NULL || (s = *sem) == NULL || n <= 0 || n > SEM_VALUE_MAX)
+    {
+      result = EINVAL;
+    }
+  else if ((result = pthread_mutex_lock (&s->lock)) == 0)
+    {
+      /* See sem_destroy.c
+       */
+      if (*sem == NULL)
+        {
+          (void) pthread_mutex_unlock (&s->lock);
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (s->waitersHead == NULL && s->value >= n)
+	{
+	  s->value -= n;
+	}
+      else
+	{
+	  result = EAGAIN;
+	}
+
+      (void) pthread_mutex_unlock (&s->lock);
+    }
+
+  if (result != 0)
+    {
+      errno = result;
+      return -1;
+    }
+
+  return 0;
+
+}				/* sem_trywait_n_np */
@@ -61,8 +61,11 @@
 #include "sem_trywait.c"
 #include "sem_wait.c"
 #include "sem_timedwait.c"
+#include "sem_timedwait_slack_np.c"
 #include "sem_post.c"
 #include "sem_post_multiple.c"
+#include "sem_wait_n_np.c"
+#include "sem_setwakeorder_np.c"
 #include "sem_getvalue.c"
 #include "sem_open.c"
 #include "sem_close.c"
@@ -159,6 +159,36 @@ PTW32_DLLPORT int __cdecl sem_unlink (const char * name);
 PTW32_DLLPORT int __cdecl sem_getvalue (sem_t * sem,
 				int * sval);
 
+#if PTW32_LEVEL >= PTW32_LEVEL_MAX
+/*
+ * Non-portable: take several tokens as one operation.
+ */
+PTW32_DLLPORT int __cdecl sem_wait_n_np (sem_t * sem,
+				 int n,
+				 const struct timespec * abstime);
+
+PTW32_DLLPORT int __cdecl sem_trywait_n_np (sem_t * sem,
+				    int n);
+
+/*
+ * Non-portable: release order, one of the PTHREAD_WAKE_*_NP
+ * values from pthread.h.
+ */
+PTW32_DLLPORT int __cdecl sem_setwakeorder_np (sem_t * sem,
+				       int order);
+
+PTW32_DLLPORT int __cdecl sem_getwakeorder_np (sem_t * sem,
+				       int * order);
+
+/*
+ * Non-portable: sem_timedwait() with its own timer slack (see
+ * pthread_setslack_np() in pthread.h).
+ */
+PTW32_DLLPORT int __cdecl sem_timedwait_slack_np (sem_t * sem,
+					  const struct timespec * abstime,
+					  unsigned long slackMillisecs);
+#endif /* PTW32_LEVEL >= PTW32_LEVEL_MAX */
+
 #ifdef __cplusplus
 }				/* End of extern "C" */
 #endif				/* __cplusplus */
@@ -0,0 +1,115 @@
+/*
+ * benchport.h
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Portability layer for the benchtests that also build natively
+ * against another pthreads implementation (e.g. glibc NPTL on Linux)
+ * so that results can be compared on the same hardware:
+ *
+ *   cc -O2 -o benchtest7-nptl benchtest7.c -pthread
+ *
+ * Under Win32 this pulls in the usual test headers. Elsewhere it
+ * provides the same always-evaluating assert() as test.h.
+ */
+
+#ifndef BENCHPORT_H
+#define BENCHPORT_H
+
+#if defined(_WIN32)
+
+#include "test.h"
+
+#ifdef __GNUC__
+#include <stdlib.h>
+#endif
+
+#include "benchtest.h"
+
+typedef LONGLONG bench_ticks_t;
+
+static bench_ticks_t
+bench_now(void)
+{
+  LARGE_INTEGER t;
+
+  QueryPerformanceCounter(&t);
+  return t.QuadPart;
+}
+
+static bench_ticks_t
+bench_frequency(void)
+{
+  LARGE_INTEGER f;
+
+  assert(QueryPerformanceFrequency(&f));
+  return f.QuadPart;
+}
+
+#define bench_processors() pthread_num_processors_np()
+
+#else /* _WIN32 */
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 700
+#endif
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+# define assert(e) \
+   ((e) ? 0 : \
+          (fprintf(stderr, "Assertion failed: (%s), file %s, line %d\n", \
+                   #e, __FILE__, (int) __LINE__), exit(1), 0))
+
+typedef long long bench_ticks_t;
+
+static bench_ticks_t
+bench_now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (bench_ticks_t) t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+#define bench_frequency() ((bench_ticks_t) 1000000000)
+#define bench_processors() ((int) sysconf(_SC_NPROCESSORS_ONLN))
+
+#endif /* _WIN32 */
+
+#endif /* BENCHPORT_H */
@@ -0,0 +1,282 @@
+/*
+ * benchtest10.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Measure the acquire latency of a high priority thread competing
+ * with normal priority threads for one resource, under each wake
+ * order (see sem_setwakeorder_np() and
+ * pthread_condattr_setwakeorder_np()).
+ *
+ * The resource is either a semaphore with one token or a flag
+ * guarded by a mutex and condition variable. Twice as many normal
+ * priority threads as processors (at least 4) take it, hold it
+ * briefly, give it back and work briefly outside it, until the
+ * THREAD_PRIORITY_HIGHEST thread has timed the given number of
+ * acquisitions of its own.
+ *
+ * Output is CSV, with latencies in microseconds:
+ *
+ *   order,primitive,threads,samples,p50_usec,p99_usec,p999_usec,max_usec
+ *
+ * Usage: benchtest10 [samples]
+ */
+
+#include "benchport.h"
+
+#define SAMPLES  2000L
+#define HOLD     2000           /* spin iterations holding the resource */
+
+typedef struct {
+  const char * name;
+  int order;
+} order_t;
+
+static order_t orders[] = {
+  {"default",  PTHREAD_WAKE_DEFAULT_NP},
+  {"fifo",     PTHREAD_WAKE_FIFO_NP},
+  {"priority", PTHREAD_WAKE_PRIORITY_NP}
+};
+
+static const char * primitives[] = { "sem", "cond" };
+
+static long samples = SAMPLES;
+static bench_ticks_t frequency;
+static bench_ticks_t * latency;
+
+static int useCond;
+static sem_t sem;
+static pthread_mutex_t mx;
+static pthread_cond_t cv;
+static int busy;
+static volatile int stop;
+
+static void
+spin(int n)
+{
+  volatile long sink = 0;
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      sink++;
+    }
+}
+
+static void
+acquire(void)
+{
+  if (useCond)
+    {
+      assert(pthread_mutex_lock(&mx) == 0);
+      while (busy)
+        {
+          assert(pthread_cond_wait(&cv, &mx) == 0);
+        }
+      busy = 1;
+      assert(pthread_mutex_unlock(&mx) == 0);
+    }
+  else
+    {
+      assert(sem_wait(&sem) == 0);
+    }
+}
+
+static void
+release(void)
+{
+  if (useCond)
+    {
+      assert(pthread_mutex_lock(&mx) == 0);
+      busy = 0;
+      assert(pthread_cond_signal(&cv) == 0);
+      assert(pthread_mutex_unlock(&mx) == 0);
+    }
+  else
+    {
+      assert(sem_post(&sem) == 0);
+    }
+}
+
+static void *
+loadThread(void * arg)
+{
+  while (!stop)
+    {
+      acquire();
+      spin(HOLD);
+      release();
+      spin(HOLD);
+    }
+
+  return NULL;
+}
+
+static void *
+highThread(void * arg)
+{
+  long i;
+
+  for (i = 0; i < samples; i++)
+    {
+      bench_ticks_t start = bench_now();
+
+      acquire();
+      latency[i] = bench_now() - start;
+      spin(HOLD);
+      release();
+      spin(HOLD * 4);
+    }
+
+  return NULL;
+}
+
+static int
+compareTicks(const void * a, const void * b)
+{
+  bench_ticks_t x = *(const bench_ticks_t *) a;
+  bench_ticks_t y = *(const bench_ticks_t *) b;
+
+  return (x > y) - (x < y);
+}
+
+static double
+percentileUsecs(double p)
+{
+  long i = (long) (p * (double) (samples - 1));
+
+  return (double) latency[i] * 1E6 / (double) frequency;
+}
+
+static void
+runBench(order_t * o, int primitive, int nthreads)
+{
+  pthread_t * t;
+  pthread_t high;
+  pthread_attr_t attr;
+  pthread_condattr_t ca;
+  struct sched_param param;
+  int i;
+
+  t = (pthread_t *) calloc(nthreads, sizeof(pthread_t));
+  assert(t != NULL);
+
+  useCond = primitive;
+  busy = 0;
+  stop = 0;
+  assert(sem_init(&sem, 0, 1) == 0);
+  assert(sem_setwakeorder_np(&sem, o->order) == 0);
+  assert(pthread_mutex_init(&mx, NULL) == 0);
+  assert(pthread_condattr_init(&ca) == 0);
+  assert(pthread_condattr_setwakeorder_np(&ca, o->order) == 0);
+  assert(pthread_cond_init(&cv, &ca) == 0);
+  assert(pthread_condattr_destroy(&ca) == 0);
+
+  for (i = 0; i < nthreads; i++)
+    {
+      assert(pthread_create(&t[i], NULL, loadThread, NULL) == 0);
+    }
+
+  /* Let the load build up before timing. */
+  Sleep(100);
+
+  assert(pthread_attr_init(&attr) == 0);
+  assert(pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED) == 0);
+  param.sched_priority = THREAD_PRIORITY_HIGHEST;
+  assert(pthread_attr_setschedparam(&attr, &param) == 0);
+  assert(pthread_create(&high, &attr, highThread, NULL) == 0);
+  assert(pthread_join(high, NULL) == 0);
+  assert(pthread_attr_destroy(&attr) == 0);
+
+  stop = 1;
+  for (i = 0; i < nthreads; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+
+  assert(pthread_cond_destroy(&cv) == 0);
+  assert(pthread_mutex_destroy(&mx) == 0);
+  assert(sem_destroy(&sem) == 0);
+
+  qsort(latency, samples, sizeof(latency[0]), compareTicks);
+
+  printf("%s,%s,%d,%ld,%.1f,%.1f,%.1f,%.1f\n",
+         o->name,
+         primitives[primitive],
+         nthreads,
+         samples,
+         percentileUsecs(0.5),
+         percentileUsecs(0.99),
+         percentileUsecs(0.999),
+         percentileUsecs(1.0));
+  fflush(stdout);
+
+  free(t);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int nthreads = 2 * bench_processors();
+  int i, j;
+
+  if (argc > 1)
+    {
+      samples = atol(argv[1]);
+    }
+  assert(samples > 0);
+
+  if (nthreads < 4)
+    {
+      nthreads = 4;
+    }
+
+  latency = (bench_ticks_t *) calloc(samples, sizeof(bench_ticks_t));
+  assert(latency != NULL);
+
+  frequency = bench_frequency();
+
+  printf("order,primitive,threads,samples,p50_usec,p99_usec,p999_usec,max_usec\n");
+
+  for (i = 0; i < (int) (sizeof(orders) / sizeof(orders[0])); i++)
+    {
+      for (j = 0; j < (int) (sizeof(primitives) / sizeof(primitives[0])); j++)
+        {
+          runBench(&orders[i], j, nthreads);
+        }
+    }
+
+  free(latency);
+
+  return 0;
+}
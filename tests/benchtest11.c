@@ -0,0 +1,231 @@
+/*
+ * benchtest11.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * Measure the message rate into one receiving thread from 1, 2, 4...
+ * senders, using the thread's own mailbox (pthread_send_np() and
+ * pthread_recv_np()) and an inbox built from a mutex, a condition
+ * variable and a list.
+ *
+ * The main thread receives. Every sender sends the given number of
+ * messages as fast as it can; the time runs from releasing the
+ * senders to the receipt of the last message.
+ *
+ * Output is CSV:
+ *
+ *   inbox,senders,messages,msec,msgs_per_sec
+ *
+ * Usage: benchtest11 [messages_per_sender]
+ */
+
+#include "benchport.h"
+
+#define MESSAGES  100000L
+
+typedef struct msg_t_ {
+  struct ptw32_msg link;        /* First, so a message is its link */
+  struct msg_t_ * next;         /* For the condvar inbox */
+} msg_t;
+
+static const char * inboxes[] = { "mailbox", "condvar" };
+
+static long messages = MESSAGES;
+static int useCond;
+static pthread_t receiver;
+static pthread_barrier_t go;
+
+static pthread_mutex_t mx;
+static pthread_cond_t cv;
+static msg_t * head;
+static msg_t * tail;
+
+static void
+inboxSend(msg_t * m)
+{
+  if (useCond)
+    {
+      m->next = NULL;
+      assert(pthread_mutex_lock(&mx) == 0);
+      if (tail == NULL)
+        {
+          head = m;
+          assert(pthread_cond_signal(&cv) == 0);
+        }
+      else
+        {
+          tail->next = m;
+        }
+      tail = m;
+      assert(pthread_mutex_unlock(&mx) == 0);
+    }
+  else
+    {
+      assert(pthread_send_np(receiver, &m->link) == 0);
+    }
+}
+
+static msg_t *
+inboxReceive(void)
+{
+  msg_t * m;
+
+  if (useCond)
+    {
+      assert(pthread_mutex_lock(&mx) == 0);
+      while (head == NULL)
+        {
+          assert(pthread_cond_wait(&cv, &mx) == 0);
+        }
+      m = head;
+      head = m->next;
+      if (head == NULL)
+        {
+          tail = NULL;
+        }
+      assert(pthread_mutex_unlock(&mx) == 0);
+    }
+  else
+    {
+      struct ptw32_msg * link;
+
+      assert(pthread_recv_np(&link, NULL) == 0);
+      m = (msg_t *) link;
+    }
+
+  return m;
+}
+
+static void *
+senderThread(void * arg)
+{
+  msg_t * m = (msg_t *) arg;
+  long i;
+
+  pthread_barrier_wait(&go);
+
+  for (i = 0; i < messages; i++)
+    {
+      inboxSend(&m[i]);
+    }
+
+  return NULL;
+}
+
+static void
+runBench(int inbox, int nsenders)
+{
+  pthread_t * t;
+  msg_t * m;
+  bench_ticks_t start;
+  double msec;
+  long total = messages * nsenders;
+  long i;
+
+  t = (pthread_t *) calloc(nsenders, sizeof(pthread_t));
+  m = (msg_t *) calloc(total, sizeof(msg_t));
+  assert(t != NULL && m != NULL);
+
+  useCond = inbox;
+  head = tail = NULL;
+  assert(pthread_barrier_init(&go, NULL, nsenders + 1) == 0);
+
+  for (i = 0; i < nsenders; i++)
+    {
+      assert(pthread_create(&t[i], NULL, senderThread, &m[i * messages]) == 0);
+    }
+
+  pthread_barrier_wait(&go);
+  start = bench_now();
+
+  for (i = 0; i < total; i++)
+    {
+      (void) inboxReceive();
+    }
+
+  msec = (double) (bench_now() - start) * 1E3 / (double) bench_frequency();
+
+  for (i = 0; i < nsenders; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+
+  assert(pthread_barrier_destroy(&go) == 0);
+
+  printf("%s,%d,%ld,%.1f,%.0f\n",
+         inboxes[inbox],
+         nsenders,
+         total,
+         msec,
+         msec > 0 ? (double) total * 1E3 / msec : 0.0);
+  fflush(stdout);
+
+  free(m);
+  free(t);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int maxSenders = 2 * bench_processors();
+  int n, j;
+
+  if (argc > 1)
+    {
+      messages = atol(argv[1]);
+    }
+  assert(messages > 0);
+
+  if (maxSenders < 4)
+    {
+      maxSenders = 4;
+    }
+
+  receiver = pthread_self();
+  assert(pthread_mutex_init(&mx, NULL) == 0);
+  assert(pthread_cond_init(&cv, NULL) == 0);
+
+  printf("inbox,senders,messages,msec,msgs_per_sec\n");
+
+  for (n = 1; n <= maxSenders; n *= 2)
+    {
+      for (j = 0; j < (int) (sizeof(inboxes) / sizeof(inboxes[0])); j++)
+        {
+          runBench(j, n);
+        }
+    }
+
+  assert(pthread_cond_destroy(&cv) == 0);
+  assert(pthread_mutex_destroy(&mx) == 0);
+
+  return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * benchtest12.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * Count the wakeups caused by idle timed waiters with 0, 1, 10 and
+ * 50 ms of timer slack (pthread_setslack_np()).
+ *
+ * Each thread waits on a condition variable that is never signalled,
+ * with a fresh deadline one period ahead each time. The periods are
+ * staggered so that, without slack, the deadlines are spread over the
+ * period. Every timeout marks the millisecond it woke in; the number
+ * of distinct milliseconds marked per second is the number of times
+ * the CPU had to wake up for the waiters.
+ *
+ * Output is CSV:
+ *
+ *   slack_ms,threads,seconds,timeouts_per_sec,wakeups_per_sec
+ *
+ * Usage: benchtest12 [threads [seconds]]
+ */
+
+#include "benchport.h"
+#include <sys/timeb.h>
+
+#define THREADS   64
+#define SECONDS   2
+#define PERIOD    100           /* ms between deadlines of one thread */
+
+static const unsigned long slacks[] = { 0, 1, 10, 50 };
+
+static int nthreads = THREADS;
+static int seconds = SECONDS;
+static unsigned long slack;
+static volatile int stop;
+static char * slots;            /* One per millisecond of the run */
+static long nslots;
+static bench_ticks_t start;
+static LONG timeouts;
+
+static pthread_mutex_t mx;
+static pthread_cond_t cv;
+static pthread_barrier_t go;
+
+static void
+deadline(struct timespec * abstime, int ms)
+{
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTime;
+#else
+  struct _timeb currSysTime;
+#endif
+
+  PTW32_FTIME(&currSysTime);
+
+  abstime->tv_sec = (long)currSysTime.time + (currSysTime.millitm + ms) / 1000;
+  abstime->tv_nsec = ((currSysTime.millitm + ms) % 1000) * 1000000L;
+}
+
+static void *
+waiterThread(void * arg)
+{
+  int period = PERIOD + (int) (size_t) arg % PERIOD;
+  struct timespec abstime;
+  long slot;
+
+  assert(pthread_setslack_np(pthread_self(), slack) == 0);
+  pthread_barrier_wait(&go);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  while (!stop)
+    {
+      deadline(&abstime, period);
+      if (pthread_cond_timedwait(&cv, &mx, &abstime) == ETIMEDOUT)
+        {
+          slot = (long) ((bench_now() - start) * 1000 / bench_frequency());
+          if (slot < nslots)
+            {
+              slots[slot] = 1;
+              timeouts++;
+            }
+        }
+    }
+  assert(pthread_mutex_unlock(&mx) == 0);
+
+  return NULL;
+}
+
+static void
+runBench(void)
+{
+  pthread_t * t;
+  long i, wakeups = 0;
+
+  t = (pthread_t *) calloc(nthreads, sizeof(pthread_t));
+  assert(t != NULL);
+  memset(slots, 0, nslots);
+  stop = 0;
+  timeouts = 0;
+  assert(pthread_barrier_init(&go, NULL, nthreads + 1) == 0);
+
+  for (i = 0; i < nthreads; i++)
+    {
+      assert(pthread_create(&t[i], NULL, waiterThread, (void *) (size_t) (i * 37)) == 0);
+    }
+
+  start = bench_now();
+  pthread_barrier_wait(&go);
+  Sleep(seconds * 1000);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  stop = 1;
+  assert(pthread_cond_broadcast(&cv) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+
+  for (i = 0; i < nthreads; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+
+  assert(pthread_barrier_destroy(&go) == 0);
+
+  for (i = 0; i < nslots; i++)
+    {
+      wakeups += slots[i];
+    }
+
+  printf("%lu,%d,%d,%.0f,%.0f\n",
+         slack,
+         nthreads,
+         seconds,
+         (double) timeouts / seconds,
+         (double) wakeups / seconds);
+  fflush(stdout);
+
+  free(t);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int j;
+
+  if (argc > 1)
+    {
+      nthreads = atoi(argv[1]);
+    }
+  if (argc > 2)
+    {
+      seconds = atoi(argv[2]);
+    }
+  assert(nthreads > 0 && seconds > 0);
+
+  nslots = seconds * 1000L;
+  slots = (char *) malloc(nslots);
+  assert(slots != NULL);
+  assert(pthread_mutex_init(&mx, NULL) == 0);
+  assert(pthread_cond_init(&cv, NULL) == 0);
+
+  printf("slack_ms,threads,seconds,timeouts_per_sec,wakeups_per_sec\n");
+
+  for (j = 0; j < (int) (sizeof(slacks) / sizeof(slacks[0])); j++)
+    {
+      slack = slacks[j];
+      runBench();
+    }
+
+  assert(pthread_cond_destroy(&cv) == 0);
+  assert(pthread_mutex_destroy(&mx) == 0);
+  free(slots);
+
+  return 0;
+}
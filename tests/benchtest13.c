@@ -0,0 +1,573 @@
+/*
+ * benchtest13.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * Replay a lock trace (pthread_locktrace_np()) against each mutex
+ * kind and report throughput and the distribution of lock waits.
+ *
+ * Every traced thread is replayed by a thread of its own which
+ * performs the same mutex operations in the same order. Before each
+ * operation it spins (or, for gaps of more than a few milliseconds,
+ * sleeps and then spins) for as long as the traced thread worked
+ * between the end of its previous operation and the call, so the
+ * hold and think times are those of the recording; only the waits
+ * depend on the mutex kind. Successful trylocks are replayed as
+ * trylocks, and a release is skipped if its lock wasn't obtained.
+ *
+ * Without a trace file a small synthetic workload is recorded first
+ * and replayed.
+ *
+ * Output is CSV, with a first row for the recording itself:
+ *
+ *   kind,threads,mutexes,acquires,msec,acquires_per_sec,
+ *   wait_p50_us,wait_p90_us,wait_p99_us,wait_max_us
+ *
+ * Usage: benchtest13 [tracefile [kind ...]]
+ *
+ * where kind is normal, errorcheck, recursive, cohort or robust.
+ */
+
+#include "benchport.h"
+
+#define HEADER_SIZE     56
+#define RECORD_SIZE     24
+#define OP_LOCK         1
+#define OP_TRYLOCK      2
+#define OP_UNLOCK       3
+
+#define SLEEP_MSEC      4       /* Gaps longer than this sleep */
+
+/* The synthetic workload */
+#define THREADS         4
+#define ITERATIONS      5000
+#define MUTEXES         3
+#define TRACEFILE       "benchtest13.lkt"
+
+typedef struct {
+  const char * name;
+  int type;
+  int robust;
+} kind_t;
+
+static const kind_t kinds[] = {
+  { "normal",     PTHREAD_MUTEX_NORMAL,     0 },
+  { "errorcheck", PTHREAD_MUTEX_ERRORCHECK, 0 },
+  { "recursive",  PTHREAD_MUTEX_RECURSIVE,  0 },
+  { "cohort",     PTHREAD_MUTEX_COHORT_NP,  0 },
+  { "robust",     PTHREAD_MUTEX_NORMAL,     1 }
+};
+
+#define NUM_KINDS ((int) (sizeof (kinds) / sizeof (kinds[0])))
+
+typedef struct {
+  unsigned long object;
+  int op;
+  bench_ticks_t gap;            /* Work before the call */
+} op_t;
+
+typedef struct {
+  op_t * ops;
+  long count;
+  long acquires;
+  double * waits;               /* Microseconds, one per acquire */
+  long nwaits;
+} replay_t;
+
+static replay_t * replays;
+static unsigned long nthreads;
+static unsigned long nobjects;
+static pthread_mutex_t * mutexes;
+static pthread_barrier_t go;
+static bench_ticks_t frequency;
+static bench_ticks_t start;
+
+static unsigned long
+get32 (const unsigned char * p)
+{
+  return (unsigned long) p[0]
+    | ((unsigned long) p[1] << 8)
+    | ((unsigned long) p[2] << 16)
+    | ((unsigned long) p[3] << 24);
+}
+
+static double
+get64 (const unsigned char * p)
+{
+  return (double) get32 (p) + (double) get32 (p + 4) * 4294967296.0;
+}
+
+static int
+compareWaits (const void * a, const void * b)
+{
+  double wa = *(const double *) a;
+  double wb = *(const double *) b;
+
+  return (wa < wb) ? -1 : (wa > wb) ? 1 : 0;
+}
+
+static void
+work (bench_ticks_t until)
+{
+  bench_ticks_t now = bench_now();
+
+  if (until - now > SLEEP_MSEC * frequency / 1000)
+    {
+      Sleep((DWORD) ((until - now) * 1000 / frequency) - 1);
+    }
+
+  while (bench_now() < until)
+    {
+      ;
+    }
+}
+
+/*
+ * Synthetic workload: short think and hold times, with one thread
+ * in four nesting a second mutex (always in id order).
+ */
+static void *
+workloadThread(void * arg)
+{
+  unsigned long seed = (unsigned long) (size_t) arg * 2654435761UL + 1;
+  bench_ticks_t us = frequency / 1000000;
+  int i, a, b;
+
+  pthread_barrier_wait(&go);
+
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      seed = seed * 1103515245UL + 12345;
+      a = (int) ((seed >> 16) % MUTEXES);
+      b = (int) ((seed >> 20) % MUTEXES);
+
+      work(bench_now() + us * (bench_ticks_t) ((seed >> 8) % 20));
+      assert(pthread_mutex_lock(&mutexes[a]) == 0);
+      work(bench_now() + us * (bench_ticks_t) ((seed >> 12) % 5));
+
+      if ((size_t) arg % 4 == 0 && b > a)
+        {
+          assert(pthread_mutex_lock(&mutexes[b]) == 0);
+          work(bench_now() + us * 2);
+          assert(pthread_mutex_unlock(&mutexes[b]) == 0);
+        }
+
+      assert(pthread_mutex_unlock(&mutexes[a]) == 0);
+    }
+
+  return NULL;
+}
+
+static void
+record (const char * path)
+{
+  pthread_t t[THREADS];
+  int i;
+
+  mutexes = (pthread_mutex_t *) calloc(MUTEXES, sizeof(pthread_mutex_t));
+  assert(mutexes != NULL);
+
+  for (i = 0; i < MUTEXES; i++)
+    {
+      assert(pthread_mutex_init(&mutexes[i], NULL) == 0);
+    }
+
+  assert(pthread_barrier_init(&go, NULL, THREADS) == 0);
+  assert(pthread_locktrace_np(THREADS * ITERATIONS * 4 + 1000) == 0);
+
+  for (i = 0; i < THREADS; i++)
+    {
+      assert(pthread_create(&t[i], NULL, workloadThread, (void *) (size_t) i) == 0);
+    }
+
+  for (i = 0; i < THREADS; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+
+  assert(pthread_locktrace_np(0) == 0);
+  assert(pthread_locktrace_dump_np(path) == 0);
+  assert(pthread_barrier_destroy(&go) == 0);
+
+  for (i = 0; i < MUTEXES; i++)
+    {
+      assert(pthread_mutex_destroy(&mutexes[i]) == 0);
+    }
+
+  free(mutexes);
+}
+
+static void
+report (const char * kind, long acquires, double msec, double * waits, long n)
+{
+  qsort(waits, n, sizeof(double), compareWaits);
+
+  printf("%s,%lu,%lu,%ld,%.1f,%.0f,%.2f,%.2f,%.2f,%.2f\n",
+         kind,
+         nthreads,
+         nobjects,
+         acquires,
+         msec,
+         msec > 0 ? (double) acquires * 1E3 / msec : 0.0,
+         n > 0 ? waits[(n - 1) / 2] : 0.0,
+         n > 0 ? waits[(long) ((n - 1) * 0.90)] : 0.0,
+         n > 0 ? waits[(long) ((n - 1) * 0.99)] : 0.0,
+         n > 0 ? waits[n - 1] : 0.0);
+  fflush(stdout);
+}
+
+/*
+ * Read the trace into one list of operations per thread, with the
+ * gap before each operation converted to our counter's ticks, and
+ * print the recording's own row.
+ */
+static void
+load (const char * path)
+{
+  FILE * in;
+  unsigned char header[HEADER_SIZE];
+  unsigned char raw[RECORD_SIZE];
+  unsigned long count, recordSize, n, i;
+  double ticksPerSecond, first = -1.0, last = 0.0;
+  double * lastEnd;
+  double * waits;
+  long nwaits = 0;
+
+  in = fopen(path, "rb");
+  assert(in != NULL);
+  assert(fread(header, HEADER_SIZE, 1, in) == 1);
+  assert(memcmp(header, "PTW32LKT", 8) == 0);
+  assert(get32(header + 8) == 1);
+  recordSize = get32(header + 12);
+  assert(recordSize >= RECORD_SIZE);
+  ticksPerSecond = get64(header + 16);
+  assert(ticksPerSecond > 0.0);
+  count = get32(header + 36);
+  nthreads = get32(header + 40);
+  nobjects = get32(header + 44);
+
+  replays = (replay_t *) calloc(nthreads + 1, sizeof(replay_t));
+  lastEnd = (double *) calloc(nthreads + 1, sizeof(double));
+  waits = (double *) calloc(count + 1, sizeof(double));
+  assert(replays != NULL && lastEnd != NULL && waits != NULL);
+
+  /* First pass: sizes and the start of the trace. */
+  for (n = 0; n < count; n++)
+    {
+      unsigned long thread;
+      double ticks;
+
+      assert(fread(raw, RECORD_SIZE, 1, in) == 1);
+      assert(recordSize == RECORD_SIZE
+             || fseek(in, (long) (recordSize - RECORD_SIZE), SEEK_CUR) == 0);
+      ticks = get64(raw);
+      thread = get32(raw + 12);
+
+      if (thread != 0 && thread <= nthreads)
+        {
+          replays[thread].count++;
+          if (first < 0.0 || ticks < first)
+            {
+              first = ticks;
+            }
+        }
+    }
+
+  for (i = 1; i <= nthreads; i++)
+    {
+      replays[i].ops = (op_t *) calloc(replays[i].count + 1, sizeof(op_t));
+      assert(replays[i].ops != NULL);
+      replays[i].count = 0;
+      lastEnd[i] = first;
+    }
+
+  /* Second pass: the operations. */
+  assert(fseek(in, HEADER_SIZE, SEEK_SET) == 0);
+
+  for (n = 0; n < count; n++)
+    {
+      unsigned long object, thread;
+      double ticks, wait;
+      replay_t * r;
+      op_t * op;
+
+      assert(fread(raw, RECORD_SIZE, 1, in) == 1);
+      assert(recordSize == RECORD_SIZE
+             || fseek(in, (long) (recordSize - RECORD_SIZE), SEEK_CUR) == 0);
+      ticks = get64(raw);
+      object = get32(raw + 8);
+      thread = get32(raw + 12);
+      wait = (double) get32(raw + 16);
+
+      if (thread == 0 || thread > nthreads || object == 0 || object > nobjects)
+        {
+          continue;
+        }
+
+      r = &replays[thread];
+      op = &r->ops[r->count++];
+      op->object = object;
+      op->op = (int) (get32(raw + 20) & 0xffff);
+      op->gap = (bench_ticks_t) ((ticks > lastEnd[thread] ? ticks - lastEnd[thread] : 0.0)
+                                 * (double) frequency / ticksPerSecond);
+
+      if (op->op == OP_LOCK || op->op == OP_TRYLOCK)
+        {
+          r->acquires++;
+          waits[nwaits++] = wait * 1E6 / ticksPerSecond;
+          ticks += wait;
+        }
+
+      lastEnd[thread] = ticks;
+      if (ticks > last)
+        {
+          last = ticks;
+        }
+    }
+
+  fclose(in);
+
+  for (i = 1; i <= nthreads; i++)
+    {
+      replays[i].waits = (double *) calloc(replays[i].acquires + 1, sizeof(double));
+      assert(replays[i].waits != NULL);
+    }
+
+  report("recorded", nwaits,
+         first >= 0.0 ? (last - first) * 1E3 / ticksPerSecond : 0.0,
+         waits, nwaits);
+
+  free(waits);
+  free(lastEnd);
+}
+
+static void *
+replayThread(void * arg)
+{
+  replay_t * r = (replay_t *) arg;
+  char * held = (char *) calloc(nobjects + 1, 1);
+  bench_ticks_t end, t0;
+  long i;
+
+  assert(held != NULL);
+  r->nwaits = 0;
+
+  pthread_barrier_wait(&go);
+  end = start;
+
+  for (i = 0; i < r->count; i++)
+    {
+      op_t * op = &r->ops[i];
+      pthread_mutex_t * mx = &mutexes[op->object];
+
+      work(end + op->gap);
+      t0 = bench_now();
+
+      switch (op->op)
+        {
+        case OP_LOCK:
+          if (!held[op->object])
+            {
+              assert(pthread_mutex_lock(mx) == 0);
+              held[op->object] = 1;
+            }
+          break;
+        case OP_TRYLOCK:
+          if (!held[op->object])
+            {
+              held[op->object] = (pthread_mutex_trylock(mx) == 0);
+            }
+          break;
+        case OP_UNLOCK:
+          if (held[op->object])
+            {
+              assert(pthread_mutex_unlock(mx) == 0);
+              held[op->object] = 0;
+            }
+          break;
+        }
+
+      end = bench_now();
+
+      if (op->op != OP_UNLOCK)
+        {
+          r->waits[r->nwaits++] = (double) (end - t0) * 1E6 / (double) frequency;
+        }
+    }
+
+  for (i = 1; i <= (long) nobjects; i++)
+    {
+      if (held[i])
+        {
+          assert(pthread_mutex_unlock(&mutexes[i]) == 0);
+        }
+    }
+
+  free(held);
+
+  return NULL;
+}
+
+static void
+replay (const kind_t * kind)
+{
+  pthread_t * t;
+  pthread_mutexattr_t ma;
+  double * waits;
+  double msec;
+  long nwaits = 0, acquires = 0;
+  unsigned long i;
+
+  t = (pthread_t *) calloc(nthreads + 1, sizeof(pthread_t));
+  mutexes = (pthread_mutex_t *) calloc(nobjects + 1, sizeof(pthread_mutex_t));
+  assert(t != NULL && mutexes != NULL);
+
+  assert(pthread_mutexattr_init(&ma) == 0);
+  assert(pthread_mutexattr_settype(&ma, kind->type) == 0);
+  if (kind->robust && pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST) != 0)
+    {
+      /* A build without robust mutexes */
+      assert(pthread_mutexattr_destroy(&ma) == 0);
+      free(mutexes);
+      free(t);
+      return;
+    }
+
+  for (i = 1; i <= nobjects; i++)
+    {
+      assert(pthread_mutex_init(&mutexes[i], &ma) == 0);
+    }
+
+  assert(pthread_mutexattr_destroy(&ma) == 0);
+  assert(pthread_barrier_init(&go, NULL, nthreads + 1) == 0);
+
+  for (i = 1; i <= nthreads; i++)
+    {
+      assert(pthread_create(&t[i], NULL, replayThread, &replays[i]) == 0);
+    }
+
+  /* Leave the threads time to reach the barrier. */
+  start = bench_now() + frequency / 100;
+  pthread_barrier_wait(&go);
+
+  for (i = 1; i <= nthreads; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+
+  msec = (double) (bench_now() - start) * 1E3 / (double) frequency;
+
+  for (i = 1; i <= nthreads; i++)
+    {
+      acquires += replays[i].acquires;
+    }
+
+  waits = (double *) calloc(acquires + 1, sizeof(double));
+  assert(waits != NULL);
+
+  for (i = 1; i <= nthreads; i++)
+    {
+      memcpy(waits + nwaits, replays[i].waits, replays[i].nwaits * sizeof(double));
+      nwaits += replays[i].nwaits;
+    }
+
+  report(kind->name, acquires, msec, waits, nwaits);
+
+  assert(pthread_barrier_destroy(&go) == 0);
+
+  for (i = 1; i <= nobjects; i++)
+    {
+      assert(pthread_mutex_destroy(&mutexes[i]) == 0);
+    }
+
+  free(waits);
+  free(mutexes);
+  free(t);
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char * path = TRACEFILE;
+  unsigned long i;
+  int j, k;
+
+  frequency = bench_frequency();
+
+  if (argc > 1)
+    {
+      path = argv[1];
+    }
+  else
+    {
+      record(path);
+    }
+
+  printf("kind,threads,mutexes,acquires,msec,acquires_per_sec,"
+         "wait_p50_us,wait_p90_us,wait_p99_us,wait_max_us\n");
+
+  load(path);
+
+  if (argc > 2)
+    {
+      for (j = 2; j < argc; j++)
+        {
+          for (k = 0; k < NUM_KINDS && strcmp(argv[j], kinds[k].name) != 0; k++)
+            {
+              ;
+            }
+          assert(k < NUM_KINDS);
+          replay(&kinds[k]);
+        }
+    }
+  else
+    {
+      for (k = 0; k < NUM_KINDS; k++)
+        {
+          replay(&kinds[k]);
+        }
+    }
+
+  for (i = 1; i <= nthreads; i++)
+    {
+      free(replays[i].waits);
+      free(replays[i].ops);
+    }
+  free(replays);
+
+  if (argc == 1)
+    {
+      remove(path);
+    }
+
+  return 0;
+}
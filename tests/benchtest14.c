@@ -0,0 +1,358 @@
+/*
+ * benchtest14.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ *
+ * Measure the latency of handing one item at a time from a producer
+ * thread to a consumer thread with no buffer in between:
+ *
+ *   exchanger        pthread_exchanger_put_np()/_take_np()
+ *   exchanger_park   the same with the wait policy's spinning off
+ *   mutex_cond       a one-slot rendezvous on a mutex and two
+ *                    condition variables, the producer waiting until
+ *                    its item has been taken
+ *   semaphore_pair   a slot guarded by a "full" and an "empty"
+ *                    semaphore
+ *   exchange         two threads swapping items with
+ *                    pthread_exchanger_exchange_np()
+ *
+ * The producer stamps the time into each item just before handing it
+ * over; the latency is the time from that stamp until the consumer
+ * has the item. For exchange, each thread's item is stamped and one
+ * side records the latency of the items it receives.
+ *
+ * Output is CSV:
+ *
+ *   method,handoffs,msec,handoffs_per_sec,latency_p50_us,latency_p99_us
+ *
+ * Usage: benchtest14 [handoffs]
+ */
+
+#include "benchport.h"
+
+#define HANDOFFS  100000
+
+typedef struct {
+  const char * name;
+  int spin;                     /* Keep the wait policy's spinning */
+  void (*init)(void);
+  void (*put)(bench_ticks_t * item);
+  bench_ticks_t * (*take)(void);
+  void (*destroy)(void);
+} method_t;
+
+static long handoffs = HANDOFFS;
+static bench_ticks_t * stamps;
+static bench_ticks_t * partnerStamps;
+static double * latencies;
+
+static pthread_exchanger_t ex;
+static pthread_mutex_t mx;
+static pthread_cond_t full;
+static pthread_cond_t empty;
+static sem_t fullSem;
+static sem_t emptySem;
+static bench_ticks_t * slot;
+
+static int
+compareLatencies (const void * a, const void * b)
+{
+  double la = *(const double *) a;
+  double lb = *(const double *) b;
+
+  return (la < lb) ? -1 : (la > lb) ? 1 : 0;
+}
+
+static double
+since (bench_ticks_t stamp)
+{
+  return (double) (bench_now() - stamp) * 1E6 / (double) bench_frequency();
+}
+
+
+static void
+exchangerInit (void)
+{
+  assert(pthread_exchanger_init_np(&ex) == 0);
+}
+
+static void
+exchangerPut (bench_ticks_t * item)
+{
+  assert(pthread_exchanger_put_np(ex, item, NULL) == 0);
+}
+
+static bench_ticks_t *
+exchangerTake (void)
+{
+  void * item;
+
+  assert(pthread_exchanger_take_np(ex, &item, NULL) == 0);
+  return (bench_ticks_t *) item;
+}
+
+static void
+exchangerDestroy (void)
+{
+  assert(pthread_exchanger_destroy_np(&ex) == 0);
+}
+
+
+static void
+condInit (void)
+{
+  slot = NULL;
+  assert(pthread_mutex_init(&mx, NULL) == 0);
+  assert(pthread_cond_init(&full, NULL) == 0);
+  assert(pthread_cond_init(&empty, NULL) == 0);
+}
+
+static void
+condPut (bench_ticks_t * item)
+{
+  assert(pthread_mutex_lock(&mx) == 0);
+  while (slot != NULL)
+    {
+      assert(pthread_cond_wait(&empty, &mx) == 0);
+    }
+  slot = item;
+  assert(pthread_cond_signal(&full) == 0);
+  while (slot == item)
+    {
+      assert(pthread_cond_wait(&empty, &mx) == 0);
+    }
+  assert(pthread_mutex_unlock(&mx) == 0);
+}
+
+static bench_ticks_t *
+condTake (void)
+{
+  bench_ticks_t * item;
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  while (slot == NULL)
+    {
+      assert(pthread_cond_wait(&full, &mx) == 0);
+    }
+  item = slot;
+  slot = NULL;
+  assert(pthread_cond_signal(&empty) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+
+  return item;
+}
+
+static void
+condDestroy (void)
+{
+  assert(pthread_cond_destroy(&empty) == 0);
+  assert(pthread_cond_destroy(&full) == 0);
+  assert(pthread_mutex_destroy(&mx) == 0);
+}
+
+
+static void
+semInit (void)
+{
+  assert(sem_init(&fullSem, 0, 0) == 0);
+  assert(sem_init(&emptySem, 0, 0) == 0);
+}
+
+static void
+semPut (bench_ticks_t * item)
+{
+  slot = item;
+  assert(sem_post(&fullSem) == 0);
+  assert(sem_wait(&emptySem) == 0);
+}
+
+static bench_ticks_t *
+semTake (void)
+{
+  bench_ticks_t * item;
+
+  assert(sem_wait(&fullSem) == 0);
+  item = slot;
+  assert(sem_post(&emptySem) == 0);
+
+  return item;
+}
+
+static void
+semDestroy (void)
+{
+  assert(sem_destroy(&emptySem) == 0);
+  assert(sem_destroy(&fullSem) == 0);
+}
+
+
+static const method_t methods[] = {
+  { "exchanger", 1, exchangerInit, exchangerPut, exchangerTake, exchangerDestroy },
+  { "exchanger_park", 0, exchangerInit, exchangerPut, exchangerTake, exchangerDestroy },
+  { "mutex_cond", 1, condInit, condPut, condTake, condDestroy },
+  { "semaphore_pair", 1, semInit, semPut, semTake, semDestroy }
+};
+
+static const method_t * method;
+
+static void *
+producerThread (void * arg)
+{
+  long i;
+
+  for (i = 0; i < handoffs; i++)
+    {
+      stamps[i] = bench_now();
+      method->put(&stamps[i]);
+    }
+
+  return arg;
+}
+
+static void *
+partnerThread (void * arg)
+{
+  void * other;
+  long i;
+
+  for (i = 0; i < handoffs; i++)
+    {
+      partnerStamps[i] = bench_now();
+      assert(pthread_exchanger_exchange_np(ex, &partnerStamps[i], &other, NULL) == 0);
+    }
+
+  return arg;
+}
+
+static void
+report (const char * name, double msec)
+{
+  qsort(latencies, handoffs, sizeof(double), compareLatencies);
+
+  printf("%s,%ld,%.1f,%.0f,%.2f,%.2f\n",
+         name,
+         handoffs,
+         msec,
+         msec > 0 ? (double) handoffs * 1E3 / msec : 0.0,
+         latencies[(handoffs - 1) / 2],
+         latencies[(long) ((handoffs - 1) * 0.99)]);
+  fflush(stdout);
+}
+
+static void
+runMethod (const method_t * m)
+{
+  pthread_t t;
+  bench_ticks_t start;
+  long i;
+
+  method = m;
+  method->init();
+
+  start = bench_now();
+  assert(pthread_create(&t, NULL, producerThread, NULL) == 0);
+  for (i = 0; i < handoffs; i++)
+    {
+      latencies[i] = since(*method->take());
+    }
+  assert(pthread_join(t, NULL) == 0);
+
+  report(method->name, (double) (bench_now() - start) * 1E3 / (double) bench_frequency());
+
+  method->destroy();
+}
+
+static void
+runExchange (void)
+{
+  pthread_t t;
+  bench_ticks_t start;
+  void * other;
+  long i;
+
+  exchangerInit();
+
+  start = bench_now();
+  assert(pthread_create(&t, NULL, partnerThread, NULL) == 0);
+  for (i = 0; i < handoffs; i++)
+    {
+      stamps[i] = bench_now();
+      assert(pthread_exchanger_exchange_np(ex, &stamps[i], &other, NULL) == 0);
+      latencies[i] = since(*(bench_ticks_t *) other);
+    }
+  assert(pthread_join(t, NULL) == 0);
+
+  report("exchange", (double) (bench_now() - start) * 1E3 / (double) bench_frequency());
+
+  exchangerDestroy();
+}
+
+int
+main (int argc, char *argv[])
+{
+  struct ptw32_wait_policy policy;
+  struct ptw32_wait_policy noSpin;
+  int j;
+
+  if (argc > 1)
+    {
+      handoffs = atol(argv[1]);
+    }
+  assert(handoffs > 0);
+
+  stamps = (bench_ticks_t *) calloc(handoffs, sizeof(bench_ticks_t));
+  partnerStamps = (bench_ticks_t *) calloc(handoffs, sizeof(bench_ticks_t));
+  latencies = (double *) calloc(handoffs, sizeof(double));
+  assert(stamps != NULL && partnerStamps != NULL && latencies != NULL);
+
+  assert(pthread_getwaitpolicy_np(&policy) == 0);
+  noSpin = policy;
+  noSpin.spinCount = 0;
+
+  printf("method,handoffs,msec,handoffs_per_sec,latency_p50_us,latency_p99_us\n");
+
+  for (j = 0; j < (int) (sizeof(methods) / sizeof(methods[0])); j++)
+    {
+      assert(pthread_setwaitpolicy_np(methods[j].spin ? &policy : &noSpin) == 0);
+      runMethod(&methods[j]);
+    }
+  assert(pthread_setwaitpolicy_np(&policy) == 0);
+
+  runExchange();
+
+  free(latencies);
+  free(partnerStamps);
+  free(stamps);
+
+  return 0;
+}
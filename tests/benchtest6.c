@@ -0,0 +1,204 @@
+/*
+ * benchtest6.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Measure time taken for process wide startup and teardown.
+ *
+ * - Library attach plus detach
+ *   Direct calls to pthread_win32_process_attach_np() and
+ *   pthread_win32_process_detach_np(), as made by DllMain (DLL)
+ *   or autostatic.c (static library).
+ * - LoadLibrary plus FreeLibrary of a fresh copy of the DLL
+ *   (DLL builds only).
+ * - Process spawn plus exit of a child linked against the library.
+ *   The child is this program run with the argument "child".
+ */
+
+#include "test.h"
+#include <sys/timeb.h>
+
+#ifdef __GNUC__
+#include <stdlib.h>
+#endif
+
+#define ATTACH_ITERATIONS       10000L
+#define LOAD_ITERATIONS         1000L
+#define SPAWN_ITERATIONS        200L
+
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTimeStart;
+  struct __timeb64 currSysTimeStop;
+#else
+  struct _timeb currSysTimeStart;
+  struct _timeb currSysTimeStop;
+#endif
+long durationMilliSecs;
+long overHeadMilliSecs = 0;
+
+#define GetDurationMilliSecs(_TStart, _TStop) ((long)((_TStop.time*1000+_TStop.millitm) \
+                                               - (_TStart.time*1000+_TStart.millitm)))
+
+/*
+ * Dummy use of j, otherwise the loop may be removed by the optimiser
+ * when doing the overhead timing with an empty loop.
+ */
+#define TESTSTART(_N) \
+  { long i, j = 0, k = 0; PTW32_FTIME(&currSysTimeStart); for (i = 0; i < (_N); i++) { j++;
+
+#define TESTSTOP \
+  }; PTW32_FTIME(&currSysTimeStop); if (j + k == i) j++; }
+
+void
+report (char * testNameString, long iterations)
+{
+  durationMilliSecs = GetDurationMilliSecs(currSysTimeStart, currSysTimeStop) - overHeadMilliSecs;
+
+  printf( "%-45s %15ld %15.3f\n",
+	    testNameString,
+          durationMilliSecs,
+          (float) durationMilliSecs * 1E3 / iterations);
+}
+
+int
+main (int argc, char *argv[])
+{
+  char selfPath[MAX_PATH];
+
+  if (argc > 1 && strcmp(argv[1], "child") == 0)
+    {
+      /*
+       * A typical short-lived tool: touch the library once and exit.
+       */
+      return (pthread_self().p == NULL);
+    }
+
+  assert(GetModuleFileName(NULL, selfPath, sizeof(selfPath)) > 0);
+
+  printf( "=============================================================================\n");
+  printf( "\nProcess startup and teardown.\n\n");
+  printf( "%-45s %15s %15s\n",
+	    "Test",
+	    "Total(msec)",
+	    "average(usec)");
+  printf( "-----------------------------------------------------------------------------\n");
+
+  /*
+   * Time the loop overhead so we can subtract it from the actual test times.
+   */
+  TESTSTART(ATTACH_ITERATIONS)
+  TESTSTOP
+
+  durationMilliSecs = GetDurationMilliSecs(currSysTimeStart, currSysTimeStop) - overHeadMilliSecs;
+  overHeadMilliSecs = durationMilliSecs;
+
+  /*
+   * Main thread must not hold an implicit POSIX handle across the
+   * detach calls below, so do not call pthread_self() before this.
+   */
+  TESTSTART(ATTACH_ITERATIONS)
+  assert(pthread_win32_process_detach_np() == TRUE);
+  assert(pthread_win32_process_attach_np() == TRUE);
+  TESTSTOP
+
+  report("Process detach + attach", ATTACH_ITERATIONS);
+
+  TESTSTART(ATTACH_ITERATIONS)
+  assert(pthread_self().p != NULL);
+  assert(pthread_win32_thread_detach_np() == TRUE);
+  assert(pthread_win32_process_detach_np() == TRUE);
+  assert(pthread_win32_process_attach_np() == TRUE);
+  TESTSTOP
+
+  report("Implicit self + process detach + attach", ATTACH_ITERATIONS);
+
+  overHeadMilliSecs = 0;
+
+#ifndef PTW32_STATIC_LIB
+  {
+    MEMORY_BASIC_INFORMATION mbi;
+    char dllPath[MAX_PATH];
+    char copyPath[MAX_PATH];
+    HINSTANCE hinst;
+
+    /*
+     * A second copy under another name is mapped and attached
+     * independently of the one this program is linked with.
+     */
+    assert(VirtualQuery((LPCVOID) pthread_self, &mbi, sizeof(mbi)) != 0);
+    assert(GetModuleFileName((HMODULE) mbi.AllocationBase, dllPath, sizeof(dllPath)) > 0);
+    strcpy(copyPath, selfPath);
+    strcpy(strrchr(copyPath, '\\') + 1, "benchtest6.dll");
+    assert(CopyFile(dllPath, copyPath, FALSE));
+
+    TESTSTART(LOAD_ITERATIONS)
+    assert((hinst = LoadLibrary(copyPath)) != (HINSTANCE) 0);
+    assert(FreeLibrary(hinst));
+    TESTSTOP
+
+    report("LoadLibrary + FreeLibrary", LOAD_ITERATIONS);
+
+    (void) DeleteFile(copyPath);
+  }
+#endif
+
+  {
+    char cmdLine[MAX_PATH + 16];
+    STARTUPINFO si;
+    PROCESS_INFORMATION pi;
+    DWORD exitCode;
+
+    sprintf(cmdLine, "\"%s\" child", selfPath);
+
+    TESTSTART(SPAWN_ITERATIONS)
+    memset(&si, 0, sizeof(si));
+    si.cb = sizeof(si);
+    assert(CreateProcess(NULL, cmdLine, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi));
+    assert(WaitForSingleObject(pi.hProcess, INFINITE) == WAIT_OBJECT_0);
+    assert(GetExitCodeProcess(pi.hProcess, &exitCode));
+    assert(exitCode == 0);
+    CloseHandle(pi.hThread);
+    CloseHandle(pi.hProcess);
+    TESTSTOP
+
+    report("Spawn + exit of linked child process", SPAWN_ITERATIONS);
+  }
+
+  printf( "=============================================================================\n");
+
+  /*
+   * End of tests.
+   */
+
+  return 0;
+}
@@ -0,0 +1,781 @@
+/*
+ * benchtest7.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Measure throughput and latency of each primitive under contention.
+ *
+ * Every benchmark is run with 1 up to the number of processors
+ * threads (pairs only for the two-sided benchmarks). Each thread
+ * times every operation with the performance counter and the
+ * results are printed as CSV, one row per benchmark and thread
+ * count:
+ *
+ *   primitive,variant,threads,ops,msec,ops_per_sec,p50_ns,p99_ns,p999_ns
+ *
+ * Latencies include the cost of reading the clock.
+ *
+ * The *_cross_node mutex rows pin alternate threads to different
+ * NUMA nodes (or, on a single node system, to the two halves of
+ * the processors) to compare the default and cohort mutexes.
+ *
+ * Usage: benchtest7 [maxthreads [ops_per_thread]]
+ *
+ * This program also builds natively against other pthreads
+ * implementations; see benchport.h. The Win32 baselines are
+ * only run here.
+ */
+
+#include "benchport.h"
+
+#define OPS_PER_THREAD  20000L
+#define QUEUE_SIZE      64
+
+typedef struct {
+  int id;
+  long ops;
+  unsigned long * lat;
+  bench_ticks_t start;
+  bench_ticks_t stop;
+} worker_t;
+
+typedef struct {
+  pthread_mutex_t mx;
+  pthread_cond_t cv;
+  int turn;
+  sem_t sem[2];
+} pair_t;
+
+typedef struct {
+  const char * primitive;
+  const char * variant;
+  int step;                     /* 2 for benchmarks run by pairs */
+  void (*setup)(int nthreads, int arg);
+  void * (*worker)(void *);
+  void (*teardown)(int nthreads);
+  int arg;
+} bench_t;
+
+static pthread_barrier_t startBarrier;
+static long opsPerThread = OPS_PER_THREAD;
+static bench_ticks_t frequency;
+
+static pthread_mutex_t mx;
+static pthread_spinlock_t spin;
+static pthread_rwlock_t rwl;
+static pthread_barrier_t bar;
+#if defined(_WIN32)
+static CRITICAL_SECTION cs;
+static old_mutex_t ox;
+#endif
+static pair_t * pairs;
+static pthread_once_t * onces;
+static int readPercent;
+static volatile long shared;
+
+static pthread_mutex_t qmx;
+static pthread_cond_t notFull;
+static pthread_cond_t notEmpty;
+static long queue[QUEUE_SIZE];
+static int qhead, qtail, qcount;
+
+#if defined(_WIN32)
+/*
+ * Cross-node placement. Worker n is pinned to the processors of
+ * node n % placementNodes. On a single node system the processors
+ * are split into two halves standing in for nodes, and cohort
+ * mutexes are given the matching topology.
+ */
+static int placementNodes = 0;
+static DWORD_PTR placementMask[64];
+static pthread_key_t placementKey;
+
+static int PTW32_CDECL
+placementNodeOf(void)
+{
+  return (int) (size_t) pthread_getspecific(placementKey);
+}
+
+static void
+placementSetup(void)
+{
+  HMODULE kernel32 = GetModuleHandle(TEXT("KERNEL32.DLL"));
+  BOOL (WINAPI *highest_node)(ULONG *) = NULL;
+  BOOL (WINAPI *node_mask)(UCHAR, ULONGLONG *) = NULL;
+  DWORD_PTR processMask, systemMask;
+  ULONG highest = 0;
+  int n;
+
+  assert(GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask));
+  assert(pthread_key_create(&placementKey, NULL) == 0);
+
+  if (kernel32 != NULL)
+    {
+      highest_node = (BOOL (WINAPI *)(ULONG *))
+        GetProcAddress(kernel32, "GetNumaHighestNodeNumber");
+      node_mask = (BOOL (WINAPI *)(UCHAR, ULONGLONG *))
+        GetProcAddress(kernel32, "GetNumaNodeProcessorMask");
+    }
+
+  if (highest_node != NULL && node_mask != NULL
+      && highest_node(&highest) && highest > 0)
+    {
+      placementNodes = (highest < 64) ? (int) highest + 1 : 64;
+      for (n = 0; n < placementNodes; n++)
+        {
+          ULONGLONG m = 0;
+
+          placementMask[n] = node_mask((UCHAR) n, &m)
+                             ? (DWORD_PTR) m & processMask : 0;
+        }
+    }
+  else
+    {
+      int cpus = 0;
+      int i;
+
+      for (i = 0; i < (int) (sizeof(DWORD_PTR) * 8); i++)
+        {
+          if (processMask & ((DWORD_PTR) 1 << i))
+            {
+              placementMask[(cpus++ & 1)] |= (DWORD_PTR) 1 << i;
+            }
+        }
+      placementNodes = 2;
+      assert(pthread_mutex_setcohorttopology_np(2, placementNodeOf) == 0);
+    }
+}
+
+static void
+placementTeardown(void)
+{
+  int n;
+
+  assert(pthread_mutex_setcohorttopology_np(0, NULL) == 0);
+  assert(pthread_key_delete(placementKey) == 0);
+  for (n = 0; n < 64; n++)
+    {
+      placementMask[n] = 0;
+    }
+  placementNodes = 0;
+}
+#endif
+
+static void
+begin(worker_t * w)
+{
+#if defined(_WIN32)
+  if (placementNodes > 0)
+    {
+      int n = w->id % placementNodes;
+
+      assert(pthread_setspecific(placementKey, (void *) (size_t) n) == 0);
+      if (placementMask[n] != 0)
+        {
+          (void) SetThreadAffinityMask(GetCurrentThread(), placementMask[n]);
+        }
+    }
+#endif
+  (void) pthread_barrier_wait(&startBarrier);
+  w->start = bench_now();
+}
+
+static void
+end(worker_t * w)
+{
+  w->stop = bench_now();
+}
+
+#define OP_BEGIN(_w) \
+  { long op; for (op = 0; op < (_w)->ops; op++) { bench_ticks_t t0 = bench_now();
+
+#define OP_END(_w) \
+  (_w)->lat[op] = (unsigned long) (bench_now() - t0); } }
+
+
+/*
+ * Mutexes, spinlock and the Win32 and old benchlib.c baselines.
+ */
+static void
+mutexSetup(int nthreads, int arg)
+{
+  pthread_mutexattr_t ma;
+
+#if defined(_WIN32)
+  if (arg & 0x200)
+    {
+      placementSetup();
+    }
+#endif
+  assert(pthread_mutexattr_init(&ma) == 0);
+  assert(pthread_mutexattr_settype(&ma, arg & 0xff) == 0);
+  if (arg & 0x100)
+    {
+      assert(pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST) == 0);
+    }
+  assert(pthread_mutex_init(&mx, &ma) == 0);
+  assert(pthread_mutexattr_destroy(&ma) == 0);
+}
+
+static void
+mutexTeardown(int nthreads)
+{
+  assert(pthread_mutex_destroy(&mx) == 0);
+#if defined(_WIN32)
+  if (placementNodes > 0)
+    {
+      placementTeardown();
+    }
+#endif
+}
+
+static void *
+mutexWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+
+  begin(w);
+  OP_BEGIN(w)
+  assert(pthread_mutex_lock(&mx) == 0);
+  shared++;
+  assert(pthread_mutex_unlock(&mx) == 0);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+static void
+spinSetup(int nthreads, int arg)
+{
+  assert(pthread_spin_init(&spin, PTHREAD_PROCESS_PRIVATE) == 0);
+}
+
+static void
+spinTeardown(int nthreads)
+{
+  assert(pthread_spin_destroy(&spin) == 0);
+}
+
+static void *
+spinWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+
+  begin(w);
+  OP_BEGIN(w)
+  assert(pthread_spin_lock(&spin) == 0);
+  shared++;
+  assert(pthread_spin_unlock(&spin) == 0);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+#if defined(_WIN32)
+static void
+csSetup(int nthreads, int arg)
+{
+  InitializeCriticalSection(&cs);
+}
+
+static void
+csTeardown(int nthreads)
+{
+  DeleteCriticalSection(&cs);
+}
+
+static void *
+csWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+
+  begin(w);
+  OP_BEGIN(w)
+  EnterCriticalSection(&cs);
+  shared++;
+  LeaveCriticalSection(&cs);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+static void
+oldMutexSetup(int nthreads, int arg)
+{
+  old_mutex_use = arg;
+  assert(old_mutex_init(&ox, NULL) == 0);
+}
+
+static void
+oldMutexTeardown(int nthreads)
+{
+  assert(old_mutex_destroy(&ox) == 0);
+}
+
+static void *
+oldMutexWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+
+  begin(w);
+  OP_BEGIN(w)
+  assert(old_mutex_lock(&ox) == 0);
+  shared++;
+  assert(old_mutex_unlock(&ox) == 0);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+#endif
+
+
+/*
+ * Read-write lock with a given percentage of reads.
+ */
+static void
+rwlockSetup(int nthreads, int arg)
+{
+  readPercent = arg;
+  assert(pthread_rwlock_init(&rwl, NULL) == 0);
+}
+
+static void
+rwlockTeardown(int nthreads)
+{
+  assert(pthread_rwlock_destroy(&rwl) == 0);
+}
+
+static void *
+rwlockWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+  unsigned long seed = (unsigned long) w->id * 2654435761UL + 1;
+
+  begin(w);
+  OP_BEGIN(w)
+  seed = seed * 1103515245UL + 12345UL;
+  if ((int) ((seed >> 16) % 100) < readPercent)
+    {
+      assert(pthread_rwlock_rdlock(&rwl) == 0);
+      if (shared == -1)
+        {
+          shared = 0;
+        }
+    }
+  else
+    {
+      assert(pthread_rwlock_wrlock(&rwl) == 0);
+      shared++;
+    }
+  assert(pthread_rwlock_unlock(&rwl) == 0);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+
+/*
+ * Two-sided benchmarks. Thread 2n and thread 2n+1 form a pair.
+ */
+static void
+pairsSetup(int nthreads, int arg)
+{
+  int i;
+
+  pairs = (pair_t *) calloc(nthreads / 2, sizeof(pair_t));
+  assert(pairs != NULL);
+
+  for (i = 0; i < nthreads / 2; i++)
+    {
+      assert(pthread_mutex_init(&pairs[i].mx, NULL) == 0);
+      assert(pthread_cond_init(&pairs[i].cv, NULL) == 0);
+      assert(sem_init(&pairs[i].sem[0], 0, 1) == 0);
+      assert(sem_init(&pairs[i].sem[1], 0, 0) == 0);
+      pairs[i].turn = 0;
+    }
+}
+
+static void
+pairsTeardown(int nthreads)
+{
+  int i;
+
+  for (i = 0; i < nthreads / 2; i++)
+    {
+      assert(pthread_mutex_destroy(&pairs[i].mx) == 0);
+      assert(pthread_cond_destroy(&pairs[i].cv) == 0);
+      assert(sem_destroy(&pairs[i].sem[0]) == 0);
+      assert(sem_destroy(&pairs[i].sem[1]) == 0);
+    }
+
+  free(pairs);
+  pairs = NULL;
+}
+
+static void *
+pingPongWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+  pair_t * p = &pairs[w->id / 2];
+  int side = w->id & 1;
+
+  begin(w);
+  OP_BEGIN(w)
+  assert(pthread_mutex_lock(&p->mx) == 0);
+  while (p->turn != side)
+    {
+      assert(pthread_cond_wait(&p->cv, &p->mx) == 0);
+    }
+  p->turn = !side;
+  assert(pthread_cond_signal(&p->cv) == 0);
+  assert(pthread_mutex_unlock(&p->mx) == 0);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+static void *
+semHandoffWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+  pair_t * p = &pairs[w->id / 2];
+  int side = w->id & 1;
+
+  begin(w);
+  OP_BEGIN(w)
+  assert(sem_wait(&p->sem[side]) == 0);
+  assert(sem_post(&p->sem[!side]) == 0);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+
+/*
+ * Bounded queue. Even threads produce, odd threads consume.
+ */
+static void
+queueSetup(int nthreads, int arg)
+{
+  qhead = qtail = qcount = 0;
+  assert(pthread_mutex_init(&qmx, NULL) == 0);
+  assert(pthread_cond_init(&notFull, NULL) == 0);
+  assert(pthread_cond_init(&notEmpty, NULL) == 0);
+}
+
+static void
+queueTeardown(int nthreads)
+{
+  assert(qcount == 0);
+  assert(pthread_mutex_destroy(&qmx) == 0);
+  assert(pthread_cond_destroy(&notFull) == 0);
+  assert(pthread_cond_destroy(&notEmpty) == 0);
+}
+
+static void *
+queueWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+
+  begin(w);
+  OP_BEGIN(w)
+  assert(pthread_mutex_lock(&qmx) == 0);
+  if ((w->id & 1) == 0)
+    {
+      while (qcount == QUEUE_SIZE)
+        {
+          assert(pthread_cond_wait(&notFull, &qmx) == 0);
+        }
+      queue[qtail] = op;
+      qtail = (qtail + 1) % QUEUE_SIZE;
+      qcount++;
+      assert(pthread_cond_signal(&notEmpty) == 0);
+    }
+  else
+    {
+      while (qcount == 0)
+        {
+          assert(pthread_cond_wait(&notEmpty, &qmx) == 0);
+        }
+      shared += queue[qhead];
+      qhead = (qhead + 1) % QUEUE_SIZE;
+      qcount--;
+      assert(pthread_cond_signal(&notFull) == 0);
+    }
+  assert(pthread_mutex_unlock(&qmx) == 0);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+
+/*
+ * Barrier episodes.
+ */
+static void
+barrierSetup(int nthreads, int arg)
+{
+  assert(pthread_barrier_init(&bar, NULL, nthreads) == 0);
+}
+
+static void
+barrierTeardown(int nthreads)
+{
+  assert(pthread_barrier_destroy(&bar) == 0);
+}
+
+static void *
+barrierWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+  int result;
+
+  begin(w);
+  OP_BEGIN(w)
+  result = pthread_barrier_wait(&bar);
+  assert(result == 0 || result == PTHREAD_BARRIER_SERIAL_THREAD);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+
+/*
+ * pthread_once. All threads race through the same sequence of
+ * once controls, so each one is run by whichever thread gets
+ * there first while the others wait or take the fast path.
+ */
+static void
+onceInit(void)
+{
+  shared++;
+}
+
+static void
+onceSetup(int nthreads, int arg)
+{
+  pthread_once_t init = PTHREAD_ONCE_INIT;
+  long i;
+
+  onces = (pthread_once_t *) calloc(opsPerThread, sizeof(pthread_once_t));
+  assert(onces != NULL);
+
+  for (i = 0; i < opsPerThread; i++)
+    {
+      onces[i] = init;
+    }
+}
+
+static void
+onceTeardown(int nthreads)
+{
+  free(onces);
+  onces = NULL;
+}
+
+static void *
+onceWorker(void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+
+  begin(w);
+  OP_BEGIN(w)
+  assert(pthread_once(&onces[op], onceInit) == 0);
+  OP_END(w)
+  end(w);
+
+  return NULL;
+}
+
+
+static bench_t benches[] = {
+#if defined(_WIN32)
+  {"critical_section", "baseline", 1, csSetup, csWorker, csTeardown, 0},
+  {"old_mutex", "critical_section", 1, oldMutexSetup, oldMutexWorker, oldMutexTeardown, OLD_WIN32CS},
+  {"old_mutex", "win32_mutex", 1, oldMutexSetup, oldMutexWorker, oldMutexTeardown, OLD_WIN32MUTEX},
+#endif
+  {"mutex", "default", 1, mutexSetup, mutexWorker, mutexTeardown, PTHREAD_MUTEX_DEFAULT},
+  {"mutex", "normal", 1, mutexSetup, mutexWorker, mutexTeardown, PTHREAD_MUTEX_NORMAL},
+  {"mutex", "errorcheck", 1, mutexSetup, mutexWorker, mutexTeardown, PTHREAD_MUTEX_ERRORCHECK},
+  {"mutex", "recursive", 1, mutexSetup, mutexWorker, mutexTeardown, PTHREAD_MUTEX_RECURSIVE},
+  {"mutex", "default_robust", 1, mutexSetup, mutexWorker, mutexTeardown, 0x100 | PTHREAD_MUTEX_DEFAULT},
+  {"mutex", "normal_robust", 1, mutexSetup, mutexWorker, mutexTeardown, 0x100 | PTHREAD_MUTEX_NORMAL},
+  {"mutex", "errorcheck_robust", 1, mutexSetup, mutexWorker, mutexTeardown, 0x100 | PTHREAD_MUTEX_ERRORCHECK},
+  {"mutex", "recursive_robust", 1, mutexSetup, mutexWorker, mutexTeardown, 0x100 | PTHREAD_MUTEX_RECURSIVE},
+#if defined(_WIN32)
+  {"mutex", "default_cross_node", 1, mutexSetup, mutexWorker, mutexTeardown, 0x200 | PTHREAD_MUTEX_DEFAULT},
+  {"mutex", "cohort_cross_node", 1, mutexSetup, mutexWorker, mutexTeardown, 0x200 | PTHREAD_MUTEX_COHORT_NP},
+#endif
+  {"spinlock", "", 1, spinSetup, spinWorker, spinTeardown, 0},
+  {"rwlock", "read50", 1, rwlockSetup, rwlockWorker, rwlockTeardown, 50},
+  {"rwlock", "read90", 1, rwlockSetup, rwlockWorker, rwlockTeardown, 90},
+  {"rwlock", "read99", 1, rwlockSetup, rwlockWorker, rwlockTeardown, 99},
+  {"cond", "ping_pong", 2, pairsSetup, pingPongWorker, pairsTeardown, 0},
+  {"cond", "producer_consumer", 2, queueSetup, queueWorker, queueTeardown, 0},
+  {"semaphore", "handoff", 2, pairsSetup, semHandoffWorker, pairsTeardown, 0},
+  {"barrier", "", 1, barrierSetup, barrierWorker, barrierTeardown, 0},
+  {"once", "", 1, onceSetup, onceWorker, onceTeardown, 0}
+};
+
+static int
+compareLatency(const void * a, const void * b)
+{
+  unsigned long x = *(const unsigned long *) a;
+  unsigned long y = *(const unsigned long *) b;
+
+  return (x < y) ? -1 : (x > y);
+}
+
+static double
+percentile(unsigned long * sorted, long count, int perMille)
+{
+  long i = (long) (((double) (count - 1) * perMille) / 1000.0 + 0.5);
+
+  return (double) sorted[i] * 1E9 / (double) frequency;
+}
+
+static void
+runBench(bench_t * b, int nthreads)
+{
+  pthread_t * t;
+  worker_t * w;
+  unsigned long * lat;
+  long total = (long) nthreads * opsPerThread;
+  bench_ticks_t start, stop;
+  double msecs;
+  int i;
+
+  t = (pthread_t *) calloc(nthreads, sizeof(pthread_t));
+  w = (worker_t *) calloc(nthreads, sizeof(worker_t));
+  lat = (unsigned long *) calloc(total, sizeof(unsigned long));
+  assert(t != NULL && w != NULL && lat != NULL);
+
+  shared = 0;
+  b->setup(nthreads, b->arg);
+  assert(pthread_barrier_init(&startBarrier, NULL, nthreads) == 0);
+
+  for (i = 0; i < nthreads; i++)
+    {
+      w[i].id = i;
+      w[i].ops = opsPerThread;
+      w[i].lat = lat + (long) i * opsPerThread;
+      assert(pthread_create(&t[i], NULL, b->worker, &w[i]) == 0);
+    }
+
+  start = stop = 0;
+
+  for (i = 0; i < nthreads; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+      if (i == 0 || w[i].start < start)
+        {
+          start = w[i].start;
+        }
+      if (w[i].stop > stop)
+        {
+          stop = w[i].stop;
+        }
+    }
+
+  assert(pthread_barrier_destroy(&startBarrier) == 0);
+  b->teardown(nthreads);
+
+  qsort(lat, total, sizeof(unsigned long), compareLatency);
+  msecs = (double) (stop - start) * 1E3 / (double) frequency;
+
+  printf("%s,%s,%d,%ld,%.1f,%.0f,%.0f,%.0f,%.0f\n",
+         b->primitive,
+         b->variant,
+         nthreads,
+         total,
+         msecs,
+         msecs > 0 ? (double) total * 1E3 / msecs : 0.0,
+         percentile(lat, total, 500),
+         percentile(lat, total, 990),
+         percentile(lat, total, 999));
+  fflush(stdout);
+
+  free(lat);
+  free(w);
+  free(t);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int maxThreads = bench_processors();
+  int nthreads;
+  int i;
+
+  if (argc > 1)
+    {
+      maxThreads = atoi(argv[1]);
+    }
+  if (argc > 2)
+    {
+      opsPerThread = atol(argv[2]);
+    }
+  if (maxThreads < 1)
+    {
+      maxThreads = 1;
+    }
+  assert(opsPerThread > 0);
+
+  frequency = bench_frequency();
+
+  printf("primitive,variant,threads,ops,msec,ops_per_sec,p50_ns,p99_ns,p999_ns\n");
+
+  for (i = 0; i < (int) (sizeof(benches) / sizeof(benches[0])); i++)
+    {
+      /*
+       * Two-sided benchmarks run at least one pair, even on one processor.
+       */
+      for (nthreads = benches[i].step;
+           nthreads <= maxThreads || nthreads == benches[i].step;
+           nthreads += benches[i].step)
+        {
+          runBench(&benches[i], nthreads);
+        }
+    }
+
+  return 0;
+}
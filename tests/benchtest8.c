@@ -0,0 +1,430 @@
+/*
+ * benchtest8.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Measure the fixed cost of individual library calls.
+ *
+ * - pthread_create plus pthread_join round trip, with and without
+ *   a TSD value that has a destructor.
+ * - How long a blocked pthread_join takes to return after the
+ *   target's start routine returns.
+ * - Tearing down a pool of idle threads: pthread_cancel and then
+ *   pthread_join on each, and (Win32 only) pthread_group_cancel_np
+ *   plus pthread_group_join_np on a thread group.
+ * - pthread_self from an implicit (main) and an explicit thread.
+ * - pthread_getspecific and pthread_setspecific, and (Win32 only)
+ *   pthread_getspecific_ptr_np on a sized key.
+ * - pthread_once after the init routine has run.
+ * - pthread_cleanup_push plus pthread_cleanup_pop.
+ * - pthread_testcancel.
+ * - Entry into a cancelation point wait: sem_post plus sem_wait,
+ *   and (Win32 only) pthreadCancelableWait on an already signaled
+ *   handle against a plain WaitForSingleObject.
+ *
+ * Output is CSV:
+ *
+ *   test,iterations,total_msec,average_nsec
+ *
+ * This program also builds natively against other pthreads
+ * implementations; see benchport.h.
+ */
+
+#include "benchport.h"
+
+#define ITERATIONS              10000000L
+#define WAIT_ITERATIONS         1000000L
+#define CREATE_ITERATIONS       20000L
+#define JOIN_ITERATIONS         2000L
+#define POOL_THREADS            1000L
+#define POOL_STACKSIZE          65536
+
+bench_ticks_t timeStart;
+bench_ticks_t timeStop;
+bench_ticks_t frequency;
+double overHeadMilliSecsPerIteration = 0;
+
+pthread_key_t key;
+pthread_key_t destructorKey;
+#if defined(_WIN32)
+pthread_key_t sizedKey;
+#endif
+pthread_once_t once = PTHREAD_ONCE_INIT;
+#if defined(_WIN32)
+/* pthread_t is a struct, which C++ won't assign to a volatile. */
+void * volatile selfSink;
+#define SELF() (pthread_self().p)
+#else
+/* Some headers declare pthread_self() const, letting it be hoisted. */
+pthread_t (* volatile selfFn)(void) = pthread_self;
+volatile pthread_t selfSink;
+#define SELF() (selfFn())
+#endif
+sem_t sem;
+sem_t poolStarted;
+sem_t poolIdle;
+int value;
+int onceCount = 0;
+volatile bench_ticks_t exitTicks;
+
+#define GetDurationMilliSecs(_TStart, _TStop) ((double) ((_TStop) - (_TStart)) * 1E3 / frequency)
+
+/*
+ * Dummy use of j, otherwise the loop may be removed by the optimiser
+ * when doing the overhead timing with an empty loop.
+ */
+#define TESTSTART(_N) \
+  { long i, j = 0, k = 0; timeStart = bench_now(); for (i = 0; i < (_N); i++) { j++;
+
+#define TESTSTOP \
+  }; timeStop = bench_now(); if (j + k == i) j++; }
+
+void
+report (char * testNameString, long iterations)
+{
+  double msecs;
+
+  msecs = GetDurationMilliSecs(timeStart, timeStop)
+          - overHeadMilliSecsPerIteration * iterations;
+  if (msecs < 0)
+    {
+      msecs = 0;
+    }
+
+  printf( "%s,%ld,%.1f,%.1f\n",
+	    testNameString,
+          iterations,
+          msecs,
+          msecs * 1E6 / iterations);
+  fflush(stdout);
+}
+
+void
+destructor(void * arg)
+{
+}
+
+void
+onceRoutine(void)
+{
+  onceCount++;
+}
+
+void
+cleanupRoutine(void * arg)
+{
+}
+
+void *
+nullThread(void * arg)
+{
+  return arg;
+}
+
+void *
+destructorThread(void * arg)
+{
+  assert(pthread_setspecific(destructorKey, &value) == 0);
+  return arg;
+}
+
+/*
+ * Stay long enough for main to block in pthread_join, then
+ * note when we return.
+ */
+void *
+lateExitThread(void * arg)
+{
+  bench_ticks_t start = bench_now();
+
+  while (bench_now() - start < frequency / 10000)
+    {
+      ;
+    }
+  exitTicks = bench_now();
+  return arg;
+}
+
+void *
+poolThread(void * arg)
+{
+  assert(sem_post(&poolStarted) == 0);
+  (void) sem_wait(&poolIdle);
+  return arg;
+}
+
+/*
+ * Start POOL_THREADS idle threads and wait until they have all
+ * reached their wait.
+ */
+void
+poolStart(pthread_t * pool, pthread_attr_t * attr)
+{
+  long i;
+
+  for (i = 0; i < POOL_THREADS; i++)
+    {
+      assert(pthread_create(&pool[i], attr, poolThread, NULL) == 0);
+    }
+  for (i = 0; i < POOL_THREADS; i++)
+    {
+      assert(sem_wait(&poolStarted) == 0);
+    }
+}
+
+void *
+explicitSelfThread(void * arg)
+{
+  TESTSTART(ITERATIONS)
+  selfSink = SELF();
+  TESTSTOP
+
+  report("pthread_self explicit thread", ITERATIONS);
+
+  return arg;
+}
+
+int
+main (int argc, char *argv[])
+{
+  pthread_t t;
+#if defined(_WIN32)
+  HANDLE event;
+
+  assert((event = CreateEvent(NULL, TRUE, TRUE, NULL)) != NULL);
+#endif
+
+  frequency = bench_frequency();
+  assert(pthread_key_create(&key, NULL) == 0);
+  assert(pthread_key_create(&destructorKey, destructor) == 0);
+  assert(sem_init(&sem, 0, 0) == 0);
+
+  printf("test,iterations,total_msec,average_nsec\n");
+
+  /*
+   * Time the loop overhead so we can subtract it from the actual test times.
+   */
+  TESTSTART(ITERATIONS)
+  TESTSTOP
+
+  overHeadMilliSecsPerIteration =
+    GetDurationMilliSecs(timeStart, timeStop) / ITERATIONS;
+
+  TESTSTART(CREATE_ITERATIONS)
+  assert(pthread_create(&t, NULL, nullThread, NULL) == 0);
+  assert(pthread_join(t, NULL) == 0);
+  TESTSTOP
+
+  report("pthread_create + pthread_join", CREATE_ITERATIONS);
+
+  TESTSTART(CREATE_ITERATIONS)
+  assert(pthread_create(&t, NULL, destructorThread, NULL) == 0);
+  assert(pthread_join(t, NULL) == 0);
+  TESTSTOP
+
+  report("pthread_create + pthread_join with TSD destructor", CREATE_ITERATIONS);
+
+  {
+    long i;
+    bench_ticks_t latency = 0;
+
+    for (i = 0; i < JOIN_ITERATIONS; i++)
+      {
+        assert(pthread_create(&t, NULL, lateExitThread, NULL) == 0);
+        assert(pthread_join(t, NULL) == 0);
+        latency += bench_now() - exitTicks;
+      }
+
+    printf("%s,%ld,%.1f,%.1f\n",
+           "pthread_join wake after thread return",
+           JOIN_ITERATIONS,
+           GetDurationMilliSecs(0, latency),
+           GetDurationMilliSecs(0, latency) * 1E6 / JOIN_ITERATIONS);
+    fflush(stdout);
+  }
+
+  {
+    static pthread_t pool[POOL_THREADS];
+    pthread_attr_t poolAttr;
+    long i;
+#if defined(_WIN32)
+    pthread_group_t group;
+#endif
+
+    assert(sem_init(&poolStarted, 0, 0) == 0);
+    assert(sem_init(&poolIdle, 0, 0) == 0);
+    assert(pthread_attr_init(&poolAttr) == 0);
+    assert(pthread_attr_setstacksize(&poolAttr, POOL_STACKSIZE) == 0);
+
+    poolStart(pool, &poolAttr);
+    timeStart = bench_now();
+    for (i = 0; i < POOL_THREADS; i++)
+      {
+        assert(pthread_cancel(pool[i]) == 0);
+      }
+    for (i = 0; i < POOL_THREADS; i++)
+      {
+        assert(pthread_join(pool[i], NULL) == 0);
+      }
+    timeStop = bench_now();
+
+    report("pool teardown pthread_cancel + pthread_join", POOL_THREADS);
+
+#if defined(_WIN32)
+    assert(pthread_group_init_np(&group) == 0);
+    assert(pthread_attr_setgroup_np(&poolAttr, group) == 0);
+
+    poolStart(pool, &poolAttr);
+    timeStart = bench_now();
+    assert(pthread_group_cancel_np(group) == 0);
+    assert(pthread_group_join_np(group) == 0);
+    timeStop = bench_now();
+
+    report("pool teardown pthread_group_cancel_np + pthread_group_join_np", POOL_THREADS);
+
+    assert(pthread_group_destroy_np(&group) == 0);
+#endif
+
+    assert(pthread_attr_destroy(&poolAttr) == 0);
+    assert(sem_destroy(&poolIdle) == 0);
+    assert(sem_destroy(&poolStarted) == 0);
+  }
+
+  /*
+   * The first call makes main an implicit POSIX thread.
+   */
+  selfSink = SELF();
+
+  TESTSTART(ITERATIONS)
+  selfSink = SELF();
+  TESTSTOP
+
+  report("pthread_self implicit thread", ITERATIONS);
+
+  assert(pthread_create(&t, NULL, explicitSelfThread, NULL) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  TESTSTART(ITERATIONS)
+  assert(pthread_setspecific(key, &value) == 0);
+  TESTSTOP
+
+  report("pthread_setspecific", ITERATIONS);
+
+  TESTSTART(ITERATIONS)
+  assert(pthread_setspecific(destructorKey, &value) == 0);
+  TESTSTOP
+
+  report("pthread_setspecific with destructor", ITERATIONS);
+
+  TESTSTART(ITERATIONS)
+  assert(pthread_getspecific(key) == &value);
+  TESTSTOP
+
+  report("pthread_getspecific", ITERATIONS);
+
+  TESTSTART(ITERATIONS)
+  assert(pthread_getspecific(destructorKey) == &value);
+  TESTSTOP
+
+  report("pthread_getspecific with destructor", ITERATIONS);
+
+#if defined(_WIN32)
+  assert(pthread_key_create_sized_np(&sizedKey, sizeof(int), 0, NULL, NULL) == 0);
+  assert(pthread_getspecific_ptr_np(sizedKey) != NULL);
+
+  TESTSTART(ITERATIONS)
+  k += *(int *) pthread_getspecific_ptr_np(sizedKey);
+  TESTSTOP
+
+  report("pthread_getspecific_ptr_np", ITERATIONS);
+
+  assert(pthread_key_delete(sizedKey) == 0);
+#endif
+
+  assert(pthread_once(&once, onceRoutine) == 0);
+
+  TESTSTART(ITERATIONS)
+  assert(pthread_once(&once, onceRoutine) == 0);
+  TESTSTOP
+
+  assert(onceCount == 1);
+  report("pthread_once after init", ITERATIONS);
+
+  TESTSTART(ITERATIONS)
+  pthread_cleanup_push(cleanupRoutine, NULL);
+  k++;
+  pthread_cleanup_pop(0);
+  TESTSTOP
+
+  report("pthread_cleanup_push + pthread_cleanup_pop", ITERATIONS);
+
+  TESTSTART(ITERATIONS)
+  pthread_testcancel();
+  TESTSTOP
+
+  report("pthread_testcancel", ITERATIONS);
+
+  TESTSTART(WAIT_ITERATIONS)
+  assert(sem_post(&sem) == 0);
+  assert(sem_wait(&sem) == 0);
+  TESTSTOP
+
+  report("sem_post + sem_wait", WAIT_ITERATIONS);
+
+#if defined(_WIN32)
+  TESTSTART(WAIT_ITERATIONS)
+  assert(WaitForSingleObject(event, INFINITE) == WAIT_OBJECT_0);
+  TESTSTOP
+
+  report("WaitForSingleObject signaled", WAIT_ITERATIONS);
+
+  TESTSTART(WAIT_ITERATIONS)
+  assert(pthreadCancelableWait(event) == 0);
+  TESTSTOP
+
+  report("pthreadCancelableWait signaled", WAIT_ITERATIONS);
+
+  CloseHandle(event);
+#endif
+
+  /*
+   * End of tests.
+   */
+
+  assert(sem_destroy(&sem) == 0);
+  assert(pthread_setspecific(destructorKey, NULL) == 0);
+  assert(pthread_key_delete(destructorKey) == 0);
+  assert(pthread_key_delete(key) == 0);
+
+  return 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * benchtest9.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Measure the latency against CPU time trade-off of wait policies
+ * (see pthread_setwaitpolicy_np()).
+ *
+ * Each policy is set in turn and the same contended workloads run:
+ *
+ * - mutex: all processors' worth of threads (at least 2) locking
+ *   and unlocking one mutex.
+ * - sem_handoff: two threads passing a token back and forth
+ *   through a pair of semaphores.
+ * - cond_ping_pong: two threads taking turns through a mutex and
+ *   condition variable.
+ *
+ * Output is CSV, with the process CPU time (user plus kernel) used
+ * alongside the elapsed time:
+ *
+ *   policy,benchmark,threads,ops,msec,cpu_msec,ns_per_op,cpu_ns_per_op
+ *
+ * Usage: benchtest9 [ops_per_thread]
+ */
+
+#include "benchport.h"
+
+#define OPS_PER_THREAD  20000L
+
+typedef struct {
+  const char * name;
+  struct ptw32_wait_policy policy;
+} policy_t;
+
+typedef struct {
+  const char * name;
+  int pairs;                    /* Two threads rather than all processors */
+  void * (*worker)(void *);
+} bench_t;
+
+static policy_t policies[] = {
+  {"park",                  {0,     0, PTW32_YIELD_SLEEP0}},
+  {"spin100",               {100,   0, PTW32_YIELD_SLEEP0}},
+  {"spin1000",              {1000,  0, PTW32_YIELD_SLEEP0}},
+  {"spin10000",             {10000, 0, PTW32_YIELD_SLEEP0}},
+  {"spin100_yield8_switch", {100,   8, PTW32_YIELD_SWITCH}},
+  {"spin100_yield8_sleep0", {100,   8, PTW32_YIELD_SLEEP0}},
+  {"spin100_yield1_sleep1", {100,   1, PTW32_YIELD_SLEEP1}}
+};
+
+static pthread_barrier_t startBarrier;
+static long opsPerThread = OPS_PER_THREAD;
+static bench_ticks_t frequency;
+
+static pthread_mutex_t mx;
+static pthread_cond_t cv;
+static sem_t sem[2];
+static int turn;
+static volatile long shared;
+
+static void *
+mutexWorker(void * arg)
+{
+  long i;
+
+  (void) pthread_barrier_wait(&startBarrier);
+  for (i = 0; i < opsPerThread; i++)
+    {
+      assert(pthread_mutex_lock(&mx) == 0);
+      shared++;
+      assert(pthread_mutex_unlock(&mx) == 0);
+    }
+
+  return NULL;
+}
+
+static void *
+semWorker(void * arg)
+{
+  int side = (int) (size_t) arg;
+  long i;
+
+  (void) pthread_barrier_wait(&startBarrier);
+  for (i = 0; i < opsPerThread; i++)
+    {
+      assert(sem_wait(&sem[side]) == 0);
+      assert(sem_post(&sem[!side]) == 0);
+    }
+
+  return NULL;
+}
+
+static void *
+condWorker(void * arg)
+{
+  int side = (int) (size_t) arg;
+  long i;
+
+  (void) pthread_barrier_wait(&startBarrier);
+  for (i = 0; i < opsPerThread; i++)
+    {
+      assert(pthread_mutex_lock(&mx) == 0);
+      while (turn != side)
+        {
+          assert(pthread_cond_wait(&cv, &mx) == 0);
+        }
+      turn = !side;
+      assert(pthread_cond_signal(&cv) == 0);
+      assert(pthread_mutex_unlock(&mx) == 0);
+    }
+
+  return NULL;
+}
+
+static bench_t benches[] = {
+  {"mutex", 0, mutexWorker},
+  {"sem_handoff", 1, semWorker},
+  {"cond_ping_pong", 1, condWorker}
+};
+
+static double
+cpuMilliSecs(void)
+{
+  FILETIME created, exited, kernel, user;
+  ULARGE_INTEGER k, u;
+
+  assert(GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user));
+  k.LowPart = kernel.dwLowDateTime;
+  k.HighPart = kernel.dwHighDateTime;
+  u.LowPart = user.dwLowDateTime;
+  u.HighPart = user.dwHighDateTime;
+
+  /* 100 nanosecond units */
+  return (double) (k.QuadPart + u.QuadPart) / 1E4;
+}
+
+static void
+runBench(policy_t * p, bench_t * b, int nthreads)
+{
+  pthread_t * t;
+  long total = (long) nthreads * opsPerThread;
+  bench_ticks_t start, stop;
+  double cpuStart, cpuStop, msecs, cpuMsecs;
+  int i;
+
+  t = (pthread_t *) calloc(nthreads, sizeof(pthread_t));
+  assert(t != NULL);
+
+  shared = 0;
+  turn = 0;
+  assert(pthread_mutex_init(&mx, NULL) == 0);
+  assert(pthread_cond_init(&cv, NULL) == 0);
+  assert(sem_init(&sem[0], 0, 1) == 0);
+  assert(sem_init(&sem[1], 0, 0) == 0);
+  assert(pthread_barrier_init(&startBarrier, NULL, nthreads + 1) == 0);
+
+  for (i = 0; i < nthreads; i++)
+    {
+      assert(pthread_create(&t[i], NULL, b->worker, (void *) (size_t) i) == 0);
+    }
+
+  (void) pthread_barrier_wait(&startBarrier);
+  cpuStart = cpuMilliSecs();
+  start = bench_now();
+
+  for (i = 0; i < nthreads; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+
+  stop = bench_now();
+  cpuStop = cpuMilliSecs();
+
+  assert(pthread_barrier_destroy(&startBarrier) == 0);
+  assert(sem_destroy(&sem[0]) == 0);
+  assert(sem_destroy(&sem[1]) == 0);
+  assert(pthread_cond_destroy(&cv) == 0);
+  assert(pthread_mutex_destroy(&mx) == 0);
+
+  msecs = (double) (stop - start) * 1E3 / (double) frequency;
+  cpuMsecs = cpuStop - cpuStart;
+
+  printf("%s,%s,%d,%ld,%.1f,%.1f,%.0f,%.0f\n",
+         p->name,
+         b->name,
+         nthreads,
+         total,
+         msecs,
+         cpuMsecs,
+         msecs * 1E6 / (double) total,
+         cpuMsecs * 1E6 / (double) total);
+  fflush(stdout);
+
+  free(t);
+}
+
+int
+main (int argc, char *argv[])
+{
+  int processors = bench_processors();
+  int i, j;
+
+  if (argc > 1)
+    {
+      opsPerThread = atol(argv[1]);
+    }
+  assert(opsPerThread > 0);
+
+  if (processors < 2)
+    {
+      processors = 2;
+    }
+
+  frequency = bench_frequency();
+
+  printf("policy,benchmark,threads,ops,msec,cpu_msec,ns_per_op,cpu_ns_per_op\n");
+
+  for (i = 0; i < (int) (sizeof(policies) / sizeof(policies[0])); i++)
+    {
+      assert(pthread_setwaitpolicy_np(&policies[i].policy) == 0);
+
+      for (j = 0; j < (int) (sizeof(benches) / sizeof(benches[0])); j++)
+        {
+          runBench(&policies[i], &benches[j], benches[j].pairs ? 2 : processors);
+        }
+    }
+
+  assert(pthread_setwaitpolicy_np(NULL) == 0);
+
+  return 0;
+}
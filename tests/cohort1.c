@@ -0,0 +1,222 @@
+/*
+ * cohort1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that PTHREAD_MUTEX_COHORT_NP mutexes exclude and prefer waiters
+ *   on the unlocking thread's node.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - PTHREAD_MUTEX_COHORT_NP
+ * - pthread_mutex_setcohorttopology_np
+ *
+ * Cases Tested:
+ * - invalid topology and attribute combinations
+ * - trylock and timedlock from the same and another node
+ * - handover to a same-node waiter ahead of an earlier waiter
+ * - mutual exclusion under contention from two nodes
+ *
+ * Description:
+ * - A fake two node topology is installed, with each thread's node
+ *   held in thread-specific data.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * - Each waiting thread reaches the mutex within the sleep.
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+#include <sys/timeb.h>
+
+enum {
+  NUMTHREADS = 4,
+  ITERATIONS = 20000
+};
+
+static pthread_key_t nodeKey;
+static pthread_mutex_t mx;
+static int counter = 0;
+static int inside = 0;
+static int order[2];
+static int orderCount = 0;
+
+static int PTW32_CDECL
+nodeOf(void)
+{
+  return (int) (size_t) pthread_getspecific(nodeKey);
+}
+
+static void
+setNode(int node)
+{
+  assert(pthread_setspecific(nodeKey, (void *) (size_t) node) == 0);
+}
+
+void * orderFunc(void * arg)
+{
+  int node = (int) (size_t) arg;
+
+  setNode(node);
+  assert(pthread_mutex_lock(&mx) == 0);
+  order[orderCount++] = node;
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return NULL;
+}
+
+void * countFunc(void * arg)
+{
+  int i;
+
+  setNode((int) (size_t) arg % 2);
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      assert(pthread_mutex_lock(&mx) == 0);
+      assert(++inside == 1);
+      counter++;
+      inside--;
+      assert(pthread_mutex_unlock(&mx) == 0);
+    }
+  return NULL;
+}
+
+void * tryFunc(void * arg)
+{
+  setNode((int) (size_t) arg);
+  assert(pthread_mutex_trylock(&mx) == EBUSY);
+  return NULL;
+}
+
+int
+main()
+{
+  pthread_mutexattr_t ma;
+  pthread_t t[NUMTHREADS];
+  struct timespec abstime = { 0, 0 };
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTime;
+#else
+  struct _timeb currSysTime;
+#endif
+  const DWORD NANOSEC_PER_MILLISEC = 1000000;
+  int i;
+
+  assert(pthread_key_create(&nodeKey, NULL) == 0);
+  setNode(0);
+
+  assert(pthread_mutex_setcohorttopology_np(0, nodeOf) == EINVAL);
+  assert(pthread_mutex_setcohorttopology_np(2, NULL) == EINVAL);
+  assert(pthread_mutex_setcohorttopology_np(65, nodeOf) == EINVAL);
+  assert(pthread_mutex_setcohorttopology_np(2, nodeOf) == 0);
+
+  assert(pthread_mutexattr_init(&ma) == 0);
+  assert(pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_COHORT_NP) == 0);
+  assert(pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST) == 0);
+  assert(pthread_mutex_init(&mx, &ma) == EINVAL);
+  assert(pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_STALLED) == 0);
+  assert(pthread_mutex_init(&mx, &ma) == 0);
+
+  /*
+   * Held by node 0: busy to both nodes, and timed locks time out.
+   */
+  assert(pthread_mutex_lock(&mx) == 0);
+  for (i = 0; i < 2; i++)
+    {
+      assert(pthread_create(&t[0], NULL, tryFunc, (void *) (size_t) i) == 0);
+      assert(pthread_join(t[0], NULL) == 0);
+    }
+  assert(pthread_mutex_trylock(&mx) == EBUSY);
+
+  PTW32_FTIME(&currSysTime);
+  abstime.tv_sec = (long)currSysTime.time;
+  abstime.tv_nsec = NANOSEC_PER_MILLISEC * currSysTime.millitm;
+  abstime.tv_sec += 1;
+  assert(pthread_mutex_timedlock(&mx, &abstime) == ETIMEDOUT);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_mutex_trylock(&mx) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+
+  /*
+   * A node 1 thread starts waiting first, then a node 0 thread.
+   * Unlocking from node 0 hands the mutex to the node 0 thread.
+   */
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t[0], NULL, orderFunc, (void *) 1) == 0);
+  Sleep(500);
+  assert(pthread_create(&t[1], NULL, orderFunc, (void *) 0) == 0);
+  Sleep(500);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t[0], NULL) == 0);
+  assert(pthread_join(t[1], NULL) == 0);
+  assert(orderCount == 2);
+  assert(order[0] == 0);
+  assert(order[1] == 1);
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(pthread_create(&t[i], NULL, countFunc, (void *) (size_t) i) == 0);
+    }
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+  assert(counter == NUMTHREADS * ITERATIONS);
+
+  assert(pthread_mutex_destroy(&mx) == 0);
+  assert(pthread_mutexattr_destroy(&ma) == 0);
+  assert(pthread_mutex_setcohorttopology_np(0, NULL) == 0);
+  assert(pthread_key_delete(nodeKey) == 0);
+
+  return 0;
+}
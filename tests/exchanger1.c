@@ -0,0 +1,252 @@
+/*
+ * exchanger1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that an exchanger hands each put item to one taker, oldest
+ *   first, and swaps items between exchanging threads.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_exchanger_init_np
+ * - pthread_exchanger_destroy_np
+ * - pthread_exchanger_put_np
+ * - pthread_exchanger_take_np
+ * - pthread_exchanger_exchange_np
+ *
+ * Cases Tested:
+ * - several putters, each seen by the taker in its own order
+ * - a put waits until a taker arrives
+ * - two exchanges swap items; an exchange doesn't meet a put
+ * - timeouts, with an abstime in the past and in the future
+ * - destroying an exchanger with a waiter
+ * - cancelling a parked putter withdraws its item
+ * - invalid arguments
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+#include <sys/timeb.h>
+
+enum {
+  NUMPUTTERS = 4,
+  NUMITEMS = 1000,
+  TIMEOUT = 100,
+  TICK = 20          /* System timer granularity allowed for */
+};
+
+static pthread_exchanger_t ex;
+static int item[NUMPUTTERS][NUMITEMS];
+static int a, b;
+static volatile int taken;
+
+static struct timespec *
+deadline(struct timespec * abstime, int ms)
+{
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTime;
+#else
+  struct _timeb currSysTime;
+#endif
+
+  PTW32_FTIME(&currSysTime);
+
+  abstime->tv_sec = (long)currSysTime.time + (currSysTime.millitm + ms) / 1000;
+  abstime->tv_nsec = ((currSysTime.millitm + ms) % 1000) * 1000000L;
+
+  return abstime;
+}
+
+void * putter(void * arg)
+{
+  int p = (int)(size_t) arg;
+  int i;
+
+  for (i = 0; i < NUMITEMS; i++)
+    {
+      item[p][i] = p * NUMITEMS + i;
+      assert(pthread_exchanger_put_np(ex, &item[p][i], NULL) == 0);
+    }
+
+  return NULL;
+}
+
+void * putone(void * arg)
+{
+  assert(pthread_exchanger_put_np(ex, arg, NULL) == 0);
+  taken = 1;
+  return arg;
+}
+
+void * swapper(void * arg)
+{
+  void * other;
+
+  assert(pthread_exchanger_exchange_np(ex, &b, &other, NULL) == 0);
+  return other;
+}
+
+void * parked(void * arg)
+{
+  (void) pthread_exchanger_put_np(ex, arg, NULL);
+
+  /* Never reached. */
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t[NUMPUTTERS];
+  pthread_t p;
+  int next[NUMPUTTERS] = {0};
+  struct timespec abstime = { 0, 0 };
+  void * v;
+  void * result;
+  DWORD start;
+  int i;
+
+  assert(pthread_exchanger_init_np(NULL) == EINVAL);
+  assert(pthread_exchanger_init_np(&ex) == 0);
+
+  assert(pthread_exchanger_take_np(NULL, &v, NULL) == EINVAL);
+  assert(pthread_exchanger_take_np(ex, NULL, NULL) == EINVAL);
+  assert(pthread_exchanger_exchange_np(ex, &a, NULL, NULL) == EINVAL);
+  assert(pthread_exchanger_put_np(NULL, &a, NULL) == EINVAL);
+
+  /*
+   * Nobody there: an abstime in the past times out at once, a
+   * future one after it has passed.
+   */
+  assert(pthread_exchanger_put_np(ex, &a, &abstime) == ETIMEDOUT);
+  assert(pthread_exchanger_take_np(ex, &v, &abstime) == ETIMEDOUT);
+  assert(pthread_exchanger_exchange_np(ex, &a, &v, &abstime) == ETIMEDOUT);
+
+  start = GetTickCount();
+  assert(pthread_exchanger_take_np(ex, &v, deadline(&abstime, TIMEOUT)) == ETIMEDOUT);
+  assert(GetTickCount() - start >= TIMEOUT - TICK);
+
+  /*
+   * Several putters, one taker.
+   */
+  for (i = 0; i < NUMPUTTERS; i++)
+    {
+      assert(pthread_create(&t[i], NULL, putter, (void *)(size_t) i) == 0);
+    }
+  for (i = 0; i < NUMPUTTERS * NUMITEMS; i++)
+    {
+      int n;
+
+      assert(pthread_exchanger_take_np(ex, &v, NULL) == 0);
+      n = *(int *) v;
+      assert(n % NUMITEMS == next[n / NUMITEMS]);
+      next[n / NUMITEMS]++;
+    }
+  for (i = 0; i < NUMPUTTERS; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+      assert(next[i] == NUMITEMS);
+    }
+
+  /*
+   * A put doesn't return until its item is taken.
+   */
+  assert(pthread_create(&p, NULL, putone, &a) == 0);
+  Sleep(TIMEOUT);
+  assert(taken == 0);
+  assert(pthread_exchanger_destroy_np(&ex) == EBUSY);
+  assert(pthread_exchanger_take_np(ex, &v, NULL) == 0);
+  assert(v == &a);
+  assert(pthread_join(p, NULL) == 0);
+  assert(taken == 1);
+
+  /*
+   * Exchanges swap, and don't meet puts.
+   */
+  assert(pthread_create(&p, NULL, swapper, NULL) == 0);
+  assert(pthread_exchanger_exchange_np(ex, &a, &v, NULL) == 0);
+  assert(v == &b);
+  assert(pthread_join(p, &result) == 0);
+  assert(result == &a);
+
+  assert(pthread_create(&p, NULL, putone, &a) == 0);
+  Sleep(TIMEOUT / 2);
+  assert(pthread_exchanger_exchange_np(ex, &b, &v, deadline(&abstime, TIMEOUT)) == ETIMEDOUT);
+  assert(pthread_exchanger_take_np(ex, &v, NULL) == 0);
+  assert(v == &a);
+  assert(pthread_join(p, NULL) == 0);
+
+  /*
+   * Cancel a parked putter: its item is withdrawn.
+   */
+  assert(pthread_create(&p, NULL, parked, &a) == 0);
+  Sleep(TIMEOUT);
+  assert(pthread_cancel(p) == 0);
+  assert(pthread_join(p, &result) == 0);
+  assert(result == PTHREAD_CANCELED);
+  assert(pthread_exchanger_take_np(ex, &v, deadline(&abstime, 0)) == ETIMEDOUT);
+
+  assert(pthread_exchanger_destroy_np(&ex) == 0);
+  assert(ex == NULL);
+  assert(pthread_exchanger_destroy_np(&ex) == EINVAL);
+
+  return 0;
+}
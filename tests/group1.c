@@ -0,0 +1,223 @@
+/*
+ * group1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that thread groups cancel, interrupt, join and reclaim their
+ *   members as a whole.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_group_init_np, pthread_group_destroy_np
+ * - pthread_attr_setgroup_np, pthread_attr_getgroup_np
+ * - pthread_group_cancel_np, pthread_group_interrupt_np
+ * - pthread_group_join_np, pthread_group_wait_any_np
+ *
+ * Cases Tested:
+ * - the group is carried by the attribute object
+ * - a group with members cannot be destroyed
+ * - cancelling a group reaches every member, more than
+ *   MAXIMUM_WAIT_OBJECTS of them, and joining reclaims them all
+ * - interrupting a group wakes every member without cancelling it
+ * - wait_any returns each finished member and its exit value once,
+ *   then ESRCH
+ * - a detached member is waited for but not reclaimed
+ * - a member cannot join its own group
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+enum {
+  NUMTHREADS = 150
+};
+
+static pthread_group_t group;
+static sem_t started;
+static sem_t never;
+static LONG cancelled = 0;
+static LONG interrupted = 0;
+
+static void
+countCancel(void * arg)
+{
+  InterlockedIncrement((LPLONG)&cancelled);
+}
+
+static void *
+blocker(void * arg)
+{
+  pthread_cleanup_push(countCancel, NULL);
+  assert(sem_post(&started) == 0);
+  (void) sem_wait(&never);
+  pthread_cleanup_pop(0);
+  return (void *) 1;
+}
+
+static void *
+interruptible(void * arg)
+{
+  assert(sem_post(&started) == 0);
+  assert(sem_wait(&never) == -1);
+  assert(errno == EINTR);
+  InterlockedIncrement((LPLONG)&interrupted);
+  return (void *) 2;
+}
+
+static void *
+returnArg(void * arg)
+{
+  return arg;
+}
+
+static void *
+selfJoin(void * arg)
+{
+  assert(pthread_group_join_np(group) == EDEADLK);
+  return arg;
+}
+
+int
+main()
+{
+  pthread_attr_t attr;
+  pthread_group_t g;
+  pthread_t t[NUMTHREADS];
+  pthread_t done;
+  void * value;
+  int seen[3] = {0, 0, 0};
+  int i;
+
+  assert(pthread_group_init_np(&group) == 0);
+  assert(sem_init(&started, 0, 0) == 0);
+  assert(sem_init(&never, 0, 0) == 0);
+
+  assert(pthread_attr_init(&attr) == 0);
+  assert(pthread_attr_getgroup_np(&attr, &g) == 0);
+  assert(g == NULL);
+  assert(pthread_attr_setgroup_np(&attr, group) == 0);
+  assert(pthread_attr_getgroup_np(&attr, &g) == 0);
+  assert(g == group);
+
+  /* Cancel and join more members than one wait can hold. */
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(pthread_create(&t[i], &attr, blocker, NULL) == 0);
+    }
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(sem_wait(&started) == 0);
+    }
+  assert(pthread_group_destroy_np(&group) == EBUSY);
+  assert(pthread_group_cancel_np(group) == 0);
+  assert(pthread_group_join_np(group) == 0);
+  assert(cancelled == NUMTHREADS);
+  assert(pthread_group_wait_any_np(group, &done, &value) == ESRCH);
+
+  /* Interrupt wakes without cancelling. */
+  for (i = 0; i < 10; i++)
+    {
+      assert(pthread_create(&t[i], &attr, interruptible, NULL) == 0);
+    }
+  for (i = 0; i < 10; i++)
+    {
+      assert(sem_wait(&started) == 0);
+    }
+  assert(pthread_group_interrupt_np(group) == 0);
+  assert(pthread_group_join_np(group) == 0);
+  assert(interrupted == 10);
+  assert(cancelled == NUMTHREADS);
+
+  /* wait_any hands back each member once. */
+  for (i = 0; i < 3; i++)
+    {
+      assert(pthread_create(&t[i], &attr, returnArg, (void *)(size_t) i) == 0);
+    }
+  for (i = 0; i < 3; i++)
+    {
+      assert(pthread_group_wait_any_np(group, &done, &value) == 0);
+      assert((size_t) value < 3);
+      assert(pthread_equal(done, t[(size_t) value]));
+      seen[(size_t) value]++;
+    }
+  assert(seen[0] == 1 && seen[1] == 1 && seen[2] == 1);
+  assert(pthread_group_wait_any_np(group, NULL, NULL) == ESRCH);
+
+  /* Detached members are waited for, not reclaimed. */
+  assert(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) == 0);
+  assert(pthread_create(&t[0], &attr, blocker, NULL) == 0);
+  assert(sem_wait(&started) == 0);
+  assert(pthread_group_cancel_np(group) == 0);
+  assert(pthread_group_join_np(group) == 0);
+  assert(cancelled == NUMTHREADS + 1);
+  assert(pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE) == 0);
+
+  /* A member can't join its own group. */
+  assert(pthread_create(&t[0], &attr, selfJoin, NULL) == 0);
+  assert(pthread_join(t[0], NULL) == 0);
+
+  assert(pthread_attr_destroy(&attr) == 0);
+  assert(pthread_group_destroy_np(&group) == 0);
+  assert(group == NULL);
+  assert(sem_destroy(&never) == 0);
+  assert(sem_destroy(&started) == 0);
+
+  return 0;
+}
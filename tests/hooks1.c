@@ -0,0 +1,195 @@
+/*
+ * hooks1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that hooks installed with pthread_set_wait_hooks_np() are called
+ *   around contended mutex and semaphore waits.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_set_wait_hooks_np
+ *
+ * Cases Tested:
+ * - contended mutex lock
+ * - semaphore wait
+ * - removing the hooks
+ *
+ * Description:
+ * - Hold a mutex, or leave a semaphore at zero, while a second
+ *   thread blocks on it, then release it and check the events
+ *   the hooks recorded, including the Win32 id of the releaser.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * - The second thread reaches the mutex or semaphore within the sleep.
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static sem_t s;
+
+static int before[PTW32_WAIT_BARRIER + 1];
+static int after[PTW32_WAIT_BARRIER + 1];
+static int acquired[PTW32_WAIT_BARRIER + 1];
+static unsigned long waker[PTW32_WAIT_BARRIER + 1];
+
+/*
+ * Only the waiting thread blocks, so the counts need no locking.
+ */
+static int
+mine(const struct ptw32_wait_event * event)
+{
+  return (event->object == (void *) &mx || event->object == (void *) &s);
+}
+
+static void PTW32_CDECL
+onBefore(const struct ptw32_wait_event * event)
+{
+  if (mine(event))
+    {
+      before[event->type]++;
+    }
+}
+
+static void PTW32_CDECL
+onAfter(const struct ptw32_wait_event * event)
+{
+  if (mine(event))
+    {
+      assert(event->result == 0);
+      after[event->type]++;
+      waker[event->type] = event->wakerThreadId;
+    }
+}
+
+static void PTW32_CDECL
+onAcquired(const struct ptw32_wait_event * event)
+{
+  if (mine(event))
+    {
+      assert(event->result == 0);
+      assert(event->duration > 0);
+      acquired[event->type]++;
+    }
+}
+
+void * mutexFunc(void * arg)
+{
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return arg;
+}
+
+void * semFunc(void * arg)
+{
+  assert(sem_wait(&s) == 0);
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t;
+  struct ptw32_wait_hooks hooks;
+  unsigned long self = (unsigned long) GetCurrentThreadId();
+
+  hooks.beforeBlock = onBefore;
+  hooks.afterWake = onAfter;
+  hooks.acquiredAfterContention = onAcquired;
+  assert(pthread_set_wait_hooks_np(&hooks) == 0);
+
+  assert(sem_init(&s, 0, 0) == 0);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t, NULL, mutexFunc, NULL) == 0);
+  Sleep(500);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(before[PTW32_WAIT_MUTEX] >= 1);
+  assert(after[PTW32_WAIT_MUTEX] == before[PTW32_WAIT_MUTEX]);
+  assert(acquired[PTW32_WAIT_MUTEX] == 1);
+  assert(waker[PTW32_WAIT_MUTEX] == self);
+
+  assert(pthread_create(&t, NULL, semFunc, NULL) == 0);
+  Sleep(500);
+  assert(sem_post(&s) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(before[PTW32_WAIT_SEMAPHORE] == 1);
+  assert(after[PTW32_WAIT_SEMAPHORE] == 1);
+  assert(acquired[PTW32_WAIT_SEMAPHORE] == 1);
+  assert(waker[PTW32_WAIT_SEMAPHORE] == self);
+
+  /*
+   * With the hooks removed nothing more is recorded.
+   */
+  assert(pthread_set_wait_hooks_np(NULL) == 0);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t, NULL, mutexFunc, NULL) == 0);
+  Sleep(500);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(acquired[PTW32_WAIT_MUTEX] == 1);
+
+  assert(sem_destroy(&s) == 0);
+  assert(pthread_mutex_destroy(&mx) == 0);
+
+  return 0;
+}
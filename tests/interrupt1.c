@@ -0,0 +1,275 @@
+/*
+ * interrupt1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that pthread_interrupt_np() wakes a thread from semaphore, join,
+ *   delay and condition variable waits without cancelling it.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_interrupt_np
+ *
+ * Cases Tested:
+ * - sem_wait and sem_timedwait fail with EINTR and leave the count alone
+ * - pthread_join fails with EINTR and the target is still joinable
+ * - pthread_delay_np returns EINTR early
+ * - pthread_cond_wait returns 0 holding the mutex
+ * - an interrupt posted before the wait is delivered to it
+ * - a deferred cancel still works after interrupts
+ * - an invalid thread is rejected
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+#include <sys/timeb.h>
+
+static sem_t sem;
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cv = PTHREAD_COND_INITIALIZER;
+static pthread_t sleeper;
+static int predicate = 0;
+
+static void *
+semWaiter(void * arg)
+{
+  assert(sem_wait(&sem) == -1);
+  assert(errno == EINTR);
+  return (void *) 1;
+}
+
+static void *
+semTimedWaiter(void * arg)
+{
+  struct timespec abstime;
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTime;
+#else
+  struct _timeb currSysTime;
+#endif
+  const DWORD NANOSEC_PER_MILLISEC = 1000000;
+
+  PTW32_FTIME(&currSysTime);
+
+  abstime.tv_sec = (long)currSysTime.time + 10;
+  abstime.tv_nsec = NANOSEC_PER_MILLISEC * currSysTime.millitm;
+
+  assert(sem_timedwait(&sem, &abstime) == -1);
+  assert(errno == EINTR);
+  return (void *) 1;
+}
+
+static void *
+sleepy(void * arg)
+{
+  assert(sem_wait(&sem) == 0);
+  return (void *) 2;
+}
+
+static void *
+joiner(void * arg)
+{
+  void * result = NULL;
+
+  assert(pthread_join(sleeper, &result) == EINTR);
+  return (void *) 1;
+}
+
+static void *
+delayer(void * arg)
+{
+  struct timespec interval = {10, 0};
+
+  assert(pthread_delay_np(&interval) == EINTR);
+  return (void *) 1;
+}
+
+static void *
+condWaiter(void * arg)
+{
+  int wakeups = 0;
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  while (!predicate)
+    {
+      assert(pthread_cond_wait(&cv, &mx) == 0);
+      /* Must own the mutex again */
+      assert(pthread_mutex_unlock(&mx) == 0);
+      assert(pthread_mutex_lock(&mx) == 0);
+      wakeups++;
+    }
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return (void *)(size_t) wakeups;
+}
+
+static void *
+early(void * arg)
+{
+  /* Wait for the interrupt to be posted before blocking */
+  while (sem_trywait((sem_t *) arg) != 0)
+    {
+      Sleep(10);
+    }
+  assert(sem_wait(&sem) == -1);
+  assert(errno == EINTR);
+  return (void *) 1;
+}
+
+static void *
+cancelled(void * arg)
+{
+  for (;;)
+    {
+      if (sem_wait(&sem) != 0)
+        {
+          assert(errno == EINTR);
+        }
+    }
+  return NULL;
+}
+
+/*
+ * An interrupt is kept until a wait consumes it, so it doesn't
+ * matter whether t has started waiting yet.
+ */
+static void *
+interruptAndJoin(pthread_t t)
+{
+  void * result = NULL;
+
+  Sleep(100);
+  assert(pthread_interrupt_np(t) == 0);
+  assert(pthread_join(t, &result) == 0);
+  return result;
+}
+
+int
+main()
+{
+  pthread_t t;
+  sem_t go;
+  void * result = NULL;
+  int value;
+
+  assert(sem_init(&sem, 0, 0) == 0);
+  assert(sem_init(&go, 0, 0) == 0);
+
+  assert(pthread_create(&t, NULL, semWaiter, NULL) == 0);
+  assert(interruptAndJoin(t) == (void *) 1);
+  assert(sem_getvalue(&sem, &value) == 0);
+  assert(value == 0);
+
+  assert(pthread_create(&t, NULL, semTimedWaiter, NULL) == 0);
+  assert(interruptAndJoin(t) == (void *) 1);
+  assert(sem_getvalue(&sem, &value) == 0);
+  assert(value == 0);
+
+  /*
+   * The interrupted joiner leaves sleeper joinable.
+   */
+  assert(pthread_create(&sleeper, NULL, sleepy, NULL) == 0);
+  assert(pthread_create(&t, NULL, joiner, NULL) == 0);
+  assert(interruptAndJoin(t) == (void *) 1);
+  assert(sem_post(&sem) == 0);
+  assert(pthread_join(sleeper, &result) == 0);
+  assert(result == (void *) 2);
+
+  assert(pthread_create(&t, NULL, delayer, NULL) == 0);
+  assert(interruptAndJoin(t) == (void *) 1);
+
+  assert(pthread_create(&t, NULL, condWaiter, NULL) == 0);
+  Sleep(100);
+  assert(pthread_interrupt_np(t) == 0);
+  Sleep(100);
+  assert(pthread_mutex_lock(&mx) == 0);
+  predicate = 1;
+  assert(pthread_cond_signal(&cv) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, &result) == 0);
+  assert((int)(size_t) result >= 1);
+
+  assert(pthread_create(&t, NULL, early, (void *) &go) == 0);
+  assert(pthread_interrupt_np(t) == 0);
+  assert(sem_post(&go) == 0);
+  assert(pthread_join(t, &result) == 0);
+  assert(result == (void *) 1);
+
+  /*
+   * Interrupts don't get in the way of cancellation.
+   */
+  assert(pthread_create(&t, NULL, cancelled, NULL) == 0);
+  Sleep(100);
+  assert(pthread_interrupt_np(t) == 0);
+  Sleep(100);
+  assert(pthread_cancel(t) == 0);
+  assert(pthread_join(t, &result) == 0);
+  assert(result == PTHREAD_CANCELED);
+
+  assert(sem_getvalue(&sem, &value) == 0);
+  assert(value == 0);
+
+  t.p = NULL;
+  assert(pthread_interrupt_np(t) == ESRCH);
+
+  assert(sem_destroy(&go) == 0);
+  assert(sem_destroy(&sem) == 0);
+
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * join4.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that pthread_join returns only after the target's TSD destructors
+ *   have run, however the target finished.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_join
+ *
+ * Cases Tested:
+ * - return from the start routine
+ * - pthread_exit
+ * - deferred cancellation
+ * - many create and join cycles, which reuse thread structs that may
+ *   still be exiting when they are joined
+ *
+ * Description:
+ * - pthread_join may return before the target has finished its Win32
+ *   thread detach, but never before its destructors have run.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+enum {
+  CYCLES = 1000
+};
+
+static pthread_key_t key;
+static int destroyed[CYCLES];
+
+static void
+destructor(void * arg)
+{
+  *(int *) arg = 1;
+}
+
+static void *
+returner(void * arg)
+{
+  assert(pthread_setspecific(key, arg) == 0);
+  return arg;
+}
+
+static void *
+exiter(void * arg)
+{
+  assert(pthread_setspecific(key, arg) == 0);
+  pthread_exit(arg);
+  return NULL;
+}
+
+static void *
+cancelled(void * arg)
+{
+  assert(pthread_setspecific(key, arg) == 0);
+  for (;;)
+    {
+      pthread_testcancel();
+      Sleep(10);
+    }
+  return NULL;
+}
+
+int
+main()
+{
+  pthread_t t;
+  void * result = NULL;
+  int i;
+
+  assert(pthread_key_create(&key, destructor) == 0);
+
+  assert(pthread_create(&t, NULL, returner, &destroyed[0]) == 0);
+  assert(pthread_join(t, &result) == 0);
+  assert(result == &destroyed[0]);
+  assert(destroyed[0] == 1);
+
+  assert(pthread_create(&t, NULL, exiter, &destroyed[1]) == 0);
+  assert(pthread_join(t, &result) == 0);
+  assert(result == &destroyed[1]);
+  assert(destroyed[1] == 1);
+
+  assert(pthread_create(&t, NULL, cancelled, &destroyed[2]) == 0);
+  Sleep(100);
+  assert(pthread_cancel(t) == 0);
+  assert(pthread_join(t, &result) == 0);
+  assert(result == PTHREAD_CANCELED);
+  assert(destroyed[2] == 1);
+
+  for (i = 3; i < CYCLES; i++)
+    {
+      assert(pthread_create(&t, NULL, returner, &destroyed[i]) == 0);
+      assert(pthread_join(t, &result) == 0);
+      assert(result == &destroyed[i]);
+      assert(destroyed[i] == 1);
+    }
+
+  assert(pthread_key_delete(key) == 0);
+
+  return 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * locktrace1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that the lock trace records each change of mutex ownership,
+ *   with the time waited, and nothing while stopped.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_locktrace_np
+ * - pthread_locktrace_dump_np
+ *
+ * Cases Tested:
+ * - lock, trylock and unlock of normal, recursive and errorcheck
+ *   mutexes; recursive relocks and failed unlocks aren't recorded
+ * - a contended lock records its wait
+ * - operations while stopped aren't recorded
+ *
+ * Description:
+ * - The dump is read back and checked record by record.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * - No other thread uses a mutex or semaphore while the test runs.
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+#define TRACEFILE "locktrace1.lkt"
+
+enum {
+  HEADER_SIZE = 56,
+  RECORD_SIZE = 24,
+  RECORDS = 10,
+  OP_LOCK = 1,
+  OP_TRYLOCK = 2,
+  OP_UNLOCK = 3
+};
+
+typedef struct {
+  double ticks;
+  unsigned long object;
+  unsigned long thread;
+  unsigned long wait;
+  unsigned long op;
+  unsigned long kind;
+} rec_t;
+
+static pthread_mutex_t mx;
+static pthread_mutex_t rmx;
+static pthread_mutex_t emx;
+static pthread_mutex_t cmx;
+static volatile int started = 0;
+
+static unsigned long
+get32 (const unsigned char * p)
+{
+  return (unsigned long) p[0]
+    | ((unsigned long) p[1] << 8)
+    | ((unsigned long) p[2] << 16)
+    | ((unsigned long) p[3] << 24);
+}
+
+static double
+get64 (const unsigned char * p)
+{
+  return (double) get32 (p) + (double) get32 (p + 4) * 4294967296.0;
+}
+
+void * contender(void * arg)
+{
+  started = 1;
+  assert(pthread_mutex_lock(&cmx) == 0);
+  assert(pthread_mutex_unlock(&cmx) == 0);
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t;
+  pthread_mutexattr_t ma;
+  FILE * in;
+  unsigned char header[HEADER_SIZE];
+  unsigned char raw[RECORD_SIZE];
+  rec_t r[RECORDS];
+  double ticksPerSecond;
+  int i;
+
+  assert(pthread_locktrace_dump_np(NULL) == EINVAL);
+
+  assert(pthread_mutexattr_init(&ma) == 0);
+  assert(pthread_mutex_init(&mx, NULL) == 0);
+  assert(pthread_mutex_init(&cmx, NULL) == 0);
+  assert(pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE) == 0);
+  assert(pthread_mutex_init(&rmx, &ma) == 0);
+  assert(pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_ERRORCHECK) == 0);
+  assert(pthread_mutex_init(&emx, &ma) == 0);
+  assert(pthread_mutexattr_destroy(&ma) == 0);
+
+  /* Not recorded yet. */
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+
+  assert(pthread_locktrace_np(65536) == 0);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+
+  assert(pthread_mutex_lock(&rmx) == 0);
+  assert(pthread_mutex_lock(&rmx) == 0);
+  assert(pthread_mutex_unlock(&rmx) == 0);
+  assert(pthread_mutex_unlock(&rmx) == 0);
+
+  assert(pthread_mutex_trylock(&emx) == 0);
+  assert(pthread_mutex_unlock(&emx) == 0);
+  assert(pthread_mutex_unlock(&emx) == EPERM);
+
+  assert(pthread_mutex_lock(&cmx) == 0);
+  assert(pthread_create(&t, NULL, contender, NULL) == 0);
+  while (!started)
+    {
+      Sleep(1);
+    }
+  Sleep(100);
+  assert(pthread_mutex_unlock(&cmx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(pthread_locktrace_np(0) == 0);
+
+  /* Stopped. */
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+
+  assert(pthread_locktrace_dump_np(TRACEFILE) == 0);
+
+  assert((in = fopen(TRACEFILE, "rb")) != NULL);
+  assert(fread(header, HEADER_SIZE, 1, in) == 1);
+  assert(memcmp(header, "PTW32LKT", 8) == 0);
+  assert(get32(header + 8) == 1);
+  assert(get32(header + 12) == RECORD_SIZE);
+  ticksPerSecond = get64(header + 16);
+  assert(ticksPerSecond > 0.0);
+  assert(get32(header + 36) == RECORDS);
+  assert(get32(header + 40) == 2);
+  assert(get32(header + 44) == 4);
+  assert(get32(header + 48) == 0);
+
+  for (i = 0; i < RECORDS; i++)
+    {
+      assert(fread(raw, RECORD_SIZE, 1, in) == 1);
+      r[i].ticks = get64(raw);
+      r[i].object = get32(raw + 8);
+      r[i].thread = get32(raw + 12);
+      r[i].wait = get32(raw + 16);
+      r[i].op = get32(raw + 20) & 0xffff;
+      r[i].kind = get32(raw + 20) >> 16;
+    }
+  assert(fread(raw, 1, 1, in) == 0);
+  fclose(in);
+  assert(remove(TRACEFILE) == 0);
+
+  /*
+   * Each thread's records are together, the main thread's first as
+   * it recorded first.
+   */
+  for (i = 0; i < 8; i++)
+    {
+      assert(r[i].thread == r[0].thread);
+      assert(r[i].object == r[0].object + (unsigned long) i / 2);
+      assert(r[i].op == ((i % 2) ? OP_UNLOCK : (i == 4) ? OP_TRYLOCK : OP_LOCK));
+      assert(i == 0 || r[i].ticks >= r[i - 1].ticks);
+    }
+  assert(r[0].kind == PTHREAD_MUTEX_NORMAL);
+  assert(r[2].kind == PTHREAD_MUTEX_RECURSIVE);
+  assert(r[4].kind == PTHREAD_MUTEX_ERRORCHECK);
+  assert(r[6].kind == PTHREAD_MUTEX_NORMAL);
+
+  assert(r[8].thread != r[0].thread);
+  assert(r[8].object == r[6].object && r[8].op == OP_LOCK);
+  assert(r[9].object == r[6].object && r[9].op == OP_UNLOCK);
+  assert((double) r[8].wait / ticksPerSecond >= 0.05);
+  assert(r[8].ticks + r[8].wait >= r[7].ticks);
+
+  assert(pthread_mutex_destroy(&mx) == 0);
+  assert(pthread_mutex_destroy(&rmx) == 0);
+  assert(pthread_mutex_destroy(&emx) == 0);
+  assert(pthread_mutex_destroy(&cmx) == 0);
+
+  return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * mailbox1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that messages sent with pthread_send_np() are received by
+ *   pthread_recv_np() in order, from any number of senders.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_send_np
+ * - pthread_recv_np
+ *
+ * Cases Tested:
+ * - messages sent to self come back oldest first
+ * - empty mailbox with a timeout
+ * - several senders, each seen in its own order
+ * - cancelling a thread parked in pthread_recv_np()
+ * - invalid arguments and threads
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+enum {
+  NUMSENDERS = 4,
+  NUMMSGS = 10000
+};
+
+typedef struct {
+  struct ptw32_msg link;	/* First, so a message is its link */
+  int sender;
+  int seq;
+} msg_t;
+
+static msg_t msgs[NUMSENDERS][NUMMSGS];
+static pthread_t receiver;
+
+void * sender(void * arg)
+{
+  int s = (int)(size_t) arg;
+  int i;
+
+  for (i = 0; i < NUMMSGS; i++)
+    {
+      msgs[s][i].sender = s;
+      msgs[s][i].seq = i;
+      assert(pthread_send_np(receiver, &msgs[s][i].link) == 0);
+    }
+
+  return NULL;
+}
+
+void * receive(void * arg)
+{
+  int next[NUMSENDERS] = {0};
+  int i;
+  struct ptw32_msg * m;
+
+  for (i = 0; i < NUMSENDERS * NUMMSGS; i++)
+    {
+      msg_t * mp;
+
+      assert(pthread_recv_np(&m, NULL) == 0);
+      assert(m->next == NULL);
+      mp = (msg_t *) m;
+      assert(mp->seq == next[mp->sender]);
+      next[mp->sender]++;
+    }
+
+  return arg;
+}
+
+void * parked(void * arg)
+{
+  struct ptw32_msg * m;
+
+  (void) pthread_recv_np(&m, NULL);
+
+  /* Never reached. */
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t[NUMSENDERS];
+  pthread_t p;
+  struct ptw32_msg a, b, c;
+  struct ptw32_msg * m;
+  struct timespec abstime = { 0, 0 };
+  void * result;
+  int i;
+
+  /*
+   * To self, oldest first.
+   */
+  assert(pthread_send_np(pthread_self(), &a) == 0);
+  assert(pthread_send_np(pthread_self(), &b) == 0);
+  assert(pthread_recv_np(&m, NULL) == 0);
+  assert(m == &a);
+  assert(pthread_send_np(pthread_self(), &c) == 0);
+  assert(pthread_recv_np(&m, NULL) == 0);
+  assert(m == &b);
+  assert(pthread_recv_np(&m, NULL) == 0);
+  assert(m == &c);
+
+  /*
+   * An abstime in the past times out at once.
+   */
+  assert(pthread_recv_np(&m, &abstime) == ETIMEDOUT);
+
+  assert(pthread_recv_np(NULL, NULL) == EINVAL);
+  assert(pthread_send_np(pthread_self(), NULL) == EINVAL);
+
+  /*
+   * Several senders at once.
+   */
+  assert(pthread_create(&receiver, NULL, receive, NULL) == 0);
+  for (i = 0; i < NUMSENDERS; i++)
+    {
+      assert(pthread_create(&t[i], NULL, sender, (void *)(size_t) i) == 0);
+    }
+  for (i = 0; i < NUMSENDERS; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+  assert(pthread_join(receiver, NULL) == 0);
+
+  /*
+   * A joined thread has no mailbox.
+   */
+  assert(pthread_send_np(receiver, &a) == ESRCH);
+
+  /*
+   * Cancel a parked receiver.
+   */
+  assert(pthread_create(&p, NULL, parked, NULL) == 0);
+  Sleep(100);
+  assert(pthread_cancel(p) == 0);
+  assert(pthread_join(p, &result) == 0);
+  assert(result == PTHREAD_CANCELED);
+
+  return 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * name1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that thread names set with pthread_setname_np() and
+ *   pthread_attr_setname_np() are read back by pthread_getname_np().
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_setname_np
+ * - pthread_getname_np
+ * - pthread_attr_setname_np
+ * - pthread_attr_getname_np
+ *
+ * Cases Tested:
+ * - unnamed thread
+ * - naming the calling thread and another thread
+ * - name given at creation
+ * - names and buffers that are too long or too short
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+#include <string.h>
+
+static pthread_barrier_t named;
+static pthread_barrier_t checked;
+
+void * func(void * arg)
+{
+  char name[PTW32_THREAD_NAME_MAX];
+
+  /*
+   * The name given at creation is there from the start.
+   */
+  assert(pthread_getname_np(pthread_self(), name, sizeof(name)) == 0);
+  assert(strcmp(name, "worker") == 0);
+
+  /*
+   * Wait to be renamed by main.
+   */
+  pthread_barrier_wait(&named);
+  assert(pthread_getname_np(pthread_self(), name, sizeof(name)) == 0);
+  assert(strcmp(name, "renamed") == 0);
+  pthread_barrier_wait(&checked);
+
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t;
+  pthread_attr_t attr;
+  char name[PTW32_THREAD_NAME_MAX];
+  char small[4];
+
+  assert(pthread_getname_np(pthread_self(), name, sizeof(name)) == 0);
+  assert(name[0] == '\0');
+
+  assert(pthread_setname_np(pthread_self(), "main") == 0);
+  assert(pthread_getname_np(pthread_self(), name, sizeof(name)) == 0);
+  assert(strcmp(name, "main") == 0);
+
+  assert(pthread_getname_np(pthread_self(), small, sizeof(small)) == ERANGE);
+  assert(pthread_getname_np(pthread_self(), small, 5) == 0);
+
+  /*
+   * 15 bytes fit, 16 don't.
+   */
+  assert(pthread_setname_np(pthread_self(), "123456789012345") == 0);
+  assert(pthread_setname_np(pthread_self(), "1234567890123456") == ERANGE);
+  assert(pthread_getname_np(pthread_self(), name, sizeof(name)) == 0);
+  assert(strcmp(name, "123456789012345") == 0);
+
+  assert(pthread_setname_np(pthread_self(), NULL) == EINVAL);
+  assert(pthread_setname_np(pthread_self(), "") == 0);
+  assert(pthread_getname_np(pthread_self(), name, sizeof(name)) == 0);
+  assert(name[0] == '\0');
+
+  assert(pthread_attr_init(&attr) == 0);
+  assert(pthread_attr_getname_np(&attr, name, sizeof(name)) == 0);
+  assert(name[0] == '\0');
+  assert(pthread_attr_setname_np(&attr, "1234567890123456") == ERANGE);
+  assert(pthread_attr_setname_np(&attr, "worker") == 0);
+  assert(pthread_attr_getname_np(&attr, small, sizeof(small)) == ERANGE);
+  assert(pthread_attr_getname_np(&attr, name, sizeof(name)) == 0);
+  assert(strcmp(name, "worker") == 0);
+
+  assert(pthread_barrier_init(&named, NULL, 2) == 0);
+  assert(pthread_barrier_init(&checked, NULL, 2) == 0);
+
+  assert(pthread_create(&t, &attr, func, NULL) == 0);
+  assert(pthread_setname_np(t, "renamed") == 0);
+  pthread_barrier_wait(&named);
+  pthread_barrier_wait(&checked);
+  assert(pthread_join(t, NULL) == 0);
+
+  /*
+   * A joined thread can't be named.
+   */
+  assert(pthread_setname_np(t, "gone") == ESRCH);
+
+  assert(pthread_attr_destroy(&attr) == 0);
+  assert(pthread_barrier_destroy(&named) == 0);
+  assert(pthread_barrier_destroy(&checked) == 0);
+
+  return 0;
+}
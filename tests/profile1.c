@@ -0,0 +1,219 @@
+/*
+ * profile1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that blocking waits sampled by pthread_profile_np() are reported
+ *   per call site with the time waited.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_profile_np
+ * - pthread_profile_get_np
+ * - pthread_profile_reset_np
+ * - pthread_profile_dump_np
+ *
+ * Cases Tested:
+ * - contended mutex, semaphore and spin lock
+ * - table too small for the sites
+ * - reset and stop
+ * - dump to a file
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * - RtlCaptureStackBackTrace is available (Windows XP and later).
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_spinlock_t spin;
+static sem_t sem;
+static struct ptw32_profile_site sites[PTW32_PROFILE_SITES + 1];
+
+void * lockMutex(void * arg)
+{
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return arg;
+}
+
+void * waitSem(void * arg)
+{
+  assert(sem_wait(&sem) == 0);
+  return arg;
+}
+
+void * lockSpin(void * arg)
+{
+  assert(pthread_spin_lock(&spin) == 0);
+  assert(pthread_spin_unlock(&spin) == 0);
+  return arg;
+}
+
+static struct ptw32_profile_site *
+findSite(int n, int type)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      if (sites[i].type == type)
+        {
+          return &sites[i];
+        }
+    }
+
+  return NULL;
+}
+
+int
+main()
+{
+  pthread_t t;
+  struct ptw32_profile_site * s;
+  int count;
+  FILE * f;
+
+  assert(pthread_profile_np(-1) == EINVAL);
+  assert(pthread_profile_get_np(sites, NULL) == EINVAL);
+  count = 1;
+  assert(pthread_profile_get_np(NULL, &count) == EINVAL);
+
+  count = PTW32_PROFILE_SITES + 1;
+  assert(pthread_profile_get_np(sites, &count) == 0);
+  assert(count == 0);
+
+  assert(pthread_spin_init(&spin, PTHREAD_PROCESS_PRIVATE) == 0);
+  assert(sem_init(&sem, 0, 0) == 0);
+
+  /*
+   * Sample every block.
+   */
+  assert(pthread_profile_np(1) == 0);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t, NULL, lockMutex, NULL) == 0);
+  Sleep(100);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(pthread_create(&t, NULL, waitSem, NULL) == 0);
+  Sleep(100);
+  assert(sem_post(&sem) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(pthread_spin_lock(&spin) == 0);
+  assert(pthread_create(&t, NULL, lockSpin, NULL) == 0);
+  Sleep(100);
+  assert(pthread_spin_unlock(&spin) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  count = PTW32_PROFILE_SITES + 1;
+  assert(pthread_profile_get_np(sites, &count) == 0);
+  assert(count >= 3);
+
+  s = findSite(count, PTW32_WAIT_MUTEX);
+  assert(s != NULL);
+  assert(s->samples >= 1);
+  assert(s->depth > 0);
+  assert(s->waited >= 50000000ULL);
+  assert(s->maxWaited <= s->waited);
+
+  s = findSite(count, PTW32_WAIT_SEMAPHORE);
+  assert(s != NULL);
+  assert(s->waited >= 50000000ULL);
+
+  s = findSite(count, PTW32_WAIT_SPIN);
+  assert(s != NULL);
+  assert(s->samples == 1);
+
+  /*
+   * Too small a table.
+   */
+  count = 1;
+  assert(pthread_profile_get_np(sites, &count) == ERANGE);
+  assert(count >= 3);
+
+  assert(pthread_profile_dump_np("profile1.out") == 0);
+  assert((f = fopen("profile1.out", "r")) != NULL);
+  assert(fgetc(f) == '#');
+  fclose(f);
+  (void) remove("profile1.out");
+
+  /*
+   * Stopped, nothing more is sampled.
+   */
+  assert(pthread_profile_np(0) == 0);
+  assert(pthread_profile_reset_np() == 0);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t, NULL, lockMutex, NULL) == 0);
+  Sleep(100);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  count = PTW32_PROFILE_SITES + 1;
+  assert(pthread_profile_get_np(sites, &count) == 0);
+  assert(count == 0);
+
+  assert(pthread_spin_destroy(&spin) == 0);
+  assert(sem_destroy(&sem) == 0);
+
+  return 0;
+}
@@ -0,0 +1,216 @@
+/*
+ * semaphore6.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that sem_wait_n_np() and sem_trywait_n_np() take several tokens
+ *   as one operation and that queued requests are served in order.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - sem_wait_n_np
+ * - sem_trywait_n_np
+ *
+ * Cases Tested:
+ * - invalid token counts are rejected
+ * - sem_trywait_n_np takes all or nothing
+ * - a waiting large request reserves posted tokens; sem_trywait fails
+ *   and a later sem_wait queues behind it
+ * - one sem_post_multiple satisfies several queued requests
+ * - a timed out request gives back the tokens it had reserved
+ * - a cancelled request gives back the tokens it had reserved
+ * - sem_destroy fails with EBUSY while a request is queued
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+#include <sys/timeb.h>
+
+static sem_t s;
+
+static void *
+waitN(void * arg)
+{
+  assert(sem_wait_n_np(&s, (int)(size_t) arg, NULL) == 0);
+  return (void *) 1;
+}
+
+static void *
+waitOne(void * arg)
+{
+  assert(sem_wait(&s) == 0);
+  return (void *) 1;
+}
+
+/*
+ * Wait until a queued request has reserved every token available.
+ */
+static void
+waitForValue(int expected)
+{
+  int value;
+
+  for (;;)
+    {
+      assert(sem_getvalue(&s, &value) == 0);
+      if (value == expected)
+        {
+          break;
+        }
+      Sleep(10);
+    }
+}
+
+int
+main()
+{
+  pthread_t big;
+  pthread_t small;
+  pthread_t t[2];
+  void * result;
+  int value;
+  struct timespec abstime;
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTime;
+#else
+  struct _timeb currSysTime;
+#endif
+  const DWORD NANOSEC_PER_MILLISEC = 1000000;
+
+  assert(sem_init(&s, PTHREAD_PROCESS_PRIVATE, 3) == 0);
+
+  assert(sem_wait_n_np(&s, 0, NULL) == -1);
+  assert(errno == EINVAL);
+  assert(sem_trywait_n_np(&s, -1) == -1);
+  assert(errno == EINVAL);
+
+  /* All or nothing. */
+  assert(sem_trywait_n_np(&s, 4) == -1);
+  assert(errno == EAGAIN);
+  assert(sem_getvalue(&s, &value) == 0);
+  assert(value == 3);
+  assert(sem_trywait_n_np(&s, 3) == 0);
+  assert(sem_getvalue(&s, &value) == 0);
+  assert(value == 0);
+
+  /*
+   * A request for 3 reserves the first token posted; nobody else
+   * can take it and a later single waiter queues behind.
+   */
+  assert(pthread_create(&big, NULL, waitN, (void *)(size_t) 3) == 0);
+  assert(sem_post(&s) == 0);
+  waitForValue(0);
+  assert(sem_trywait(&s) == -1);
+  assert(errno == EAGAIN);
+  assert(sem_destroy(&s) == -1);
+  assert(errno == EBUSY);
+  assert(pthread_create(&small, NULL, waitOne, NULL) == 0);
+  Sleep(100);
+  assert(sem_post_multiple(&s, 2) == 0);
+  assert(pthread_join(big, &result) == 0);
+  assert(result == (void *) 1);
+  assert(sem_post(&s) == 0);
+  assert(pthread_join(small, &result) == 0);
+  assert(result == (void *) 1);
+  assert(sem_getvalue(&s, &value) == 0);
+  assert(value == 0);
+
+  /* One post satisfies two requests. */
+  assert(pthread_create(&t[0], NULL, waitN, (void *)(size_t) 2) == 0);
+  assert(sem_post(&s) == 0);
+  waitForValue(0);
+  assert(pthread_create(&t[1], NULL, waitN, (void *)(size_t) 2) == 0);
+  assert(sem_post_multiple(&s, 3) == 0);
+  assert(pthread_join(t[0], &result) == 0);
+  assert(result == (void *) 1);
+  assert(pthread_join(t[1], &result) == 0);
+  assert(result == (void *) 1);
+  assert(sem_getvalue(&s, &value) == 0);
+  assert(value == 0);
+
+  /* A timeout gives back what was reserved. */
+  assert(sem_post(&s) == 0);
+  PTW32_FTIME(&currSysTime);
+  abstime.tv_sec = (long)currSysTime.time;
+  abstime.tv_nsec = NANOSEC_PER_MILLISEC * currSysTime.millitm;
+  abstime.tv_nsec += 200 * NANOSEC_PER_MILLISEC;
+  if (abstime.tv_nsec >= 1000000000)
+    {
+      abstime.tv_nsec -= 1000000000;
+      abstime.tv_sec++;
+    }
+  assert(sem_wait_n_np(&s, 2, &abstime) == -1);
+  assert(errno == ETIMEDOUT);
+  assert(sem_getvalue(&s, &value) == 0);
+  assert(value == 1);
+
+  /* So does cancelation. */
+  assert(pthread_create(&big, NULL, waitN, (void *)(size_t) 3) == 0);
+  waitForValue(0);
+  assert(pthread_cancel(big) == 0);
+  assert(pthread_join(big, &result) == 0);
+  assert(result == PTHREAD_CANCELED);
+  assert(sem_getvalue(&s, &value) == 0);
+  assert(value == 1);
+
+  assert(sem_destroy(&s) == 0);
+
+  return 0;
+}
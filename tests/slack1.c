@@ -0,0 +1,230 @@
+/*
+ * slack1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that timed waits with timer slack time out no earlier than
+ *   their deadline and no later than the slack allows.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_setslack_np
+ * - pthread_getslack_np
+ * - pthread_cond_timedwait_slack_np
+ * - sem_timedwait_slack_np
+ *
+ * Cases Tested:
+ * - thread slack applied to pthread_cond_timedwait()
+ * - per-call slack, and the thread's slack restored after it
+ * - the thread's slack set by another thread during a per-call wait
+ * - a signal before the deadline is not delayed by the slack
+ * - invalid arguments and threads
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * - The system timer ticks at least every 20 ms.
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+#include <sys/timeb.h>
+
+enum {
+  SLACK = 50,
+  TIMEOUT = 200,
+  TICK = 20          /* System timer granularity allowed for */
+};
+
+static pthread_cond_t cv = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static sem_t sem;
+static int signalled;
+
+static struct timespec *
+deadline(struct timespec * abstime, int ms)
+{
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTime;
+#else
+  struct _timeb currSysTime;
+#endif
+
+  PTW32_FTIME(&currSysTime);
+
+  abstime->tv_sec = (long)currSysTime.time + (currSysTime.millitm + ms) / 1000;
+  abstime->tv_nsec = ((currSysTime.millitm + ms) % 1000) * 1000000L;
+
+  return abstime;
+}
+
+void * waker(void * arg)
+{
+  Sleep(TIMEOUT / 4);
+  assert(pthread_mutex_lock(&mx) == 0);
+  signalled = 1;
+  assert(pthread_cond_signal(&cv) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return arg;
+}
+
+void * idle(void * arg)
+{
+  return arg;
+}
+
+void * slackWaiter(void * arg)
+{
+  struct timespec abstime;
+  unsigned long slack;
+
+  assert(sem_timedwait_slack_np(&sem, deadline(&abstime, 10 * TIMEOUT), SLACK) == 0);
+
+  /*
+   * The setting made during the call stands.
+   */
+  assert(pthread_getslack_np(pthread_self(), &slack) == 0);
+  assert(slack == SLACK / 2);
+
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t;
+  struct timespec abstime;
+  unsigned long slack;
+  DWORD start, elapsed;
+
+  assert(pthread_getslack_np(pthread_self(), &slack) == 0);
+  assert(slack == 0);
+  assert(pthread_getslack_np(pthread_self(), NULL) == EINVAL);
+  assert(pthread_setslack_np(pthread_self(), (unsigned long) INFINITE) == EINVAL);
+
+  /*
+   * The thread's slack.
+   */
+  assert(pthread_setslack_np(pthread_self(), SLACK) == 0);
+  assert(pthread_getslack_np(pthread_self(), &slack) == 0);
+  assert(slack == SLACK);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  start = GetTickCount();
+  assert(pthread_cond_timedwait(&cv, &mx, deadline(&abstime, TIMEOUT)) == ETIMEDOUT);
+  elapsed = GetTickCount() - start;
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(elapsed + TICK >= TIMEOUT);
+  assert(elapsed <= TIMEOUT + SLACK + 2 * TICK);
+
+  /*
+   * Per call, leaving the thread's slack alone.
+   */
+  assert(pthread_setslack_np(pthread_self(), 0) == 0);
+  assert(sem_init(&sem, 0, 0) == 0);
+  start = GetTickCount();
+  assert(sem_timedwait_slack_np(&sem, deadline(&abstime, TIMEOUT), SLACK) == -1);
+  assert(errno == ETIMEDOUT);
+  elapsed = GetTickCount() - start;
+  assert(elapsed + TICK >= TIMEOUT);
+  assert(elapsed <= TIMEOUT + SLACK + 2 * TICK);
+  assert(pthread_getslack_np(pthread_self(), &slack) == 0);
+  assert(slack == 0);
+
+  assert(sem_timedwait_slack_np(&sem, &abstime, (unsigned long) INFINITE) == -1);
+  assert(errno == EINVAL);
+
+  /*
+   * Another thread sees and sets the waiter's own slack while it
+   * waits with a per-call slack.
+   */
+  assert(pthread_create(&t, NULL, slackWaiter, NULL) == 0);
+  Sleep(TIMEOUT / 4);
+  assert(pthread_getslack_np(t, &slack) == 0);
+  assert(slack == 0);
+  assert(pthread_setslack_np(t, SLACK / 2) == 0);
+  assert(sem_post(&sem) == 0);
+  assert(pthread_join(t, NULL) == 0);
+  assert(sem_destroy(&sem) == 0);
+
+  /*
+   * A wakeup is never held back by the slack.
+   */
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t, NULL, waker, NULL) == 0);
+  start = GetTickCount();
+  while (!signalled)
+    {
+      assert(pthread_cond_timedwait_slack_np(&cv, &mx,
+                                             deadline(&abstime, 10 * TIMEOUT),
+                                             10 * TIMEOUT) == 0);
+    }
+  elapsed = GetTickCount() - start;
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+  assert(elapsed < 2 * TIMEOUT);
+
+  /*
+   * A joined thread has no slack.
+   */
+  assert(pthread_create(&t, NULL, idle, NULL) == 0);
+  assert(pthread_setslack_np(t, SLACK) == 0 || pthread_kill(t, 0) == ESRCH);
+  assert(pthread_join(t, NULL) == 0);
+  assert(pthread_setslack_np(t, SLACK) == ESRCH);
+  assert(pthread_getslack_np(t, &slack) == ESRCH);
+
+  return 0;
+}
@@ -0,0 +1,450 @@
+/*
+ * soak1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - Soak test a mixed workload for a long period, watching for
+ *   throughput drift and resource leaks.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * - No growth in handle count or private bytes, and no throughput
+ *   decline, while the library is exercised for hours.
+ *
+ * Features Tested:
+ * - pthread_create, pthread_join
+ * - statically initialised mutexes, condition variables and rwlocks
+ * - pthread_cond_timedwait, sem_timedwait timeouts
+ * - pthread_cancel
+ * - TSD destructors
+ *
+ * Cases Tested:
+ * - 
+ *
+ * Description:
+ * - One worker per processor (at least two, at most eight) repeats a
+ *   cycle of: create and join a thread that sets a TSD value with a
+ *   destructor; use and destroy statically initialised objects; a
+ *   condition variable and a semaphore wait that time out; create,
+ *   cancel and join a thread blocked in a cancelation point.
+ * - Main samples completed cycles per second, the process handle
+ *   count and private bytes every interval and prints them as CSV.
+ *   The first interval is warm up; the next is the baseline.
+ * - At the end the mean of the last quarter of the samples is
+ *   compared with the baseline.
+ *
+ * Environment:
+ * - 
+ *
+ * Input:
+ * - soak1 [seconds [interval [percent]]]
+ *   Defaults are 60 seconds, 5 second intervals and 25 percent.
+ *   The duration can also be set with the SOAK_SECONDS environment
+ *   variable.
+ *
+ * Output:
+ * - One CSV line per sample: seconds,cycles_per_sec,handles,private_kb
+ * - File name, Line number, and failed expression on failure.
+ *
+ * Assumptions:
+ * - GetProcessHandleCount (kernel32) and GetProcessMemoryInfo (psapi)
+ *   are looked up at run time; if either is missing that measure
+ *   reads as 0 and isn't checked.
+ *
+ * Pass Criteria:
+ * - Handle count and private bytes grow by no more than 'percent'
+ *   (plus a small fixed allowance) and cycles per second fall by no
+ *   more than 'percent'.
+ *
+ * Fail Criteria:
+ * - Growth or decline beyond the threshold, or any failed assertion.
+ */
+
+#include "test.h"
+#include <string.h>
+#include <sys/timeb.h>
+
+#define MAX_WORKERS     8
+#define MAX_SAMPLES     100000
+#define HANDLE_SLACK    (8 * MAX_WORKERS)
+#define PRIVATE_SLACK_KB 1024
+
+typedef struct {
+  pthread_t thread;
+  volatile long cycles;
+  char pad[64];
+} worker_t;
+
+typedef struct {
+  double cyclesPerSec;
+  unsigned long handles;
+  unsigned long privateKb;
+} sample_t;
+
+typedef struct {
+  DWORD cb;
+  DWORD PageFaultCount;
+  SIZE_T PeakWorkingSetSize;
+  SIZE_T WorkingSetSize;
+  SIZE_T QuotaPeakPagedPoolUsage;
+  SIZE_T QuotaPagedPoolUsage;
+  SIZE_T QuotaPeakNonPagedPoolUsage;
+  SIZE_T QuotaNonPagedPoolUsage;
+  SIZE_T PagefileUsage;
+  SIZE_T PeakPagefileUsage;
+  SIZE_T PrivateUsage;
+} soak_memory_counters_t;
+
+static BOOL (WINAPI * getHandleCount)(HANDLE, LPDWORD);
+static BOOL (WINAPI * getMemoryInfo)(HANDLE, soak_memory_counters_t *, DWORD);
+
+static worker_t workers[MAX_WORKERS];
+static sample_t samples[MAX_SAMPLES];
+static volatile int allExit = 0;
+static pthread_key_t key;
+static volatile long destructorCount = 0;
+static volatile long tsdThreadCount = 0;
+static sem_t neverPosted;
+
+/*
+ * Returns abstime 'milliseconds' from 'now'.
+ */
+static struct timespec *
+millisecondsFromNow (struct timespec * time, int millisecs)
+{
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTime;
+#else
+  struct _timeb currSysTime;
+#endif
+  int64_t nanosecs, secs;
+  const int64_t NANOSEC_PER_MILLISEC = 1000000;
+  const int64_t NANOSEC_PER_SEC = 1000000000;
+
+  PTW32_FTIME(&currSysTime);
+
+  secs = (int64_t)(currSysTime.time) + (millisecs / 1000);
+  nanosecs = ((int64_t) (millisecs%1000 + currSysTime.millitm)) * NANOSEC_PER_MILLISEC;
+  if (nanosecs >= NANOSEC_PER_SEC)
+    {
+      secs++;
+      nanosecs -= NANOSEC_PER_SEC;
+    }
+
+  time->tv_nsec = (long)nanosecs;
+  time->tv_sec = (long)secs;
+
+  return time;
+}
+
+static void
+destructor (void * arg)
+{
+  InterlockedIncrement((LPLONG)&destructorCount);
+}
+
+static void *
+tsdThread (void * arg)
+{
+  assert(pthread_setspecific(key, arg) == 0);
+  return arg;
+}
+
+static void *
+cancelThread (void * arg)
+{
+  /* sem_wait is a cancelation point. */
+  (void) sem_wait(&neverPosted);
+  return NULL;
+}
+
+static void *
+worker (void * arg)
+{
+  worker_t * w = (worker_t *) arg;
+
+  while (!allExit)
+    {
+      pthread_t t;
+      void * result;
+      struct timespec abstime;
+
+      /*
+       * Create/join churn with a TSD destructor to run at exit.
+       */
+      InterlockedIncrement((LPLONG)&tsdThreadCount);
+      assert(pthread_create(&t, NULL, tsdThread, (void *) w) == 0);
+      assert(pthread_join(t, &result) == 0);
+      assert(result == (void *) w);
+
+      /*
+       * Statically initialised objects, initialised on first use,
+       * with a timed wait that times out.
+       */
+      {
+        pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+        pthread_cond_t cv = PTHREAD_COND_INITIALIZER;
+        pthread_rwlock_t rwl = PTHREAD_RWLOCK_INITIALIZER;
+
+        assert(pthread_rwlock_rdlock(&rwl) == 0);
+        assert(pthread_rwlock_unlock(&rwl) == 0);
+        assert(pthread_mutex_lock(&mx) == 0);
+        assert(pthread_cond_timedwait(&cv, &mx, millisecondsFromNow(&abstime, 1)) == ETIMEDOUT);
+        assert(pthread_mutex_unlock(&mx) == 0);
+        assert(pthread_rwlock_destroy(&rwl) == 0);
+        assert(pthread_cond_destroy(&cv) == 0);
+        assert(pthread_mutex_destroy(&mx) == 0);
+      }
+
+      assert(sem_timedwait(&neverPosted, millisecondsFromNow(&abstime, 1)) == -1);
+      assert(errno == ETIMEDOUT);
+
+      /*
+       * Cancel a thread blocked in a cancelation point.
+       */
+      assert(pthread_create(&t, NULL, cancelThread, NULL) == 0);
+      Sleep(1);
+      assert(pthread_cancel(t) == 0);
+      assert(pthread_join(t, &result) == 0);
+      assert(result == PTHREAD_CANCELED);
+
+      w->cycles++;
+    }
+
+  return NULL;
+}
+
+static long
+totalCycles (int nworkers)
+{
+  long total = 0;
+  int i;
+
+  for (i = 0; i < nworkers; i++)
+    {
+      total += workers[i].cycles;
+    }
+
+  return total;
+}
+
+static void
+measure (sample_t * s)
+{
+  DWORD handles = 0;
+  soak_memory_counters_t mc;
+
+  if (getHandleCount != NULL)
+    {
+      (void) getHandleCount(GetCurrentProcess(), &handles);
+    }
+  s->handles = (unsigned long) handles;
+
+  memset(&mc, 0, sizeof(mc));
+  mc.cb = sizeof(mc);
+  if (getMemoryInfo != NULL
+      && getMemoryInfo(GetCurrentProcess(), &mc, sizeof(mc)))
+    {
+      s->privateKb = (unsigned long) (mc.PrivateUsage / 1024);
+    }
+  else
+    {
+      s->privateKb = 0;
+    }
+}
+
+/*
+ * Checks that 'now' hasn't grown more than 'percent' plus 'slack'
+ * over 'base'. A zero base means the measure isn't available.
+ */
+static int
+withinGrowth (const char * what, double base, double now, int percent, double slack)
+{
+  if (base > 0 && now > base * (100 + percent) / 100 + slack)
+    {
+      fprintf(stderr, "%s grew from %.0f to %.0f\n", what, base, now);
+      return 0;
+    }
+
+  return 1;
+}
+
+int
+main (int argc, char * argv[])
+{
+  int seconds = 60;
+  int interval = 5;
+  int percent = 25;
+  int nworkers = pthread_num_processors_np();
+  int nsamples = 0;
+  int i, first, last;
+  long cycles, lastCycles;
+  DWORD start, lastTick;
+  sample_t end;
+  HINSTANCE psapi;
+  char * env;
+
+  if ((env = getenv("SOAK_SECONDS")) != NULL)
+    {
+      seconds = atoi(env);
+    }
+  if (argc > 1)
+    {
+      seconds = atoi(argv[1]);
+    }
+  if (argc > 2)
+    {
+      interval = atoi(argv[2]);
+    }
+  if (argc > 3)
+    {
+      percent = atoi(argv[3]);
+    }
+  assert(seconds > 0 && interval > 0 && percent >= 0);
+
+  if (nworkers < 2)
+    {
+      nworkers = 2;
+    }
+  if (nworkers > MAX_WORKERS)
+    {
+      nworkers = MAX_WORKERS;
+    }
+
+  getHandleCount = (BOOL (WINAPI *)(HANDLE, LPDWORD))
+    GetProcAddress(GetModuleHandle(TEXT("KERNEL32.DLL")), "GetProcessHandleCount");
+  if ((psapi = LoadLibrary(TEXT("PSAPI.DLL"))) != NULL)
+    {
+      getMemoryInfo = (BOOL (WINAPI *)(HANDLE, soak_memory_counters_t *, DWORD))
+        GetProcAddress(psapi, "GetProcessMemoryInfo");
+    }
+
+  assert(pthread_key_create(&key, destructor) == 0);
+  assert(sem_init(&neverPosted, 0, 0) == 0);
+
+  for (i = 0; i < nworkers; i++)
+    {
+      assert(pthread_create(&workers[i].thread, NULL, worker, (void *) &workers[i]) == 0);
+    }
+
+  printf("seconds,cycles_per_sec,handles,private_kb\n");
+
+  start = lastTick = GetTickCount();
+  lastCycles = 0;
+
+  while (nsamples < MAX_SAMPLES
+         && (GetTickCount() - start) < (DWORD) seconds * 1000)
+    {
+      DWORD now;
+
+      Sleep(interval * 1000);
+
+      now = GetTickCount();
+      cycles = totalCycles(nworkers);
+      samples[nsamples].cyclesPerSec =
+        (double) (cycles - lastCycles) * 1000 / (now - lastTick > 0 ? now - lastTick : 1);
+      measure(&samples[nsamples]);
+
+      printf("%lu,%.1f,%lu,%lu\n",
+             (unsigned long) (now - start) / 1000,
+             samples[nsamples].cyclesPerSec,
+             samples[nsamples].handles,
+             samples[nsamples].privateKb);
+      fflush(stdout);
+
+      lastCycles = cycles;
+      lastTick = now;
+      nsamples++;
+    }
+
+  allExit = 1;
+
+  for (i = 0; i < nworkers; i++)
+    {
+      assert(pthread_join(workers[i].thread, NULL) == 0);
+    }
+
+  assert(destructorCount == tsdThreadCount);
+  assert(sem_destroy(&neverPosted) == 0);
+  assert(pthread_key_delete(key) == 0);
+
+  if (psapi != NULL)
+    {
+      (void) FreeLibrary(psapi);
+    }
+
+  /*
+   * Sample 0 is warm up and sample 1 the baseline; compare the
+   * mean of the last quarter (at least one sample) against it.
+   */
+  if (nsamples < 3)
+    {
+      printf("Too few samples to check for drift\n");
+      return 0;
+    }
+
+  first = nsamples - (nsamples - 2) / 4;
+  if (first == nsamples)
+    {
+      first = nsamples - 1;
+    }
+  last = nsamples;
+
+  memset(&end, 0, sizeof(end));
+  for (i = first; i < last; i++)
+    {
+      end.cyclesPerSec += samples[i].cyclesPerSec;
+      end.handles += samples[i].handles;
+      end.privateKb += samples[i].privateKb;
+    }
+  end.cyclesPerSec /= last - first;
+  end.handles /= last - first;
+  end.privateKb /= last - first;
+
+  assert(withinGrowth("Handle count", samples[1].handles, end.handles,
+                      percent, HANDLE_SLACK));
+  assert(withinGrowth("Private KB", samples[1].privateKb, end.privateKb,
+                      percent, PRIVATE_SLACK_KB));
+
+  if (end.cyclesPerSec < samples[1].cyclesPerSec * (100 - percent) / 100)
+    {
+      fprintf(stderr, "Cycles per second fell from %.1f to %.1f\n",
+              samples[1].cyclesPerSec, end.cyclesPerSec);
+      assert(end.cyclesPerSec >= samples[1].cyclesPerSec * (100 - percent) / 100);
+    }
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * File: stats1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that pthread_getstats_np() counters track library activity.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_getstats_np
+ *
+ * Cases Tested:
+ * - thread create, join and reuse
+ * - object live counts and handles
+ * - mutex and semaphore timeouts
+ *
+ * Description:
+ * - Take snapshots before and after each operation and check
+ *   the differences. Only this thread is running so the
+ *   differences are exact.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+#include <sys/timeb.h>
+
+static struct ptw32_stats before;
+static struct ptw32_stats after;
+
+void * func(void * arg)
+{
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t;
+  pthread_mutex_t mx;
+  pthread_cond_t cv;
+  sem_t s;
+  struct timespec abstime = { 0, 0 };
+#if (defined(__MINGW64__) || defined(__MINGW32__)) && __MSVCRT_VERSION__ >= 0x0601
+  struct __timeb64 currSysTime;
+#else
+  struct _timeb currSysTime;
+#endif
+  const DWORD NANOSEC_PER_MILLISEC = 1000000;
+
+  assert(pthread_getstats_np(NULL) == EINVAL);
+
+  /*
+   * Thread lifecycle.
+   */
+  assert(pthread_getstats_np(&before) == 0);
+  assert(pthread_create(&t, NULL, func, NULL) == 0);
+  assert(pthread_join(t, NULL) == 0);
+  assert(pthread_getstats_np(&after) == 0);
+
+  assert(after.threadsCreated - before.threadsCreated == 1);
+  assert(after.threadReuseHits + after.threadReuseMisses
+         - before.threadReuseHits - before.threadReuseMisses == 1);
+  assert(after.threadHandles == before.threadHandles);
+
+  /*
+   * The joined thread's descriptor is reused.
+   */
+  assert(pthread_getstats_np(&before) == 0);
+  assert(pthread_create(&t, NULL, func, NULL) == 0);
+  assert(pthread_join(t, NULL) == 0);
+  assert(pthread_getstats_np(&after) == 0);
+
+  assert(after.threadReuseHits - before.threadReuseHits == 1);
+
+  /*
+   * Live objects and their kernel handles.
+   */
+  assert(pthread_getstats_np(&before) == 0);
+  assert(pthread_mutex_init(&mx, NULL) == 0);
+  assert(sem_init(&s, 0, 0) == 0);
+  assert(pthread_cond_init(&cv, NULL) == 0);
+  assert(pthread_getstats_np(&after) == 0);
+
+  /* The cond has one internal mutex and two internal semaphores; sem has one mutex. */
+  assert(after.mutexes - before.mutexes == 3);
+  assert(after.mutexHandles - before.mutexHandles == 3);
+  assert(after.semaphores - before.semaphores == 3);
+  assert(after.semaphoreHandles - before.semaphoreHandles == 3);
+  assert(after.conds - before.conds == 1);
+
+  /*
+   * Timeouts.
+   */
+  PTW32_FTIME(&currSysTime);
+  abstime.tv_sec = (long)currSysTime.time;
+  abstime.tv_nsec = NANOSEC_PER_MILLISEC * currSysTime.millitm;
+  abstime.tv_nsec += 10 * NANOSEC_PER_MILLISEC;
+  if (abstime.tv_nsec >= 1000000000)
+    {
+      abstime.tv_sec++;
+      abstime.tv_nsec -= 1000000000;
+    }
+
+  assert(pthread_getstats_np(&before) == 0);
+  assert(sem_timedwait(&s, &abstime) == -1);
+  assert(errno == ETIMEDOUT);
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_cond_timedwait(&cv, &mx, &abstime) == ETIMEDOUT);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_getstats_np(&after) == 0);
+
+  assert(after.semTimeouts - before.semTimeouts == 2);
+  assert(after.condWaits - before.condWaits == 1);
+  assert(after.condTimeouts - before.condTimeouts == 1);
+
+  assert(pthread_getstats_np(&before) == 0);
+  assert(pthread_cond_destroy(&cv) == 0);
+  assert(sem_destroy(&s) == 0);
+  assert(pthread_mutex_destroy(&mx) == 0);
+  assert(pthread_getstats_np(&after) == 0);
+
+  assert(before.mutexes - after.mutexes == 3);
+  assert(before.semaphores - after.semaphores == 3);
+  assert(before.semaphoreHandles - after.semaphoreHandles == 3);
+  assert(before.conds - after.conds == 1);
+
+  return 0;
+}
@@ -0,0 +1,259 @@
+/*
+ * stats2.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that pthread_stats_export_np() publishes the counters in a
+ *   shared memory section that other processes can read.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_stats_export_np
+ *
+ * Cases Tested:
+ * - invalid and repeated calls
+ * - section contents match pthread_getstats_np()
+ * - reading the section from another process
+ *
+ * Description:
+ * - Export to a section named after the process id, then read it
+ *   back read-only, as a monitoring tool would, and compare with
+ *   pthread_getstats_np(). Only this thread is running so the
+ *   values are exact. Finally run this program again as a reader.
+ *
+ *   Run as "stats2 <section>" it is a reader tool: it prints the
+ *   counters exported by another process and exits.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+#include <string.h>
+
+/*
+ * Map the section read-only and sum its shards into 'stats', whose
+ * members are all longs in counter order. Returns the section's
+ * state, or 0 if it can't be read.
+ */
+static long
+readStats(const char * name, struct ptw32_stats * stats)
+{
+  HANDLE mapping;
+  const volatile struct ptw32_stats_export * ex;
+  long * out = (long *) stats;
+  unsigned long n = sizeof(*stats) / sizeof(long);
+  unsigned long i, j;
+  long seq;
+  long state = 0;
+
+  if ((mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name)) == NULL)
+    {
+      return 0;
+    }
+
+  ex = (const volatile struct ptw32_stats_export *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+  if (ex != NULL
+      && ex->magic == PTW32_STATS_EXPORT_MAGIC
+      && ex->version == PTW32_STATS_EXPORT_VERSION)
+    {
+      if (ex->counters < n)
+	{
+	  n = ex->counters;
+	}
+
+      do
+	{
+	  while ((seq = ex->sequence) & 1)
+	    {
+	      Sleep(0);
+	    }
+
+	  memset(stats, 0, sizeof(*stats));
+
+	  for (i = 0; i < ex->shards; i++)
+	    {
+	      const volatile LONG * counter = (const volatile LONG *)
+		((const volatile char *) ex + ex->offset + i * ex->shardSize);
+
+	      for (j = 0; j < n; j++)
+		{
+		  out[j] += counter[j];
+		}
+	    }
+
+	  state = ex->state;
+	}
+      while (ex->sequence != seq);
+    }
+
+  if (ex != NULL)
+    {
+      UnmapViewOfFile((LPCVOID) ex);
+    }
+  CloseHandle(mapping);
+
+  return state;
+}
+
+static int
+printStats(const char * name)
+{
+  struct ptw32_stats s;
+  long state = readStats(name, &s);
+
+  if (state == 0)
+    {
+      fprintf(stderr, "%s: no pthreads-win32 statistics section\n", name);
+      return 1;
+    }
+
+  printf("%s (%s)\n", name, state == PTW32_STATS_EXPORT_LIVE ? "live" : "detached");
+  printf("  threads live       %ld\n",
+	 (long) (s.threadsCreated + s.implicitThreads - s.threadsExited));
+  printf("  threads created    %lu  reused %lu  implicit %lu  exited %lu\n",
+	 s.threadsCreated, s.threadReuseHits, s.implicitThreads, s.threadsExited);
+  printf("  objects            mutex %ld  cond %ld  rwlock %ld  spin %ld"
+	 "  barrier %ld  sem %ld  key %ld\n",
+	 s.mutexes, s.conds, s.rwlocks, s.spinlocks, s.barriers,
+	 s.semaphores, s.keys);
+  printf("  kernel handles     thread %ld  mutex %ld  semaphore %ld\n",
+	 s.threadHandles, s.mutexHandles, s.semaphoreHandles);
+  printf("  contended waits    mutex %lu  cond %lu  sem %lu  barrier %lu"
+	 "  join %lu\n",
+	 s.mutexWaits, s.condWaits, s.semWaits, s.barrierWaits, s.joinWaits);
+  printf("  timeouts           mutex %lu  cond %lu  sem %lu\n",
+	 s.mutexTimeouts, s.condTimeouts, s.semTimeouts);
+  printf("  internal locks     contended %lu  blocked %lu\n",
+	 s.mcsContended, s.mcsWaits);
+  printf("  cancelations       requested %lu  acted on %lu\n",
+	 s.cancelsRequested, s.cancelsActed);
+
+  return 0;
+}
+
+void * func(void * arg)
+{
+  return arg;
+}
+
+int
+main(int argc, char * argv[])
+{
+  char name[64];
+  char selfPath[MAX_PATH];
+  char cmdLine[MAX_PATH + 80];
+  pthread_t t;
+  pthread_mutex_t mx;
+  struct ptw32_stats before;
+  struct ptw32_stats exported;
+  struct ptw32_stats local;
+  STARTUPINFO si;
+  PROCESS_INFORMATION pi;
+  DWORD exitCode;
+
+  if (argc == 2)
+    {
+      return printStats(argv[1]);
+    }
+
+  sprintf(name, "Local\\ptw32-stats2-%lu", (unsigned long) GetCurrentProcessId());
+
+  assert(pthread_getstats_np(&before) == 0);
+
+  assert(pthread_stats_export_np(NULL) == EINVAL);
+  assert(pthread_stats_export_np("") == EINVAL);
+  assert(readStats(name, &exported) == 0);
+  assert(pthread_stats_export_np(name) == 0);
+  assert(pthread_stats_export_np(name) == EBUSY);
+
+  /*
+   * What was counted before is carried over.
+   */
+  assert(readStats(name, &exported) == PTW32_STATS_EXPORT_LIVE);
+  assert(pthread_getstats_np(&local) == 0);
+  assert(memcmp(&exported, &local, sizeof(local)) == 0);
+  assert(exported.keys == before.keys);
+
+  assert(pthread_mutex_init(&mx, NULL) == 0);
+  assert(pthread_create(&t, NULL, func, NULL) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(readStats(name, &exported) == PTW32_STATS_EXPORT_LIVE);
+  assert(pthread_getstats_np(&local) == 0);
+  assert(memcmp(&exported, &local, sizeof(local)) == 0);
+  assert(exported.mutexes - before.mutexes == 1);
+  assert(exported.threadsCreated - before.threadsCreated == 1);
+
+  /*
+   * As another process sees it.
+   */
+  assert(GetModuleFileName(NULL, selfPath, sizeof(selfPath)) > 0);
+  sprintf(cmdLine, "\"%s\" %s", selfPath, name);
+  memset(&si, 0, sizeof(si));
+  si.cb = sizeof(si);
+  assert(CreateProcess(NULL, cmdLine, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi));
+  assert(WaitForSingleObject(pi.hProcess, INFINITE) == WAIT_OBJECT_0);
+  assert(GetExitCodeProcess(pi.hProcess, &exitCode));
+  assert(exitCode == 0);
+  CloseHandle(pi.hThread);
+  CloseHandle(pi.hProcess);
+
+  assert(pthread_mutex_destroy(&mx) == 0);
+
+  return 0;
+}
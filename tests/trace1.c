@@ -0,0 +1,169 @@
+/*
+ * trace1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that pthread_trace_np() records blocking waits and thread
+ *   lifecycle, and pthread_trace_dump_np() writes them out.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_trace_np
+ * - pthread_trace_dump_np
+ *
+ * Cases Tested:
+ * - contended mutex lock
+ * - thread start and exit
+ *
+ * Description:
+ * - Hold a mutex while a second thread blocks on it, then dump
+ *   the trace and look for the expected event types. Passes
+ *   trivially if the library was built without PTW32_TRACE.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * - The second thread reaches the mutex within the sleep.
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+/* Event types and layout from the dump file format. */
+enum {
+  TRACE_THREAD_START = 1,
+  TRACE_THREAD_EXIT = 2,
+  TRACE_MUTEX_WAIT_BEGIN = 4,
+  TRACE_MUTEX_WAIT_END = 5
+};
+
+#define HEADER_SIZE     48
+#define RECORD_SIZE     32
+
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static int seen[16];
+
+static unsigned long
+get32(const unsigned char * p)
+{
+  return (unsigned long) p[0] | ((unsigned long) p[1] << 8)
+         | ((unsigned long) p[2] << 16) | ((unsigned long) p[3] << 24);
+}
+
+void * func(void * arg)
+{
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t;
+  FILE * fp;
+  unsigned char header[HEADER_SIZE];
+  unsigned char record[RECORD_SIZE];
+  unsigned long count, i, type;
+  int result;
+
+  result = pthread_trace_np(1);
+
+  if (result == ENOSYS)
+    {
+      assert(pthread_trace_dump_np("trace1.dmp") == ENOSYS);
+      printf("Library built without PTW32_TRACE\n");
+      return 0;
+    }
+
+  assert(result == 0);
+  assert(pthread_trace_dump_np(NULL) == EINVAL);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t, NULL, func, NULL) == 0);
+  Sleep(500);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(pthread_trace_np(0) == 0);
+  assert(pthread_trace_dump_np("trace1.dmp") == 0);
+
+  assert((fp = fopen("trace1.dmp", "rb")) != NULL);
+  assert(fread(header, HEADER_SIZE, 1, fp) == 1);
+  assert(memcmp(header, "PTW32TRC", 8) == 0);
+  assert(get32(header + 8) == 1);
+  assert(get32(header + 12) == RECORD_SIZE);
+
+  count = get32(header + 36);
+  assert(count > 0);
+
+  for (i = 0; i < count; i++)
+    {
+      assert(fread(record, RECORD_SIZE, 1, fp) == 1);
+      type = get32(record + 20);
+      if (type < sizeof(seen) / sizeof(seen[0]))
+        {
+          seen[type]++;
+        }
+    }
+
+  fclose(fp);
+  (void) remove("trace1.dmp");
+
+  assert(seen[TRACE_THREAD_START] >= 1);
+  assert(seen[TRACE_THREAD_EXIT] >= 1);
+  assert(seen[TRACE_MUTEX_WAIT_BEGIN] >= 1);
+  assert(seen[TRACE_MUTEX_WAIT_END] == seen[TRACE_MUTEX_WAIT_BEGIN]);
+
+  return 0;
+}
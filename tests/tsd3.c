@@ -0,0 +1,282 @@
+/*
+ * tsd3.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that sized keys give each thread its own zeroed, constructed and
+ *   aligned block, and destroy it when the thread exits.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_key_create_sized_np
+ * - pthread_getspecific_ptr_np
+ *
+ * Cases Tested:
+ * - invalid size and alignment
+ * - blocks are distinct per thread and stable within a thread
+ * - a key created after a thread's arena exists
+ * - constructor and destructor run once per thread per key
+ * - pthread_setspecific and pthread_key_delete on a sized key
+ * - a new key takes over a deleted key's block, reconstructed
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+enum {
+  NUMTHREADS = 8,
+  REUSES = 1000
+};
+
+typedef struct {
+  int constructed;
+  int id;
+  char pad[40];
+} block_t;
+
+static pthread_key_t small;
+static pthread_key_t aligned;
+static pthread_key_t late;
+static sem_t lateCreated;
+static sem_t arenaReady[NUMTHREADS];
+static LONG constructed = 0;
+static LONG destroyed = 0;
+static void * seen[NUMTHREADS];
+
+static void
+constructor(void * p)
+{
+  block_t * b = (block_t *) p;
+
+  assert(b->constructed == 0);
+  assert(b->id == 0);
+  b->constructed = 1;
+  InterlockedIncrement(&constructed);
+}
+
+static void
+destructor(void * p)
+{
+  block_t * b = (block_t *) p;
+
+  assert(b->constructed == 1);
+  InterlockedIncrement(&destroyed);
+}
+
+static void *
+worker(void * arg)
+{
+  int id = (int)(size_t) arg;
+  block_t * b;
+  char * c;
+  int * l;
+
+  b = (block_t *) pthread_getspecific_ptr_np(aligned);
+  assert(b != NULL);
+  assert(((size_t) b & 63) == 0);
+  assert(b->constructed == 1);
+  b->id = id;
+
+  c = (char *) pthread_getspecific_ptr_np(small);
+  assert(c != NULL);
+  assert(*c == 0);
+  *c = (char) id;
+
+  seen[id] = b;
+
+  /*
+   * Create 'late' only once every thread's arena exists.
+   */
+  assert(sem_post(&arenaReady[id]) == 0);
+  assert(sem_wait(&lateCreated) == 0);
+
+  l = (int *) pthread_getspecific_ptr_np(late);
+  assert(l != NULL);
+  assert(((size_t) l & (sizeof(int) - 1)) == 0);
+  assert(*l == 0);
+  *l = id;
+
+  assert(pthread_getspecific_ptr_np(aligned) == b);
+  assert(b->id == id);
+  assert(*(char *) pthread_getspecific_ptr_np(small) == (char) id);
+  assert(*(int *) pthread_getspecific_ptr_np(late) == id);
+
+  return NULL;
+}
+
+static void *
+afterDelete(void * arg)
+{
+  block_t * b = (block_t *) pthread_getspecific_ptr_np(aligned);
+
+  assert(b != NULL);
+  assert(b->constructed == 0);
+  return NULL;
+}
+
+static void *
+reuser(void * arg)
+{
+  pthread_key_t k;
+  block_t * first;
+  block_t * b;
+  int i;
+
+  assert(pthread_key_create_sized_np(&k, sizeof(block_t), 64,
+                                     constructor, destructor) == 0);
+  first = (block_t *) pthread_getspecific_ptr_np(k);
+  assert(first != NULL);
+  first->id = -1;
+
+  /*
+   * Each new key of the same size gets the same block, zeroed and
+   * constructed again, so the arena doesn't grow.
+   */
+  for (i = 0; i < REUSES; i++)
+    {
+      assert(pthread_key_delete(k) == 0);
+      assert(pthread_key_create_sized_np(&k, sizeof(block_t), 64,
+                                         constructor, destructor) == 0);
+      b = (block_t *) pthread_getspecific_ptr_np(k);
+      assert(b == first);
+      assert(b->constructed == 1);
+      assert(b->id == 0);
+      b->id = i + 1;
+    }
+
+  assert(pthread_key_delete(k) == 0);
+  return arg;
+}
+
+int
+main()
+{
+  pthread_t t[NUMTHREADS];
+  pthread_key_t k;
+  int i, j;
+
+  assert(pthread_key_create_sized_np(&k, 0, 0, NULL, NULL) == EINVAL);
+  assert(pthread_key_create_sized_np(&k, 4, 3, NULL, NULL) == EINVAL);
+  assert(pthread_key_create_sized_np(&k, 4, 128, NULL, NULL) == EINVAL);
+
+  assert(pthread_key_create_sized_np(&small, 1, 1, NULL, NULL) == 0);
+  assert(pthread_key_create_sized_np(&aligned, sizeof(block_t), 64,
+                                     constructor, destructor) == 0);
+
+  assert(pthread_setspecific(small, &i) == EINVAL);
+  assert(pthread_getspecific(small) == NULL);
+
+  assert(sem_init(&lateCreated, 0, 0) == 0);
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(sem_init(&arenaReady[i], 0, 0) == 0);
+      assert(pthread_create(&t[i], NULL, worker, (void *)(size_t) i) == 0);
+    }
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(sem_wait(&arenaReady[i]) == 0);
+    }
+
+  assert(pthread_key_create_sized_np(&late, sizeof(int), 0, NULL, NULL) == 0);
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(sem_post(&lateCreated) == 0);
+    }
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+      assert(sem_destroy(&arenaReady[i]) == 0);
+    }
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      for (j = i + 1; j < NUMTHREADS; j++)
+        {
+          assert(seen[i] != seen[j]);
+        }
+    }
+
+  assert(constructed == NUMTHREADS);
+  assert(destroyed == NUMTHREADS);
+
+  /*
+   * Once deleted, the key's blocks are no longer constructed or
+   * destroyed.
+   */
+  assert(pthread_key_delete(aligned) == 0);
+  assert(pthread_create(&t[0], NULL, afterDelete, NULL) == 0);
+  assert(pthread_join(t[0], NULL) == 0);
+  assert(constructed == NUMTHREADS);
+  assert(destroyed == NUMTHREADS);
+
+  assert(pthread_create(&t[0], NULL, reuser, NULL) == 0);
+  assert(pthread_join(t[0], NULL) == 0);
+  assert(constructed == NUMTHREADS + REUSES + 1);
+  assert(destroyed == NUMTHREADS);
+
+  assert(sem_destroy(&lateCreated) == 0);
+  assert(pthread_key_delete(small) == 0);
+  assert(pthread_key_delete(late) == 0);
+
+  return 0;
+}
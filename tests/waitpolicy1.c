@@ -0,0 +1,206 @@
+/*
+ * waitpolicy1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that the wait policy can be set and read back, and that the
+ *   pthread_setconcurrency() hint only applies to the default policy.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_setwaitpolicy_np
+ * - pthread_getwaitpolicy_np
+ *
+ * Cases Tested:
+ * - invalid arguments
+ * - each yield kind, with contended mutex and semaphore waits
+ * - concurrency level 1 turns off default spinning
+ *
+ * Description:
+ * -
+ *
+ * Environment:
+ * - PTW32_WAIT_POLICY must not be set.
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+enum {
+  NUMTHREADS = 4,
+  ITERATIONS = 2000
+};
+
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static sem_t sem[2];
+static int counter = 0;
+
+void * mutexFunc(void * arg)
+{
+  int i;
+
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      assert(pthread_mutex_lock(&mx) == 0);
+      counter++;
+      assert(pthread_mutex_unlock(&mx) == 0);
+    }
+  return NULL;
+}
+
+void * semFunc(void * arg)
+{
+  int side = (int) (size_t) arg;
+  int i;
+
+  for (i = 0; i < ITERATIONS; i++)
+    {
+      assert(sem_wait(&sem[side]) == 0);
+      assert(sem_post(&sem[!side]) == 0);
+    }
+  return NULL;
+}
+
+static void
+exercise(void)
+{
+  pthread_t t[NUMTHREADS];
+  int i;
+
+  counter = 0;
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(pthread_create(&t[i], NULL, mutexFunc, NULL) == 0);
+    }
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+  assert(counter == NUMTHREADS * ITERATIONS);
+
+  assert(sem_init(&sem[0], 0, 1) == 0);
+  assert(sem_init(&sem[1], 0, 0) == 0);
+  for (i = 0; i < 2; i++)
+    {
+      assert(pthread_create(&t[i], NULL, semFunc, (void *) (size_t) i) == 0);
+    }
+  for (i = 0; i < 2; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+  assert(sem_destroy(&sem[0]) == 0);
+  assert(sem_destroy(&sem[1]) == 0);
+
+  assert(sched_yield() == 0);
+}
+
+int
+main()
+{
+  struct ptw32_wait_policy dflt, p, q;
+  int kind;
+
+  assert(pthread_getwaitpolicy_np(NULL) == EINVAL);
+  assert(pthread_getwaitpolicy_np(&dflt) == 0);
+  assert(dflt.spinCount >= 0);
+  assert(dflt.yieldCount == 0);
+  assert(dflt.yieldKind == PTW32_YIELD_SLEEP0);
+  if (pthread_num_processors_np() == 1)
+    {
+      assert(dflt.spinCount == 0);
+    }
+
+  p.spinCount = -1;
+  p.yieldCount = 0;
+  p.yieldKind = PTW32_YIELD_SWITCH;
+  assert(pthread_setwaitpolicy_np(&p) == EINVAL);
+  p.spinCount = 0;
+  p.yieldKind = PTW32_YIELD_SLEEP1 + 1;
+  assert(pthread_setwaitpolicy_np(&p) == EINVAL);
+
+  for (kind = PTW32_YIELD_SWITCH; kind <= PTW32_YIELD_SLEEP1; kind++)
+    {
+      p.spinCount = 500;
+      p.yieldCount = (kind == PTW32_YIELD_SLEEP1) ? 1 : 4;
+      p.yieldKind = kind;
+      assert(pthread_setwaitpolicy_np(&p) == 0);
+      assert(pthread_getwaitpolicy_np(&q) == 0);
+      assert(q.spinCount == p.spinCount);
+      assert(q.yieldCount == p.yieldCount);
+      assert(q.yieldKind == kind);
+      exercise();
+    }
+
+  /*
+   * An explicit policy is kept whatever the concurrency level.
+   */
+  assert(pthread_setconcurrency(1) == 0);
+  assert(pthread_getwaitpolicy_np(&q) == 0);
+  assert(q.spinCount == 500);
+
+  /*
+   * The default policy follows it.
+   */
+  assert(pthread_setwaitpolicy_np(NULL) == 0);
+  assert(pthread_getwaitpolicy_np(&q) == 0);
+  assert(q.spinCount == 0);
+  exercise();
+
+  assert(pthread_setconcurrency(0) == 0);
+  assert(pthread_getwaitpolicy_np(&q) == 0);
+  assert(q.spinCount == dflt.spinCount);
+  exercise();
+
+  return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * wakeorder1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that semaphores and condition variables with a wake order
+ *   release their waiters in that order.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - sem_setwakeorder_np
+ * - sem_getwakeorder_np
+ * - pthread_condattr_setwakeorder_np
+ * - pthread_condattr_getwakeorder_np
+ *
+ * Cases Tested:
+ * - invalid orders are rejected
+ * - the order of a semaphore cannot change while threads wait on it
+ * - PTHREAD_WAKE_FIFO_NP wakes in arrival order
+ * - PTHREAD_WAKE_PRIORITY_NP wakes the highest priority first and
+ *   waiters of equal priority in arrival order
+ * - the same for pthread_cond_signal
+ *
+ * Description:
+ * - Waiters are started one at a time, each with its own priority,
+ *   and given time to block. Then one token or signal is released
+ *   at a time and the order the waiters wake in is recorded.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * -
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+enum {
+  NUMTHREADS = 6
+};
+
+/*
+ * Priorities in arrival order, and the order the priority policy
+ * must wake them in. The two THREAD_PRIORITY_NORMAL waiters keep
+ * their arrival order.
+ */
+static const int arrivalPriority[NUMTHREADS] = {
+  THREAD_PRIORITY_LOWEST,
+  THREAD_PRIORITY_NORMAL,
+  THREAD_PRIORITY_BELOW_NORMAL,
+  THREAD_PRIORITY_HIGHEST,
+  THREAD_PRIORITY_NORMAL,
+  THREAD_PRIORITY_ABOVE_NORMAL
+};
+static const int priorityOrder[NUMTHREADS] = { 3, 5, 1, 4, 2, 0 };
+
+static sem_t s;
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cv;
+static int tickets;
+static int woken;
+static int order[NUMTHREADS];
+
+static void
+record(int index)
+{
+  assert(pthread_mutex_lock(&mx) == 0);
+  order[woken++] = index;
+  assert(pthread_mutex_unlock(&mx) == 0);
+}
+
+static void *
+semWaiter(void * arg)
+{
+  assert(sem_wait(&s) == 0);
+  record((int)(size_t) arg);
+  return NULL;
+}
+
+static void *
+condWaiter(void * arg)
+{
+  assert(pthread_mutex_lock(&mx) == 0);
+  while (tickets == 0)
+    {
+      assert(pthread_cond_wait(&cv, &mx) == 0);
+    }
+  tickets--;
+  order[woken++] = (int)(size_t) arg;
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return NULL;
+}
+
+static int
+wokenCount(void)
+{
+  int n;
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  n = woken;
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return n;
+}
+
+/*
+ * Start the waiters, then release them one at a time and check the
+ * order they wake in.
+ */
+static void
+run(void * (*waiter)(void *), const int * expected)
+{
+  pthread_t t[NUMTHREADS];
+  pthread_attr_t attr;
+  struct sched_param param;
+  int i;
+
+  woken = 0;
+  tickets = 0;
+  assert(pthread_attr_init(&attr) == 0);
+  assert(pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED) == 0);
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      param.sched_priority = arrivalPriority[i];
+      assert(pthread_attr_setschedparam(&attr, &param) == 0);
+      assert(pthread_create(&t[i], &attr, waiter, (void *)(size_t) i) == 0);
+      Sleep(100);
+    }
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      if (waiter == semWaiter)
+        {
+          assert(sem_post(&s) == 0);
+        }
+      else
+        {
+          assert(pthread_mutex_lock(&mx) == 0);
+          tickets++;
+          assert(pthread_cond_signal(&cv) == 0);
+          assert(pthread_mutex_unlock(&mx) == 0);
+        }
+      while (wokenCount() == i)
+        {
+          Sleep(10);
+        }
+    }
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(pthread_join(t[i], NULL) == 0);
+    }
+  assert(pthread_attr_destroy(&attr) == 0);
+
+  for (i = 0; i < NUMTHREADS; i++)
+    {
+      assert(order[i] == (expected == NULL ? i : expected[i]));
+    }
+}
+
+int
+main()
+{
+  pthread_condattr_t ca;
+  pthread_t blocked;
+  int value;
+
+  assert(sem_init(&s, PTHREAD_PROCESS_PRIVATE, 0) == 0);
+  assert(sem_getwakeorder_np(&s, &value) == 0);
+  assert(value == PTHREAD_WAKE_DEFAULT_NP);
+  assert(sem_setwakeorder_np(&s, PTHREAD_WAKE_PRIORITY_NP + 1) == -1);
+  assert(errno == EINVAL);
+
+  /* Not while a thread is waiting. */
+  assert(pthread_create(&blocked, NULL, semWaiter, (void *) 0) == 0);
+  Sleep(100);
+  assert(sem_setwakeorder_np(&s, PTHREAD_WAKE_FIFO_NP) == -1);
+  assert(errno == EBUSY);
+  assert(sem_post(&s) == 0);
+  assert(pthread_join(blocked, NULL) == 0);
+
+  assert(sem_setwakeorder_np(&s, PTHREAD_WAKE_FIFO_NP) == 0);
+  assert(sem_getwakeorder_np(&s, &value) == 0);
+  assert(value == PTHREAD_WAKE_FIFO_NP);
+  run(semWaiter, NULL);
+
+  assert(sem_setwakeorder_np(&s, PTHREAD_WAKE_PRIORITY_NP) == 0);
+  run(semWaiter, priorityOrder);
+  assert(sem_destroy(&s) == 0);
+
+  assert(pthread_condattr_init(&ca) == 0);
+  assert(pthread_condattr_getwakeorder_np(&ca, &value) == 0);
+  assert(value == PTHREAD_WAKE_DEFAULT_NP);
+  assert(pthread_condattr_setwakeorder_np(&ca, -1) == EINVAL);
+
+  assert(pthread_condattr_setwakeorder_np(&ca, PTHREAD_WAKE_FIFO_NP) == 0);
+  assert(pthread_cond_init(&cv, &ca) == 0);
+  run(condWaiter, NULL);
+  assert(pthread_cond_destroy(&cv) == 0);
+
+  assert(pthread_condattr_setwakeorder_np(&ca, PTHREAD_WAKE_PRIORITY_NP) == 0);
+  assert(pthread_condattr_getwakeorder_np(&ca, &value) == 0);
+  assert(value == PTHREAD_WAKE_PRIORITY_NP);
+  assert(pthread_cond_init(&cv, &ca) == 0);
+  run(condWaiter, priorityOrder);
+  assert(pthread_cond_destroy(&cv) == 0);
+
+  assert(pthread_condattr_destroy(&ca) == 0);
+
+  return 0;
+}
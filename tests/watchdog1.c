@@ -0,0 +1,240 @@
+/*
+ * watchdog1.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ * Test Synopsis:
+ * - that the watchdog started with pthread_watchdog_np() reports
+ *   threads blocked longer than the threshold, and who holds the
+ *   object they are blocked on.
+ *
+ * Test Method (Validation or Falsification):
+ * - Validation
+ *
+ * Requirements Tested:
+ * -
+ *
+ * Features Tested:
+ * - pthread_watchdog_np
+ *
+ * Cases Tested:
+ * - mutex held past the threshold
+ * - join on a thread that does not exit
+ * - rwlock held for writing past the threshold
+ * - stopping the watchdog
+ *
+ * Description:
+ * - Start the watchdog with a 100 ms threshold and a recording
+ *   callback, hold each object for half a second while a second
+ *   thread blocks on it, then check that exactly one report was
+ *   made for the stall, naming the waiter and the holder.
+ *
+ * Environment:
+ * -
+ *
+ * Input:
+ * - None.
+ *
+ * Output:
+ * - File name, Line number, and failed expression on failure.
+ * - No output on success.
+ *
+ * Assumptions:
+ * - The second thread blocks within the first 100 ms.
+ *
+ * Pass Criteria:
+ * - Process returns zero exit status.
+ *
+ * Fail Criteria:
+ * - Process returns non-zero exit status.
+ */
+
+#include "test.h"
+
+enum {
+  NUMREPORTS = 16
+};
+
+static pthread_mutex_t mx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t rw = PTHREAD_RWLOCK_INITIALIZER;
+static HANDLE go;
+
+/*
+ * Written by the watchdog thread only, read once the stall is over.
+ */
+static struct ptw32_stall_report reports[NUMREPORTS];
+static LONG numReports = 0;
+
+static void PTW32_CDECL
+onStall(const struct ptw32_stall_report * report)
+{
+  LONG i = InterlockedIncrement(&numReports) - 1;
+
+  if (i < NUMREPORTS)
+    {
+      reports[i] = *report;
+    }
+}
+
+static int
+count(void * object, int type)
+{
+  int i;
+  int n = 0;
+
+  for (i = 0; i < numReports && i < NUMREPORTS; i++)
+    {
+      if (reports[i].object == object && reports[i].type == type)
+	{
+	  n++;
+	}
+    }
+
+  return n;
+}
+
+static struct ptw32_stall_report *
+find(void * object, int type)
+{
+  int i;
+
+  for (i = 0; i < numReports && i < NUMREPORTS; i++)
+    {
+      if (reports[i].object == object && reports[i].type == type)
+	{
+	  return &reports[i];
+	}
+    }
+
+  return NULL;
+}
+
+void * mutexFunc(void * arg)
+{
+  *(unsigned long *) arg = (unsigned long) GetCurrentThreadId();
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  return NULL;
+}
+
+void * rwlockFunc(void * arg)
+{
+  *(unsigned long *) arg = (unsigned long) GetCurrentThreadId();
+  assert(pthread_rwlock_rdlock(&rw) == 0);
+  assert(pthread_rwlock_unlock(&rw) == 0);
+  return NULL;
+}
+
+void * sleepFunc(void * arg)
+{
+  *(unsigned long *) arg = (unsigned long) GetCurrentThreadId();
+  assert(WaitForSingleObject(go, INFINITE) == WAIT_OBJECT_0);
+  return NULL;
+}
+
+void * joinFunc(void * arg)
+{
+  assert(pthread_join(*(pthread_t *) arg, NULL) == 0);
+  return NULL;
+}
+
+int
+main()
+{
+  pthread_t t;
+  pthread_t sleeper;
+  unsigned long waiter = 0;
+  unsigned long target = 0;
+  unsigned long self = (unsigned long) GetCurrentThreadId();
+  struct ptw32_stall_report * r;
+
+  assert((go = CreateEvent(NULL, TRUE, FALSE, NULL)) != NULL);
+
+  assert(pthread_watchdog_np(100, onStall) == 0);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t, NULL, mutexFunc, &waiter) == 0);
+  Sleep(500);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  /*
+   * One report per stall, however long it lasts.
+   */
+  assert(count(&mx, PTW32_WAIT_MUTEX) == 1);
+  r = find(&mx, PTW32_WAIT_MUTEX);
+  assert(r->waiterThreadId == waiter);
+  assert(r->ownerThreadId == self);
+  assert(r->waited >= 100000000);
+
+  assert(pthread_create(&sleeper, NULL, sleepFunc, &target) == 0);
+  assert(pthread_create(&t, NULL, joinFunc, &sleeper) == 0);
+  Sleep(500);
+  assert(SetEvent(go));
+  assert(pthread_join(t, NULL) == 0);
+
+  r = find(sleeper.p, PTW32_WAIT_JOIN);
+  assert(r != NULL);
+  assert(r->ownerThreadId == target);
+
+  assert(pthread_rwlock_wrlock(&rw) == 0);
+  assert(pthread_create(&t, NULL, rwlockFunc, &waiter) == 0);
+  Sleep(500);
+  assert(pthread_rwlock_unlock(&rw) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(count(&rw, PTW32_WAIT_RWLOCK) == 1);
+  r = find(&rw, PTW32_WAIT_RWLOCK);
+  assert(r->waiterThreadId == waiter);
+  assert(r->ownerThreadId == self);
+
+  /*
+   * Stopped, nothing more is reported.
+   */
+  assert(pthread_watchdog_np(0, NULL) == 0);
+
+  assert(pthread_mutex_lock(&mx) == 0);
+  assert(pthread_create(&t, NULL, mutexFunc, &waiter) == 0);
+  Sleep(500);
+  assert(pthread_mutex_unlock(&mx) == 0);
+  assert(pthread_join(t, NULL) == 0);
+
+  assert(count(&mx, PTW32_WAIT_MUTEX) == 1);
+
+  assert(pthread_rwlock_destroy(&rw) == 0);
+  assert(pthread_mutex_destroy(&mx) == 0);
+  assert(CloseHandle(go));
+
+  return 0;
+}
@@ -0,0 +1,352 @@
+/*
+ * benchcmp.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ *
+ * Put two sets of CSV benchtest results side by side, e.g. this
+ * library under Wine or Windows against glibc NPTL on the same
+ * hardware (see tests/README.BENCHTESTS).
+ *
+ * Usage: benchcmp first.csv second.csv [firstlabel [secondlabel]]
+ *
+ * Both files must come from the same benchtest. Rows are matched on
+ * their key columns (primitive, variant, threads or test) and each
+ * result column is printed for both sets followed by the ratio
+ * first/second. Rows present in only one set are printed with the
+ * other set's columns empty.
+ *
+ * This program doesn't use the library or any Windows headers so that
+ * it builds on any host.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINE        1024
+#define MAX_FIELDS      16
+
+typedef struct {
+  char line[MAX_LINE];
+  char * field[MAX_FIELDS];
+  int nfields;
+  int matched;
+} row_t;
+
+typedef struct {
+  row_t header;
+  row_t * rows;
+  int nrows;
+} table_t;
+
+static const char * keyColumns[] = { "primitive", "variant", "threads", "test" };
+
+/* Counts that are the same in both sets and so aren't compared. */
+static const char * skipColumns[] = { "ops", "iterations", "msec", "total_msec" };
+
+static int
+isOneOf (const char * name, const char ** list, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      if (strcmp (name, list[i]) == 0)
+	{
+	  return 1;
+	}
+    }
+
+  return 0;
+}
+
+#define IS_KEY(_name) \
+  isOneOf ((_name), keyColumns, sizeof (keyColumns) / sizeof (keyColumns[0]))
+#define IS_SKIPPED(_name) \
+  isOneOf ((_name), skipColumns, sizeof (skipColumns) / sizeof (skipColumns[0]))
+
+static int
+splitRow (row_t * row)
+{
+  char * p = row->line;
+  size_t len = strlen (p);
+
+  while (len > 0 && (p[len - 1] == '\n' || p[len - 1] == '\r'))
+    {
+      p[--len] = '\0';
+    }
+
+  row->nfields = 0;
+  row->matched = 0;
+
+  for (;;)
+    {
+      if (row->nfields == MAX_FIELDS)
+	{
+	  return -1;
+	}
+      row->field[row->nfields++] = p;
+      if ((p = strchr (p, ',')) == NULL)
+	{
+	  break;
+	}
+      *p++ = '\0';
+    }
+
+  return 0;
+}
+
+static int
+readTable (const char * path, table_t * table)
+{
+  FILE * in;
+  int allocated = 64;
+
+  if ((in = fopen (path, "r")) == NULL)
+    {
+      perror (path);
+      return -1;
+    }
+
+  if (fgets (table->header.line, MAX_LINE, in) == NULL
+      || splitRow (&table->header) != 0)
+    {
+      fprintf (stderr, "%s: no CSV header\n", path);
+      fclose (in);
+      return -1;
+    }
+
+  table->nrows = 0;
+  if ((table->rows = (row_t *) malloc (allocated * sizeof (row_t))) == NULL)
+    {
+      fprintf (stderr, "Out of memory\n");
+      fclose (in);
+      return -1;
+    }
+
+  for (;;)
+    {
+      row_t * row;
+
+      if (table->nrows == allocated)
+	{
+	  row_t * more;
+
+	  allocated *= 2;
+	  if ((more = (row_t *) realloc (table->rows, allocated * sizeof (row_t))) == NULL)
+	    {
+	      fprintf (stderr, "Out of memory\n");
+	      fclose (in);
+	      return -1;
+	    }
+	  table->rows = more;
+	}
+
+      row = &table->rows[table->nrows];
+      if (fgets (row->line, MAX_LINE, in) == NULL)
+	{
+	  break;
+	}
+      if (row->line[0] == '\n' || row->line[0] == '\r' || row->line[0] == '\0')
+	{
+	  continue;
+	}
+      if (splitRow (row) != 0 || row->nfields != table->header.nfields)
+	{
+	  fprintf (stderr, "%s: malformed row %d\n", path, table->nrows + 2);
+	  fclose (in);
+	  return -1;
+	}
+      table->nrows++;
+    }
+
+  fclose (in);
+  return 0;
+}
+
+static int
+sameKey (const table_t * table, const row_t * a, const row_t * b)
+{
+  int i;
+
+  for (i = 0; i < table->header.nfields; i++)
+    {
+      if (IS_KEY (table->header.field[i])
+	  && strcmp (a->field[i], b->field[i]) != 0)
+	{
+	  return 0;
+	}
+    }
+
+  return 1;
+}
+
+static void
+printRow (const table_t * table, const row_t * a, const row_t * b)
+{
+  const row_t * keyRow = (a != NULL) ? a : b;
+  const char * sep = "";
+  int i;
+
+  for (i = 0; i < table->header.nfields; i++)
+    {
+      if (IS_KEY (table->header.field[i]))
+	{
+	  printf ("%s%s", sep, keyRow->field[i]);
+	  sep = ",";
+	}
+    }
+
+  for (i = 0; i < table->header.nfields; i++)
+    {
+      const char * name = table->header.field[i];
+
+      if (IS_KEY (name) || IS_SKIPPED (name))
+	{
+	  continue;
+	}
+
+      printf ("%s%s,%s,", sep,
+	      (a != NULL) ? a->field[i] : "",
+	      (b != NULL) ? b->field[i] : "");
+      sep = ",";
+
+      if (a != NULL && b != NULL && atof (b->field[i]) != 0.0)
+	{
+	  printf ("%.3f", atof (a->field[i]) / atof (b->field[i]));
+	}
+    }
+
+  printf ("\n");
+}
+
+int
+main (int argc, char * argv[])
+{
+  table_t first, second;
+  const char * firstLabel = "first";
+  const char * secondLabel = "second";
+  const char * sep = "";
+  int i, j;
+
+  if (argc < 3 || argc > 5)
+    {
+      fprintf (stderr, "Usage: %s first.csv second.csv [firstlabel [secondlabel]]\n",
+	       argv[0]);
+      return 2;
+    }
+
+  if (argc > 3)
+    {
+      firstLabel = argv[3];
+    }
+  if (argc > 4)
+    {
+      secondLabel = argv[4];
+    }
+
+  if (readTable (argv[1], &first) != 0 || readTable (argv[2], &second) != 0)
+    {
+      return 1;
+    }
+
+  if (first.header.nfields != second.header.nfields)
+    {
+      fprintf (stderr, "%s and %s have different columns\n", argv[1], argv[2]);
+      return 1;
+    }
+
+  for (i = 0; i < first.header.nfields; i++)
+    {
+      if (strcmp (first.header.field[i], second.header.field[i]) != 0)
+	{
+	  fprintf (stderr, "%s and %s have different columns\n", argv[1], argv[2]);
+	  return 1;
+	}
+    }
+
+  for (i = 0; i < first.header.nfields; i++)
+    {
+      if (IS_KEY (first.header.field[i]))
+	{
+	  printf ("%s%s", sep, first.header.field[i]);
+	  sep = ",";
+	}
+    }
+
+  for (i = 0; i < first.header.nfields; i++)
+    {
+      const char * name = first.header.field[i];
+
+      if (IS_KEY (name) || IS_SKIPPED (name))
+	{
+	  continue;
+	}
+
+      printf ("%s%s_%s,%s_%s,%s_ratio", sep, name, firstLabel, name, secondLabel, name);
+      sep = ",";
+    }
+
+  printf ("\n");
+
+  for (i = 0; i < first.nrows; i++)
+    {
+      row_t * match = NULL;
+
+      for (j = 0; j < second.nrows; j++)
+	{
+	  if (!second.rows[j].matched && sameKey (&first, &first.rows[i], &second.rows[j]))
+	    {
+	      match = &second.rows[j];
+	      match->matched = 1;
+	      break;
+	    }
+	}
+
+      printRow (&first, &first.rows[i], match);
+    }
+
+  for (j = 0; j < second.nrows; j++)
+    {
+      if (!second.rows[j].matched)
+	{
+	  printRow (&first, NULL, &second.rows[j]);
+	}
+    }
+
+  free (first.rows);
+  free (second.rows);
+
+  return 0;
+}
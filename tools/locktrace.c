@@ -0,0 +1,375 @@
+/*
+ * locktrace.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ *
+ * Summarise a lock trace written by pthread_locktrace_dump_np(): for
+ * each mutex, how often it was taken, how long it was held and how
+ * long threads waited for it; for each thread, how its time divided
+ * between holding, waiting and working with no mutex held. Mutexes
+ * are listed most time waited first. Output is tab-separated text.
+ *
+ * Usage: locktrace dumpfile
+ *
+ * tests/benchtest13 replays the same file against each mutex kind.
+ *
+ * This program doesn't use the library or any Windows headers so that
+ * traces can be read on any host. The file is little-endian; see
+ * README.NONPORTABLE for the layout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_SIZE     56
+#define RECORD_SIZE     24
+#define TRACE_VERSION   1
+#define MAX_HELD        32      /* Mutexes one thread holds at once */
+
+#define OP_LOCK         1
+#define OP_TRYLOCK      2
+#define OP_UNLOCK       3
+
+#define KIND_ROBUST     0x100
+
+/* A wait this long or longer counts as contended. */
+#define CONTENDED_USEC  1.0
+
+static const char * kindNames[] = {
+  "normal", "recursive", "errorcheck", "cohort"
+};
+
+typedef struct {
+  unsigned long id;
+  unsigned long kind;
+  unsigned long acquires;
+  unsigned long tries;
+  unsigned long contended;
+  double held;                  /* Seconds, summed */
+  double maxHeld;
+  double waited;
+  double maxWaited;
+} object_t;
+
+typedef struct {
+  unsigned long acquires;
+  double held;                  /* Time holding at least one mutex */
+  double waited;
+  double worked;                /* Time holding none */
+  double last;                  /* Time of the last record, or -1 */
+  int depth;
+  unsigned long heldObject[MAX_HELD];
+  double heldSince[MAX_HELD];
+} thread_t;
+
+static unsigned long
+get32 (const unsigned char * p)
+{
+  return (unsigned long) p[0]
+    | ((unsigned long) p[1] << 8)
+    | ((unsigned long) p[2] << 16)
+    | ((unsigned long) p[3] << 24);
+}
+
+/*
+ * 64 bit fields are kept as doubles so that this builds with C89
+ * compilers.
+ */
+static double
+get64 (const unsigned char * p)
+{
+  return (double) get32 (p) + (double) get32 (p + 4) * 4294967296.0;
+}
+
+static const char *
+kindName (unsigned long kind, char * buf)
+{
+  const char * name = "?";
+
+  if ((kind & 0xff) < sizeof (kindNames) / sizeof (kindNames[0]))
+    {
+      name = kindNames[kind & 0xff];
+    }
+
+  sprintf (buf, "%s%s", name, (kind & KIND_ROBUST) ? "-robust" : "");
+
+  return buf;
+}
+
+static int
+compareObjects (const void * a, const void * b)
+{
+  const object_t * oa = (const object_t *) a;
+  const object_t * ob = (const object_t *) b;
+
+  if (oa->waited != ob->waited)
+    {
+      return (oa->waited > ob->waited) ? -1 : 1;
+    }
+
+  return (oa->acquires > ob->acquires) ? -1 : (oa->acquires < ob->acquires) ? 1 : 0;
+}
+
+int
+main (int argc, char * argv[])
+{
+  FILE * in;
+  unsigned char header[HEADER_SIZE];
+  unsigned char raw[RECORD_SIZE];
+  object_t * objects;
+  thread_t * threads;
+  unsigned long version, recordSize, count, nthreads, nobjects, dropped, n, i;
+  double ticksPerSecond, baseTicks, first = -1.0, last = 0.0;
+  char buf[32];
+
+  if (argc != 2)
+    {
+      fprintf (stderr, "Usage: %s dumpfile\n", argv[0]);
+      return 2;
+    }
+
+  if ((in = fopen (argv[1], "rb")) == NULL)
+    {
+      perror (argv[1]);
+      return 1;
+    }
+
+  if (fread (header, HEADER_SIZE, 1, in) != 1
+      || memcmp (header, "PTW32LKT", 8) != 0)
+    {
+      fprintf (stderr, "%s: not a pthreads-win32 lock trace\n", argv[1]);
+      return 1;
+    }
+
+  version = get32 (header + 8);
+  recordSize = get32 (header + 12);
+  ticksPerSecond = get64 (header + 16);
+  baseTicks = get64 (header + 24);
+  count = get32 (header + 36);
+  nthreads = get32 (header + 40);
+  nobjects = get32 (header + 44);
+  dropped = get32 (header + 48);
+
+  if (version != TRACE_VERSION || recordSize < RECORD_SIZE)
+    {
+      fprintf (stderr, "%s: unsupported trace version %lu\n", argv[1], version);
+      return 1;
+    }
+
+  if (ticksPerSecond <= 0.0)
+    {
+      ticksPerSecond = 1.0e9;
+    }
+
+  objects = (object_t *) calloc (nobjects + 1, sizeof (object_t));
+  threads = (thread_t *) calloc (nthreads + 1, sizeof (thread_t));
+
+  if (objects == NULL || threads == NULL)
+    {
+      fprintf (stderr, "Out of memory\n");
+      return 1;
+    }
+
+  for (i = 0; i <= nobjects; i++)
+    {
+      objects[i].id = i;
+    }
+
+  for (i = 0; i <= nthreads; i++)
+    {
+      threads[i].last = -1.0;
+    }
+
+  /*
+   * Each thread's records are in order, so per-thread state is all
+   * that's needed; the threads' records may be interleaved.
+   */
+  for (n = 0; n < count; n++)
+    {
+      double ticks, wait;
+      unsigned long object, thread, op;
+      object_t * o;
+      thread_t * t;
+      int j;
+
+      if (fread (raw, RECORD_SIZE, 1, in) != 1
+	  || (recordSize > RECORD_SIZE
+	      && fseek (in, (long) (recordSize - RECORD_SIZE), SEEK_CUR) != 0))
+	{
+	  fprintf (stderr, "%s: truncated after %lu of %lu records\n",
+		   argv[1], n, count);
+	  break;
+	}
+
+      ticks = (get64 (raw) - baseTicks) / ticksPerSecond;
+      object = get32 (raw + 8);
+      thread = get32 (raw + 12);
+      wait = (double) get32 (raw + 16) / ticksPerSecond;
+      op = get32 (raw + 20) & 0xffff;
+
+      if (object == 0 || object > nobjects || thread == 0 || thread > nthreads)
+	{
+	  continue;
+	}
+
+      o = &objects[object];
+      t = &threads[thread];
+      o->kind = get32 (raw + 20) >> 16;
+
+      if (first < 0.0 || ticks < first)
+	{
+	  first = ticks;
+	}
+
+      if (op == OP_LOCK || op == OP_TRYLOCK)
+	{
+	  if (t->depth == 0 && t->last >= 0.0)
+	    {
+	      t->worked += ticks - t->last;
+	    }
+
+	  o->acquires++;
+	  o->tries += (op == OP_TRYLOCK);
+	  o->waited += wait;
+	  o->contended += (wait * 1.0e6 >= CONTENDED_USEC);
+	  if (wait > o->maxWaited)
+	    {
+	      o->maxWaited = wait;
+	    }
+
+	  t->acquires++;
+	  t->waited += wait;
+	  if (t->depth > 0)
+	    {
+	      t->held += ticks + wait - t->last;
+	    }
+	  t->last = ticks + wait;       /* Holding from here */
+
+	  if (t->depth < MAX_HELD)
+	    {
+	      t->heldObject[t->depth] = object;
+	      t->heldSince[t->depth] = ticks + wait;
+	      t->depth++;
+	    }
+	  ticks += wait;
+	}
+      else if (op == OP_UNLOCK)
+	{
+	  for (j = t->depth - 1; j >= 0 && t->heldObject[j] != object; j--)
+	    ;
+
+	  if (j >= 0)
+	    {
+	      double held = ticks - t->heldSince[j];
+
+	      o->held += held;
+	      if (held > o->maxHeld)
+		{
+		  o->maxHeld = held;
+		}
+
+	      /* Out of order releases are allowed. */
+	      for (; j < t->depth - 1; j++)
+		{
+		  t->heldObject[j] = t->heldObject[j + 1];
+		  t->heldSince[j] = t->heldSince[j + 1];
+		}
+	      t->depth--;
+	    }
+
+	  if (t->last >= 0.0)
+	    {
+	      t->held += ticks - t->last;
+	    }
+	  t->last = ticks;
+	}
+
+      if (ticks > last)
+	{
+	  last = ticks;
+	}
+    }
+
+  fclose (in);
+
+  printf ("# %lu records, %lu threads, %lu mutexes, %.3f ms",
+	  n, nthreads, nobjects, first >= 0.0 ? (last - first) * 1.0e3 : 0.0);
+  if (dropped != 0)
+    {
+      printf (", %lu operations not recorded", dropped);
+    }
+  printf ("\n");
+
+  qsort (objects + 1, nobjects, sizeof (object_t), compareObjects);
+
+  printf ("# mutex\tkind\tacquires\ttrylocks\tcontended"
+	  "\thold_avg_us\thold_max_us\twait_avg_us\twait_max_us\twait_total_us\n");
+
+  for (i = 1; i <= nobjects; i++)
+    {
+      object_t * o = &objects[i];
+
+      if (o->acquires == 0)
+	{
+	  continue;
+	}
+
+      printf ("%lu\t%s\t%lu\t%lu\t%lu\t%.2f\t%.2f\t%.2f\t%.2f\t%.0f\n",
+	      o->id, kindName (o->kind, buf), o->acquires, o->tries, o->contended,
+	      o->held * 1.0e6 / o->acquires, o->maxHeld * 1.0e6,
+	      o->waited * 1.0e6 / o->acquires, o->maxWaited * 1.0e6,
+	      o->waited * 1.0e6);
+    }
+
+  printf ("# thread\tacquires\thold_us\twait_us\twork_us\n");
+
+  for (i = 1; i <= nthreads; i++)
+    {
+      thread_t * t = &threads[i];
+
+      if (t->acquires == 0)
+	{
+	  continue;
+	}
+
+      printf ("%lu\t%lu\t%.0f\t%.0f\t%.0f\n",
+	      i, t->acquires, t->held * 1.0e6, t->waited * 1.0e6, t->worked * 1.0e6);
+    }
+
+  free (threads);
+  free (objects);
+
+  return 0;
+}
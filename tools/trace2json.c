@@ -0,0 +1,312 @@
+/*
+ * trace2json.c
+ *
+ *
+ * --------------------------------------------------------------------------
+ *
+ *      Pthreads-win32 - POSIX Threads Library for Win32
+ *      Copyright(C) 1998 John E. Bossom
+ *      Copyright(C) 1999,2005 Pthreads-win32 contributors
+ * 
+ *      Contact Email: rpj@callisto.canberra.edu.au
+ * 
+ *      The current list of contributors is contained
+ *      in the file CONTRIBUTORS included with the source
+ *      code distribution. The list can also be seen at the
+ *      following World Wide Web location:
+ *      http://sources.redhat.com/pthreads-win32/contributors.html
+ * 
+ *      This library is free software; you can redistribute it and/or
+ *      modify it under the terms of the GNU Lesser General Public
+ *      License as published by the Free Software Foundation; either
+ *      version 2 of the License, or (at your option) any later version.
+ * 
+ *      This library is distributed in the hope that it will be useful,
+ *      but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *      Lesser General Public License for more details.
+ * 
+ *      You should have received a copy of the GNU Lesser General Public
+ *      License along with this library in the file COPYING.LIB;
+ *      if not, write to the Free Software Foundation, Inc.,
+ *      59 Temple Place - Suite 330, Boston, MA 02111-1307, USA
+ *
+ * --------------------------------------------------------------------------
+ *
+ *
+ * Convert a dump written by pthread_trace_dump_np() to the Chrome
+ * trace event JSON format, for loading into chrome://tracing or
+ * Perfetto.
+ *
+ * Usage: trace2json dumpfile [jsonfile]
+ *
+ * This program doesn't use the library or any Windows headers so that
+ * dumps can be decoded on any host. The dump is little-endian; see
+ * README.NONPORTABLE for the layout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_SIZE     48
+#define RECORD_SIZE     32
+#define TRACE_VERSION   1
+
+typedef struct {
+  double ticks;
+  unsigned long seq;
+  unsigned long objectHi;
+  unsigned long objectLo;
+  unsigned long threadId;
+  unsigned long type;
+  unsigned long arg;
+  char name[17];		/* For thread name records */
+} record_t;
+
+/*
+ * Event types, indexed by the type field of a record.
+ * Phase is 'B' (begin) or 'E' (end) for waits, 'i' for instants
+ * and 'M' for metadata.
+ */
+static const struct {
+  const char * name;
+  const char * category;
+  char phase;
+} eventTypes[] = {
+  { NULL, NULL, 0 },
+  { "thread start", "thread", 'i' },
+  { "thread exit", "thread", 'i' },
+  { "cancel", "thread", 'i' },
+  { "mutex wait", "mutex", 'B' },
+  { "mutex wait", "mutex", 'E' },
+  { "cond wait", "cond", 'B' },
+  { "cond wait", "cond", 'E' },
+  { "cond signal", "cond", 'i' },
+  { "cond broadcast", "cond", 'i' },
+  { "sem wait", "sem", 'B' },
+  { "sem wait", "sem", 'E' },
+  { "rwlock read wait", "rwlock", 'B' },
+  { "rwlock read wait", "rwlock", 'E' },
+  { "rwlock write wait", "rwlock", 'B' },
+  { "rwlock write wait", "rwlock", 'E' },
+  { "barrier wait", "barrier", 'B' },
+  { "barrier wait", "barrier", 'E' },
+  { "thread_name", "__metadata", 'M' }
+};
+
+#define TYPE_THREAD_NAME 18
+
+#define NUM_TYPES (sizeof (eventTypes) / sizeof (eventTypes[0]))
+
+static unsigned long
+get32 (const unsigned char * p)
+{
+  return (unsigned long) p[0]
+    | ((unsigned long) p[1] << 8)
+    | ((unsigned long) p[2] << 16)
+    | ((unsigned long) p[3] << 24);
+}
+
+/*
+ * 64 bit fields are kept as two 32 bit halves, or as a double where
+ * arithmetic is needed, so that this builds with C89 compilers.
+ */
+static double
+get64 (const unsigned char * p)
+{
+  return (double) get32 (p) + (double) get32 (p + 4) * 4294967296.0;
+}
+
+/*
+ * Write a thread name as the body of a JSON string. Bytes from 0x80
+ * up are passed through: names are UTF-8.
+ */
+static void
+putString (FILE * out, const char * s)
+{
+  for (; *s != '\0'; s++)
+    {
+      if (*s == '"' || *s == '\\')
+	{
+	  fprintf (out, "\\%c", *s);
+	}
+      else if ((unsigned char) *s < 0x20)
+	{
+	  fprintf (out, "\\u%04x", (unsigned) (unsigned char) *s);
+	}
+      else
+	{
+	  fputc (*s, out);
+	}
+    }
+}
+
+static int
+compareRecords (const void * a, const void * b)
+{
+  const record_t * ra = (const record_t *) a;
+  const record_t * rb = (const record_t *) b;
+
+  if (ra->ticks != rb->ticks)
+    {
+      return (ra->ticks < rb->ticks) ? -1 : 1;
+    }
+
+  /* Keep the dump order for equal timestamps. */
+  return (ra->seq < rb->seq) ? -1 : (ra->seq > rb->seq) ? 1 : 0;
+}
+
+int
+main (int argc, char * argv[])
+{
+  FILE * in;
+  FILE * out = stdout;
+  unsigned char header[HEADER_SIZE];
+  unsigned char raw[RECORD_SIZE];
+  record_t * records;
+  unsigned long version, recordSize, processId, count, i, n;
+  double ticksPerSecond, baseTicks;
+  const char * sep = "";
+
+  if (argc < 2 || argc > 3)
+    {
+      fprintf (stderr, "Usage: %s dumpfile [jsonfile]\n", argv[0]);
+      return 2;
+    }
+
+  if ((in = fopen (argv[1], "rb")) == NULL)
+    {
+      perror (argv[1]);
+      return 1;
+    }
+
+  if (fread (header, HEADER_SIZE, 1, in) != 1
+      || memcmp (header, "PTW32TRC", 8) != 0)
+    {
+      fprintf (stderr, "%s: not a pthreads-win32 trace dump\n", argv[1]);
+      return 1;
+    }
+
+  version = get32 (header + 8);
+  recordSize = get32 (header + 12);
+  ticksPerSecond = get64 (header + 16);
+  baseTicks = get64 (header + 24);
+  processId = get32 (header + 32);
+  count = get32 (header + 36);
+
+  if (version != TRACE_VERSION || recordSize < RECORD_SIZE)
+    {
+      fprintf (stderr, "%s: unsupported dump version %lu\n", argv[1], version);
+      return 1;
+    }
+
+  if (ticksPerSecond <= 0.0)
+    {
+      ticksPerSecond = 1.0e9;
+    }
+
+  if ((records = (record_t *) calloc (count + 1, sizeof (record_t))) == NULL)
+    {
+      fprintf (stderr, "Out of memory\n");
+      return 1;
+    }
+
+  for (n = 0; n < count; n++)
+    {
+      if (fread (raw, RECORD_SIZE, 1, in) != 1
+	  || (recordSize > RECORD_SIZE
+	      && fseek (in, (long) (recordSize - RECORD_SIZE), SEEK_CUR) != 0))
+	{
+	  fprintf (stderr, "%s: truncated after %lu of %lu records\n",
+		   argv[1], n, count);
+	  break;
+	}
+
+      records[n].ticks = get64 (raw);
+      records[n].seq = n;
+      records[n].objectLo = get32 (raw + 8);
+      records[n].objectHi = get32 (raw + 12);
+      records[n].threadId = get32 (raw + 16);
+      records[n].type = get32 (raw + 20);
+      records[n].arg = get32 (raw + 24);
+
+      if (records[n].type == TYPE_THREAD_NAME)
+	{
+	  memcpy (records[n].name, raw + 8, 8);
+	  memcpy (records[n].name + 8, raw + 24, 8);
+	}
+    }
+
+  fclose (in);
+
+  /*
+   * Each thread's records are in order but threads are dumped one
+   * after another; the viewer wants a single timeline.
+   */
+  qsort (records, n, sizeof (record_t), compareRecords);
+
+  if (argc == 3 && (out = fopen (argv[2], "w")) == NULL)
+    {
+      perror (argv[2]);
+      return 1;
+    }
+
+  fprintf (out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+  for (i = 0; i < n; i++)
+    {
+      record_t * r = &records[i];
+      double us = (r->ticks - baseTicks) * 1.0e6 / ticksPerSecond;
+
+      if (r->type == 0 || r->type >= NUM_TYPES)
+	{
+	  continue;
+	}
+
+      if (r->type == TYPE_THREAD_NAME)
+	{
+	  fprintf (out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+		   "\"pid\":%lu,\"tid\":%lu,\"args\":{\"name\":\"",
+		   sep, processId, r->threadId);
+	  putString (out, r->name);
+	  fprintf (out, "\"}}");
+	  sep = ",";
+	  continue;
+	}
+
+      fprintf (out, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\","
+	       "\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu",
+	       sep, eventTypes[r->type].name, eventTypes[r->type].category,
+	       eventTypes[r->type].phase, us, processId, r->threadId);
+
+      if (eventTypes[r->type].phase == 'i')
+	{
+	  fprintf (out, ",\"s\":\"t\"");
+	}
+
+      if (r->objectHi != 0)
+	{
+	  fprintf (out, ",\"args\":{\"object\":\"0x%lx%08lx\",\"arg\":%lu}}",
+		   r->objectHi, r->objectLo, r->arg);
+	}
+      else
+	{
+	  fprintf (out, ",\"args\":{\"object\":\"0x%08lx\",\"arg\":%lu}}",
+		   r->objectLo, r->arg);
+	}
+
+      sep = ",";
+    }
+
+  fprintf (out, "\n]}\n");
+
+  if (out != stdout)
+    {
+      fclose (out);
+    }
+
+  free (records);
+
+  return 0;
+}
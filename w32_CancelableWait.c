@@ -49,17 +49,51 @@ ptw32_cancelable_wait (HANDLE waitHandle, DWORD timeout)
       * WaitForMultipleObjects on 'waitHandle' and a manually reset WIN32
       * event used to implement pthread_cancel.
       * 
+      * The same event is signaled by pthread_interrupt_np, in which case
+      * the wait returns EINTR instead of unwinding the thread.
+      *
+      * If the thread has timer slack (pthread_setslack_np), a timeout
+      * is moved to a boundary shared with other waiters and, where a
+      * slack timer can be armed, left to that timer.
+      *
       * Given this hook it would be possible to implement more of the cancellation
       * points.
       * -------------------------------------------------------------------
       */
+#if defined(PTW32_NO_CANCEL)
+{
+  /*
+   * Lean build: a plain wait.
+   */
+  ptw32_thread_t * sp;
+
+  if (timeout != INFINITE && timeout != 0
+      && (sp = (ptw32_thread_t *) pthread_getspecific (ptw32_selfThreadKey)) != NULL)
+    {
+      timeout = ptw32_slack_timeout (timeout, PTW32_SLACK_OF(sp));
+    }
+
+  switch (WaitForSingleObject (waitHandle, timeout))
+    {
+    case WAIT_OBJECT_0:
+      return 0;
+    case WAIT_TIMEOUT:
+      return ETIMEDOUT;
+    default:
+      return EINVAL;
+    }
+}
+#else
 {
   int result;
   pthread_t self;
   ptw32_thread_t * sp;
-  HANDLE handles[2];
-  DWORD nHandles = 1;
+  HANDLE handles[3];
+  HANDLE timer = NULL;
+  DWORD nHandles;
   DWORD status;
+  DWORD started = 0;
+  DWORD slack = 0;
 
   handles[0] = waitHandle;
 
@@ -68,85 +102,116 @@ ptw32_cancelable_wait (HANDLE waitHandle, DWORD timeout)
 
   if (sp != NULL)
     {
-      /*
-       * Get cancelEvent handle
-       */
-      if (sp->cancelState == PTHREAD_CANCEL_ENABLE)
-	{
+      slack = PTW32_SLACK_OF(sp);	/* Once: other threads may set timerSlack */
+    }
 
-	  if ((handles[1] = sp->cancelEvent) != NULL)
-	    {
-	      nHandles++;
-	    }
+  if (timeout != INFINITE && timeout != 0 && slack != 0)
+    {
+      if (ptw32_slack_arm (sp, timeout, slack))
+	{
+	  timer = sp->slackTimer;
+	  timeout = INFINITE;
+	}
+      else
+	{
+	  timeout = ptw32_slack_timeout (timeout, slack);
 	}
     }
-  else
+
+  if (timeout != INFINITE)
     {
-      handles[1] = NULL;
+      started = GetTickCount ();
     }
 
-  status = WaitForMultipleObjects (nHandles, handles, PTW32_FALSE, timeout);
-
-  switch (status - WAIT_OBJECT_0)
+  for (;;)
     {
-    case 0:
-      /*
-       * Got the handle.
-       * In the event that both handles are signalled, the smallest index
-       * value (us) is returned. As it has been arranged, this ensures that
-       * we don't drop a signal that we should act on (i.e. semaphore,
-       * mutex, or condition variable etc).
-       */
-      result = 0;
-      break;
+      nHandles = 1;
 
-    case 1:
       /*
-       * Got cancel request.
-       * In the event that both handles are signaled, the cancel will
-       * be ignored (see case 0 comment).
+       * Get cancelEvent handle
        */
-      ResetEvent (handles[1]);
-
-      if (sp != NULL)
+      if (sp != NULL && PTW32_CANCEL_EVENT_WAITABLE(sp))
 	{
-          ptw32_mcs_local_node_t stateLock;
-	  /*
-	   * Should handle POSIX and implicit POSIX threads..
-	   * Make sure we haven't been async-canceled in the meantime.
-	   */
-	  ptw32_mcs_lock_acquire (&sp->stateLock, &stateLock);
-	  if (sp->state < PThreadStateCanceling)
-	    {
-	      sp->state = PThreadStateCanceling;
-	      sp->cancelState = PTHREAD_CANCEL_DISABLE;
-	      ptw32_mcs_lock_release (&stateLock);
-	      ptw32_throw (PTW32_EPS_CANCEL);
+	  handles[1] = sp->cancelEvent;
+	  nHandles++;
+	}
 
-	      /* Never reached */
-	    }
-	  ptw32_mcs_lock_release (&stateLock);
+      if (timer != NULL)
+	{
+	  handles[nHandles++] = timer;
 	}
 
-      /* Should never get to here. */
-      result = EINVAL;
-      break;
+      status = WaitForMultipleObjects (nHandles, handles, PTW32_FALSE, timeout);
 
-    default:
-      if (status == WAIT_TIMEOUT)
+      if (timer != NULL && status == WAIT_OBJECT_0 + nHandles - 1)
 	{
+	  /* The slack timer, which stands for the timeout. */
 	  result = ETIMEDOUT;
+	  break;
 	}
-      else
+
+      switch (status - WAIT_OBJECT_0)
 	{
-	  result = EINVAL;
+	case 0:
+	  /*
+	   * Got the handle.
+	   * In the event that both handles are signalled, the smallest index
+	   * value (us) is returned. As it has been arranged, this ensures that
+	   * we don't drop a signal that we should act on (i.e. semaphore,
+	   * mutex, or condition variable etc).
+	   */
+	  result = 0;
+	  break;
+
+	case 1:
+	  /*
+	   * Got cancel request or interrupt.
+	   * In the event that both handles are signaled, the cancel will
+	   * be ignored (see case 0 comment).
+	   * A deferred cancel does not return from here.
+	   */
+	  if ((result = ptw32_cancel_event_check (sp)) == 0)
+	    {
+	      /*
+	       * Stale signal from an interrupt that has already been
+	       * consumed. Wait again for whatever time is left.
+	       */
+	      if (timeout != INFINITE)
+		{
+		  DWORD elapsed = GetTickCount () - started;
+
+		  timeout = (elapsed < timeout) ? timeout - elapsed : 0;
+		  started += elapsed;
+		}
+	      continue;
+	    }
+	  break;
+
+	default:
+	  if (status == WAIT_TIMEOUT)
+	    {
+	      result = ETIMEDOUT;
+	    }
+	  else
+	    {
+	      result = EINVAL;
+	    }
+	  break;
 	}
+
       break;
     }
 
+  if (timer != NULL && result != ETIMEDOUT)
+    {
+      /* Don't let it wake the system for nothing. */
+      (void) CancelWaitableTimer (timer);
+    }
+
   return (result);
 
-}				/* CancelableWait */
+}
+#endif				/* CancelableWait */
 
 int
 pthreadCancelableWait (HANDLE waitHandle)